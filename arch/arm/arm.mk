@@ -85,6 +85,9 @@ else ifeq ($(LOSCFG_ARCH_FPU_VFP_D16), y)
 else ifeq ($(LOSCFG_ARCH_FPU_VFP_D32), y)
     LITEOS_CMACRO       += -DLOSCFG_ARCH_FPU_VFP_D32
 endif
+ifeq ($(LOSCFG_ARCH_FPU_VFP_NEON), y)
+    LITEOS_CMACRO       += -DLOSCFG_ARCH_FPU_VFP_NEON
+endif
 
 # extra definition for other module
 LITEOS_CPU_TYPE          = $(LOSCFG_ARCH_CPU)
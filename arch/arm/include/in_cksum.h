@@ -43,6 +43,12 @@ unsigned int csum_partial_copy_nocheck(const void *src, void *dst, int len, unsi
 unsigned short in_cksum(const void *buf, int len);
 unsigned short in_cksum_copy(const void *src, void *dst, int len);
 
+#ifdef LOSCFG_ARCH_FPU_VFP_NEON
+/* NEON variants of csum_partial and csum_partial_copy_nocheck, task context only */
+unsigned int csum_partial_neon(const void *buf, int len, unsigned int wsum);
+unsigned int csum_partial_copy_neon(const void *src, void *dst, int len, unsigned int wsum);
+#endif
+
 #ifdef __cplusplus
 #if __cplusplus
 }
@@ -47,7 +47,9 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
-#include "los_queue_pri.h"
+#include "los_list.h"
+#include "los_event.h"
+#include "los_spinlock.h"
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -71,8 +73,11 @@ extern "C" {
 /* CONSTANTS */
 
 #define MQ_USE_MAGIC  0x89abcdef
-/* not suppurt prio */
-#define MQ_PRIO_MAX 1
+/* one message list per priority, the busiest non-empty list is found through a 32-bit bitmap */
+#define MQ_PRIO_MAX 32
+
+#define MQ_EVENT_READABLE 0x1
+#define MQ_EVENT_WRITABLE 0x2
 
 typedef union send_receive_t {
     unsigned oth : 3;
@@ -82,6 +87,25 @@ typedef union send_receive_t {
 } mode_s;
 
 /* TYPE DEFINITIONS */
+struct mqmsg {
+    LOS_DL_LIST node;  /* on the free list or on the list of its priority */
+    UINT32 prio;
+    UINT32 len;
+    CHAR data[0];
+};
+
+/* Message storage of one queue, allocated in one block together with maxmsg message slots */
+struct mqueuecb {
+    SPIN_LOCK_S lock;  /* protects the lists, the bitmap and curmsgs */
+    EVENT_CB_S event;  /* MQ_EVENT_READABLE / MQ_EVENT_WRITABLE */
+    UINT32 maxmsg;
+    UINT32 msgsize;
+    UINT32 curmsgs;
+    UINT32 prioBitmap; /* bit n set: prioList[n] is not empty */
+    LOS_DL_LIST freeList;
+    LOS_DL_LIST prioList[MQ_PRIO_MAX];
+};
+
 struct mqarray {
     UINT32 mq_id : 31;
     UINT32 unlinkflag : 1;
@@ -91,8 +115,9 @@ struct mqarray {
     uid_t euid; /* euid of mqueue */
     gid_t egid; /* egid of mqueue */
     fd_set mq_fdset; /* mqueue sysFd bit map */
-    LosQueueCB *mqcb;
+    struct mqueuecb *mqcb;
     struct mqpersonal *mq_personal;
+    UINT32 mq_busy; /* senders and receivers currently inside the queue */
 };
 
 struct mqpersonal {
@@ -235,16 +260,15 @@ extern int mq_unlink(const char *mqName);
  * a message queue that has a specified descriptor.
  * @attention
  * <ul>
- * <li> Priority-based message processing is not supported.</li>
+ * <li> Messages of a higher priority are received before messages of a lower priority,
+ *      messages of the same priority are received in the order they were sent.</li>
  * <li> The msg_len should be same to the length of string which msg_ptr point to.</li>
  * </ul>
  *
  * @param personal   [IN] Message queue descriptor.
  * @param msg        [IN] Pointer to the message content to be sent.
  * @param msgLen     [IN] Length of the message to be sent.
- * @param msgPrio    [IN] Priority of the message to be sent (the value of this parameter must
- *                        be 0 because priority-based message sending is not supported. If the
- *                        value is not 0, this API will cease to work.)
+ * @param msgPrio    [IN] Priority of the message to be sent, in the range [0, MQ_PRIO_MAX - 1].
  *
  * @retval  0    The message is successfully sent.
  * @retval -1    The message fails to be sent, with any of the following error codes in errno.
@@ -272,19 +296,17 @@ extern int mq_send(mqd_t personal, const char *msg, size_t msgLen, unsigned int
  * @ingroup mqueue
  *
  * @par Description:
- * This API is used to remove the oldest message from the message queue that has a specified descriptor,
- * and puts it in the buffer pointed to by msg_ptr.
+ * This API is used to remove the oldest message of the highest priority from the message queue that has
+ * a specified descriptor, and puts it in the buffer pointed to by msg_ptr.
  * @attention
  * <ul>
- * <li> Priority-based message processing is not supported.</li>
  * <li> The msg_len should be same to the length of string which msg_ptr point to.</li>
  * </ul>
  *
  * @param personal   [IN] Message queue descriptor.
  * @param msg        [IN] Pointer to the message content to be received.
  * @param msgLen     [IN] Length of the message to be received.
- * @param msgPrio    [OUT] Priority of the message to be received
- *                         because priority-based message processing is not supported, this parameter is useless).
+ * @param msgPrio    [OUT] Priority of the message to be received, may be NULL.
  *
  * @retval  0    The message is successfully received.
  * @retval -1    The message fails to be received, with any of the following error codes in the errno.
@@ -345,7 +367,6 @@ extern int mq_getsetattr(mqd_t personal, const struct mq_attr *mqSetAttr, struct
  * a message queue that has a descriptor at a scheduled time.
  * @attention
  * <ul>
- * <li> Priority-based message processing is not supported.</li>
  * <li> The expiry time must be later than the current time.</li>
  * <li> The wait time is a relative time.</li>
  * <li> The msg_len should be same to the length of string which msg_ptr point to.</li>
@@ -354,8 +375,7 @@ extern int mq_getsetattr(mqd_t personal, const struct mq_attr *mqSetAttr, struct
  * @param mqdes           [IN] Message queue descriptor.
  * @param msg             [IN] Pointer to the message content to be sent.
  * @param msgLen          [IN] Length of the message to be sent.
- * @param msgPrio         [IN] Priority of the message to be sent (the value of this parameter must be 0
- *                             because priority-based message processing is not supported).
+ * @param msgPrio         [IN] Priority of the message to be sent, in the range [0, MQ_PRIO_MAX - 1].
  * @param absTimeout      [IN] Scheduled time at which the message will be sent. If the value is 0,
  *                             the message is an instant message.
  *
@@ -388,7 +408,6 @@ extern int mq_timedsend(mqd_t personal, const char *msg, size_t msgLen,
  * a message queue message that has a specified descriptor.
  * @attention
  * <ul>
- * <li> Priority-based message processing is not supported.</li>
  * <li> The expiry time must be later than the current time.</li>
  * <li> The wait time is a relative time.</li>
  * <li> The msg_len should be same to the length of string which msg_ptr point to.</li>
@@ -397,8 +416,7 @@ extern int mq_timedsend(mqd_t personal, const char *msg, size_t msgLen,
  * @param personal        [IN] Message queue descriptor.
  * @param msg             [IN] Pointer to the message content to be received.
  * @param msgLen          [IN] Length of the message to be received.
- * @param msgPrio         [OUT] Priority of the message to be received (because priority-based message
- *                              processing is not supported, this parameter is useless ).
+ * @param msgPrio         [OUT] Priority of the message to be received, may be NULL.
  * @param absTimeout      [IN] Scheduled time at which the messagewill be received. If the value is 0,
  *                             the message is an instant message.
  *
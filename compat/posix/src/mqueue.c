@@ -37,6 +37,8 @@
 #include "los_memory.h"
 #include "los_vm_map.h"
 #include "los_process_pri.h"
+#include "los_bitmap.h"
+#include "los_tick.h"
 #include "fs_file.h"
 #include "user_copy.h"
 
@@ -58,6 +60,8 @@ STATIC struct mqarray g_queueTable[LOSCFG_BASE_IPC_QUEUE_LIMIT];
 //ϢҪ
 STATIC pthread_mutex_t g_mqueueMutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
 STATIC struct mqpersonal *g_mqPrivBuf[MAX_MQ_FD];
+/* Guards g_mqPrivBuf and mq_busy, so send/receive can pin a queue without g_mqueueMutex */
+LITE_OS_SEC_BSS SPIN_LOCK_INIT(g_mqueueSpin);
 
 /* LOCAL FUNCTIONS */
 //ϢƼ
@@ -80,23 +84,6 @@ STATIC INLINE INT32 MqNameCheck(const CHAR *mqName)
     return 0;
 }
 
-//ϢIDȡƿ
-STATIC INLINE UINT32 GetMqueueCBByID(UINT32 queueID, LosQueueCB **queueCB)
-{
-    LosQueueCB *tmpQueueCB = NULL;
-    if (queueCB == NULL) {
-        errno = EINVAL;
-        return LOS_ERRNO_QUEUE_READ_PTR_NULL;
-    }
-    tmpQueueCB = GET_QUEUE_HANDLE(queueID);
-    if ((GET_QUEUE_INDEX(queueID) >= LOSCFG_BASE_IPC_QUEUE_LIMIT) || (tmpQueueCB->queueID != queueID)) {
-        return LOS_ERRNO_QUEUE_INVALID; //ϢвڣϢѱɾ
-    }
-    *queueCB = tmpQueueCB;
-
-    return LOS_OK;
-}
-
 //ƻȡϢ
 STATIC INLINE struct mqarray *GetMqueueCBByName(const CHAR *name)
 {
@@ -119,7 +106,19 @@ STATIC INLINE struct mqarray *GetMqueueCBByName(const CHAR *name)
 //ɾϢпƿ
 STATIC INT32 DoMqueueDelete(struct mqarray *mqueueCB)
 {
-    UINT32 ret;
+    struct mqueuecb *mqcb = NULL;
+    UINT32 intSave;
+
+    /* a sender or receiver may still sleep on the queue after the last close */
+    LOS_SpinLockSave(&g_mqueueSpin, &intSave);
+    if (mqueueCB->mq_busy != 0) {
+        LOS_SpinUnlockRestore(&g_mqueueSpin, intSave);
+        errno = EAGAIN;
+        return -1;
+    }
+    mqcb = mqueueCB->mqcb;
+    mqueueCB->mqcb = NULL;
+    LOS_SpinUnlockRestore(&g_mqueueSpin, intSave);
 
     if (mqueueCB->mq_name != NULL) {
 		//ͷϢ
@@ -127,26 +126,16 @@ STATIC INT32 DoMqueueDelete(struct mqarray *mqueueCB)
         mqueueCB->mq_name = NULL;
     }
 
-    mqueueCB->mqcb = NULL;  //ԵײϢе
     /* When mqueue-list head node needed free ,reset the mode_data */
     mqueueCB->mode_data.data = 0;
     mqueueCB->euid = -1;
     mqueueCB->egid = -1;
 
-    ret = LOS_QueueDelete(mqueueCB->mq_id); //֪ͨײɾϢ
-    switch (ret) {
-        case LOS_OK:
-            return 0;
-        case LOS_ERRNO_QUEUE_NOT_FOUND:
-        case LOS_ERRNO_QUEUE_NOT_CREATE:
-        case LOS_ERRNO_QUEUE_IN_TSKUSE:
-        case LOS_ERRNO_QUEUE_IN_TSKWRITE:
-            errno = EAGAIN;
-            return -1;
-        default:
-            errno = EINVAL;
-            return -1;
+    if (mqcb != NULL) {
+        (VOID)LOS_EventDestroy(&mqcb->event);
+        (VOID)LOS_MemFree(OS_SYS_MEM_ADDR, mqcb);
     }
+    return 0;
 }
 
 //Ϣ
@@ -172,23 +161,60 @@ STATIC int SaveMqueueName(const CHAR *mqName, struct mqarray *mqueueCB)
     return LOS_OK;
 }
 
+/* Allocate the message storage: the queue head followed by maxmsg message slots, all on the free list */
+STATIC struct mqueuecb *MqueueCBAlloc(UINT32 maxmsg, UINT32 msgsize)
+{
+    struct mqueuecb *mqcb = NULL;
+    struct mqmsg *msg = NULL;
+    UINT32 stride = ALIGN(sizeof(struct mqmsg) + msgsize, sizeof(UINTPTR));
+    UINT64 size = sizeof(struct mqueuecb) + (UINT64)stride * maxmsg;
+    UINT32 index;
+
+    if (size > UINT32_MAX) {
+        return NULL;
+    }
+    mqcb = (struct mqueuecb *)LOS_MemAlloc(OS_SYS_MEM_ADDR, (UINT32)size);
+    if (mqcb == NULL) {
+        return NULL;
+    }
+
+    LOS_SpinInit(&mqcb->lock);
+    (VOID)LOS_EventInit(&mqcb->event);
+    mqcb->maxmsg = maxmsg;
+    mqcb->msgsize = msgsize;
+    mqcb->curmsgs = 0;
+    mqcb->prioBitmap = 0;
+    LOS_ListInit(&mqcb->freeList);
+    for (index = 0; index < MQ_PRIO_MAX; index++) {
+        LOS_ListInit(&mqcb->prioList[index]);
+    }
+    msg = (struct mqmsg *)(mqcb + 1);
+    for (index = 0; index < maxmsg; index++) {
+        LOS_ListTailInsert(&mqcb->freeList, &msg->node);
+        msg = (struct mqmsg *)((UINTPTR)msg + stride);
+    }
+    return mqcb;
+}
+
 STATIC struct mqpersonal *DoMqueueCreate(const struct mq_attr *attr, const CHAR *mqName, INT32 openFlag, UINT32 mode){
     struct mqarray *mqueueCB = NULL;
-    UINT32 mqueueID;
+    UINT32 index;
 
-	//õײ㴴
-    UINT32 err = LOS_QueueCreate(NULL, attr->mq_maxmsg, &mqueueID, 0, attr->mq_msgsize);
-    if (map_errno(err) != ENOERR) {
+    if ((attr->mq_maxmsg == 0) || (attr->mq_msgsize == 0)) {
+        errno = EINVAL;
         goto ERROUT;
     }
 
-    if (g_queueTable[GET_QUEUE_INDEX(mqueueID)].mqcb == NULL) {
-        mqueueCB = &(g_queueTable[GET_QUEUE_INDEX(mqueueID)]);
-        mqueueCB->mq_id = mqueueID; //¼ײϢID
+    for (index = 0; index < LOSCFG_BASE_IPC_QUEUE_LIMIT; index++) {
+        if ((g_queueTable[index].mqcb == NULL) && (g_queueTable[index].mq_name == NULL)) {
+            mqueueCB = &(g_queueTable[index]);
+            mqueueCB->mq_id = index;
+            break;
+        }
     }
 
     if (mqueueCB == NULL) {
-        errno = EINVAL;
+        errno = ENFILE;
         goto ERROUT;
     }
 
@@ -196,16 +222,18 @@ STATIC struct mqpersonal *DoMqueueCreate(const struct mq_attr *attr, const CHAR
         goto ERROUT; //Ϣ
     }
 
-    if (GetMqueueCBByID(mqueueCB->mq_id, &(mqueueCB->mqcb)) != LOS_OK) {
-        errno = ENOSPC; //ٴλȡײϢпƿʧܣ˵ʧ
+    mqueueCB->mqcb = MqueueCBAlloc((UINT32)attr->mq_maxmsg, (UINT32)attr->mq_msgsize);
+    if (mqueueCB->mqcb == NULL) {
+        errno = ENOSPC;
         goto ERROUT;
     }
+    mqueueCB->mq_busy = 0;
 
 	//Ϣи˽Ϣ
     mqueueCB->mq_personal = (struct mqpersonal *)LOS_MemAlloc(OS_SYS_MEM_ADDR, sizeof(struct mqpersonal));
     if (mqueueCB->mq_personal == NULL) {
-        (VOID)LOS_QueueDelete(mqueueCB->mq_id);
-        mqueueCB->mqcb->queueHandle = NULL;
+        (VOID)LOS_EventDestroy(&mqueueCB->mqcb->event);
+        (VOID)LOS_MemFree(OS_SYS_MEM_ADDR, mqueueCB->mqcb);
         mqueueCB->mqcb = NULL;
         errno = ENOSPC;
         goto ERROUT;
@@ -286,6 +314,7 @@ STATIC struct mqpersonal *MqGetPrivDataBuff(mqd_t personal)
 STATIC INT32 MqAllocSysFd(int maxfdp, struct mqpersonal *privateMqPersonal)
 {
     INT32 i;
+    UINT32 intSave;
     struct mqarray *mqueueCB = privateMqPersonal->mq_posixdes;
     fd_set *fdset = &mqueueCB->mq_fdset;
     for (i = 0; i < maxfdp; i++) {
@@ -293,7 +322,9 @@ STATIC INT32 MqAllocSysFd(int maxfdp, struct mqpersonal *privateMqPersonal)
         if (!(fdset && FD_ISSET(i + MQUEUE_FD_OFFSET, fdset))) {
             FD_SET(i + MQUEUE_FD_OFFSET, fdset);
             if (!g_mqPrivBuf[i]) {
+                LOS_SpinLockSave(&g_mqueueSpin, &intSave);
                 g_mqPrivBuf[i] = mqueueCB->mq_personal;
+                LOS_SpinUnlockRestore(&g_mqueueSpin, intSave);
                 return i + MQUEUE_FD_OFFSET;
             }
         }
@@ -308,10 +339,13 @@ STATIC INT32 MqAllocSysFd(int maxfdp, struct mqpersonal *privateMqPersonal)
 STATIC VOID MqFreeSysFd(struct mqarray *mqueueCB, mqd_t personal)
 {
     INT32 sysFd = (INT32)personal;
+    UINT32 intSave;
     fd_set *fdset = &mqueueCB->mq_fdset;
     if (fdset && FD_ISSET(sysFd, fdset)) {
         FD_CLR(sysFd, fdset);
+        LOS_SpinLockSave(&g_mqueueSpin, &intSave);
         g_mqPrivBuf[sysFd - MQUEUE_FD_OFFSET] = NULL;
+        LOS_SpinUnlockRestore(&g_mqueueSpin, intSave);
     }
 }
 
@@ -617,9 +651,9 @@ int OsMqGetAttr(mqd_t personal, struct mq_attr *mqAttr)
     }
 
     mqueueCB = privateMqPersonal->mq_posixdes;
-    mqAttr->mq_maxmsg = mqueueCB->mqcb->queueLen;
-    mqAttr->mq_msgsize = mqueueCB->mqcb->queueSize - sizeof(UINT32);
-    mqAttr->mq_curmsgs = mqueueCB->mqcb->readWriteableCnt[OS_QUEUE_READ];
+    mqAttr->mq_maxmsg = mqueueCB->mqcb->maxmsg;
+    mqAttr->mq_msgsize = mqueueCB->mqcb->msgsize;
+    mqAttr->mq_curmsgs = mqueueCB->mqcb->curmsgs;
     mqAttr->mq_flags = privateMqPersonal->mq_flags;
     (VOID)pthread_mutex_unlock(&g_mqueueMutex);
     return 0;
@@ -743,43 +777,218 @@ STATIC INLINE BOOL MqParamCheck(mqd_t personal, const char *msg, size_t msgLen)
         errno = errcode;                 \
         goto ERROUT;                     \
     }
+/* Pin the queue behind a descriptor for one send or receive, without taking g_mqueueMutex */
+STATIC struct mqarray *MqueueGet(mqd_t personal, INT32 *flags)
+{
+    struct mqpersonal *privateMqPersonal = NULL;
+    struct mqarray *mqueueCB = NULL;
+    UINT32 intSave;
+
+    LOS_SpinLockSave(&g_mqueueSpin, &intSave);
+    privateMqPersonal = MqGetPrivDataBuff(personal);
+    if (privateMqPersonal == NULL) {
+        goto OUT_UNLOCK;
+    }
+    if ((privateMqPersonal->mq_status != MQ_USE_MAGIC) || (privateMqPersonal->mq_posixdes->mqcb == NULL)) {
+        errno = EBADF;
+        goto OUT_UNLOCK;
+    }
+    mqueueCB = privateMqPersonal->mq_posixdes;
+    mqueueCB->mq_busy++;
+    *flags = privateMqPersonal->mq_flags;
+OUT_UNLOCK:
+    LOS_SpinUnlockRestore(&g_mqueueSpin, intSave);
+    return mqueueCB;
+}
+
+STATIC VOID MqueuePut(struct mqarray *mqueueCB)
+{
+    UINT32 intSave;
+
+    LOS_SpinLockSave(&g_mqueueSpin, &intSave);
+    mqueueCB->mq_busy--;
+    LOS_SpinUnlockRestore(&g_mqueueSpin, intSave);
+}
+
+/* Sleep until the event is posted; *ticks is reduced by the time slept */
+STATIC INT32 MqueueWait(struct mqueuecb *mqcb, UINT32 event, UINT64 *ticks)
+{
+    UINT64 start;
+    UINT64 elapsed;
+    UINT32 ret;
+
+    if (*ticks == LOS_NO_WAIT) {
+        return EAGAIN;
+    }
+
+    start = LOS_TickCountGet();
+    ret = LOS_EventRead(&mqcb->event, event, LOS_WAITMODE_OR | LOS_WAITMODE_CLR, (UINT32)*ticks);
+    if (ret == LOS_ERRNO_EVENT_READ_TIMEOUT) {
+        return ETIMEDOUT;
+    } else if (ret & LOS_ERRTYPE_ERROR) {
+        return EINVAL;
+    }
+
+    if (*ticks != LOS_WAIT_FOREVER) {
+        elapsed = LOS_TickCountGet() - start;
+        if (elapsed >= *ticks) {
+            return ETIMEDOUT;
+        }
+        *ticks -= elapsed;
+    }
+    return ENOERR;
+}
+
+/*
+ * The syscall layer hands user buffers straight through, so a message is copied once
+ * between the caller and its slot. Copies run outside the queue lock on a slot that
+ * is owned by the caller at that time.
+ */
+STATIC INT32 MqueueCopy(VOID *dst, const VOID *src, size_t len, BOOL toUser)
+{
+    INT32 ret;
+
+    if (toUser && LOS_IsUserAddressRange((VADDR_T)(UINTPTR)dst, len)) {
+        ret = (INT32)LOS_ArchCopyToUser(dst, src, len);
+    } else if (!toUser && LOS_IsUserAddressRange((VADDR_T)(UINTPTR)src, len)) {
+        ret = (INT32)LOS_ArchCopyFromUser(dst, src, len);
+    } else {
+        ret = memcpy_s(dst, len, src, len);
+    }
+    return (ret != 0) ? EFAULT : ENOERR;
+}
+
+/* Give a slot back to the free list and wake a sender */
+STATIC VOID MqueueMsgFree(struct mqueuecb *mqcb, struct mqmsg *msg)
+{
+    UINT32 intSave;
+
+    LOS_SpinLockSave(&mqcb->lock, &intSave);
+    LOS_ListAdd(&mqcb->freeList, &msg->node);
+    LOS_SpinUnlockRestore(&mqcb->lock, intSave);
+    (VOID)LOS_EventWrite(&mqcb->event, MQ_EVENT_WRITABLE);
+}
+
+STATIC INT32 MqueueSend(struct mqueuecb *mqcb, const CHAR *msg, size_t msgLen, UINT32 msgPrio, UINT64 ticks)
+{
+    struct mqmsg *node = NULL;
+    BOOL more = FALSE;
+    UINT32 intSave;
+    INT32 ret;
+
+    while (TRUE) {
+        LOS_SpinLockSave(&mqcb->lock, &intSave);
+        if (!LOS_ListEmpty(&mqcb->freeList)) {
+            node = LOS_DL_LIST_ENTRY(mqcb->freeList.pstNext, struct mqmsg, node);
+            LOS_ListDelete(&node->node);
+            more = !LOS_ListEmpty(&mqcb->freeList);
+            LOS_SpinUnlockRestore(&mqcb->lock, intSave);
+            break;
+        }
+        LOS_SpinUnlockRestore(&mqcb->lock, intSave);
+
+        ret = MqueueWait(mqcb, MQ_EVENT_WRITABLE, &ticks);
+        if (ret != ENOERR) {
+            return ret;
+        }
+    }
+
+    /* pass the wakeup on to the next sender when slots are left */
+    if (more) {
+        (VOID)LOS_EventWrite(&mqcb->event, MQ_EVENT_WRITABLE);
+    }
+
+    ret = MqueueCopy(node->data, msg, msgLen, FALSE);
+    if (ret != ENOERR) {
+        MqueueMsgFree(mqcb, node);
+        return ret;
+    }
+    node->prio = msgPrio;
+    node->len = (UINT32)msgLen;
+
+    LOS_SpinLockSave(&mqcb->lock, &intSave);
+    LOS_ListTailInsert(&mqcb->prioList[msgPrio], &node->node);
+    mqcb->prioBitmap |= 1U << msgPrio;
+    mqcb->curmsgs++;
+    LOS_SpinUnlockRestore(&mqcb->lock, intSave);
+
+    (VOID)LOS_EventWrite(&mqcb->event, MQ_EVENT_READABLE);
+    return ENOERR;
+}
+
+STATIC INT32 MqueueReceive(struct mqueuecb *mqcb, CHAR *msg, UINT32 *msgPrio, size_t *msgLen, UINT64 ticks)
+{
+    struct mqmsg *node = NULL;
+    BOOL more = FALSE;
+    UINT32 intSave;
+    UINT32 prio;
+    INT32 ret;
+
+    while (TRUE) {
+        LOS_SpinLockSave(&mqcb->lock, &intSave);
+        if (mqcb->prioBitmap != 0) {
+            /* the highest priority wins, messages of one priority leave in FIFO order */
+            prio = LOS_HighBitGet(mqcb->prioBitmap);
+            node = LOS_DL_LIST_ENTRY(mqcb->prioList[prio].pstNext, struct mqmsg, node);
+            LOS_ListDelete(&node->node);
+            if (LOS_ListEmpty(&mqcb->prioList[prio])) {
+                mqcb->prioBitmap &= ~(1U << prio);
+            }
+            mqcb->curmsgs--;
+            more = (mqcb->curmsgs != 0);
+            LOS_SpinUnlockRestore(&mqcb->lock, intSave);
+            break;
+        }
+        LOS_SpinUnlockRestore(&mqcb->lock, intSave);
+
+        ret = MqueueWait(mqcb, MQ_EVENT_READABLE, &ticks);
+        if (ret != ENOERR) {
+            return ret;
+        }
+    }
+
+    /* pass the wakeup on to the next receiver when messages are left */
+    if (more) {
+        (VOID)LOS_EventWrite(&mqcb->event, MQ_EVENT_READABLE);
+    }
+
+    ret = MqueueCopy(msg, node->data, node->len, TRUE);
+    *msgPrio = node->prio;
+    *msgLen = node->len;
+    MqueueMsgFree(mqcb, node);
+    return ret;
+}
+
 int mq_timedsend(mqd_t personal, const char *msg, size_t msgLen, unsigned int msgPrio,
                  const struct timespec *absTimeout)
 {
-    UINT32 mqueueID, err;
     UINT64 absTicks;
+    INT32 flags = 0;
+    INT32 err;
     struct mqarray *mqueueCB = NULL;
-    struct mqpersonal *privateMqPersonal = NULL;
 
     OS_MQ_GOTO_ERROUT_IF(!MqParamCheck(personal, msg, msgLen), errno);
     OS_MQ_GOTO_ERROUT_IF(msgPrio > (MQ_PRIO_MAX - 1), EINVAL);
 
-    (VOID)pthread_mutex_lock(&g_mqueueMutex);
-    privateMqPersonal = MqGetPrivDataBuff(personal);
-    if (privateMqPersonal == NULL) {
-        goto ERROUT_UNLOCK;
+    mqueueCB = MqueueGet(personal, &flags);
+    if (mqueueCB == NULL) {
+        goto ERROUT;
     }
 
-    OS_MQ_GOTO_ERROUT_UNLOCK_IF(privateMqPersonal->mq_status != MQ_USE_MAGIC, EBADF);
-
-    mqueueCB = privateMqPersonal->mq_posixdes;
-    OS_MQ_GOTO_ERROUT_UNLOCK_IF(msgLen > (size_t)(mqueueCB->mqcb->queueSize - sizeof(UINT32)), EMSGSIZE);
+    OS_MQ_GOTO_ERROUT_UNLOCK_IF(msgLen > (size_t)mqueueCB->mqcb->msgsize, EMSGSIZE);
 
-    OS_MQ_GOTO_ERROUT_UNLOCK_IF((((UINT32)privateMqPersonal->mq_flags & (UINT32)O_WRONLY) != (UINT32)O_WRONLY) &&
-                                (((UINT32)privateMqPersonal->mq_flags & (UINT32)O_RDWR) != (UINT32)O_RDWR),
+    OS_MQ_GOTO_ERROUT_UNLOCK_IF((((UINT32)flags & (UINT32)O_WRONLY) != (UINT32)O_WRONLY) &&
+                                (((UINT32)flags & (UINT32)O_RDWR) != (UINT32)O_RDWR),
                                 EBADF);
 
-    OS_MQ_GOTO_ERROUT_UNLOCK_IF(ConvertTimeout(privateMqPersonal->mq_flags, absTimeout, &absTicks) == -1, errno);
-    mqueueID = mqueueCB->mq_id;
-    (VOID)pthread_mutex_unlock(&g_mqueueMutex);
+    OS_MQ_GOTO_ERROUT_UNLOCK_IF(ConvertTimeout(flags, absTimeout, &absTicks) == -1, errno);
 
-    err = LOS_QueueWriteCopy(mqueueID, (VOID *)msg, (UINT32)msgLen, (UINT32)absTicks);
-    if (map_errno(err) != ENOERR) {
-        goto ERROUT;
-    }
+    err = MqueueSend(mqueueCB->mqcb, msg, msgLen, msgPrio, absTicks);
+    OS_MQ_GOTO_ERROUT_UNLOCK_IF(err != ENOERR, err);
+    MqueuePut(mqueueCB);
     return 0;
 ERROUT_UNLOCK:
-    (VOID)pthread_mutex_unlock(&g_mqueueMutex);
+    MqueuePut(mqueueCB);
 ERROUT:
     return -1;
 }
@@ -787,11 +996,12 @@ ERROUT:
 ssize_t mq_timedreceive(mqd_t personal, char *msg, size_t msgLen, unsigned int *msgPrio,
                         const struct timespec *absTimeout)
 {
-    UINT32 mqueueID, err;
-    UINT32 receiveLen;
+    UINT32 receivePrio = 0;
+    size_t receiveLen = 0;
     UINT64 absTicks;
+    INT32 flags = 0;
+    INT32 err;
     struct mqarray *mqueueCB = NULL;
-    struct mqpersonal *privateMqPersonal = NULL;
 
     if (!MqParamCheck(personal, msg, msgLen)) {
         goto ERROUT;
@@ -801,49 +1011,40 @@ ssize_t mq_timedreceive(mqd_t personal, char *msg, size_t msgLen, unsigned int *
         *msgPrio = 0;
     }
 
-    (VOID)pthread_mutex_lock(&g_mqueueMutex);
-    privateMqPersonal = MqGetPrivDataBuff(personal);
-    if (privateMqPersonal == NULL) {
-        goto ERROUT_UNLOCK;
-    }
-    if (privateMqPersonal->mq_status != MQ_USE_MAGIC) {
-        errno = EBADF;
-        goto ERROUT_UNLOCK;
+    mqueueCB = MqueueGet(personal, &flags);
+    if (mqueueCB == NULL) {
+        goto ERROUT;
     }
 
-    mqueueCB = privateMqPersonal->mq_posixdes;
-    if (msgLen < (size_t)(mqueueCB->mqcb->queueSize - sizeof(UINT32))) {
+    if (msgLen < (size_t)mqueueCB->mqcb->msgsize) {
         errno = EMSGSIZE;
         goto ERROUT_UNLOCK;
     }
 
-    if (((UINT32)privateMqPersonal->mq_flags & (UINT32)O_WRONLY) == (UINT32)O_WRONLY) {
+    if (((UINT32)flags & (UINT32)O_WRONLY) == (UINT32)O_WRONLY) {
         errno = EBADF;
         goto ERROUT_UNLOCK;
     }
 
-    if (ConvertTimeout(privateMqPersonal->mq_flags, absTimeout, &absTicks) == -1) {
+    if (ConvertTimeout(flags, absTimeout, &absTicks) == -1) {
         goto ERROUT_UNLOCK;
     }
 
-    receiveLen = msgLen;
-    mqueueID = mqueueCB->mq_id;
-    (VOID)pthread_mutex_unlock(&g_mqueueMutex);
+    err = MqueueReceive(mqueueCB->mqcb, msg, &receivePrio, &receiveLen, absTicks);
+    OS_MQ_GOTO_ERROUT_UNLOCK_IF(err != ENOERR, err);
+    MqueuePut(mqueueCB);
 
-    err = LOS_QueueReadCopy(mqueueID, (VOID *)msg, &receiveLen, (UINT32)absTicks);
-    if (map_errno(err) == ENOERR) {
-        return (ssize_t)receiveLen;
-    } else {
-        goto ERROUT;
+    if (msgPrio != NULL) {
+        *msgPrio = receivePrio;
     }
+    return (ssize_t)receiveLen;
 
 ERROUT_UNLOCK:
-    (VOID)pthread_mutex_unlock(&g_mqueueMutex);
+    MqueuePut(mqueueCB);
 ERROUT:
     return -1;
 }
 
-/* not support the prio */
 int mq_send(mqd_t personal, const char *msg_ptr, size_t msg_len, unsigned int msg_prio)
 {
     return mq_timedsend(personal, msg_ptr, msg_len, msg_prio, NULL);
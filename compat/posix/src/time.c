@@ -589,6 +589,7 @@ static VOID SwtmrProc(UINTPTR tmrArg)
     int sig;
     pid_t pid;
     siginfo_t info;
+    UINT32 intSave;
     swtmr_proc_arg *arg = (swtmr_proc_arg *)tmrArg;
     if (arg == NULL) {
         return;
@@ -610,7 +611,9 @@ static VOID SwtmrProc(UINTPTR tmrArg)
     info.si_value.sival_ptr = arg->sigev_value.sival_ptr;
 
     /* Send the signal */
-    OsDispatch(pid, &info, OS_USER_KILL_PERMISSION);
+    SCHEDULER_LOCK(intSave);
+    (VOID)OsDispatch(pid, &info, OS_USER_KILL_PERMISSION);
+    SCHEDULER_UNLOCK(intSave);
     return;
 }
 
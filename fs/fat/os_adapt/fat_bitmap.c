@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fatfs.h"
+#ifdef LOSCFG_FS_FAT
+#include "ff.h"
+#include "disk.h"
+#ifdef LOSCFG_FS_FAT_VIRTUAL_PARTITION
+#include "virpartff.h"
+#endif
+#include <errno.h>
+#include <stdlib.h>
+
+#define BITS_PER_WORD        32
+#define FAT_BITMAP_MAX_SIZE  0x100000 /* bytes; larger FATs are left to FatFs */
+#define FAT_BITMAP_HINT_SPAN 0x800    /* clusters one hint looks at past its cursor */
+
+typedef struct {
+    FATFS *fs;    /* volume the map is for, NULL while not started */
+    UINT32 *map;  /* one bit per cluster, set while the cluster is in use; NULL if only counted */
+    DWORD nclst;  /* fs->n_fatent */
+    DWORD scan;   /* next FAT entry the scan reads, the map and nfree cover the clusters below */
+    DWORD nfree;  /* free clusters below scan */
+    DWORD cursor; /* where the next hint starts looking */
+} FAT_BITMAP;
+
+static FAT_BITMAP g_fat_bitmap[SYS_MAX_PART];
+
+static FAT_BITMAP *fatfs_bitmap_get(const FATFS *fs)
+{
+    FAT_BITMAP *bm = NULL;
+
+    if (fs->pdrv >= SYS_MAX_PART) {
+        return NULL;
+    }
+    bm = &g_fat_bitmap[fs->pdrv];
+    return ((bm->fs == fs) && (bm->map != NULL)) ? bm : NULL;
+}
+
+static inline BOOL fatfs_bitmap_used(const FAT_BITMAP *bm, DWORD clst)
+{
+    return (bm->map[clst / BITS_PER_WORD] >> (clst % BITS_PER_WORD)) & 1;
+}
+
+static inline void fatfs_bitmap_set(FAT_BITMAP *bm, DWORD clst, BOOL used)
+{
+    if (used) {
+        bm->map[clst / BITS_PER_WORD] |= 1U << (clst % BITS_PER_WORD);
+    } else {
+        bm->map[clst / BITS_PER_WORD] &= ~(1U << (clst % BITS_PER_WORD));
+    }
+}
+
+/*
+ * Scan the FAT to its end, called with the volume locked: once by mount, and again by the
+ * operations that want the map if a disk error stopped the scan there. When the scan reaches
+ * the end the free count goes to fs->free_clst, where create_chain and remove_chain keep it
+ * current from then on. A FAT too large for the map is still counted.
+ */
+int fatfs_bitmap_build(FATFS *fs)
+{
+    FAT_BITMAP *bm = NULL;
+    FFOBJID obj;
+    DWORD link;
+    size_t size;
+
+    if (fs->pdrv >= SYS_MAX_PART) {
+        return -EINVAL;
+    }
+#if FF_FS_EXFAT
+    if (fs->fs_type == FS_EXFAT) { /* exFAT has an allocation bitmap of its own */
+        return 0;
+    }
+#endif
+#ifdef LOSCFG_FS_FAT_VIRTUAL_PARTITION
+    if (fs->vir_avail == FS_VIRENABLE) { /* virtual partitions count and allocate per range */
+        return 0;
+    }
+#endif
+    bm = &g_fat_bitmap[fs->pdrv];
+    if (bm->fs != fs) {
+        size = ((fs->n_fatent + BITS_PER_WORD - 1) / BITS_PER_WORD) * sizeof(UINT32);
+        bm->fs = fs;
+        bm->map = (size <= FAT_BITMAP_MAX_SIZE) ? (UINT32 *)zalloc(size) : NULL;
+        bm->nclst = fs->n_fatent;
+        bm->scan = FAT_RESERVED_NUM;
+        bm->nfree = 0;
+        bm->cursor = FAT_RESERVED_NUM;
+        if (bm->map != NULL) {
+            bm->map[0] |= (1U << FAT_RESERVED_NUM) - 1;
+        }
+    }
+    if (bm->scan >= bm->nclst) {
+        return 0;
+    }
+
+    obj.fs = fs;
+    for (; bm->scan < bm->nclst; bm->scan++) {
+        link = get_fat(&obj, bm->scan);
+        if ((link == 1) || (link == DISK_ERROR)) {
+            return -EIO; /* the next call reads the entry again */
+        }
+        if (link == 0) {
+            bm->nfree++;
+        } else if (bm->map != NULL) {
+            fatfs_bitmap_set(bm, bm->scan, TRUE);
+        }
+    }
+    fs->free_clst = bm->nfree;
+    return 0;
+}
+
+/*
+ * Free clusters for statfs. Until the scan has reached the end of the FAT, fs->free_clst is
+ * whatever FSInfo said, or not known at all, so the FAT is counted in full instead; a count
+ * the scan has only got part way through is never reported.
+ */
+int fatfs_bitmap_free(FATFS *fs, DWORD *nfree)
+{
+    FAT_BITMAP *bm = NULL;
+    FFOBJID obj;
+    DWORD clst;
+    DWORD link;
+    DWORD count = 0;
+
+    if (fs->pdrv >= SYS_MAX_PART) {
+        return -EINVAL;
+    }
+    bm = &g_fat_bitmap[fs->pdrv];
+    if ((bm->fs == fs) && (bm->scan >= bm->nclst)) {
+        *nfree = fs->free_clst;
+        return 0;
+    }
+#if FF_FS_EXFAT
+    if (fs->fs_type == FS_EXFAT) {
+        *nfree = fs->free_clst;
+        return 0;
+    }
+#endif
+#ifdef LOSCFG_FS_FAT_VIRTUAL_PARTITION
+    if (fs->vir_avail == FS_VIRENABLE) {
+        *nfree = fs->free_clst;
+        return 0;
+    }
+#endif
+
+    obj.fs = fs;
+    for (clst = FAT_RESERVED_NUM; clst < fs->n_fatent; clst++) {
+        link = get_fat(&obj, clst);
+        if ((link == 1) || (link == DISK_ERROR)) {
+            return -EIO;
+        }
+        if (link == 0) {
+            count++;
+        }
+    }
+    *nfree = count;
+    return 0;
+}
+
+void fatfs_bitmap_destroy(FATFS *fs)
+{
+    FAT_BITMAP *bm = NULL;
+
+    if (fs->pdrv >= SYS_MAX_PART) {
+        return;
+    }
+    bm = &g_fat_bitmap[fs->pdrv];
+    if (bm->fs == fs) {
+        free(bm->map);
+        bm->map = NULL;
+        bm->fs = NULL;
+        bm->nclst = 0;
+        bm->scan = 0;
+        bm->nfree = 0;
+    }
+}
+
+/*
+ * Every FAT entry that changes between free and in use is reported here. An entry a scan
+ * stopped by a disk error has not read yet is left to it, it will read the entry as it is by then.
+ */
+void fatfs_bitmap_put(FATFS *fs, DWORD clst, BOOL used)
+{
+    FAT_BITMAP *bm = fatfs_bitmap_get(fs);
+
+    if ((bm == NULL) || (clst < FAT_RESERVED_NUM) || (clst >= bm->scan)) {
+        return;
+    }
+    if (fatfs_bitmap_used(bm, clst) != (used ? 1 : 0)) {
+        fatfs_bitmap_set(bm, clst, used);
+        bm->nfree = used ? (bm->nfree - 1) : (bm->nfree + 1);
+    }
+}
+
+/*
+ * Steer the next allocation of nclst clusters: fs->last_clst, where FatFs starts looking for
+ * a new chain or for a fragment a chain cannot stretch into, is moved in front of the first
+ * free run that fits among the FAT_BITMAP_HINT_SPAN clusters after the hint cursor, or the
+ * longest one there. A tail cluster followed by a free one is left alone, FatFs stretches in
+ * place. The cursor goes round the scanned part of the map, one window per call.
+ */
+void fatfs_bitmap_hint(FATFS *fs, DWORD tail, DWORD nclst)
+{
+    FAT_BITMAP *bm = fatfs_bitmap_get(fs);
+    DWORD best = 0;
+    DWORD bestLen = 0;
+    DWORD start;
+    DWORD clst;
+    DWORD end;
+
+    if ((bm == NULL) || (bm->scan <= FAT_RESERVED_NUM)) {
+        return;
+    }
+    if ((tail >= FAT_RESERVED_NUM) && ((tail + 1) < bm->scan) && !fatfs_bitmap_used(bm, tail + 1)) {
+        return;
+    }
+
+    clst = ((bm->cursor >= FAT_RESERVED_NUM) && (bm->cursor < bm->scan)) ? bm->cursor : FAT_RESERVED_NUM;
+    end = (bm->scan - clst > FAT_BITMAP_HINT_SPAN) ? (clst + FAT_BITMAP_HINT_SPAN) : bm->scan;
+    while ((clst < end) && (bestLen < nclst)) {
+        if (((clst % BITS_PER_WORD) == 0) && (bm->map[clst / BITS_PER_WORD] == ~0U)) {
+            clst += BITS_PER_WORD;
+            continue;
+        }
+        if (fatfs_bitmap_used(bm, clst)) {
+            clst++;
+            continue;
+        }
+        /* a run may go on past the window, but no further than the request needs */
+        start = clst;
+        while ((clst < bm->scan) && ((clst - start) < nclst) && !fatfs_bitmap_used(bm, clst)) {
+            clst++;
+        }
+        if ((clst - start) > bestLen) {
+            best = start;
+            bestLen = clst - start;
+        }
+    }
+    bm->cursor = (clst < bm->scan) ? clst : FAT_RESERVED_NUM;
+
+    if (bestLen != 0) {
+        fs->last_clst = best - 1;
+    }
+}
+
+/* Mark the chain from clst to its end as in use, after FatFs has stretched it */
+void fatfs_bitmap_taken(FATFS *fs, DWORD clst)
+{
+    FAT_BITMAP *bm = fatfs_bitmap_get(fs);
+    FFOBJID obj;
+    DWORD count;
+
+    if (bm == NULL) {
+        return;
+    }
+    obj.fs = fs;
+    for (count = 0; (clst >= FAT_RESERVED_NUM) && (clst < bm->nclst) && (count < bm->nclst); count++) {
+        fatfs_bitmap_put(fs, clst, TRUE);
+        clst = get_fat(&obj, clst);
+    }
+}
+
+/* Clear the clusters of the chain starting at clst, before remove_chain frees it */
+void fatfs_bitmap_release(FATFS *fs, DWORD clst)
+{
+    FAT_BITMAP *bm = fatfs_bitmap_get(fs);
+    FFOBJID obj;
+    DWORD count;
+
+    if (bm == NULL) {
+        return;
+    }
+    obj.fs = fs;
+    for (count = 0; (clst >= FAT_RESERVED_NUM) && (clst < bm->nclst) && (count < bm->nclst); count++) {
+        fatfs_bitmap_put(fs, clst, FALSE);
+        clst = get_fat(&obj, clst);
+    }
+}
+#endif /* LOSCFG_FS_FAT */
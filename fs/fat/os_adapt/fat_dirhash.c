@@ -0,0 +1,623 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fatfs.h"
+#ifdef LOSCFG_FS_FAT
+#include "ff.h"
+#include "disk.h"
+#include "fs/vfs_util.h"
+#ifdef LOSCFG_FS_FAT_VIRTUAL_PARTITION
+#include "virpartff.h"
+#endif
+#include <stdlib.h>
+#include <string.h>
+
+#if FF_USE_LFN
+#define DIRHASH_MIN_ENTRIES 64      /* smaller directories are searched by dir_find */
+#define DIRHASH_MEM_MAX     0x40000 /* bytes of index per volume, least recently used out first */
+#define DIRHASH_VOL_BUCKETS 16      /* directories of a volume, by start cluster */
+#define DIRHASH_MIN_BUCKETS 64
+#define DIRHASH_NAMES       2     /* the long name and the 8.3 alias */
+#define DIRHASH_LOAD        2     /* grow when the entries exceed twice the buckets */
+#define LFN_CHARS_PER_ENT   13
+#define DIR_ENTRY_SIZE      32
+#define BLK_OFS_NONE        0xFFFFFFFF
+#define SFN_BODY_LEN        8
+#define SFN_E5              0xE5 /* a name starting with 0xE5 (the deleted mark) is stored with 0x05 */
+#define SFN_E5_STORED       0x05
+
+typedef struct DirHashEntry DIRHASH_ENTRY;
+
+typedef struct {
+    LOS_DL_LIST node;      /* in a name bucket */
+    DWORD hash;
+    const char *name;
+    DIRHASH_ENTRY *entry;
+} DIRHASH_NAME;
+
+struct DirHashEntry {
+    DIRHASH_NAME names[DIRHASH_NAMES];
+    LOS_DL_LIST posNode;   /* in a position bucket */
+    DWORD ofs;             /* first entry of the name, LFN included, for dir_sdi */
+    DWORD sfn;             /* the short entry, dp->dptr after dir_find */
+};
+
+typedef struct {
+    FATFS *fs;
+    LOS_DL_LIST dirs;      /* most recently used first */
+    LOS_DL_LIST buckets[DIRHASH_VOL_BUCKETS];
+    size_t bytes;          /* held by the indexes of the volume, the verdicts included */
+} DIRHASH_VOL;
+
+/*
+ * A directory too small or too large to be worth an index keeps only the verdict, so it is
+ * not read again on every lookup; a small one counts its entries and is indexed once it grows.
+ */
+typedef struct {
+    LOS_DL_LIST node;      /* in the volume's list */
+    LOS_DL_LIST hashNode;  /* in a bucket of the volume */
+    DIRHASH_VOL *vol;
+    DWORD sclst;           /* start cluster of the directory, 0 for the root */
+    BOOL overflow;         /* too large to index, dir_find it is */
+    BOOL small;            /* fewer than DIRHASH_MIN_ENTRIES entries, dir_find it is */
+    UINT32 count;
+    UINT32 nbucket;        /* power of two */
+    size_t bytes;
+    LOS_DL_LIST *names;
+    LOS_DL_LIST *pos;
+} DIRHASH;
+
+static DIRHASH_VOL g_dirhash[SYS_MAX_PART];
+
+static inline char dirhash_fold(char c)
+{
+    return ((c >= 'a') && (c <= 'z')) ? (char)(c - 'a' + 'A') : c;
+}
+
+/* FAT compares names without case; only ASCII is folded here, other bytes must match exactly */
+static DWORD dirhash_hash(const char *name, size_t len)
+{
+    DWORD hash = FNV1_32_INIT;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        hash *= FNV_32_PRIME;
+        hash ^= (BYTE)dirhash_fold(name[i]);
+    }
+    return hash;
+}
+
+static BOOL dirhash_equal(const char *stored, const char *name, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        if ((stored[i] == '\0') || (dirhash_fold(stored[i]) != dirhash_fold(name[i]))) {
+            return FALSE;
+        }
+    }
+    return stored[len] == '\0';
+}
+
+/*
+ * A name the index can declare absent: printable ASCII that create_name takes as it is, so
+ * no case folding beyond ASCII, no trailing dots or spaces stripped, nothing rejected.
+ */
+static BOOL dirhash_plain(const char *name, size_t len)
+{
+    size_t i;
+
+    if ((len == 0) || (name[0] == ' ') || (name[len - 1] == '.') || (name[len - 1] == ' ')) {
+        return FALSE;
+    }
+    for (i = 0; i < len; i++) {
+        if ((name[i] < 0x20) || (name[i] > 0x7E) || (strchr("\"*/:<>?\\|", name[i]) != NULL)) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static DIRHASH_VOL *dirhash_vol(FATFS *fs)
+{
+    DIRHASH_VOL *vol = NULL;
+    UINT32 i;
+
+    if (fs->pdrv >= SYS_MAX_PART) {
+        return NULL;
+    }
+#if FF_FS_EXFAT
+    if (fs->fs_type == FS_EXFAT) {
+        return NULL;
+    }
+#endif
+#ifdef LOSCFG_FS_FAT_VIRTUAL_PARTITION
+    if (fs->vir_flag == FS_CHILD) { /* children share the drive of their parent */
+        return NULL;
+    }
+#endif
+    vol = &g_dirhash[fs->pdrv];
+    if (vol->fs != fs) {
+        vol->fs = fs;
+        vol->bytes = 0;
+        LOS_ListInit(&vol->dirs);
+        for (i = 0; i < DIRHASH_VOL_BUCKETS; i++) {
+            LOS_ListInit(&vol->buckets[i]);
+        }
+    }
+    return vol;
+}
+
+static inline void dirhash_charge(DIRHASH *dh, size_t bytes, BOOL add)
+{
+    if (add) {
+        dh->bytes += bytes;
+        dh->vol->bytes += bytes;
+    } else {
+        dh->bytes -= bytes;
+        dh->vol->bytes -= bytes;
+    }
+}
+
+static inline BOOL dirhash_indexed(const DIRHASH *dh)
+{
+    return !dh->overflow && !dh->small;
+}
+
+static void dirhash_free(DIRHASH *dh)
+{
+    DIRHASH_ENTRY *entry = NULL;
+    DIRHASH_ENTRY *next = NULL;
+    UINT32 i;
+
+    for (i = 0; (dh->pos != NULL) && (i < dh->nbucket); i++) {
+        LOS_DL_LIST_FOR_EACH_ENTRY_SAFE(entry, next, &dh->pos[i], DIRHASH_ENTRY, posNode) {
+            free(entry);
+        }
+    }
+    free(dh->names);
+    free(dh->pos);
+    dh->vol->bytes -= dh->bytes;
+    free(dh);
+}
+
+static void dirhash_detach(DIRHASH *dh)
+{
+    LOS_ListDelete(&dh->node);
+    LOS_ListDelete(&dh->hashNode);
+    dirhash_free(dh);
+}
+
+static BOOL dirhash_buckets(DIRHASH *dh, UINT32 nbucket)
+{
+    LOS_DL_LIST *names = NULL;
+    LOS_DL_LIST *pos = NULL;
+    DIRHASH_ENTRY *entry = NULL;
+    DIRHASH_ENTRY *next = NULL;
+    UINT32 i;
+    UINT32 n;
+
+    if ((dh->bytes + nbucket * sizeof(LOS_DL_LIST) * 2) > DIRHASH_MEM_MAX) {
+        return FALSE;
+    }
+    names = (LOS_DL_LIST *)malloc(nbucket * sizeof(LOS_DL_LIST));
+    pos = (LOS_DL_LIST *)malloc(nbucket * sizeof(LOS_DL_LIST));
+    if ((names == NULL) || (pos == NULL)) {
+        free(names);
+        free(pos);
+        return FALSE;
+    }
+    for (i = 0; i < nbucket; i++) {
+        LOS_ListInit(&names[i]);
+        LOS_ListInit(&pos[i]);
+    }
+    for (i = 0; (dh->pos != NULL) && (i < dh->nbucket); i++) {
+        LOS_DL_LIST_FOR_EACH_ENTRY_SAFE(entry, next, &dh->pos[i], DIRHASH_ENTRY, posNode) {
+            LOS_ListDelete(&entry->posNode);
+            LOS_ListTailInsert(&pos[entry->sfn & (nbucket - 1)], &entry->posNode);
+            for (n = 0; n < DIRHASH_NAMES; n++) {
+                if (entry->names[n].name != NULL) {
+                    LOS_ListDelete(&entry->names[n].node);
+                    LOS_ListTailInsert(&names[entry->names[n].hash & (nbucket - 1)], &entry->names[n].node);
+                }
+            }
+        }
+    }
+    free(dh->names);
+    free(dh->pos);
+    if (dh->pos != NULL) {
+        dirhash_charge(dh, dh->nbucket * sizeof(LOS_DL_LIST) * 2, FALSE);
+    }
+    dirhash_charge(dh, nbucket * sizeof(LOS_DL_LIST) * 2, TRUE);
+    dh->names = names;
+    dh->pos = pos;
+    dh->nbucket = nbucket;
+    return TRUE;
+}
+
+static void dirhash_remove_entry(DIRHASH *dh, DIRHASH_ENTRY *entry)
+{
+    size_t size = sizeof(DIRHASH_ENTRY);
+    UINT32 n;
+
+    for (n = 0; n < DIRHASH_NAMES; n++) {
+        if (entry->names[n].name != NULL) {
+            LOS_ListDelete(&entry->names[n].node);
+            size += strlen(entry->names[n].name) + 1;
+        }
+    }
+    LOS_ListDelete(&entry->posNode);
+    free(entry);
+    dirhash_charge(dh, size, FALSE);
+    dh->count--;
+}
+
+static BOOL dirhash_insert(DIRHASH *dh, DWORD ofs, DWORD sfn, const char *name, size_t len, const char *alias)
+{
+    size_t alen = ((alias != NULL) && (alias[0] != '\0')) ? strlen(alias) : 0;
+    DIRHASH_ENTRY *entry = NULL;
+    char *buf = NULL;
+    size_t size;
+
+    if ((alen != 0) && dirhash_equal(alias, name, len)) {
+        alen = 0; /* an 8.3 name is its own alias */
+    }
+    size = sizeof(DIRHASH_ENTRY) + len + 1 + ((alen != 0) ? (alen + 1) : 0);
+    if (((dh->bytes + size) > DIRHASH_MEM_MAX) ||
+        ((dh->count >= dh->nbucket * DIRHASH_LOAD) && !dirhash_buckets(dh, dh->nbucket << 1))) {
+        return FALSE;
+    }
+    entry = (DIRHASH_ENTRY *)malloc(size);
+    if (entry == NULL) {
+        return FALSE;
+    }
+    dirhash_charge(dh, size, TRUE);
+    buf = (char *)(entry + 1);
+    (void)memcpy_s(buf, len + 1, name, len);
+    buf[len] = '\0';
+    entry->ofs = ofs;
+    entry->sfn = sfn;
+    entry->names[0].name = buf;
+    entry->names[0].hash = dirhash_hash(buf, len);
+    entry->names[0].entry = entry;
+    LOS_ListTailInsert(&dh->names[entry->names[0].hash & (dh->nbucket - 1)], &entry->names[0].node);
+    entry->names[1].name = NULL;
+    if (alen != 0) {
+        buf += len + 1;
+        (void)memcpy_s(buf, alen + 1, alias, alen + 1);
+        entry->names[1].name = buf;
+        entry->names[1].hash = dirhash_hash(buf, alen);
+        entry->names[1].entry = entry;
+        LOS_ListTailInsert(&dh->names[entry->names[1].hash & (dh->nbucket - 1)], &entry->names[1].node);
+    }
+    LOS_ListTailInsert(&dh->pos[sfn & (dh->nbucket - 1)], &entry->posNode);
+    dh->count++;
+    return TRUE;
+}
+
+/* A verdict alone, or the start of an index: the record of one directory, charged to vol */
+static DIRHASH *dirhash_new(DIRHASH_VOL *vol, DWORD sclst)
+{
+    DIRHASH *dh = (DIRHASH *)zalloc(sizeof(DIRHASH));
+
+    if (dh == NULL) {
+        return NULL;
+    }
+    dh->vol = vol;
+    dh->sclst = sclst;
+    dirhash_charge(dh, sizeof(DIRHASH), TRUE);
+    return dh;
+}
+
+/* Read the whole directory once; the caller holds the volume lock and has set up the name buffer */
+static DIRHASH *dirhash_build(DIRHASH_VOL *vol, FATFS *fs, DWORD sclst)
+{
+    DIRHASH *dh = dirhash_new(vol, sclst);
+    BOOL overflow;
+    UINT32 count;
+    FILINFO fno;
+    DIR dir;
+    FRESULT result;
+
+    if ((dh == NULL) || !dirhash_buckets(dh, DIRHASH_MIN_BUCKETS)) {
+        if (dh != NULL) {
+            dirhash_free(dh);
+        }
+        return NULL;
+    }
+
+    (void)memset_s(&dir, sizeof(dir), 0, sizeof(dir));
+    dir.obj.fs = fs;
+    dir.obj.sclust = sclst;
+    result = dir_sdi(&dir, 0);
+    while (result == FR_OK) {
+        result = dir_read(&dir, 0);
+        if (result != FR_OK) {
+            break;
+        }
+        get_fileinfo(&dir, &fno);
+        if ((fno.fname[0] == 0x00) || (fno.fname[0] == (TCHAR)0xFF)) {
+            result = FR_NO_FILE;
+            break;
+        }
+        if (!dirhash_insert(dh, (dir.blk_ofs != BLK_OFS_NONE) ? dir.blk_ofs : dir.dptr, dir.dptr,
+                            fno.fname, strlen(fno.fname), fno.altname)) {
+            dh->overflow = TRUE;
+            break;
+        }
+        result = dir_next(&dir, 0);
+    }
+    if (!dh->overflow && (result != FR_NO_FILE)) {
+        dirhash_free(dh);
+        return NULL;
+    }
+    if (!dh->overflow && (dh->count >= DIRHASH_MIN_ENTRIES)) {
+        return dh;
+    }
+
+    /* keep the verdict, not the entries */
+    overflow = dh->overflow;
+    count = dh->count;
+    dirhash_free(dh);
+    dh = dirhash_new(vol, sclst);
+    if (dh == NULL) {
+        return NULL;
+    }
+    dh->overflow = overflow;
+    dh->small = !overflow;
+    dh->count = overflow ? 0 : count;
+    return dh;
+}
+
+/* Give back memory over DIRHASH_MEM_MAX, least recently used first, keep aside */
+static void dirhash_trim(DIRHASH_VOL *vol, const DIRHASH *keep)
+{
+    DIRHASH *old = NULL;
+
+    while ((vol->bytes > DIRHASH_MEM_MAX) && !LOS_ListEmpty(&vol->dirs)) {
+        old = LOS_DL_LIST_ENTRY(vol->dirs.pstPrev, DIRHASH, node);
+        if (old == keep) {
+            break;
+        }
+        dirhash_detach(old);
+    }
+}
+
+static DIRHASH *dirhash_get(FATFS *fs, DWORD sclst, BOOL build)
+{
+    DIRHASH_VOL *vol = dirhash_vol(fs);
+    LOS_DL_LIST *bucket = NULL;
+    DIRHASH *dh = NULL;
+
+    if (vol == NULL) {
+        return NULL;
+    }
+    bucket = &vol->buckets[sclst % DIRHASH_VOL_BUCKETS];
+    LOS_DL_LIST_FOR_EACH_ENTRY(dh, bucket, DIRHASH, hashNode) {
+        if (dh->sclst == sclst) {
+            LOS_ListDelete(&dh->node);
+            LOS_ListAdd(&vol->dirs, &dh->node);
+            return dh;
+        }
+    }
+    if (!build) {
+        return NULL;
+    }
+
+    dh = dirhash_build(vol, fs, sclst);
+    if (dh == NULL) {
+        return NULL;
+    }
+    dirhash_trim(vol, NULL); /* the new index counts already */
+    LOS_ListAdd(&vol->dirs, &dh->node);
+    LOS_ListAdd(bucket, &dh->hashNode);
+    return dh;
+}
+
+/*
+ * Look name up in the index of the directory dp->obj.sclust, building it on first use.
+ * Must run before create_name, since reading entries reuses the name buffer.
+ * FR_OK: found, dp is left on the entry as dir_find leaves it.
+ * FR_NO_FILE: the name is certainly absent.
+ * FR_DENIED: the index cannot tell; parse the name and dir_find it.
+ */
+FRESULT fatfs_dirhash_find(DIR *dp, const char *name, size_t len)
+{
+    FATFS *fs = dp->obj.fs;
+    DIRHASH *dh = dirhash_get(fs, dp->obj.sclust, TRUE);
+    DIRHASH_NAME *node = NULL;
+    DIRHASH_ENTRY *entry = NULL;
+    DWORD hash;
+    FRESULT result;
+
+    if ((dh == NULL) || !dirhash_indexed(dh)) {
+        return FR_DENIED;
+    }
+
+    hash = dirhash_hash(name, len);
+    LOS_DL_LIST_FOR_EACH_ENTRY(node, &dh->names[hash & (dh->nbucket - 1)], DIRHASH_NAME, node) {
+        if ((node->hash != hash) || !dirhash_equal(node->name, name, len)) {
+            continue;
+        }
+        entry = node->entry;
+        result = dir_sdi(dp, entry->ofs);
+        if (result == FR_OK) {
+            result = dir_read(dp, 0);
+        }
+        if ((result == FR_OK) && (dp->dptr == entry->sfn)) {
+            return FR_OK;
+        }
+        fatfs_dirhash_drop(fs, dp->obj.sclust); /* out of step with the disk, start over */
+        return FR_DENIED;
+    }
+
+    return dirhash_plain(name, len) ? FR_NO_FILE : FR_DENIED;
+}
+
+/* "NAME    EXT" as dir_register stored it in dp->fn, back to "NAME.EXT" */
+static void dirhash_sfn(const BYTE *fn, char *buf)
+{
+    UINT i;
+    UINT j = 0;
+
+    for (i = 0; (i < SFN_BODY_LEN) && (fn[i] != ' '); i++) {
+        buf[j++] = (char)(((i == 0) && (fn[i] == SFN_E5_STORED)) ? SFN_E5 : fn[i]);
+    }
+    if (fn[SFN_BODY_LEN] != ' ') {
+        buf[j++] = '.';
+        for (i = SFN_BODY_LEN; (i < DIR_NAME_LEN) && (fn[i] != ' '); i++) {
+            buf[j++] = (char)fn[i];
+        }
+    }
+    buf[j] = '\0';
+}
+
+/*
+ * Record the entry dir_register has just written at dp under name. The long name, when there
+ * is one, is still in the name buffer and tells how many entries precede the short one.
+ */
+void fatfs_dirhash_add(DIR *dp, const char *name)
+{
+    FATFS *fs = dp->obj.fs;
+    DIRHASH *dh = dirhash_get(fs, dp->obj.sclust, FALSE);
+    char alias[DIR_NAME_LEN + 2]; /* dot and terminator */
+    size_t len = strlen(name);
+    DWORD ofs = dp->dptr;
+    UINT n = 0;
+
+    if ((dh == NULL) || dh->overflow) {
+        return;
+    }
+    if (dh->small) {
+        if (++dh->count >= DIRHASH_MIN_ENTRIES) {
+            fatfs_dirhash_drop(fs, dp->obj.sclst); /* large enough now, the next lookup indexes it */
+        }
+        return;
+    }
+    while ((len > 0) && ((name[len - 1] == '.') || (name[len - 1] == ' '))) {
+        len--; /* create_name drops them too */
+    }
+    if (dp->fn[NSFLAG] & NS_LFN) {
+        while (fs->lfnbuf[n] != 0) {
+            n++;
+        }
+        ofs -= ((n + LFN_CHARS_PER_ENT - 1) / LFN_CHARS_PER_ENT) * DIR_ENTRY_SIZE;
+    }
+    dirhash_sfn(dp->fn, alias);
+    if (!dirhash_insert(dh, ofs, dp->dptr, name, len, alias)) {
+        fatfs_dirhash_drop(fs, dp->obj.sclust);
+        return;
+    }
+    dirhash_trim(dh->vol, dh);
+}
+
+/*
+ * Forget the entry dir_remove has just freed at dp; if dir_remove failed part way the
+ * directory may be half updated and its whole index goes.
+ */
+void fatfs_dirhash_remove(DIR *dp, FRESULT result)
+{
+    DIRHASH *dh = dirhash_get(dp->obj.fs, dp->obj.sclust, FALSE);
+    DIRHASH_ENTRY *entry = NULL;
+
+    if ((dh == NULL) || dh->overflow) {
+        return;
+    }
+    if (result != FR_OK) {
+        fatfs_dirhash_drop(dp->obj.fs, dp->obj.sclust);
+        return;
+    }
+    if (dh->small) {
+        dh->count -= (dh->count != 0) ? 1 : 0;
+        return;
+    }
+    LOS_DL_LIST_FOR_EACH_ENTRY(entry, &dh->pos[dp->dptr & (dh->nbucket - 1)], DIRHASH_ENTRY, posNode) {
+        if (entry->sfn == dp->dptr) {
+            dirhash_remove_entry(dh, entry);
+            return;
+        }
+    }
+}
+
+/* Drop the index of one directory, e.g. when it is removed or changed behind the index's back */
+void fatfs_dirhash_drop(FATFS *fs, DWORD sclst)
+{
+    DIRHASH_VOL *vol = dirhash_vol(fs);
+    DIRHASH *dh = NULL;
+
+    if (vol == NULL) {
+        return;
+    }
+    LOS_DL_LIST_FOR_EACH_ENTRY(dh, &vol->buckets[sclst % DIRHASH_VOL_BUCKETS], DIRHASH, hashNode) {
+        if (dh->sclst == sclst) {
+            dirhash_detach(dh);
+            return;
+        }
+    }
+}
+
+void fatfs_dirhash_destroy(FATFS *fs)
+{
+    DIRHASH_VOL *vol = dirhash_vol(fs);
+    DIRHASH *dh = NULL;
+    DIRHASH *next = NULL;
+
+    if (vol == NULL) {
+        return;
+    }
+    LOS_DL_LIST_FOR_EACH_ENTRY_SAFE(dh, next, &vol->dirs, DIRHASH, node) {
+        dirhash_detach(dh);
+    }
+    vol->fs = NULL;
+}
+#else
+FRESULT fatfs_dirhash_find(DIR *dp, const char *name, size_t len)
+{
+    return FR_DENIED;
+}
+
+void fatfs_dirhash_add(DIR *dp, const char *name)
+{
+}
+
+void fatfs_dirhash_remove(DIR *dp, FRESULT result)
+{
+}
+
+void fatfs_dirhash_drop(FATFS *fs, DWORD sclst)
+{
+}
+
+void fatfs_dirhash_destroy(FATFS *fs)
+{
+}
+#endif /* FF_USE_LFN */
+#endif /* LOSCFG_FS_FAT */
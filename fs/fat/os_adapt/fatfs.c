@@ -76,6 +76,11 @@ struct file_operations_vfs fatfs_fops;
 #define FTIME_DATE_OFFSET 16 /* date offset in dword */
 #define SEC_MULTIPLIER 2
 #define YEAR_OFFSET 80 /* Year start from 1980 in FATFS, while start from 1900 in struct tm */
+#if FF_USE_FASTSEEK
+#define EXTENT_MIN_CLUSTERS 64   /* shorter files just follow the FAT chain */
+#define EXTENT_INIT_LEN     32   /* DWORDs of the first cluster map, 15 fragments */
+#define EXTENT_MAX_LEN      4096 /* DWORDs, 2047 fragments; files more fragmented than this go without */
+#endif
 
 int fatfs_2_vfs(int result)
 {
@@ -256,13 +261,15 @@ int fatfs_lookup(struct Vnode *parent, const char *path, int len, struct Vnode *
 
     DEF_NAMBUF;
     INIT_NAMBUF(fs);
-    result = create_name(dp, &path);
-    if (result != FR_OK) {
-        ret = fatfs_2_vfs(result);
-        goto ERROR_UNLOCK;
+    result = fatfs_dirhash_find(dp, path, (size_t)len);
+    if (result == FR_DENIED) {
+        result = create_name(dp, &path);
+        if (result != FR_OK) {
+            ret = fatfs_2_vfs(result);
+            goto ERROR_UNLOCK;
+        }
+        result = dir_find(dp);
     }
-
-    result = dir_find(dp);
     if (result != FR_OK) {
         ret = fatfs_2_vfs(result);
         goto ERROR_UNLOCK;
@@ -329,9 +336,11 @@ int fatfs_create(struct Vnode *parent, const char *name, int mode, struct Vnode
     DIR_FILE *dfp;
     DIR *dp = NULL;
     FILINFO *finfo = NULL;
+    const char *fname = name;
     QWORD time;
     DWORD hash;
     FRESULT result;
+    BOOL absent;
     int ret;
 
     dfp = (DIR_FILE *)zalloc(sizeof(DIR_FILE));
@@ -353,13 +362,18 @@ int fatfs_create(struct Vnode *parent, const char *name, int mode, struct Vnode
 
     DEF_NAMBUF;
     INIT_NAMBUF(fs);
+    result = fatfs_dirhash_find(dp, name, strlen(name));
+    if (result == FR_OK) {
+        ret = EEXIST;
+        goto ERROR_UNLOCK;
+    }
+    absent = (result == FR_NO_FILE);
     result = create_name(dp, &name);
     if (result != FR_OK) {
         ret = fatfs_2_vfs(result);
         goto ERROR_UNLOCK;
     }
-    result = dir_find(dp);
-    if (result == FR_OK) {
+    if (!absent && (dir_find(dp) == FR_OK)) {
         ret = EEXIST;
         goto ERROR_UNLOCK;
     }
@@ -368,6 +382,8 @@ int fatfs_create(struct Vnode *parent, const char *name, int mode, struct Vnode
         ret = fatfs_2_vfs(result);
         goto ERROR_UNLOCK;
     }
+    fatfs_bitmap_put(fs, dp->clust, TRUE); /* the directory may have grown */
+    fatfs_dirhash_add(dp, fname);
     /* Set the directory entry attribute */
     if (time_status == SYSTEM_TIME_ENABLE) {
         time = GET_FATTIME();
@@ -438,6 +454,82 @@ ERROR_EXIT:
     return -ret;
 }
 
+#if FF_USE_FASTSEEK
+/* Drop the cluster maps of every open instance of a file whose cluster chain may change */
+static void fatfs_extent_drop(FILINFO *finfo)
+{
+    FIL *entry = NULL;
+
+    LOS_DL_LIST_FOR_EACH_ENTRY(entry, &finfo->fp_list, FIL, fp_entry) {
+        if (entry->cltbl != NULL) {
+            free(entry->cltbl);
+            entry->cltbl = NULL;
+        }
+    }
+}
+
+/*
+ * A write that allocates clusters goes past the end of the maps, those of the other open
+ * instances of the file included, whether or not the writing one has a map.
+ */
+static void fatfs_extent_write(const FIL *fp, FILINFO *finfo, size_t count)
+{
+    FATFS *fs = fp->obj.fs;
+    FSIZE_t csize = (FSIZE_t)SS(fs) * fs->csize;
+
+    if ((fp->fptr + count) > (((finfo->fsize + csize - 1) / csize) * csize)) {
+        fatfs_extent_drop(finfo);
+    }
+}
+
+/*
+ * Build the cluster map of a large file on first use, so that seeks and cluster crossings
+ * are resolved in memory instead of by following the FAT chain.
+ */
+static void fatfs_extent_build(FIL *fp)
+{
+    FATFS *fs = fp->obj.fs;
+    DWORD len = EXTENT_INIT_LEN;
+    DWORD *tbl = NULL;
+    FRESULT result;
+
+    if ((fp->cltbl != NULL) || (fp->obj.sclust == 0) ||
+        (fp->obj.objsize < (FSIZE_t)SS(fs) * fs->csize * EXTENT_MIN_CLUSTERS)) {
+        return;
+    }
+
+    while (len <= EXTENT_MAX_LEN) {
+        tbl = (DWORD *)malloc(len * sizeof(DWORD));
+        if (tbl == NULL) {
+            return;
+        }
+        tbl[0] = len;
+        fp->cltbl = tbl;
+        result = f_lseek(fp, CREATE_LINKMAP);
+        if (result == FR_OK) {
+            return;
+        }
+        fp->cltbl = NULL;
+        len = tbl[0]; /* the size the map needs */
+        free(tbl);
+        if (result != FR_NOT_ENOUGH_CORE) {
+            return;
+        }
+    }
+}
+#endif
+
+/* Clusters a write of count bytes at the file pointer adds to the file */
+static DWORD fatfs_write_clusters(const FIL *fp, const FILINFO *finfo, size_t count)
+{
+    FATFS *fs = fp->obj.fs;
+    FSIZE_t csize = (FSIZE_t)SS(fs) * fs->csize;
+    FSIZE_t alloc = ((finfo->fsize + csize - 1) / csize) * csize;
+    FSIZE_t end = fp->fptr + count;
+
+    return (end > alloc) ? (DWORD)((end - alloc + csize - 1) / csize) : 0;
+}
+
 int fatfs_open(struct file *filep)
 {
     struct Vnode *vp = filep->f_vnode;
@@ -513,6 +605,9 @@ int fatfs_close(struct file *filep)
     }
 #endif
     LOS_ListDelete(&fp->fp_entry);
+#if FF_USE_FASTSEEK
+    free(fp->cltbl);
+#endif
     ff_memfree(fp->buf);
     free(fp);
     filep->f_priv = NULL;
@@ -537,6 +632,9 @@ int fatfs_read(struct file *filep, char *buff, size_t count)
     }
     fp->obj.objsize = finfo->fsize;
     fp->obj.sclust = finfo->sclst;
+#if FF_USE_FASTSEEK
+    fatfs_extent_build(fp);
+#endif
     result = f_read(fp, buff, count, &rcount);
     if (result != FR_OK) {
         goto EXIT;
@@ -586,6 +684,8 @@ off64_t fatfs_lseek64(struct file *filep, off64_t offset, int whence)
     FILINFO *finfo = &(dfp->fno);
     FSIZE_t fpos;
     FRESULT result;
+    BOOL stretch;
+    DWORD from;
     int ret;
 
     switch (whence) {
@@ -623,8 +723,21 @@ off64_t fatfs_lseek64(struct file *filep, off64_t offset, int whence)
     }
     fp->obj.sclust = finfo->sclst;
     fp->obj.objsize = finfo->fsize;
+#if FF_USE_FASTSEEK
+    /* a map never stretches the file, so a seek past the end goes the long way */
+    if (fpos > finfo->fsize) {
+        fatfs_extent_drop(finfo);
+    } else {
+        fatfs_extent_build(fp);
+    }
+#endif
+    stretch = (fpos > finfo->fsize);
+    from = (fp->fptr != 0) ? fp->clust : 0;
 
     result = f_lseek(fp, fpos);
+    if (stretch && (result == FR_OK)) {
+        fatfs_bitmap_taken(fs, (from != 0) ? from : fp->obj.sclust);
+    }
     finfo->fsize = fp->obj.objsize;
     finfo->sclst = fp->obj.sclust;
     if (result != FR_OK) {
@@ -678,6 +791,8 @@ int fatfs_write(struct file *filep, const char *buff, size_t count)
     FILINFO *finfo = &(((DIR_FILE *)vp->data)->fno);
     size_t wcount;
     FRESULT result;
+    DWORD nclst;
+    DWORD from = 0;
     int ret;
 
     ret = lock_fs(fs);
@@ -686,7 +801,19 @@ int fatfs_write(struct file *filep, const char *buff, size_t count)
     }
     fp->obj.objsize = finfo->fsize;
     fp->obj.sclust = finfo->sclst;
+#if FF_USE_FASTSEEK
+    fatfs_extent_write(fp, finfo, count);
+#endif
+    nclst = fatfs_write_clusters(fp, finfo, count);
+    if (nclst != 0) {
+        (void)fatfs_bitmap_build(fs);
+        fatfs_bitmap_hint(fs, ((fp->fptr == finfo->fsize) && (finfo->fsize != 0)) ? fp->clust : 0, nclst);
+        from = (fp->fptr != 0) ? fp->clust : 0; /* the chain is stretched from here on */
+    }
     result = f_write(fp, buff, count, &wcount);
+    if (nclst != 0) {
+        fatfs_bitmap_taken(fs, (from != 0) ? from : fp->obj.sclust);
+    }
     if (result != FR_OK) {
         goto ERROR_EXIT;
     }
@@ -731,7 +858,9 @@ int fatfs_fallocate64(struct file *filep, int mode, off64_t offset, off64_t len)
     FATFS *fs = fp->obj.fs;
     struct Vnode *vp = filep->f_vnode;
     FILINFO *finfo = &((DIR_FILE *)(vp->data))->fno;
+    FSIZE_t csize = (FSIZE_t)SS(fs) * fs->csize;
     FRESULT result;
+    DWORD nclst;
     int ret;
 
     if (offset < 0 || len <= 0) {
@@ -751,7 +880,16 @@ int fatfs_fallocate64(struct file *filep, int mode, off64_t offset, off64_t len)
     if (ret == FALSE) {
         return -EBUSY;
     }
+#if FF_USE_FASTSEEK
+    fatfs_extent_drop(finfo);
+#endif
+    nclst = (DWORD)(((FSIZE_t)len + csize - 1) / csize);
+    (void)fatfs_bitmap_build(fs);
+    fatfs_bitmap_hint(fs, 0, nclst);
     result = f_expand(fp, (FSIZE_t)offset, (FSIZE_t)len, 1);
+    if (result == FR_OK) {
+        fatfs_bitmap_taken(fs, fp->obj.sclust);
+    }
     if (result == FR_OK && finfo->sclst == 0) {
         finfo->sclst = fp->obj.sclust;
     }
@@ -772,6 +910,7 @@ static FRESULT realloc_cluster(FILINFO *finfo, FFOBJID *obj, FSIZE_t size)
 
     if (size == 0) { /* Remove cluster chain */
         if (finfo->sclst != 0) {
+            fatfs_bitmap_release(fs, finfo->sclst);
             result = remove_chain(obj, finfo->sclst, 0);
             if (result != FR_OK) {
                 return result;
@@ -791,6 +930,7 @@ static FRESULT realloc_cluster(FILINFO *finfo, FFOBJID *obj, FSIZE_t size)
         if (cclust == 1 || cclust == DISK_ERROR) {
             return FR_DISK_ERR;
         }
+        fatfs_bitmap_put(fs, cclust, TRUE);
         finfo->sclst = cclust;
     }
     cclust = finfo->sclst;
@@ -803,6 +943,7 @@ static FRESULT realloc_cluster(FILINFO *finfo, FFOBJID *obj, FSIZE_t size)
         if (cclust == 1 || cclust == DISK_ERROR) {
             return FR_DISK_ERR;
         }
+        fatfs_bitmap_put(fs, cclust, TRUE);
         remain -= csize;
     }
     pclust = cclust;
@@ -811,6 +952,7 @@ static FRESULT realloc_cluster(FILINFO *finfo, FFOBJID *obj, FSIZE_t size)
         return FR_DISK_ERR;
     }
     if (cclust != END_OF_FILE) { /* Remove extra cluster if existing */
+        fatfs_bitmap_release(fs, cclust);
         result = remove_chain(obj, cclust, pclust);
         if (result != FR_OK) {
             return result;
@@ -850,6 +992,9 @@ int fatfs_truncate64(struct Vnode *vp, off64_t len)
     }
 
     object.fs = fs;
+#if FF_USE_FASTSEEK
+    fatfs_extent_drop(finfo);
+#endif
     result = realloc_cluster(finfo, &object, (FSIZE_t)len);
     if (result != FR_OK) {
         goto ERROR_UNLOCK;
@@ -1026,6 +1171,7 @@ int fatfs_mount(struct Mount *mnt, struct Vnode *blk_device, const void *data)
 
     mnt->data = fs;
     mnt->vnodeCovered = vp;
+    mnt->diskId = (int)part->disk_id;
 
     vp->parent = mnt->vnodeBeCovered;
     vp->fop = &fatfs_fops;
@@ -1042,6 +1188,8 @@ int fatfs_mount(struct Mount *mnt, struct Vnode *blk_device, const void *data)
         ret = -ret;
         goto ERROR_WITH_LOCK;
     }
+    /* count the free clusters and map them now, a disk error leaves the rest to later calls */
+    (void)fatfs_bitmap_build(fs);
     unlock_fs(fs, FR_OK);
 
     return 0;
@@ -1111,6 +1259,8 @@ int fatfs_umount(struct Mount *mnt, struct Vnode **blkdriver)
     if (fs->win != NULL) {
         ff_memfree(fs->win);
     }
+    fatfs_bitmap_destroy(fs);
+    fatfs_dirhash_destroy(fs);
 
     unlock_fs(fs, FR_OK);
 
@@ -1128,6 +1278,19 @@ int fatfs_umount(struct Mount *mnt, struct Vnode **blkdriver)
 int fatfs_statfs(struct Mount *mnt, struct statfs *info)
 {
     FATFS *fs = (FATFS *)mnt->data;
+    DWORD nfree;
+    int ret;
+
+    ret = lock_fs(fs);
+    if (ret == FALSE) {
+        return -EBUSY;
+    }
+    (void)fatfs_bitmap_build(fs);
+    ret = fatfs_bitmap_free(fs, &nfree);
+    unlock_fs(fs, FR_OK);
+    if (ret != 0) {
+        return ret;
+    }
 
     info->f_type = MSDOS_SUPER_MAGIC;
 #if FF_MAX_SS != FF_MIN_SS
@@ -1136,8 +1299,8 @@ int fatfs_statfs(struct Mount *mnt, struct statfs *info)
     info->f_bsize = FF_MIN_SS * fs->csize;
 #endif
     info->f_blocks = fs->n_fatent;
-    info->f_bfree = fs->free_clst;
-    info->f_bavail = fs->free_clst;
+    info->f_bfree = nfree;
+    info->f_bavail = nfree;
 
 #if FF_USE_LFN
     /* Maximum length of filenames */
@@ -1474,6 +1637,7 @@ int fatfs_rename(struct Vnode *old_vnode, struct Vnode *new_parent, const char *
     DIR_FILE *dfp_new = NULL;
     DIR* dp_new = NULL;
     FILINFO* finfo_new = NULL;
+    const char *new_name = newname;
     DWORD clust;
     FRESULT result;
     int ret;
@@ -1509,11 +1673,14 @@ int fatfs_rename(struct Vnode *old_vnode, struct Vnode *new_parent, const char *
             goto ERROR_FREE;
         }
         result = dir_remove(dp_old);
+        fatfs_dirhash_remove(dp_old, result);
         if (result != FR_OK) {
             goto ERROR_FREE;
         }
         clust = finfo_new->sclst;
         if (clust != 0) { /* remove the new path cluster chain if exists */
+            fatfs_dirhash_drop(fs, clust);
+            fatfs_bitmap_release(fs, clust);
             result = remove_chain(&(dp_new->obj), clust, 0);
             if (result != FR_OK) {
                 goto ERROR_FREE;
@@ -1521,6 +1688,7 @@ int fatfs_rename(struct Vnode *old_vnode, struct Vnode *new_parent, const char *
         }
     } else { /* new path name not exist */
         result = dir_remove(dp_old);
+        fatfs_dirhash_remove(dp_old, result);
         if (result != FR_OK) {
             goto ERROR_FREE;
         }
@@ -1528,6 +1696,8 @@ int fatfs_rename(struct Vnode *old_vnode, struct Vnode *new_parent, const char *
         if (result != FR_OK) {
             goto ERROR_FREE;
         }
+        fatfs_bitmap_put(fs, dp_new->clust, TRUE); /* the directory may have grown */
+        fatfs_dirhash_add(dp_new, new_name);
     }
 
     /* update new dir entry with old info */
@@ -1669,11 +1839,13 @@ int fatfs_mkdir(struct Vnode *parent, const char *name, mode_t mode, struct Vnod
     DIR_FILE *dfp = (DIR_FILE *)parent->data;
     FILINFO *finfo = &(dfp->fno);
     DIR_FILE *dfp_new = NULL;
+    const char *dname = name;
     QWORD sect;
     DWORD clust;
     BYTE *dir = NULL;
     DWORD hash;
     FRESULT result = FR_OK;
+    BOOL absent;
     int ret;
     UINT n;
 
@@ -1697,12 +1869,17 @@ int fatfs_mkdir(struct Vnode *parent, const char *name, mode_t mode, struct Vnod
     LOS_ListInit(&(dfp_new->fno.fp_list));
     dfp_new->f_dir.obj.sclust = finfo->sclst;
     dfp_new->f_dir.obj.fs = fs;
+    result = fatfs_dirhash_find(&(dfp_new->f_dir), name, strlen(name));
+    if (result == FR_OK) {
+        result = FR_EXIST;
+        goto ERROR_FREE;
+    }
+    absent = (result == FR_NO_FILE);
     result = create_name(&(dfp_new->f_dir), &name);
     if (result != FR_OK) {
         goto ERROR_FREE;
     }
-    result = dir_find(&(dfp_new->f_dir));
-    if (result == FR_OK) {
+    if (!absent && (dir_find(&(dfp_new->f_dir)) == FR_OK)) {
         result = FR_EXIST;
         goto ERROR_FREE;
     }
@@ -1716,6 +1893,7 @@ int fatfs_mkdir(struct Vnode *parent, const char *name, mode_t mode, struct Vnod
         result = FR_DISK_ERR;
         goto ERROR_FREE;
     }
+    fatfs_bitmap_put(fs, clust, TRUE);
     result = sync_window(fs); /* Flush FAT */
     if (result != FR_OK) {
         goto ERROR_REMOVE_CHAIN;
@@ -1748,6 +1926,8 @@ int fatfs_mkdir(struct Vnode *parent, const char *name, mode_t mode, struct Vnod
     if (result != FR_OK) {
         goto ERROR_REMOVE_CHAIN;
     }
+    fatfs_bitmap_put(fs, dfp_new->f_dir.clust, TRUE); /* the parent may have grown */
+    fatfs_dirhash_add(&(dfp_new->f_dir), dname);
     dir = dfp_new->f_dir.dir;
     st_dword(dir + DIR_ModTime, 0); /* Set the time */
     st_clust(fs, dir, clust); /* Set the start cluster */
@@ -1799,6 +1979,7 @@ int fatfs_mkdir(struct Vnode *parent, const char *name, mode_t mode, struct Vnod
     return fatfs_sync(vp->originMount->mountFlags, fs);
 
 ERROR_REMOVE_CHAIN:
+    fatfs_bitmap_release(fs, clust);
     remove_chain(&(dfp_new->f_dir.obj), clust, 0);
 ERROR_FREE:
     free(dfp_new);
@@ -1843,11 +2024,14 @@ int fatfs_rmdir(struct Vnode *parent, struct Vnode *vp, char *name)
         result = FR_NO_EMPTY_DIR;
         goto ERROR_UNLOCK;
     }
+    fatfs_dirhash_drop(fs, finfo->sclst);
     result = dir_remove(dp); /* remove directory entry */
+    fatfs_dirhash_remove(dp, result);
     if (result != FR_OK) {
         goto ERROR_UNLOCK;
     }
     /* Directory entry contains at least one cluster */
+    fatfs_bitmap_release(fs, finfo->sclst);
     result = remove_chain(&(dp->obj), finfo->sclst, 0);
     if (result != FR_OK) {
         goto ERROR_UNLOCK;
@@ -1890,10 +2074,15 @@ int fatfs_unlink(struct Vnode *parent, struct Vnode *vp, char *name)
         goto ERROR_OUT;
     }
     result = dir_remove(dp); /* remove directory entry */
+    fatfs_dirhash_remove(dp, result);
     if (result != FR_OK) {
         goto ERROR_UNLOCK;
     }
+#if FF_USE_FASTSEEK
+    fatfs_extent_drop(finfo);
+#endif
     if (finfo->sclst != 0) { /* if cluster chain exists */
+        fatfs_bitmap_release(fs, finfo->sclst);
         result = remove_chain(&(dp->obj), finfo->sclst, 0);
         if (result != FR_OK) {
             goto ERROR_UNLOCK;
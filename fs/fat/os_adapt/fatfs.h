@@ -138,6 +138,20 @@ FRESULT find_fat_partition(FATFS *fs, los_part *part, BYTE *format, QWORD *start
 FRESULT init_fatobj(FATFS *fs, BYTE fmt, QWORD start_sector);
 FRESULT _mkfs(los_part *partition, int sector, int opt, BYTE *work, UINT len);
 
+int fatfs_bitmap_build(FATFS *fs);
+int fatfs_bitmap_free(FATFS *fs, DWORD *nfree);
+void fatfs_bitmap_destroy(FATFS *fs);
+void fatfs_bitmap_put(FATFS *fs, DWORD clst, BOOL used);
+void fatfs_bitmap_hint(FATFS *fs, DWORD tail, DWORD nclst);
+void fatfs_bitmap_taken(FATFS *fs, DWORD clst);
+void fatfs_bitmap_release(FATFS *fs, DWORD clst);
+
+FRESULT fatfs_dirhash_find(DIR *dp, const char *name, size_t len);
+void fatfs_dirhash_add(DIR *dp, const char *name);
+void fatfs_dirhash_remove(DIR *dp, FRESULT result);
+void fatfs_dirhash_drop(FATFS *fs, DWORD sclst);
+void fatfs_dirhash_destroy(FATFS *fs);
+
 #ifdef __cplusplus
 #if __cplusplus
 }
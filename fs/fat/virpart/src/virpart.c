@@ -286,6 +286,7 @@ static FRESULT FatfsBuildEntry(FATFS *fat, INT vol)
         }
 
         ret = f_mkdir(path);
+        fatfs_dirhash_drop(fat, 0); /* the root changed outside fatfs.c */
         if (ret == FR_EXIST) {
             (void)memset_s(&dir, sizeof(dir), 0, sizeof(dir));
             ret = f_opendir(&dir, path);
@@ -104,6 +104,26 @@ extern void rename_mapping(const char *src, const char *dst);
 
 extern void dec_mapping_nolock(struct page_mapping *mapping);
 
+/****************************************************************************
+ * Name: flush_file_mappings
+ *
+ * Description:
+ *   Write back the dirty page-caches of the files on a disk.
+ *
+ ****************************************************************************/
+
+extern void flush_file_mappings(int disk);
+
+/****************************************************************************
+ * Name: balance_file_mappings
+ *
+ * Description:
+ *   Pace a writer of a file by the dirty page-caches of its disk.
+ *
+ ****************************************************************************/
+
+extern void balance_file_mappings(struct file *filep);
+
 
 /****************************************************************************
  * Name: update_file_path
@@ -474,7 +494,8 @@ extern INT32 LOS_GetDirtyRatioByName(const CHAR *name);
  *
  * @par Description:
  * The LOS_SetDirtyRatioThreshold() function shall set the dirty ratio threshold of bcache. When the percentage
- * of dirty blocks in the cache is greater than the threshold, write back data to disk.
+ * of dirty blocks in the cache is greater than the threshold, the sync thread writes back data to disk until
+ * it is under the threshold again.
  *
  * @param dirtyRatio  [IN] Threshold of the percentage of dirty blocks, expressed in %.
  *
@@ -487,11 +508,36 @@ extern INT32 LOS_GetDirtyRatioByName(const CHAR *name);
  *
  * @par Dependency:
  * <ul><li>fs.h</li></ul>
- * @see LOS_SetSyncThreadInterval | LOS_SetSyncThreadPrio
+ * @see LOS_SetDirtyRatioLimit | LOS_SetSyncThreadInterval | LOS_SetSyncThreadPrio
  */
 
 extern VOID LOS_SetDirtyRatioThreshold(UINT32 dirtyRatio);
 
+/**
+ * @ingroup fs
+ *
+ * @par Description:
+ * The LOS_SetDirtyRatioLimit() function shall set the hard dirty ratio limit of bcache. When the percentage
+ * of dirty blocks in the cache is greater than the limit, a writer writes back data to disk itself before
+ * its write returns, until the cache is under the limit again.
+ *
+ * @param dirtyRatio  [IN] Limit of the percentage of dirty blocks, expressed in %.
+ *
+ * @attention
+ * <ul>
+ * <li>The dirtyRatio must be less than or equal to 100, or the setting is invalid.</li>
+ * <li>The limit is meant to be greater than the threshold set by LOS_SetDirtyRatioThreshold.</li>
+ * </ul>
+ *
+ * @retval #VOID  None.
+ *
+ * @par Dependency:
+ * <ul><li>fs.h</li></ul>
+ * @see LOS_SetDirtyRatioThreshold
+ */
+
+extern VOID LOS_SetDirtyRatioLimit(UINT32 dirtyRatio);
+
 /**
  * @ingroup fs
  *
@@ -52,6 +52,7 @@ struct Mount {
     uint32_t hashseed;                 /* Random seed for vfshash */
     unsigned long mountFlags;          /* Flags for mount */
     char pathName[PATH_MAX];           /* path name of mount point */
+    int diskId;                        /* disk the fs is on, set by its mount op; -1 for none */
 };
 
 struct MountOps {
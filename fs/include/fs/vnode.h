@@ -108,6 +108,7 @@ int VnodeDevInit(void);
 int VnodeAlloc(struct VnodeOps *vop, struct Vnode **vnode);
 int VnodeFree(struct Vnode *vnode);
 int VnodeLookup(const char *path, struct Vnode **vnode, uint32_t flags);
+int VnodeLookupAt(struct Vnode *parent, const char *name, uint8_t len, struct Vnode **vnode);
 int VnodeHold(void);
 int VnodeDrop(void);
 void VnodeRefDec(struct Vnode *vnode);
@@ -58,6 +58,9 @@ extern "C" {
 #define CONFIG_FS_FAT_READ_NUMS         7
 #define CONFIG_FS_FAT_BLOCK_NUMS        28
 
+/* config the read blocks the fat cache may add while free memory is plenty, given back on reclaim */
+#define CONFIG_FS_FAT_DYNAMIC_NUMS      32
+
 #ifdef LOSCFG_FS_FAT_CACHE_SYNC_THREAD
 
 /* config the priority of sync task */
@@ -68,6 +71,10 @@ extern "C" {
 
 #define CONFIG_FS_FAT_DIRTY_RATIO      60
 
+/* config dirty ratio of bcache over which writers write back blocks themselves */
+
+#define CONFIG_FS_FAT_DIRTY_HARD_RATIO 80
+
 /* config time interval of sync thread for fat file system, in milliseconds */
 
 #define CONFIG_FS_FAT_SYNC_INTERVAL    5000
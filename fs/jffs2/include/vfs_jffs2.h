@@ -50,6 +50,8 @@ extern "C" {
 #define BLOCK_SIZE    4096
 #define JFFS2_NODE_HASH_BUCKETS 128
 #define JFFS2_NODE_HASH_MASK (JFFS2_NODE_HASH_BUCKETS - 1)
+#define JFFS2_INODE_LOCK_BUCKETS 32
+#define JFFS2_INODE_LOCK_MASK (JFFS2_INODE_LOCK_BUCKETS - 1)
 
 
 #define JFFS2_WAITING_FOREVER              -1    /* Block forever until get resource. */
@@ -60,7 +60,8 @@
 struct VnodeOps g_jffs2Vops;
 struct file_operations_vfs g_jffs2Fops;
 
-static LosMux g_jffs2FsLock;  /* lock for all jffs2 ops */
+static LosMux g_jffs2SbLock[CONFIG_MTD_PATTITION_NUM];     /* per partition lock for namespace ops */
+static LosMux g_jffs2InodeLock[JFFS2_INODE_LOCK_BUCKETS];  /* striped by ino, lock for file data ops */
 
 static pthread_mutex_t g_jffs2NodeLock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
 struct Vnode *g_jffs2PartList[CONFIG_MTD_PATTITION_NUM];
@@ -88,6 +89,38 @@ time_t Jffs2CurSec(void)
     return (uint32_t)(tv.tv_sec);
 }
 
+/*
+ * Lock order is partition lock first, then inode lock. Read and stat only take the lock of the inode
+ * they work on, so files on one partition are read in parallel. Write, truncate and chattr write
+ * nodes, and the flash space they reserve for them is the partition's, so they take the partition
+ * lock as well; anything that changes a directory takes the partition lock, and the inode lock of
+ * the victim when it removes one.
+ */
+static LosMux *Jffs2SbMux(const struct Mount *mnt)
+{
+    return &g_jffs2SbLock[((mtd_partition *)mnt->data)->patitionnum];
+}
+
+static void Jffs2SbLock(const struct Mount *mnt)
+{
+    (void)LOS_MuxLock(Jffs2SbMux(mnt), (uint32_t)JFFS2_WAITING_FOREVER);
+}
+
+static void Jffs2SbUnlock(const struct Mount *mnt)
+{
+    (void)LOS_MuxUnlock(Jffs2SbMux(mnt));
+}
+
+static void Jffs2InodeLock(const struct jffs2_inode *node)
+{
+    (void)LOS_MuxLock(&g_jffs2InodeLock[node->i_ino & JFFS2_INODE_LOCK_MASK], (uint32_t)JFFS2_WAITING_FOREVER);
+}
+
+static void Jffs2InodeUnlock(const struct jffs2_inode *node)
+{
+    (void)LOS_MuxUnlock(&g_jffs2InodeLock[node->i_ino & JFFS2_INODE_LOCK_MASK]);
+}
+
 void Jffs2NodeLock(void)
 {
     (void)pthread_mutex_lock(&g_jffs2NodeLock);
@@ -107,27 +140,26 @@ int VfsJffs2Bind(struct Mount *mnt, struct Vnode *blkDriver, const void *data)
     struct Vnode *pv = NULL;
     struct jffs2_inode *rootNode = NULL;
 
-    LOS_MuxLock(&g_jffs2FsLock, (uint32_t)JFFS2_WAITING_FOREVER);
     p = (mtd_partition *)((struct drv_data *)blkDriver->data)->priv;
     mtd = (struct MtdDev *)(p->mtd_info);
 
     /* find a empty mte in partition table */
     if (mtd == NULL || mtd->type != MTD_NORFLASH) {
-        LOS_MuxUnlock(&g_jffs2FsLock);
         return -EINVAL;
     }
 
     partNo = p->patitionnum;
 
+    LOS_MuxLock(&g_jffs2SbLock[partNo], (uint32_t)JFFS2_WAITING_FOREVER);
     ret = jffs2_mount(partNo, &rootNode);
     if (ret != 0) {
-        LOS_MuxUnlock(&g_jffs2FsLock);
+        LOS_MuxUnlock(&g_jffs2SbLock[partNo]);
         return ret;
     }
 
     ret = VnodeAlloc(&g_jffs2Vops, &pv);
     if (ret != 0) {
-        LOS_MuxUnlock(&g_jffs2FsLock);
+        LOS_MuxUnlock(&g_jffs2SbLock[partNo]);
         goto ERROR_WITH_VNODE;
     }
     rootNode->i_vnode = pv;
@@ -145,7 +177,7 @@ int VfsJffs2Bind(struct Mount *mnt, struct Vnode *blkDriver, const void *data)
 
     g_jffs2PartList[partNo] = blkDriver;
 
-    LOS_MuxUnlock(&g_jffs2FsLock);
+    LOS_MuxUnlock(&g_jffs2SbLock[partNo]);
 
     return 0;
 ERROR_WITH_VNODE:
@@ -158,18 +190,16 @@ int VfsJffs2Unbind(struct Mount *mnt, struct Vnode **blkDriver)
     mtd_partition *p = NULL;
     int partNo;
 
-    LOS_MuxLock(&g_jffs2FsLock, (uint32_t)JFFS2_WAITING_FOREVER);
-
     p = (mtd_partition *)mnt->data;
     if (p == NULL) {
-        LOS_MuxUnlock(&g_jffs2FsLock);
         return -EINVAL;
     }
 
     partNo = p->patitionnum;
+    LOS_MuxLock(&g_jffs2SbLock[partNo], (uint32_t)JFFS2_WAITING_FOREVER);
     ret = jffs2_umount((struct jffs2_inode *)mnt->vnodeCovered->data);
     if (ret) {
-        LOS_MuxUnlock(&g_jffs2FsLock);
+        LOS_MuxUnlock(&g_jffs2SbLock[partNo]);
         return ret;
     }
 
@@ -177,7 +207,7 @@ int VfsJffs2Unbind(struct Mount *mnt, struct Vnode **blkDriver)
     p->mountpoint_name = NULL;
     *blkDriver = g_jffs2PartList[partNo];
 
-    LOS_MuxUnlock(&g_jffs2FsLock);
+    LOS_MuxUnlock(&g_jffs2SbLock[partNo]);
     return 0;
 }
 
@@ -188,20 +218,20 @@ int VfsJffs2Lookup(struct Vnode *parentVnode, const char *path, int len, struct
     struct jffs2_inode *node = NULL;
     struct jffs2_inode *parentNode = NULL;
 
-    LOS_MuxLock(&g_jffs2FsLock, (uint32_t)JFFS2_WAITING_FOREVER);
+    Jffs2SbLock(parentVnode->originMount);
 
     parentNode = (struct jffs2_inode *)parentVnode->data;
     node = jffs2_lookup(parentNode, (const unsigned char *)path, len);
     if (!node) {
-        LOS_MuxUnlock(&g_jffs2FsLock);
+        Jffs2SbUnlock(parentVnode->originMount);
         return -ENOENT;
     }
 
     if (node->i_vnode) {
         *ppVnode = node->i_vnode;
         (void)VfsHashGet(parentVnode->originMount, node->i_ino, &newVnode, NULL, NULL);
-        LOS_MuxUnlock(&g_jffs2FsLock);
         if (newVnode) {
+            Jffs2SbUnlock(parentVnode->originMount);
             if (newVnode->data == NULL) {
                 LOS_Panic("#####VfsHashGet error#####\n");
             }
@@ -213,7 +243,7 @@ int VfsJffs2Lookup(struct Vnode *parentVnode, const char *path, int len, struct
     if (ret != 0) {
         PRINT_ERR("%s-%d, ret: %x\n", __FUNCTION__, __LINE__, ret);
         (void)jffs2_iput(node);
-        LOS_MuxUnlock(&g_jffs2FsLock);
+        Jffs2SbUnlock(parentVnode->originMount);
         return ret;
     }
 
@@ -232,7 +262,7 @@ int VfsJffs2Lookup(struct Vnode *parentVnode, const char *path, int len, struct
 
     *ppVnode = newVnode;
 
-    LOS_MuxUnlock(&g_jffs2FsLock);
+    Jffs2SbUnlock(parentVnode->originMount);
     return 0;
 }
 
@@ -247,11 +277,11 @@ int VfsJffs2Create(struct Vnode *parentVnode, const char *path, int mode, struct
         return -ENOMEM;
     }
 
-    LOS_MuxLock(&g_jffs2FsLock, (uint32_t)JFFS2_WAITING_FOREVER);
+    Jffs2SbLock(parentVnode->originMount);
     ret = jffs2_create((struct jffs2_inode *)parentVnode->data, (const unsigned char *)path, mode, &newNode);
     if (ret != 0) {
         VnodeFree(newVnode);
-        LOS_MuxUnlock(&g_jffs2FsLock);
+        Jffs2SbUnlock(parentVnode->originMount);
         return ret;
     }
 
@@ -270,7 +300,7 @@ int VfsJffs2Create(struct Vnode *parentVnode, const char *path, int mode, struct
 
     *ppVnode = newVnode;
 
-    LOS_MuxUnlock(&g_jffs2FsLock);
+    Jffs2SbUnlock(parentVnode->originMount);
     return 0;
 }
 
@@ -286,29 +316,28 @@ ssize_t VfsJffs2Read(struct file *filep, char *buffer, size_t bufLen)
     struct jffs2_sb_info *c = NULL;
     int ret;
 
-    LOS_MuxLock(&g_jffs2FsLock, (uint32_t)JFFS2_WAITING_FOREVER);
-
     node = (struct jffs2_inode *)filep->f_vnode->data;
     f = JFFS2_INODE_INFO(node);
     c = JFFS2_SB_INFO(node->i_sb);
 
+    Jffs2InodeLock(node);
     off_t pos = min(node->i_size, filep->f_pos);
     off_t len = min(bufLen, (node->i_size - pos));
     ret = jffs2_read_inode_range(c, f, (unsigned char *)buffer, filep->f_pos, len);
     if (ret) {
         PRINTK("VfsJffs2Read(): read_inode_range failed %d\n", ret);
-        LOS_MuxUnlock(&g_jffs2FsLock);
+        Jffs2InodeUnlock(node);
         return ret;
     }
     node->i_atime = Jffs2CurSec();
     filep->f_pos += len;
 
-    LOS_MuxUnlock(&g_jffs2FsLock);
+    Jffs2InodeUnlock(node);
 
     return len;
 }
 
-ssize_t VfsJffs2Write(struct file *filep, const char *buffer, size_t bufLen)
+static ssize_t Jffs2Write(struct file *filep, const char *buffer, size_t bufLen)
 {
     struct jffs2_inode *node = NULL;
     struct jffs2_inode_info *f = NULL;
@@ -319,11 +348,11 @@ ssize_t VfsJffs2Write(struct file *filep, const char *buffer, size_t bufLen)
     off_t pos;
     uint32_t writtenLen;
 
-    LOS_MuxLock(&g_jffs2FsLock, (uint32_t)JFFS2_WAITING_FOREVER);
-
     node = (struct jffs2_inode *)filep->f_vnode->data;
     f = JFFS2_INODE_INFO(node);
     c = JFFS2_SB_INFO(node->i_sb);
+
+    Jffs2InodeLock(node);
     pos = filep->f_pos;
 
 #if (LOSCFG_KERNEL_SMP == YES)
@@ -340,7 +369,7 @@ ssize_t VfsJffs2Write(struct file *filep, const char *buffer, size_t bufLen)
     }
 #endif
     if (pos < 0) {
-        LOS_MuxUnlock(&g_jffs2FsLock);
+        Jffs2InodeUnlock(node);
         return -EINVAL;
     }
 
@@ -356,7 +385,7 @@ ssize_t VfsJffs2Write(struct file *filep, const char *buffer, size_t bufLen)
         attr.attr_chg_size = pos;
         err = jffs2_setattr(node, &attr);
         if (err) {
-            LOS_MuxUnlock(&g_jffs2FsLock);
+            Jffs2InodeUnlock(node);
             return err;
         }
     }
@@ -372,7 +401,7 @@ ssize_t VfsJffs2Write(struct file *filep, const char *buffer, size_t bufLen)
 
         filep->f_pos = pos;
 
-        LOS_MuxUnlock(&g_jffs2FsLock);
+        Jffs2InodeUnlock(node);
 
         return ret;
     }
@@ -386,7 +415,7 @@ ssize_t VfsJffs2Write(struct file *filep, const char *buffer, size_t bufLen)
 
         filep->f_pos = pos;
 
-        LOS_MuxUnlock(&g_jffs2FsLock);
+        Jffs2InodeUnlock(node);
 
         return -ENOSPC;
     }
@@ -399,18 +428,27 @@ ssize_t VfsJffs2Write(struct file *filep, const char *buffer, size_t bufLen)
 
     filep->f_pos = pos;
 
-    LOS_MuxUnlock(&g_jffs2FsLock);
+    Jffs2InodeUnlock(node);
 
     return writtenLen;
 }
 
+ssize_t VfsJffs2Write(struct file *filep, const char *buffer, size_t bufLen)
+{
+    struct Mount *mnt = filep->f_vnode->originMount;
+    ssize_t ret;
+
+    Jffs2SbLock(mnt);
+    ret = Jffs2Write(filep, buffer, bufLen);
+    Jffs2SbUnlock(mnt);
+    return ret;
+}
+
 off_t VfsJffs2Seek(struct file *filep, off_t offset, int whence)
 {
     struct jffs2_inode *node = NULL;
     loff_t filePos;
 
-    LOS_MuxLock(&g_jffs2FsLock, (uint32_t)JFFS2_WAITING_FOREVER);
-
     node = (struct jffs2_inode *)filep->f_vnode->data;
     filePos = filep->f_pos;
 
@@ -424,16 +462,15 @@ off_t VfsJffs2Seek(struct file *filep, off_t offset, int whence)
             break;
 
         case SEEK_END:
+            Jffs2InodeLock(node);
             filePos = node->i_size + offset;
+            Jffs2InodeUnlock(node);
             break;
 
         default:
-            LOS_MuxUnlock(&g_jffs2FsLock);
             return -EINVAL;
     }
 
-    LOS_MuxUnlock(&g_jffs2FsLock);
-
     if (filePos < 0)
         return -EINVAL;
 
@@ -470,7 +507,7 @@ int VfsJffs2Readdir(struct Vnode *pVnode, struct fs_dirent_s *dir)
     int ret;
     int i = 0;
 
-    LOS_MuxLock(&g_jffs2FsLock, (uint32_t)JFFS2_WAITING_FOREVER);
+    Jffs2SbLock(pVnode->originMount);
 
     /* set jffs2_d */
     while (i < dir->read_cnt) {
@@ -483,7 +520,7 @@ int VfsJffs2Readdir(struct Vnode *pVnode, struct fs_dirent_s *dir)
         i++;
     }
 
-    LOS_MuxUnlock(&g_jffs2FsLock);
+    Jffs2SbUnlock(pVnode->originMount);
 
     return i;
 }
@@ -516,12 +553,12 @@ int VfsJffs2Mkdir(struct Vnode *parentNode, const char *dirName, mode_t mode, st
         return -ENOMEM;
     }
 
-    LOS_MuxLock(&g_jffs2FsLock, (uint32_t)JFFS2_WAITING_FOREVER);
+    Jffs2SbLock(parentNode->originMount);
 
     ret = jffs2_mkdir((struct jffs2_inode *)parentNode->data, (const unsigned char *)dirName, mode, &node);
     if (ret != 0) {
         VnodeFree(newVnode);
-        LOS_MuxUnlock(&g_jffs2FsLock);
+        Jffs2SbUnlock(parentNode->originMount);
         return ret;
     }
 
@@ -540,7 +577,7 @@ int VfsJffs2Mkdir(struct Vnode *parentNode, const char *dirName, mode_t mode, st
 
     (void)VfsHashInsert(newVnode, node->i_ino);
 
-    LOS_MuxUnlock(&g_jffs2FsLock);
+    Jffs2SbUnlock(parentNode->originMount);
 
     return 0;
 }
@@ -548,14 +585,17 @@ int VfsJffs2Mkdir(struct Vnode *parentNode, const char *dirName, mode_t mode, st
 static int Jffs2Truncate(struct Vnode *pVnode, unsigned int len)
 {
     int ret;
+    struct jffs2_inode *node = (struct jffs2_inode *)pVnode->data;
     struct IATTR attr = {0};
 
     attr.attr_chg_size = len;
     attr.attr_chg_valid = CHG_SIZE;
 
-    LOS_MuxLock(&g_jffs2FsLock, (uint32_t)JFFS2_WAITING_FOREVER);
-    ret = jffs2_setattr((struct jffs2_inode *)pVnode->data, &attr);
-    LOS_MuxUnlock(&g_jffs2FsLock);
+    Jffs2SbLock(pVnode->originMount);
+    Jffs2InodeLock(node);
+    ret = jffs2_setattr(node, &attr);
+    Jffs2InodeUnlock(node);
+    Jffs2SbUnlock(pVnode->originMount);
     return ret;
 }
 
@@ -580,16 +620,17 @@ int VfsJffs2Chattr(struct Vnode *pVnode, struct IATTR *attr)
         return -EINVAL;
     }
 
-    LOS_MuxLock(&g_jffs2FsLock, (uint32_t)JFFS2_WAITING_FOREVER);
-
     node = pVnode->data;
+    Jffs2SbLock(pVnode->originMount);
+    Jffs2InodeLock(node);
     ret = jffs2_setattr(node, attr);
     if (ret == 0) {
         pVnode->uid = node->i_uid;
         pVnode->gid = node->i_gid;
         pVnode->mode = node->i_mode;
     }
-    LOS_MuxUnlock(&g_jffs2FsLock);
+    Jffs2InodeUnlock(node);
+    Jffs2SbUnlock(pVnode->originMount);
     return ret;
 }
 
@@ -601,12 +642,14 @@ int VfsJffs2Rmdir(struct Vnode *parentVnode, struct Vnode *targetVnode, char *pa
         return -EINVAL;
     }
 
-    LOS_MuxLock(&g_jffs2FsLock, (uint32_t)JFFS2_WAITING_FOREVER);
+    Jffs2SbLock(parentVnode->originMount);
+    Jffs2InodeLock((struct jffs2_inode *)targetVnode->data);
 
     ret = jffs2_rmdir((struct jffs2_inode *)parentVnode->data, (struct jffs2_inode *)targetVnode->data,
                       (const unsigned char *)path);
 
-    LOS_MuxUnlock(&g_jffs2FsLock);
+    Jffs2InodeUnlock((struct jffs2_inode *)targetVnode->data);
+    Jffs2SbUnlock(parentVnode->originMount);
     return ret;
 }
 
@@ -619,12 +662,14 @@ int VfsJffs2Unlink(struct Vnode *parentVnode, struct Vnode *targetVnode, char *p
         return -EINVAL;
     }
 
-    LOS_MuxLock(&g_jffs2FsLock, (uint32_t)JFFS2_WAITING_FOREVER);
+    Jffs2SbLock(parentVnode->originMount);
+    Jffs2InodeLock((struct jffs2_inode *)targetVnode->data);
 
     ret = jffs2_unlink((struct jffs2_inode *)parentVnode->data, (struct jffs2_inode *)targetVnode->data,
                        (const unsigned char *)path);
 
-    LOS_MuxUnlock(&g_jffs2FsLock);
+    Jffs2InodeUnlock((struct jffs2_inode *)targetVnode->data);
+    Jffs2SbUnlock(parentVnode->originMount);
     return ret;
 }
 
@@ -635,7 +680,8 @@ int VfsJffs2Rename(struct Vnode *fromVnode, struct Vnode *toParentVnode, const c
     struct Vnode *toVnode = NULL;
     struct jffs2_inode *fromNode = NULL;
 
-    LOS_MuxLock(&g_jffs2FsLock, (uint32_t)JFFS2_WAITING_FOREVER);
+    /* recursive, so the lookup and removal of an existing target below nest inside */
+    Jffs2SbLock(toParentVnode->originMount);
     fromParentVnode = fromVnode->parent;
 
     ret = VfsJffs2Lookup(toParentVnode, toName, strlen(toName), &toVnode);
@@ -647,7 +693,7 @@ int VfsJffs2Rename(struct Vnode *fromVnode, struct Vnode *toParentVnode, const c
         }
         if (ret) {
             PRINTK("%s-%d remove newname(%s) failed ret=%d\n", __FUNCTION__, __LINE__, toName, ret);
-            LOS_MuxUnlock(&g_jffs2FsLock);
+            Jffs2SbUnlock(toParentVnode->originMount);
             return ret;
         }
     }
@@ -657,7 +703,7 @@ int VfsJffs2Rename(struct Vnode *fromVnode, struct Vnode *toParentVnode, const c
     /* Careful with this: we can safely free the fromVnode AND toVnode but not fromNode, so reset the i_vnode field OR
        it will be a jungle field. With a new lookup process, we'll allocate a new vnode for it. */
     fromVnode->parent = toParentVnode;
-    LOS_MuxUnlock(&g_jffs2FsLock);
+    Jffs2SbUnlock(toParentVnode->originMount);
 
     if (ret) {
         return ret;
@@ -670,9 +716,8 @@ int VfsJffs2Stat(struct Vnode *pVnode, struct stat *buf)
 {
     struct jffs2_inode *node = NULL;
 
-    LOS_MuxLock(&g_jffs2FsLock, (uint32_t)JFFS2_WAITING_FOREVER);
-
     node = (struct jffs2_inode *)pVnode->data;
+    Jffs2InodeLock(node);
     switch (node->i_mode & S_IFMT) {
         case S_IFREG:
         case S_IFDIR:
@@ -696,7 +741,7 @@ int VfsJffs2Stat(struct Vnode *pVnode, struct stat *buf)
     buf->st_mtime = node->i_mtime;
     buf->st_ctime = node->i_ctime;
 
-    LOS_MuxUnlock(&g_jffs2FsLock);
+    Jffs2InodeUnlock(node);
 
     return 0;
 }
@@ -706,17 +751,15 @@ int VfsJffs2Reclaim(struct Vnode *pVnode)
     int ret;
     struct jffs2_inode *node = NULL;
 
-    LOS_MuxLock(&g_jffs2FsLock, (uint32_t)JFFS2_WAITING_FOREVER);
-
     node = pVnode->data;
     if (node == NULL) {
         return LOS_OK;
     }
 
+    Jffs2SbLock(pVnode->originMount);
     node->i_vnode = NULL;
     ret = jffs2_iput(node);
-
-    LOS_MuxUnlock(&g_jffs2FsLock);
+    Jffs2SbUnlock(pVnode->originMount);
 
     return ret;
 }
@@ -727,7 +770,7 @@ int VfsJffs2Statfs(struct Mount *mnt, struct statfs *buf)
     struct jffs2_sb_info *c = NULL;
     struct jffs2_inode *rootNode = NULL;
 
-    LOS_MuxLock(&g_jffs2FsLock, (uint32_t)JFFS2_WAITING_FOREVER);
+    Jffs2SbLock(mnt);
 
     rootNode = (struct jffs2_inode *)mnt->vnodeCovered->data;
     c = JFFS2_SB_INFO(rootNode->i_sb);
@@ -746,23 +789,47 @@ int VfsJffs2Statfs(struct Mount *mnt, struct statfs *buf)
     buf->f_ffree = 0;
     buf->f_flags = mnt->mountFlags;
 
-    LOS_MuxUnlock(&g_jffs2FsLock);
+    Jffs2SbUnlock(mnt);
     return 0;
 }
 
 int Jffs2MutexCreate(void)
 {
-    if (LOS_MuxInit(&g_jffs2FsLock, NULL) != LOS_OK) {
-        PRINT_ERR("%s, LOS_MuxCreate failed\n", __FUNCTION__);
-        return -1;
-    } else {
-        return 0;
+    int i;
+    int j;
+
+    for (i = 0; i < CONFIG_MTD_PATTITION_NUM; i++) {
+        if (LOS_MuxInit(&g_jffs2SbLock[i], NULL) != LOS_OK) {
+            goto ERROR_WITH_SB;
+        }
     }
+    for (j = 0; j < JFFS2_INODE_LOCK_BUCKETS; j++) {
+        if (LOS_MuxInit(&g_jffs2InodeLock[j], NULL) != LOS_OK) {
+            goto ERROR_WITH_INODE;
+        }
+    }
+    return 0;
+
+ERROR_WITH_INODE:
+    while (j-- > 0) {
+        (void)LOS_MuxDestroy(&g_jffs2InodeLock[j]);
+    }
+ERROR_WITH_SB:
+    while (i-- > 0) {
+        (void)LOS_MuxDestroy(&g_jffs2SbLock[i]);
+    }
+    PRINT_ERR("%s, LOS_MuxCreate failed\n", __FUNCTION__);
+    return -1;
 }
 
 void Jffs2MutexDelete(void)
 {
-    (void)LOS_MuxDestroy(&g_jffs2FsLock);
+    for (int i = 0; i < CONFIG_MTD_PATTITION_NUM; i++) {
+        (void)LOS_MuxDestroy(&g_jffs2SbLock[i]);
+    }
+    for (int i = 0; i < JFFS2_INODE_LOCK_BUCKETS; i++) {
+        (void)LOS_MuxDestroy(&g_jffs2InodeLock[i]);
+    }
 }
 
 const struct MountOps jffs_operations = {
@@ -63,6 +63,14 @@ extern void ProcMountsInit(void);
 
 extern void ProcUptimeInit(void);
 
+#ifdef LOSCFG_KERNEL_CPUP
+extern void ProcStatInit(void);
+#endif
+
+#ifdef LOSCFG_FS_FAT_CACHE
+extern void ProcBcacheInit(void);
+#endif
+
 #ifdef __cplusplus
 #if __cplusplus
 }
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "proc_fs.h"
+#include "errno.h"
+#include "disk.h"
+
+#ifdef LOSCFG_FS_FAT_CACHE
+/*
+ * /proc/bcache: one line per disk with a block cache, the current sizes then the counters.
+ * in and main are the 2Q queues of the read buffers, dynamic the read buffers allocated
+ * beyond the base pool, bypasses the page-cache fills and writebacks that skipped the cache,
+ * throttles the writes that had to write back blocks themselves over the hard dirty limit.
+ */
+static int BcacheProcFill(struct SeqBuf *seqBuf, void *v)
+{
+    OsBcacheStat stat;
+    los_disk *disk = NULL;
+    INT32 ret;
+    INT32 i;
+
+    (void)v;
+    for (i = 0; i < SYS_MAX_DISK; i++) {
+        disk = get_disk(i);
+        if ((disk == NULL) || (pthread_mutex_lock(&disk->disk_mutex) != ENOERR)) {
+            continue;
+        }
+        ret = -ENODEV;
+        if ((disk->disk_status == STAT_INUSED) && (disk->bcache != NULL)) {
+            ret = BlockCacheStatGet(disk->bcache, &stat);
+        }
+        if (ret == ENOERR) {
+            (void)LosBufPrintf(seqBuf, "%s blocks %u read %u dynamic %u in %u main %u dirty %u "
+                               "hits %llu misses %llu ghosthits %llu evictions %llu writebacks %llu "
+                               "bypasses %llu throttles %llu grows %u shrinks %u\n",
+                               (disk->disk_name != NULL) ? disk->disk_name : "disk",
+                               stat.nBlock, stat.readBlocks, stat.nDynamic, stat.nIn, stat.nMain, stat.nDirty,
+                               stat.hits, stat.misses, stat.ghostHits, stat.evictions, stat.writebacks,
+                               stat.bypasses, stat.throttles, stat.grows, stat.shrinks);
+        }
+        (void)pthread_mutex_unlock(&disk->disk_mutex);
+    }
+    return 0;
+}
+
+static const struct ProcFileOperations BCACHE_PROC_FOPS = {
+    .read       = BcacheProcFill,
+};
+
+void ProcBcacheInit(void)
+{
+    struct ProcDirEntry *pde = CreateProcEntry("bcache", 0, NULL);
+    if (pde == NULL) {
+        PRINT_ERR("create /proc/bcache error!\n");
+        return;
+    }
+    pde->procFileOps = &BCACHE_PROC_FOPS;
+}
+#endif
@@ -59,6 +59,12 @@ void ProcFsInit(void)
 #endif
     ProcProcessInit();
     ProcUptimeInit();
+#ifdef LOSCFG_KERNEL_CPUP
+    ProcStatInit();
+#endif
+#ifdef LOSCFG_FS_FAT_CACHE
+    ProcBcacheInit();
+#endif
     ProcKernelTraceInit();
 }
 #endif
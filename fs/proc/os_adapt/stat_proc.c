@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "proc_fs.h"
+#include "stdlib.h"
+#include "errno.h"
+#include "los_cpup.h"
+#include "los_sys_pri.h"
+
+#ifdef LOSCFG_KERNEL_CPUP
+#define CPU_STAT_WINDOW_NUM 4
+
+STATIC const UINT16 g_cpuStatWindows[CPU_STAT_WINDOW_NUM] = {
+    CPUP_LAST_ONE_SECONDS, CPUP_LAST_TEN_SECONDS, CPUP_LAST_SIXTY_SECONDS, CPUP_ALL_TIME
+};
+
+STATIC const CHAR *g_cpuStatWindowNames[CPU_STAT_WINDOW_NUM] = { "1s", "10s", "60s", "all" };
+
+STATIC UINT32 CpuStatUsage(UINT64 time, UINT64 allTime)
+{
+    if (allTime == 0) {
+        return 0;
+    }
+    return (UINT32)((LOS_CPUP_SINGLE_CORE_PRECISION * time) / allTime);
+}
+
+STATIC VOID CpuStatTimeFill(struct SeqBuf *seqBuf, const CHAR *name, const CPUP_CPU_STAT_S *stat)
+{
+    /* user nice system idle iowait irq softirq, in ticks, the same layout as linux */
+    (VOID)LosBufPrintf(seqBuf, "%-4s %llu 0 0 %llu 0 %llu %llu\n", name,
+                       stat->taskTime / OS_CYCLE_PER_TICK, stat->idleTime / OS_CYCLE_PER_TICK,
+                       stat->irqTime / OS_CYCLE_PER_TICK, stat->swtmrTime / OS_CYCLE_PER_TICK);
+}
+
+STATIC VOID CpuStatUsageFill(struct SeqBuf *seqBuf, const CPUP_CPU_STAT_S *stat, const CHAR *window)
+{
+    UINT32 busy = LOS_CPUP_SINGLE_CORE_PRECISION - CpuStatUsage(stat->idleTime, stat->allTime);
+    UINT32 task = CpuStatUsage(stat->taskTime, stat->allTime);
+    UINT32 swtmr = CpuStatUsage(stat->swtmrTime, stat->allTime);
+    UINT32 irq = CpuStatUsage(stat->irqTime, stat->allTime);
+
+    (VOID)LosBufPrintf(seqBuf, "usage cpu%u %-3s %u.%02u task %u.%02u swtmr %u.%02u irq %u.%02u\n",
+                       stat->cpuid, window,
+                       busy / LOS_CPUP_PRECISION_MULT, busy % LOS_CPUP_PRECISION_MULT,
+                       task / LOS_CPUP_PRECISION_MULT, task % LOS_CPUP_PRECISION_MULT,
+                       swtmr / LOS_CPUP_PRECISION_MULT, swtmr % LOS_CPUP_PRECISION_MULT,
+                       irq / LOS_CPUP_PRECISION_MULT, irq % LOS_CPUP_PRECISION_MULT);
+}
+
+#ifdef LOSCFG_CPUP_INCLUDE_IRQ
+STATIC VOID IrqStatFill(struct SeqBuf *seqBuf)
+{
+    size_t size = sizeof(CPUP_INFO_S) * OS_HWI_MAX_NUM;
+    CPUP_INFO_S *irqAll = (CPUP_INFO_S *)malloc(size);
+    CPUP_INFO_S *irq10s = (CPUP_INFO_S *)malloc(size);
+    CPUP_INFO_S *irq1s = (CPUP_INFO_S *)malloc(size);
+    UINT32 loop;
+
+    if ((irqAll == NULL) || (irq10s == NULL) || (irq1s == NULL)) {
+        goto OUT;
+    }
+
+    if ((LOS_GetAllIrqCpuUsage(CPUP_ALL_TIME, irqAll, size) != LOS_OK) ||
+        (LOS_GetAllIrqCpuUsage(CPUP_LAST_TEN_SECONDS, irq10s, size) != LOS_OK) ||
+        (LOS_GetAllIrqCpuUsage(CPUP_LAST_ONE_SECONDS, irq1s, size) != LOS_OK)) {
+        goto OUT;
+    }
+
+    for (loop = 0; loop < OS_HWI_MAX_NUM; loop++) {
+        if (irqAll[loop].status == 0) {
+            continue;
+        }
+        (VOID)LosBufPrintf(seqBuf, "irq %u 1s %u.%02u 10s %u.%02u all %u.%02u\n", loop,
+                           irq1s[loop].usage / LOS_CPUP_PRECISION_MULT, irq1s[loop].usage % LOS_CPUP_PRECISION_MULT,
+                           irq10s[loop].usage / LOS_CPUP_PRECISION_MULT, irq10s[loop].usage % LOS_CPUP_PRECISION_MULT,
+                           irqAll[loop].usage / LOS_CPUP_PRECISION_MULT, irqAll[loop].usage % LOS_CPUP_PRECISION_MULT);
+    }
+
+OUT:
+    free(irqAll);
+    free(irq10s);
+    free(irq1s);
+}
+#endif
+
+/*
+ * /proc/stat: the cpu lines keep the linux layout so that the usual tools can
+ * parse them, the usage and irq lines add the windowed breakdown.
+ */
+static int StatProcFill(struct SeqBuf *seqBuf, void *v)
+{
+    CPUP_CPU_STAT_S stat[LOSCFG_KERNEL_CORE_NUM];
+    CPUP_CPU_STAT_S total = { 0 };
+    CHAR name[NAME_MAX];
+    UINT32 window;
+    UINT32 cpuid;
+
+    (void)v;
+    if (LOS_GetCpuStat(CPUP_ALL_TIME, stat, sizeof(stat)) != LOS_OK) {
+        return -EINVAL;
+    }
+
+    for (cpuid = 0; cpuid < LOSCFG_KERNEL_CORE_NUM; cpuid++) {
+        total.taskTime += stat[cpuid].taskTime;
+        total.idleTime += stat[cpuid].idleTime;
+        total.swtmrTime += stat[cpuid].swtmrTime;
+        total.irqTime += stat[cpuid].irqTime;
+    }
+    CpuStatTimeFill(seqBuf, "cpu", &total);
+    for (cpuid = 0; cpuid < LOSCFG_KERNEL_CORE_NUM; cpuid++) {
+        (VOID)snprintf_s(name, sizeof(name), sizeof(name) - 1, "cpu%u", cpuid);
+        CpuStatTimeFill(seqBuf, name, &stat[cpuid]);
+    }
+
+    for (window = 0; window < CPU_STAT_WINDOW_NUM; window++) {
+        if (LOS_GetCpuStat(g_cpuStatWindows[window], stat, sizeof(stat)) != LOS_OK) {
+            return -EINVAL;
+        }
+        for (cpuid = 0; cpuid < LOSCFG_KERNEL_CORE_NUM; cpuid++) {
+            CpuStatUsageFill(seqBuf, &stat[cpuid], g_cpuStatWindowNames[window]);
+        }
+    }
+
+#ifdef LOSCFG_CPUP_INCLUDE_IRQ
+    IrqStatFill(seqBuf);
+#endif
+    return 0;
+}
+
+/*
+ * /proc/cpustat: the binary form, CPUP_CPU_STAT_S records of every core for
+ * the 1s, 10s, 60s and all time windows in turn.
+ */
+static int CpuStatProcFill(struct SeqBuf *seqBuf, void *v)
+{
+    CPUP_CPU_STAT_S stat[LOSCFG_KERNEL_CORE_NUM];
+    UINT32 window;
+
+    (void)v;
+    for (window = 0; window < CPU_STAT_WINDOW_NUM; window++) {
+        if (LOS_GetCpuStat(g_cpuStatWindows[window], stat, sizeof(stat)) != LOS_OK) {
+            return -EINVAL;
+        }
+        if (LosBufWrite(seqBuf, stat, sizeof(stat)) != 0) {
+            return -ENOMEM;
+        }
+    }
+    return 0;
+}
+
+static const struct ProcFileOperations STAT_PROC_FOPS = {
+    .read       = StatProcFill,
+};
+
+static const struct ProcFileOperations CPUSTAT_PROC_FOPS = {
+    .read       = CpuStatProcFill,
+};
+
+void ProcStatInit(void)
+{
+    struct ProcDirEntry *pde = CreateProcEntry("stat", 0, NULL);
+    if (pde == NULL) {
+        PRINT_ERR("create /proc/stat error!\n");
+        return;
+    }
+    pde->procFileOps = &STAT_PROC_FOPS;
+
+    pde = CreateProcEntry("cpustat", 0, NULL);
+    if (pde == NULL) {
+        PRINT_ERR("create /proc/cpustat error!\n");
+        return;
+    }
+    pde->procFileOps = &CPUSTAT_PROC_FOPS;
+}
+#endif
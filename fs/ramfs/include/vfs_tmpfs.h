@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2021-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _VFS_TMPFS_H_
+#define _VFS_TMPFS_H_
+
+#include <sys/types.h>
+#include <sys/statfs.h>
+
+#include "los_list.h"
+#include "los_mux.h"
+#include "los_spinlock.h"
+#include "los_vm_filemap.h"
+
+#include "fs/file.h"
+#include "fs/vnode.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#ifndef TMPFS_MAGIC
+#define TMPFS_MAGIC             0x01021994
+#endif
+
+#define TMPFS_DEFAULT_MODE      01777
+
+/* file pages are indexed by a directory of leaves, each leaf covers TMPFS_INDEX_LEAF pages */
+#define TMPFS_INDEX_SHIFT       8
+#define TMPFS_INDEX_LEAF        (1U << TMPFS_INDEX_SHIFT)
+#define TMPFS_INDEX_MASK        (TMPFS_INDEX_LEAF - 1)
+#define TMPFS_MAX_FILE_PAGES    (1U << 20)      /* 4GiB with 4KiB pages */
+
+struct TmpfsSb {
+    LosMux lock;                    /* protects the namespace */
+    SPIN_LOCK_S statLock;           /* protects usedPages */
+    UINT32 maxPages;                /* page budget of the mount, 0 for no limit */
+    UINT32 usedPages;               /* pages charged to files of the mount */
+    UINT32 nextIno;
+    struct TmpfsNode *root;
+    LOS_DL_LIST orphans;            /* unlinked nodes still cached by a vnode */
+};
+
+struct TmpfsLeaf {
+    UINT32 count;                   /* slots in use */
+    LosFilePage *slot[TMPFS_INDEX_LEAF];
+};
+
+struct TmpfsNode {
+    LOS_DL_LIST sibling;            /* entry in the children of the parent, or in the orphans */
+    LOS_DL_LIST children;
+    struct TmpfsNode *parent;       /* NULL once unlinked */
+    struct TmpfsSb *sb;
+    struct Vnode *vnode;            /* vnode caching the node, if any */
+    char *name;
+    UINT32 ino;
+    UINT32 nlink;
+    mode_t mode;
+    uid_t uid;
+    gid_t gid;
+    time_t atime;
+    time_t mtime;
+    time_t ctime;
+    UINT64 size;
+    /*
+     * The page cache is the file data. Pages stay off the LRU so the shrinker never drops them,
+     * page_list is kept sorted by pgoff for the generic fault path, leaf indexes it by pgoff.
+     */
+    struct page_mapping mapping;
+    struct TmpfsLeaf **leaf;
+    UINT32 leafCnt;
+};
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#endif /* _VFS_TMPFS_H_ */
@@ -0,0 +1,1429 @@
+/*
+ * Copyright (c) 2021-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vfs_tmpfs.h"
+
+#include "fcntl.h"
+#include "stdlib.h"
+#include "string.h"
+#include "sys/stat.h"
+#include "sys/time.h"
+#include "errno.h"
+#include "securec.h"
+
+#include "los_config.h"
+#include "los_typedef.h"
+#include "los_arch_mmu.h"
+#include "los_atomic.h"
+#include "los_process.h"
+#include "los_tables.h"
+#include "los_vm_common.h"
+#include "los_vm_dump.h"
+#include "los_vm_fault.h"
+#include "los_vm_map.h"
+#include "los_vm_page.h"
+#include "los_vm_phys.h"
+#include "user_copy.h"
+
+#include "fs/dirent_fs.h"
+#include "fs/fs.h"
+#include "fs/fs_operation.h"
+#include "fs/mount.h"
+
+#if defined(LOSCFG_FS_TMPFS) && defined(LOSCFG_KERNEL_VM)
+
+#define TMPFS_DEFAULT_PERCENT   50
+#define TMPFS_PERCENT_MAX       100
+#define TMPFS_MAX_SIZE          ((UINT64)TMPFS_MAX_FILE_PAGES << PAGE_SHIFT)
+#define TMPFS_SECTOR_SIZE       512
+#define TMPFS_OPT_SIZE          "size="
+#define TMPFS_OPT_MODE          "mode="
+
+static struct VnodeOps g_tmpfsVops;
+static struct file_operations_vfs g_tmpfsFops;
+
+/*
+ * Lock order is namespace lock, then the node mux (the mux_lock of the node mapping), then the
+ * mapping list_lock. The mux serialises size changes and page insertion and removal, the page
+ * fault path takes it through f_mapping. Read and write copy to and from the user with no lock
+ * held, on a pinned page, so a fault on a mapping of another tmpfs file never nests two muxes.
+ */
+static void TmpfsSbLock(struct TmpfsSb *sb)
+{
+    (void)LOS_MuxLock(&sb->lock, LOS_WAIT_FOREVER);
+}
+
+static void TmpfsSbUnlock(struct TmpfsSb *sb)
+{
+    (void)LOS_MuxUnlock(&sb->lock);
+}
+
+static void TmpfsNodeLock(struct TmpfsNode *node)
+{
+    (void)LOS_MuxLock(&node->mapping.mux_lock, LOS_WAIT_FOREVER);
+}
+
+static void TmpfsNodeUnlock(struct TmpfsNode *node)
+{
+    (void)LOS_MuxUnlock(&node->mapping.mux_lock);
+}
+
+static time_t TmpfsCurSec(void)
+{
+    struct timeval tv;
+    if (gettimeofday(&tv, NULL)) {
+        return 0;
+    }
+    return tv.tv_sec;
+}
+
+static UINT32 TmpfsPages(UINT64 size)
+{
+    return (UINT32)((size + PAGE_SIZE - 1) >> PAGE_SHIFT);
+}
+
+static struct TmpfsNode *TmpfsFileNode(const struct file *filep)
+{
+    if ((filep == NULL) || (filep->f_vnode == NULL)) {
+        return NULL;
+    }
+    return (struct TmpfsNode *)filep->f_vnode->data;
+}
+
+static int TmpfsCharge(struct TmpfsSb *sb)
+{
+    UINT32 intSave;
+    int ret = 0;
+
+    LOS_SpinLockSave(&sb->statLock, &intSave);
+    if ((sb->maxPages != 0) && (sb->usedPages >= sb->maxPages)) {
+        ret = -ENOSPC;
+    } else {
+        sb->usedPages++;
+    }
+    LOS_SpinUnlockRestore(&sb->statLock, intSave);
+    return ret;
+}
+
+static void TmpfsUncharge(struct TmpfsSb *sb, UINT32 pages)
+{
+    UINT32 intSave;
+
+    LOS_SpinLockSave(&sb->statLock, &intSave);
+    sb->usedPages -= pages;
+    LOS_SpinUnlockRestore(&sb->statLock, intSave);
+}
+
+/* the caller holds the list_lock or the node mux */
+static LosFilePage *TmpfsIndexFind(const struct TmpfsNode *node, VM_OFFSET_T pgoff)
+{
+    UINT32 dir = pgoff >> TMPFS_INDEX_SHIFT;
+
+    if ((dir >= node->leafCnt) || (node->leaf[dir] == NULL)) {
+        return NULL;
+    }
+    return node->leaf[dir]->slot[pgoff & TMPFS_INDEX_MASK];
+}
+
+/* make sure pgoff has a slot, the caller holds the node mux */
+static int TmpfsIndexReserve(struct TmpfsNode *node, VM_OFFSET_T pgoff)
+{
+    UINT32 dir = pgoff >> TMPFS_INDEX_SHIFT;
+    struct TmpfsLeaf **oldDir = NULL;
+    struct TmpfsLeaf **newDir = NULL;
+    struct TmpfsLeaf *leaf = NULL;
+    UINT32 cnt;
+    UINT32 intSave;
+
+    if (dir >= node->leafCnt) {
+        cnt = (node->leafCnt == 0) ? 1 : node->leafCnt;
+        while (cnt <= dir) {
+            cnt <<= 1;
+        }
+        newDir = (struct TmpfsLeaf **)zalloc(cnt * sizeof(struct TmpfsLeaf *));
+        if (newDir == NULL) {
+            return -ENOMEM;
+        }
+        if (node->leafCnt != 0) {
+            (void)memcpy_s(newDir, cnt * sizeof(struct TmpfsLeaf *),
+                           node->leaf, node->leafCnt * sizeof(struct TmpfsLeaf *));
+        }
+        LOS_SpinLockSave(&node->mapping.list_lock, &intSave);
+        oldDir = node->leaf;
+        node->leaf = newDir;
+        node->leafCnt = cnt;
+        LOS_SpinUnlockRestore(&node->mapping.list_lock, intSave);
+        free(oldDir);
+    }
+
+    if (node->leaf[dir] == NULL) {
+        leaf = (struct TmpfsLeaf *)zalloc(sizeof(struct TmpfsLeaf));
+        if (leaf == NULL) {
+            return -ENOMEM;
+        }
+        LOS_SpinLockSave(&node->mapping.list_lock, &intSave);
+        node->leaf[dir] = leaf;
+        LOS_SpinUnlockRestore(&node->mapping.list_lock, intSave);
+    }
+    return 0;
+}
+
+/* the cached page with the highest pgoff below pgoff, the caller holds the list_lock */
+static LosFilePage *TmpfsIndexPrev(const struct TmpfsNode *node, VM_OFFSET_T pgoff)
+{
+    LosFilePage *last = NULL;
+    struct TmpfsLeaf *leaf = NULL;
+    INT32 dir = (INT32)(pgoff >> TMPFS_INDEX_SHIFT);
+    INT32 slot = (INT32)(pgoff & TMPFS_INDEX_MASK);
+
+    if (LOS_ListEmpty(&node->mapping.page_list)) {
+        return NULL;
+    }
+    /* appending is the common case */
+    last = LOS_DL_LIST_ENTRY(LOS_DL_LIST_LAST(&node->mapping.page_list), LosFilePage, node);
+    if (last->pgoff < pgoff) {
+        return last;
+    }
+
+    for (; dir >= 0; dir--, slot = TMPFS_INDEX_LEAF) {
+        leaf = node->leaf[dir];
+        if ((leaf == NULL) || (leaf->count == 0)) {
+            continue;
+        }
+        while (--slot >= 0) {
+            if (leaf->slot[slot] != NULL) {
+                return leaf->slot[slot];
+            }
+        }
+    }
+    return NULL;
+}
+
+/* find the page caching pgoff or add a zeroed one, the caller holds the node mux */
+static int TmpfsPageGet(struct TmpfsNode *node, VM_OFFSET_T pgoff, LosFilePage **fpagep)
+{
+    LosFilePage *fpage = NULL;
+    LosFilePage *prev = NULL;
+    struct TmpfsLeaf *leaf = NULL;
+    UINT32 intSave;
+    int ret;
+
+    fpage = TmpfsIndexFind(node, pgoff);
+    if (fpage != NULL) {
+        *fpagep = fpage;
+        return 0;
+    }
+
+    ret = TmpfsIndexReserve(node, pgoff);
+    if (ret != 0) {
+        return ret;
+    }
+    ret = TmpfsCharge(node->sb);
+    if (ret != 0) {
+        return ret;
+    }
+    fpage = OsPageCacheAlloc(&node->mapping, pgoff);
+    if (fpage == NULL) {
+        TmpfsUncharge(node->sb, 1);
+        return -ENOMEM;
+    }
+
+    /* keep page_list sorted, the generic fault and fork paths walk it with OsFindGetEntry */
+    LOS_SpinLockSave(&node->mapping.list_lock, &intSave);
+    prev = TmpfsIndexPrev(node, pgoff);
+    if (prev != NULL) {
+        LOS_ListAdd(&prev->node, &fpage->node);
+    } else {
+        LOS_ListAdd(&node->mapping.page_list, &fpage->node);
+    }
+    leaf = node->leaf[pgoff >> TMPFS_INDEX_SHIFT];
+    leaf->slot[pgoff & TMPFS_INDEX_MASK] = fpage;
+    leaf->count++;
+    node->mapping.nrpages++;
+    LOS_SpinUnlockRestore(&node->mapping.list_lock, intSave);
+
+    *fpagep = fpage;
+    return 0;
+}
+
+/* take a reference on the page caching pgoff, released with LOS_PhysPageFree */
+static LosVmPage *TmpfsPagePin(struct TmpfsNode *node, VM_OFFSET_T pgoff)
+{
+    LosFilePage *fpage = NULL;
+    LosVmPage *vmPage = NULL;
+    UINT32 intSave;
+
+    LOS_SpinLockSave(&node->mapping.list_lock, &intSave);
+    fpage = TmpfsIndexFind(node, pgoff);
+    if (fpage != NULL) {
+        vmPage = fpage->vmPage;
+        LOS_AtomicInc(&vmPage->refCounts);
+    }
+    LOS_SpinUnlockRestore(&node->mapping.list_lock, intSave);
+
+    return vmPage;
+}
+
+/*
+ * Drop the pages from start on, last page first. User mappings of a page are torn down with it and
+ * pinned readers keep the memory until they let go. The caller holds the node mux or owns the node.
+ */
+static void TmpfsPagesDrop(struct TmpfsNode *node, VM_OFFSET_T start)
+{
+    LosFilePage *fpage = NULL;
+    struct TmpfsLeaf *leaf = NULL;
+    SPIN_LOCK_S *lruLock = NULL;
+    UINT32 dropped = 0;
+    UINT32 dir;
+    UINT32 intSave;
+    UINT32 lruSave;
+
+    /* one page per lock round so a large truncate does not keep interrupts off */
+    for (;;) {
+        leaf = NULL;
+        LOS_SpinLockSave(&node->mapping.list_lock, &intSave);
+        if (LOS_ListEmpty(&node->mapping.page_list)) {
+            LOS_SpinUnlockRestore(&node->mapping.list_lock, intSave);
+            break;
+        }
+        fpage = LOS_DL_LIST_ENTRY(LOS_DL_LIST_LAST(&node->mapping.page_list), LosFilePage, node);
+        if (fpage->pgoff < start) {
+            LOS_SpinUnlockRestore(&node->mapping.list_lock, intSave);
+            break;
+        }
+
+        dir = fpage->pgoff >> TMPFS_INDEX_SHIFT;
+        node->leaf[dir]->slot[fpage->pgoff & TMPFS_INDEX_MASK] = NULL;
+        if (--node->leaf[dir]->count == 0) {
+            leaf = node->leaf[dir];
+            node->leaf[dir] = NULL;
+        }
+
+        lruLock = &fpage->physSeg->lruLock;
+        LOS_SpinLockSave(lruLock, &lruSave);
+        OsCleanPageDirty(fpage->vmPage);
+        OsPageCacheDel(fpage);
+        LOS_SpinUnlockRestore(lruLock, lruSave);
+        LOS_SpinUnlockRestore(&node->mapping.list_lock, intSave);
+
+        free(leaf);
+        dropped++;
+    }
+
+    if (dropped != 0) {
+        TmpfsUncharge(node->sb, dropped);
+    }
+}
+
+/* clear the part of the last page beyond size, so growing the file again reads zeros */
+static void TmpfsZeroTail(struct TmpfsNode *node, UINT64 size)
+{
+    UINT32 off = (UINT32)(size & (PAGE_SIZE - 1));
+    LosVmPage *vmPage = NULL;
+
+    if (off == 0) {
+        return;
+    }
+    vmPage = TmpfsPagePin(node, size >> PAGE_SHIFT);
+    if (vmPage == NULL) {
+        return;
+    }
+    (void)memset_s((char *)OsVmPageToVaddr(vmPage) + off, PAGE_SIZE - off, 0, PAGE_SIZE - off);
+    LOS_PhysPageFree(vmPage);
+}
+
+static struct TmpfsNode *TmpfsNodeAlloc(struct TmpfsSb *sb, const char *name, int len, mode_t mode)
+{
+    struct TmpfsNode *node = NULL;
+    time_t now = TmpfsCurSec();
+
+    node = (struct TmpfsNode *)zalloc(sizeof(struct TmpfsNode));
+    if (node == NULL) {
+        return NULL;
+    }
+    node->name = (char *)malloc(len + 1);
+    if (node->name == NULL) {
+        free(node);
+        return NULL;
+    }
+    if (LOS_MuxInit(&node->mapping.mux_lock, NULL) != LOS_OK) {
+        free(node->name);
+        free(node);
+        return NULL;
+    }
+    (void)memcpy_s(node->name, len + 1, name, len);
+    node->name[len] = '\0';
+
+    LOS_ListInit(&node->sibling);
+    LOS_ListInit(&node->children);
+    LOS_ListInit(&node->mapping.page_list);
+    LOS_SpinInit(&node->mapping.list_lock);
+    LOS_AtomicSet(&node->mapping.ref, 1);
+
+    node->sb = sb;
+    node->ino = ++sb->nextIno;
+    node->nlink = 1;
+    node->mode = mode;
+    node->uid = LOS_GetUserID();
+    node->gid = LOS_GetGroupID();
+    node->atime = now;
+    node->mtime = now;
+    node->ctime = now;
+    return node;
+}
+
+/* the node is unlinked or the mount is going away, nobody else can reach it */
+static void TmpfsNodeFree(struct TmpfsNode *node)
+{
+    UINT32 i;
+
+    TmpfsPagesDrop(node, 0);
+    for (i = 0; i < node->leafCnt; i++) {
+        free(node->leaf[i]);
+    }
+    free(node->leaf);
+    (void)LOS_MuxDestroy(&node->mapping.mux_lock);
+    free(node->name);
+    free(node);
+}
+
+/* a subdirectory holds a link to its parent through its ".." */
+static void TmpfsNodeLink(struct TmpfsNode *parent, struct TmpfsNode *node)
+{
+    node->parent = parent;
+    LOS_ListTailInsert(&parent->children, &node->sibling);
+    if (S_ISDIR(node->mode)) {
+        parent->nlink++;
+    }
+    parent->mtime = node->ctime;
+    parent->ctime = node->ctime;
+}
+
+/* take node out of the namespace, a node still cached by a vnode waits on the orphan list for reclaim */
+static void TmpfsNodeUnlink(struct TmpfsNode *node)
+{
+    time_t now = TmpfsCurSec();
+
+    LOS_ListDelete(&node->sibling);
+    if (S_ISDIR(node->mode)) {
+        node->parent->nlink--;
+    }
+    node->parent->mtime = now;
+    node->parent->ctime = now;
+    node->parent = NULL;
+    node->nlink = 0;
+    node->ctime = now;
+    if (node->vnode == NULL) {
+        TmpfsNodeFree(node);
+    } else {
+        LOS_ListTailInsert(&node->sb->orphans, &node->sibling);
+    }
+}
+
+static struct TmpfsNode *TmpfsNodeFind(const struct TmpfsNode *parent, const char *name, int len)
+{
+    struct TmpfsNode *node = NULL;
+
+    LOS_DL_LIST_FOR_EACH_ENTRY(node, &parent->children, struct TmpfsNode, sibling) {
+        if ((strncmp(node->name, name, len) == 0) && (node->name[len] == '\0')) {
+            return node;
+        }
+    }
+    return NULL;
+}
+
+static int TmpfsVnodeGet(struct Vnode *parentVnode, struct TmpfsNode *node, struct Vnode **ppVnode)
+{
+    struct Vnode *newVnode = node->vnode;
+    int ret;
+
+    if (newVnode != NULL) {
+        *ppVnode = newVnode;
+        return 0;
+    }
+
+    ret = VnodeAlloc(&g_tmpfsVops, &newVnode);
+    if (ret != 0) {
+        return -ENOMEM;
+    }
+    newVnode->type = S_ISDIR(node->mode) ? VNODE_TYPE_DIR : VNODE_TYPE_REG;
+    newVnode->fop = &g_tmpfsFops;
+    newVnode->data = node;
+    newVnode->parent = parentVnode;
+    newVnode->originMount = parentVnode->originMount;
+    newVnode->uid = node->uid;
+    newVnode->gid = node->gid;
+    newVnode->mode = node->mode;
+    node->vnode = newVnode;
+
+    *ppVnode = newVnode;
+    return 0;
+}
+
+static int TmpfsParseSize(const char *value, UINT32 totalPages, UINT32 *maxPages)
+{
+    char *end = NULL;
+    UINT64 size = strtoull(value, &end, 0);
+
+    if (end == value) {
+        return -EINVAL;
+    }
+    switch (*end) {
+        case '%':
+            if (size > TMPFS_PERCENT_MAX) {
+                return -EINVAL;
+            }
+            *maxPages = (UINT32)(((UINT64)totalPages * size) / TMPFS_PERCENT_MAX);
+            return (end[1] == '\0') ? 0 : -EINVAL;
+        case 'g':
+        case 'G':
+            size <<= 10; /* 10: giga is 1024 mega */
+            /* fall through */
+        case 'm':
+        case 'M':
+            size <<= 10; /* 10: mega is 1024 kilo */
+            /* fall through */
+        case 'k':
+        case 'K':
+            size <<= 10; /* 10: kilo */
+            end++;
+            break;
+        default:
+            break;
+    }
+    if (*end != '\0') {
+        return -EINVAL;
+    }
+    *maxPages = TmpfsPages(size);
+    return 0;
+}
+
+/* mount options are "size=<bytes>[k|m|g]" or "size=<percent>%" of RAM, and "mode=<octal>" of the root */
+static int TmpfsParseOptions(struct TmpfsSb *sb, mode_t *rootMode, const char *data)
+{
+    UINT32 usedPages = 0;
+    UINT32 totalPages = 0;
+    char *opts = NULL;
+    char *opt = NULL;
+    char *save = NULL;
+    char *end = NULL;
+    int ret = 0;
+
+    OsVmPhysUsedInfoGet(&usedPages, &totalPages);
+    sb->maxPages = (UINT32)(((UINT64)totalPages * TMPFS_DEFAULT_PERCENT) / TMPFS_PERCENT_MAX);
+    *rootMode = TMPFS_DEFAULT_MODE;
+    if ((data == NULL) || (*data == '\0')) {
+        return 0;
+    }
+
+    opts = strdup(data);
+    if (opts == NULL) {
+        return -ENOMEM;
+    }
+    for (opt = strtok_r(opts, ",", &save); opt != NULL; opt = strtok_r(NULL, ",", &save)) {
+        if (strncmp(opt, TMPFS_OPT_SIZE, strlen(TMPFS_OPT_SIZE)) == 0) {
+            ret = TmpfsParseSize(opt + strlen(TMPFS_OPT_SIZE), totalPages, &sb->maxPages);
+        } else if (strncmp(opt, TMPFS_OPT_MODE, strlen(TMPFS_OPT_MODE)) == 0) {
+            *rootMode = (mode_t)strtoul(opt + strlen(TMPFS_OPT_MODE), &end, 8) & 07777; /* 8: octal */
+            ret = (*end == '\0') ? 0 : -EINVAL;
+        } else {
+            ret = -EINVAL;
+        }
+        if (ret != 0) {
+            PRINT_ERR("tmpfs: bad mount option %s\n", opt);
+            break;
+        }
+    }
+    free(opts);
+    return ret;
+}
+
+int VfsTmpfsMount(struct Mount *mnt, struct Vnode *device, const void *data)
+{
+    struct TmpfsSb *sb = NULL;
+    struct TmpfsNode *root = NULL;
+    struct Vnode *vp = NULL;
+    mode_t rootMode;
+    int ret;
+
+    (void)device;
+
+    sb = (struct TmpfsSb *)zalloc(sizeof(struct TmpfsSb));
+    if (sb == NULL) {
+        return -ENOMEM;
+    }
+    ret = TmpfsParseOptions(sb, &rootMode, (const char *)data);
+    if (ret != 0) {
+        goto ERROR_WITH_SB;
+    }
+    if (LOS_MuxInit(&sb->lock, NULL) != LOS_OK) {
+        ret = -ENOMEM;
+        goto ERROR_WITH_SB;
+    }
+    LOS_SpinInit(&sb->statLock);
+    LOS_ListInit(&sb->orphans);
+
+    root = TmpfsNodeAlloc(sb, "", 0, S_IFDIR | rootMode);
+    if (root == NULL) {
+        ret = -ENOMEM;
+        goto ERROR_WITH_LOCK;
+    }
+    ret = VnodeAlloc(&g_tmpfsVops, &vp);
+    if (ret != 0) {
+        ret = -ENOMEM;
+        goto ERROR_WITH_ROOT;
+    }
+
+    root->nlink = 2; /* 2: "." and the entry in the covered directory */
+    root->vnode = vp;
+    sb->root = root;
+    vp->type = VNODE_TYPE_DIR;
+    vp->data = root;
+    vp->originMount = mnt;
+    vp->fop = &g_tmpfsFops;
+    vp->uid = root->uid;
+    vp->gid = root->gid;
+    vp->mode = root->mode;
+    mnt->data = sb;
+    mnt->vnodeCovered = vp;
+
+    return 0;
+
+ERROR_WITH_ROOT:
+    TmpfsNodeFree(root);
+ERROR_WITH_LOCK:
+    (void)LOS_MuxDestroy(&sb->lock);
+ERROR_WITH_SB:
+    free(sb);
+    return ret;
+}
+
+int VfsTmpfsUnmount(struct Mount *mnt, struct Vnode **blkDriver)
+{
+    struct TmpfsSb *sb = (struct TmpfsSb *)mnt->data;
+    struct TmpfsNode *node = NULL;
+    struct TmpfsNode *parent = NULL;
+
+    if (sb == NULL) {
+        return -EINVAL;
+    }
+
+    TmpfsSbLock(sb);
+    /* post-order walk without recursion, directory depth is only bounded by PATH_MAX */
+    node = sb->root;
+    while (node != NULL) {
+        if (!LOS_ListEmpty(&node->children)) {
+            node = LOS_DL_LIST_ENTRY(LOS_DL_LIST_FIRST(&node->children), struct TmpfsNode, sibling);
+            continue;
+        }
+        parent = node->parent;
+        LOS_ListDelete(&node->sibling);
+        if (node->vnode != NULL) {
+            node->vnode->data = NULL;
+        }
+        TmpfsNodeFree(node);
+        node = parent;
+    }
+    sb->root = NULL;
+    while (!LOS_ListEmpty(&sb->orphans)) {
+        node = LOS_DL_LIST_ENTRY(LOS_DL_LIST_FIRST(&sb->orphans), struct TmpfsNode, sibling);
+        LOS_ListDelete(&node->sibling);
+        node->vnode->data = NULL;
+        TmpfsNodeFree(node);
+    }
+    TmpfsSbUnlock(sb);
+
+    (void)LOS_MuxDestroy(&sb->lock);
+    free(sb);
+    mnt->data = NULL;
+    *blkDriver = NULL;
+    return 0;
+}
+
+int VfsTmpfsStatfs(struct Mount *mnt, struct statfs *buf)
+{
+    struct TmpfsSb *sb = (struct TmpfsSb *)mnt->data;
+    UINT32 usedPages = 0;
+    UINT32 totalPages = 0;
+    UINT32 maxPages;
+    UINT32 intSave;
+
+    (void)memset_s(buf, sizeof(struct statfs), 0, sizeof(struct statfs));
+    OsVmPhysUsedInfoGet(&usedPages, &totalPages);
+
+    LOS_SpinLockSave(&sb->statLock, &intSave);
+    maxPages = (sb->maxPages != 0) ? sb->maxPages : totalPages;
+    usedPages = sb->usedPages;
+    LOS_SpinUnlockRestore(&sb->statLock, intSave);
+
+    buf->f_type = TMPFS_MAGIC;
+    buf->f_bsize = PAGE_SIZE;
+    buf->f_frsize = PAGE_SIZE;
+    buf->f_blocks = maxPages;
+    buf->f_bfree = (maxPages > usedPages) ? (maxPages - usedPages) : 0;
+    buf->f_bavail = buf->f_bfree;
+    buf->f_namelen = NAME_MAX;
+    buf->f_fsid.__val[0] = TMPFS_MAGIC;
+    buf->f_flags = mnt->mountFlags;
+    return 0;
+}
+
+int VfsTmpfsLookup(struct Vnode *parentVnode, const char *path, int len, struct Vnode **ppVnode)
+{
+    struct TmpfsNode *parent = (struct TmpfsNode *)parentVnode->data;
+    struct TmpfsNode *node = NULL;
+    int ret;
+
+    if (parent == NULL) {
+        return -ENOENT;
+    }
+
+    TmpfsSbLock(parent->sb);
+    node = TmpfsNodeFind(parent, path, len);
+    if (node == NULL) {
+        TmpfsSbUnlock(parent->sb);
+        return -ENOENT;
+    }
+    ret = TmpfsVnodeGet(parentVnode, node, ppVnode);
+    TmpfsSbUnlock(parent->sb);
+    return ret;
+}
+
+static int TmpfsCreate(struct Vnode *parentVnode, const char *name, mode_t mode, struct Vnode **ppVnode)
+{
+    struct TmpfsNode *parent = (struct TmpfsNode *)parentVnode->data;
+    struct TmpfsNode *node = NULL;
+    int len = strlen(name);
+    int ret;
+
+    if (parent == NULL) {
+        return -ENOENT;
+    }
+    if (len > NAME_MAX) {
+        return -ENAMETOOLONG;
+    }
+
+    TmpfsSbLock(parent->sb);
+    if (parent->nlink == 0) {
+        TmpfsSbUnlock(parent->sb);
+        return -ENOENT;
+    }
+    if (TmpfsNodeFind(parent, name, len) != NULL) {
+        TmpfsSbUnlock(parent->sb);
+        return -EEXIST;
+    }
+    node = TmpfsNodeAlloc(parent->sb, name, len, mode);
+    if (node == NULL) {
+        TmpfsSbUnlock(parent->sb);
+        return -ENOMEM;
+    }
+    ret = TmpfsVnodeGet(parentVnode, node, ppVnode);
+    if (ret != 0) {
+        TmpfsNodeFree(node);
+        TmpfsSbUnlock(parent->sb);
+        return ret;
+    }
+    if (S_ISDIR(mode)) {
+        node->nlink = 2; /* 2: "." and the entry in the parent */
+    }
+    TmpfsNodeLink(parent, node);
+    TmpfsSbUnlock(parent->sb);
+    return 0;
+}
+
+int VfsTmpfsCreate(struct Vnode *parentVnode, const char *path, int mode, struct Vnode **ppVnode)
+{
+    return TmpfsCreate(parentVnode, path, S_IFREG | ((mode_t)mode & 07777), ppVnode);
+}
+
+int VfsTmpfsMkdir(struct Vnode *parentVnode, const char *dirName, mode_t mode, struct Vnode **ppVnode)
+{
+    return TmpfsCreate(parentVnode, dirName, S_IFDIR | (mode & 07777), ppVnode);
+}
+
+int VfsTmpfsUnlink(struct Vnode *parentVnode, struct Vnode *targetVnode, char *path)
+{
+    struct TmpfsNode *node = NULL;
+    struct TmpfsSb *sb = NULL;
+
+    if ((parentVnode == NULL) || (targetVnode == NULL) || (targetVnode->data == NULL)) {
+        return -EINVAL;
+    }
+    (void)path;
+
+    node = (struct TmpfsNode *)targetVnode->data;
+    sb = node->sb;
+    TmpfsSbLock(sb);
+    if (S_ISDIR(node->mode)) {
+        TmpfsSbUnlock(sb);
+        return -EISDIR;
+    }
+    if (node->parent == NULL) {
+        TmpfsSbUnlock(sb);
+        return -ENOENT;
+    }
+    TmpfsNodeUnlink(node);
+    TmpfsSbUnlock(sb);
+    return 0;
+}
+
+int VfsTmpfsRmdir(struct Vnode *parentVnode, struct Vnode *targetVnode, char *path)
+{
+    struct TmpfsNode *node = NULL;
+    struct TmpfsSb *sb = NULL;
+
+    if ((parentVnode == NULL) || (targetVnode == NULL) || (targetVnode->data == NULL)) {
+        return -EINVAL;
+    }
+    (void)path;
+
+    node = (struct TmpfsNode *)targetVnode->data;
+    sb = node->sb;
+    TmpfsSbLock(sb);
+    if (!S_ISDIR(node->mode)) {
+        TmpfsSbUnlock(sb);
+        return -ENOTDIR;
+    }
+    if (node->parent == NULL) {
+        TmpfsSbUnlock(sb);
+        return (node == sb->root) ? -EBUSY : -ENOENT;
+    }
+    if (!LOS_ListEmpty(&node->children)) {
+        TmpfsSbUnlock(sb);
+        return -ENOTEMPTY;
+    }
+    TmpfsNodeUnlink(node);
+    TmpfsSbUnlock(sb);
+    return 0;
+}
+
+int VfsTmpfsRename(struct Vnode *fromVnode, struct Vnode *toParentVnode, const char *fromName, const char *toName)
+{
+    struct TmpfsNode *from = (struct TmpfsNode *)fromVnode->data;
+    struct TmpfsNode *toParent = (struct TmpfsNode *)toParentVnode->data;
+    struct TmpfsNode *to = NULL;
+    struct TmpfsNode *up = NULL;
+    struct TmpfsSb *sb = NULL;
+    char *newName = NULL;
+    int len = strlen(toName);
+    int ret = 0;
+
+    (void)fromName;
+    if ((from == NULL) || (toParent == NULL)) {
+        return -ENOENT;
+    }
+    if (len > NAME_MAX) {
+        return -ENAMETOOLONG;
+    }
+
+    sb = from->sb;
+    TmpfsSbLock(sb);
+    if (from->parent == NULL) {
+        ret = -ENOENT;
+        goto OUT;
+    }
+    /* a directory can not move below itself */
+    for (up = toParent; up != NULL; up = up->parent) {
+        if (up == from) {
+            ret = -EINVAL;
+            goto OUT;
+        }
+    }
+
+    to = TmpfsNodeFind(toParent, toName, len);
+    if (to == from) {
+        goto OUT;
+    }
+    if (to != NULL) {
+        if (S_ISDIR(from->mode) && !S_ISDIR(to->mode)) {
+            ret = -ENOTDIR;
+        } else if (!S_ISDIR(from->mode) && S_ISDIR(to->mode)) {
+            ret = -EISDIR;
+        } else if (S_ISDIR(to->mode) && !LOS_ListEmpty(&to->children)) {
+            ret = -ENOTEMPTY;
+        }
+        if (ret != 0) {
+            goto OUT;
+        }
+    }
+
+    newName = strdup(toName);
+    if (newName == NULL) {
+        ret = -ENOMEM;
+        goto OUT;
+    }
+    if (to != NULL) {
+        TmpfsNodeUnlink(to);
+    }
+    free(from->name);
+    from->name = newName;
+    LOS_ListDelete(&from->sibling);
+    if (S_ISDIR(from->mode)) {
+        from->parent->nlink--;
+    }
+    from->parent->mtime = TmpfsCurSec();
+    from->ctime = from->parent->mtime;
+    TmpfsNodeLink(toParent, from);
+    fromVnode->parent = toParentVnode;
+
+OUT:
+    TmpfsSbUnlock(sb);
+    return ret;
+}
+
+int VfsTmpfsOpendir(struct Vnode *pVnode, struct fs_dirent_s *dir)
+{
+    (void)pVnode;
+    dir->fd_position = 0;
+    return 0;
+}
+
+int VfsTmpfsReaddir(struct Vnode *pVnode, struct fs_dirent_s *dir)
+{
+    struct TmpfsNode *parent = (struct TmpfsNode *)pVnode->data;
+    struct TmpfsNode *node = NULL;
+    struct dirent *dirp = NULL;
+    off_t pos = 0;
+    int i = 0;
+
+    if (parent == NULL) {
+        return -ENOENT;
+    }
+    if (!S_ISDIR(parent->mode)) {
+        return -ENOTDIR;
+    }
+
+    TmpfsSbLock(parent->sb);
+    LOS_DL_LIST_FOR_EACH_ENTRY(node, &parent->children, struct TmpfsNode, sibling) {
+        if (i >= dir->read_cnt) {
+            break;
+        }
+        if (pos++ < dir->fd_position) {
+            continue;
+        }
+        dirp = &dir->fd_dir[i];
+        if (strncpy_s(dirp->d_name, sizeof(dirp->d_name), node->name, strlen(node->name)) != EOK) {
+            TmpfsSbUnlock(parent->sb);
+            return -ENAMETOOLONG;
+        }
+        dirp->d_type = S_ISDIR(node->mode) ? DT_DIR : DT_REG;
+        dir->fd_position++;
+        dirp->d_off = dir->fd_position;
+        dirp->d_reclen = (uint16_t)sizeof(struct dirent);
+        i++;
+    }
+    parent->atime = TmpfsCurSec();
+    TmpfsSbUnlock(parent->sb);
+
+    return i;
+}
+
+int VfsTmpfsRewinddir(struct Vnode *pVnode, struct fs_dirent_s *dir)
+{
+    (void)pVnode;
+    dir->fd_position = 0;
+    return 0;
+}
+
+int VfsTmpfsClosedir(struct Vnode *pVnode, struct fs_dirent_s *dir)
+{
+    (void)pVnode;
+    (void)dir;
+    return 0;
+}
+
+int VfsTmpfsStat(struct Vnode *pVnode, struct stat *buf)
+{
+    struct TmpfsNode *node = (struct TmpfsNode *)pVnode->data;
+
+    if (node == NULL) {
+        return -ENOENT;
+    }
+
+    (void)memset_s(buf, sizeof(struct stat), 0, sizeof(struct stat));
+    TmpfsNodeLock(node);
+    buf->st_mode = node->mode;
+    buf->st_ino = node->ino;
+    buf->st_nlink = node->nlink;
+    buf->st_uid = node->uid;
+    buf->st_gid = node->gid;
+    buf->st_size = (off_t)node->size;
+    buf->st_blksize = PAGE_SIZE;
+    /* holes take no pages */
+    buf->st_blocks = (blkcnt_t)node->mapping.nrpages * (PAGE_SIZE / TMPFS_SECTOR_SIZE);
+    buf->st_atime = node->atime;
+    buf->st_mtime = node->mtime;
+    buf->st_ctime = node->ctime;
+    TmpfsNodeUnlock(node);
+
+    return 0;
+}
+
+int VfsTmpfsChattr(struct Vnode *pVnode, struct IATTR *attr)
+{
+    struct TmpfsNode *node = (struct TmpfsNode *)pVnode->data;
+
+    if ((node == NULL) || (attr == NULL)) {
+        return -EINVAL;
+    }
+
+    TmpfsNodeLock(node);
+    if (attr->attr_chg_valid & CHG_MODE) {
+        node->mode = (node->mode & S_IFMT) | (attr->attr_chg_mode & ~S_IFMT);
+    }
+    if (attr->attr_chg_valid & CHG_UID) {
+        node->uid = attr->attr_chg_uid;
+    }
+    if (attr->attr_chg_valid & CHG_GID) {
+        node->gid = attr->attr_chg_gid;
+    }
+    if (attr->attr_chg_valid & CHG_ATIME) {
+        node->atime = attr->attr_chg_atime;
+    }
+    if (attr->attr_chg_valid & CHG_MTIME) {
+        node->mtime = attr->attr_chg_mtime;
+    }
+    node->ctime = TmpfsCurSec();
+    if (attr->attr_chg_valid & CHG_CTIME) {
+        node->ctime = attr->attr_chg_ctime;
+    }
+    pVnode->uid = node->uid;
+    pVnode->gid = node->gid;
+    pVnode->mode = node->mode;
+    TmpfsNodeUnlock(node);
+    return 0;
+}
+
+static int TmpfsTruncate(struct Vnode *pVnode, UINT64 len)
+{
+    struct TmpfsNode *node = (struct TmpfsNode *)pVnode->data;
+
+    if (node == NULL) {
+        return -ENOENT;
+    }
+    if (pVnode->type != VNODE_TYPE_REG) {
+        return -EISDIR;
+    }
+    if (len > TMPFS_MAX_SIZE) {
+        return -EFBIG;
+    }
+
+    TmpfsNodeLock(node);
+    if (len < node->size) {
+        TmpfsPagesDrop(node, TmpfsPages(len));
+        TmpfsZeroTail(node, len);
+    }
+    /* growing only moves the end, the new range is a hole */
+    node->size = len;
+    node->mtime = TmpfsCurSec();
+    node->ctime = node->mtime;
+    TmpfsNodeUnlock(node);
+    return 0;
+}
+
+int VfsTmpfsTruncate(struct Vnode *pVnode, off_t len)
+{
+    if (len < 0) {
+        return -EINVAL;
+    }
+    return TmpfsTruncate(pVnode, (UINT64)len);
+}
+
+int VfsTmpfsTruncate64(struct Vnode *pVnode, off64_t len)
+{
+    if (len < 0) {
+        return -EINVAL;
+    }
+    return TmpfsTruncate(pVnode, (UINT64)len);
+}
+
+int VfsTmpfsReclaim(struct Vnode *pVnode)
+{
+    struct TmpfsNode *node = (struct TmpfsNode *)pVnode->data;
+    struct TmpfsSb *sb = NULL;
+
+    if (node == NULL) {
+        return 0;
+    }
+
+    sb = node->sb;
+    TmpfsSbLock(sb);
+    node->vnode = NULL;
+    pVnode->data = NULL;
+    if (node->nlink == 0) {
+        LOS_ListDelete(&node->sibling);
+        TmpfsNodeFree(node);
+    }
+    TmpfsSbUnlock(sb);
+    return 0;
+}
+
+ssize_t VfsTmpfsRead(struct file *filep, char *buffer, size_t bufLen)
+{
+    struct TmpfsNode *node = TmpfsFileNode(filep);
+    LosVmPage *vmPage = NULL;
+    UINT64 pos = (UINT64)filep->f_pos;
+    size_t done = 0;
+    UINT32 off;
+    UINT32 n;
+    int ret = 0;
+
+    if (node == NULL) {
+        return -EBADF;
+    }
+
+    TmpfsNodeLock(node);
+    if (pos >= node->size) {
+        TmpfsNodeUnlock(node);
+        return 0;
+    }
+    if (bufLen > node->size - pos) {
+        bufLen = (size_t)(node->size - pos);
+    }
+    node->atime = TmpfsCurSec();
+    TmpfsNodeUnlock(node);
+
+    while (done < bufLen) {
+        off = (UINT32)((pos + done) & (PAGE_SIZE - 1));
+        n = ((bufLen - done) < (PAGE_SIZE - off)) ? (UINT32)(bufLen - done) : (PAGE_SIZE - off);
+        vmPage = TmpfsPagePin(node, (VM_OFFSET_T)((pos + done) >> PAGE_SHIFT));
+        if (vmPage == NULL) {
+            /* a hole */
+            ret = LOS_UserMemClear((unsigned char *)buffer + done, n);
+        } else {
+            ret = LOS_CopyFromKernel(buffer + done, n, (char *)OsVmPageToVaddr(vmPage) + off, n);
+            LOS_PhysPageFree(vmPage);
+        }
+        if (ret != 0) {
+            break;
+        }
+        done += n;
+    }
+
+    if ((done == 0) && (ret != 0)) {
+        return -EFAULT;
+    }
+    filep->f_pos = (loff_t)(pos + done);
+    return (ssize_t)done;
+}
+
+ssize_t VfsTmpfsWrite(struct file *filep, const char *buffer, size_t bufLen)
+{
+    struct TmpfsNode *node = TmpfsFileNode(filep);
+    LosFilePage *fpage = NULL;
+    LosVmPage *vmPage = NULL;
+    BOOL append = (filep != NULL) && (filep->f_oflags & O_APPEND);
+    UINT64 pos;
+    size_t done = 0;
+    UINT32 off;
+    UINT32 n;
+    int ret = 0;
+
+    if (node == NULL) {
+        return -EBADF;
+    }
+
+    /*
+     * An append takes its range at the end and moves the end past it in one go, so appenders
+     * running at the same time each get a range of their own. The range reads as a hole until
+     * the copy fills it.
+     */
+    TmpfsNodeLock(node);
+    pos = append ? node->size : (UINT64)filep->f_pos;
+    if (pos >= TMPFS_MAX_SIZE) {
+        TmpfsNodeUnlock(node);
+        return (bufLen == 0) ? 0 : -EFBIG;
+    }
+    if (bufLen > TMPFS_MAX_SIZE - pos) {
+        bufLen = (size_t)(TMPFS_MAX_SIZE - pos);
+    }
+    if (append) {
+        node->size = pos + bufLen;
+    }
+    TmpfsNodeUnlock(node);
+
+    while (done < bufLen) {
+        off = (UINT32)((pos + done) & (PAGE_SIZE - 1));
+        n = ((bufLen - done) < (PAGE_SIZE - off)) ? (UINT32)(bufLen - done) : (PAGE_SIZE - off);
+
+        TmpfsNodeLock(node);
+        ret = TmpfsPageGet(node, (VM_OFFSET_T)((pos + done) >> PAGE_SHIFT), &fpage);
+        if (ret == 0) {
+            vmPage = fpage->vmPage;
+            LOS_AtomicInc(&vmPage->refCounts);
+        }
+        TmpfsNodeUnlock(node);
+        if (ret != 0) {
+            break;
+        }
+
+        ret = LOS_CopyToKernel((char *)OsVmPageToVaddr(vmPage) + off, n, buffer + done, n);
+        LOS_PhysPageFree(vmPage);
+        if (ret != 0) {
+            ret = -EFAULT;
+            break;
+        }
+        done += n;
+
+        TmpfsNodeLock(node);
+        if (pos + done > node->size) {
+            node->size = pos + done;
+        }
+        node->mtime = TmpfsCurSec();
+        node->ctime = node->mtime;
+        TmpfsNodeUnlock(node);
+    }
+
+    /* give back the part of a short append nobody has appended behind */
+    if (append && (done < bufLen)) {
+        TmpfsNodeLock(node);
+        if (node->size == pos + bufLen) {
+            node->size = pos + done;
+            TmpfsPagesDrop(node, TmpfsPages(node->size));
+            TmpfsZeroTail(node, node->size);
+        }
+        TmpfsNodeUnlock(node);
+    }
+
+    if (done == 0) {
+        return ret;
+    }
+    filep->f_pos = (loff_t)(pos + done);
+    return (ssize_t)done;
+}
+
+off_t VfsTmpfsSeek(struct file *filep, off_t offset, int whence)
+{
+    struct TmpfsNode *node = TmpfsFileNode(filep);
+    loff_t filePos;
+
+    if (node == NULL) {
+        return -EBADF;
+    }
+    filePos = filep->f_pos;
+
+    switch (whence) {
+        case SEEK_SET:
+            filePos = offset;
+            break;
+
+        case SEEK_CUR:
+            filePos += offset;
+            break;
+
+        case SEEK_END:
+            TmpfsNodeLock(node);
+            filePos = (loff_t)node->size + offset;
+            TmpfsNodeUnlock(node);
+            break;
+
+        default:
+            return -EINVAL;
+    }
+
+    if ((filePos < 0) || ((UINT64)filePos > TMPFS_MAX_SIZE)) {
+        return -EINVAL;
+    }
+
+    filep->f_pos = filePos;
+    return filePos;
+}
+
+int VfsTmpfsFsync(struct file *filep)
+{
+    (void)filep;
+    return 0;
+}
+
+/*
+ * Map the file pages themselves. The generic fault path takes the reference for the new mapping and
+ * finds the page again through f_mapping on copy-on-write, so only shared mappings and reads record
+ * a map info here, exactly as OsVmmFileFault does.
+ */
+static INT32 TmpfsVmFault(LosVmMapRegion *region, LosVmPgFault *vmf)
+{
+    struct TmpfsNode *node = TmpfsFileNode(region->unTypeData.rf.file);
+    LosFilePage *fpage = NULL;
+    UINT32 intSave;
+
+    if (node == NULL) {
+        return LOS_NOK;
+    }
+
+    /* the caller holds node->mapping.mux_lock through f_mapping */
+    if (vmf->pgoff >= TmpfsPages(node->size)) {
+        return LOS_NOK;
+    }
+    if (TmpfsPageGet(node, vmf->pgoff, &fpage) != 0) {
+        return LOS_NOK;
+    }
+
+    LOS_SpinLockSave(&node->mapping.list_lock, &intSave);
+    OsSetPageLocked(fpage->vmPage);
+    if (!((vmf->flags & VM_MAP_PF_FLAG_WRITE) && !(region->regionFlags & VM_MAP_REGION_FLAG_SHARED))) {
+        OsAddMapInfo(fpage, &region->space->archMmu, (vaddr_t)vmf->vaddr);
+        fpage->flags = region->regionFlags;
+    }
+    vmf->pageKVaddr = (VADDR_T *)OsVmPageToVaddr(fpage->vmPage);
+    LOS_SpinUnlockRestore(&node->mapping.list_lock, intSave);
+    return LOS_OK;
+}
+
+static VOID TmpfsVmRemove(LosVmMapRegion *region, LosArchMmu *archMmu, VM_OFFSET_T pgoff)
+{
+    struct TmpfsNode *node = TmpfsFileNode(region->unTypeData.rf.file);
+    VADDR_T vaddr = region->range.base + ((UINT32)(pgoff - region->pgOff) << PAGE_SHIFT);
+    LosFilePage *fpage = NULL;
+    LosMapInfo *info = NULL;
+    LosVmPage *mapPage = NULL;
+    PADDR_T paddr = 0;
+    BOOL unmapped = FALSE;
+    UINT32 intSave;
+    UINT32 lruSave;
+
+    if (LOS_ArchMmuQuery(archMmu, vaddr, &paddr, NULL) != LOS_OK) {
+        return;
+    }
+    mapPage = LOS_VmPageGet(paddr);
+
+    if (node != NULL) {
+        LOS_SpinLockSave(&node->mapping.list_lock, &intSave);
+        fpage = TmpfsIndexFind(node, pgoff);
+        if ((fpage != NULL) && (fpage->vmPage == mapPage)) {
+            LOS_SpinLockSave(&fpage->physSeg->lruLock, &lruSave);
+            /* the page is the data, there is nothing to write back */
+            OsCleanPageDirty(fpage->vmPage);
+            info = OsGetMapInfo(fpage, archMmu, vaddr);
+            if (info != NULL) {
+                OsUnmapPageLocked(fpage, info);
+                unmapped = TRUE;
+            }
+            LOS_SpinUnlockRestore(&fpage->physSeg->lruLock, lruSave);
+        }
+        LOS_SpinUnlockRestore(&node->mapping.list_lock, intSave);
+    }
+
+    /* a private copy, or a page that was truncated away and no longer tracks its mappings */
+    if (!unmapped) {
+        (VOID)LOS_ArchMmuUnmap(archMmu, vaddr, 1);
+        LOS_PhysPageFree(mapPage);
+    }
+}
+
+static const LosVmFileOps g_tmpfsVmOps = {
+    .open = NULL,
+    .close = NULL,
+    .fault = TmpfsVmFault,
+    .remove = TmpfsVmRemove,
+};
+
+int VfsTmpfsMmap(struct file *filep, LosVmMapRegion *region)
+{
+    struct TmpfsNode *node = TmpfsFileNode(filep);
+
+    if ((node == NULL) || !S_ISREG(node->mode)) {
+        return -EBADF;
+    }
+
+    LOS_SetRegionTypeFile(region);
+    region->unTypeData.rf.vmFOps = &g_tmpfsVmOps;
+    region->unTypeData.rf.file = filep;
+    region->unTypeData.rf.fileMagic = filep->f_magicnum;
+
+    /*
+     * The fault path serialises on and looks pages up through f_mapping, so point it at the file
+     * data. The path keyed mapping from open never caches anything for tmpfs, drop it right away.
+     */
+    TmpfsNodeLock(node);
+    if (filep->f_mapping != &node->mapping) {
+        dec_mapping_nolock(filep->f_mapping);
+        filep->f_mapping = &node->mapping;
+    }
+    TmpfsNodeUnlock(node);
+    return LOS_OK;
+}
+
+int VfsTmpfsClose(struct file *filep)
+{
+    struct TmpfsNode *node = TmpfsFileNode(filep);
+
+    if (node == NULL) {
+        return 0;
+    }
+
+    TmpfsNodeLock(node);
+    /* mapped pages keep their own references, the node mapping is not ours to drop */
+    if (filep->f_mapping == &node->mapping) {
+        filep->f_mapping = NULL;
+    }
+    /* last close of an unlinked file, give the pages back now rather than at vnode reclaim */
+    if ((node->nlink == 0) && (filep->f_vnode->useCount <= 1)) {
+        TmpfsPagesDrop(node, 0);
+    }
+    TmpfsNodeUnlock(node);
+    return 0;
+}
+
+static struct MountOps g_tmpfsMops = {
+    .Mount = VfsTmpfsMount,
+    .Unmount = VfsTmpfsUnmount,
+    .Statfs = VfsTmpfsStatfs,
+};
+
+static struct VnodeOps g_tmpfsVops = {
+    .Lookup = VfsTmpfsLookup,
+    .Create = VfsTmpfsCreate,
+    .Rename = VfsTmpfsRename,
+    .Mkdir = VfsTmpfsMkdir,
+    .Getattr = VfsTmpfsStat,
+    .Opendir = VfsTmpfsOpendir,
+    .Readdir = VfsTmpfsReaddir,
+    .Closedir = VfsTmpfsClosedir,
+    .Rewinddir = VfsTmpfsRewinddir,
+    .Unlink = VfsTmpfsUnlink,
+    .Rmdir = VfsTmpfsRmdir,
+    .Chattr = VfsTmpfsChattr,
+    .Reclaim = VfsTmpfsReclaim,
+    .Truncate = VfsTmpfsTruncate,
+    .Truncate64 = VfsTmpfsTruncate64,
+};
+
+static struct file_operations_vfs g_tmpfsFops = {
+    .read = VfsTmpfsRead,
+    .write = VfsTmpfsWrite,
+    .mmap = VfsTmpfsMmap,
+    .seek = VfsTmpfsSeek,
+    .close = VfsTmpfsClose,
+    .fsync = VfsTmpfsFsync,
+};
+
+FSMAP_ENTRY(tmpfs_fsmap, "tmpfs", g_tmpfsMops, FALSE, FALSE);
+
+#endif
@@ -36,6 +36,12 @@
 #include "disk_pri.h"
 #include "fs_other.h"
 #include "user_copy.h"
+#ifdef LOSCFG_KERNEL_VM
+#include "los_vm_dump.h"
+#include "los_vm_phys.h"
+#include "los_vm_filemap.h"
+#include "fs/fs_operation.h"
+#endif
 
 #undef HALARC_ALIGNMENT
 #define DMA_ALLGN          64
@@ -43,6 +49,16 @@
 #define BCACHE_MAGIC_NUM   20132016
 #define BCACHE_STATCK_SIZE 0x3000
 #define ASYNC_EVENT_BIT    0x01
+#define SYNC_EVENT_BIT     0x01
+#define SYNC_EXIT_BIT      0x02
+#define SYNC_DONE_BIT      0x04
+#define BCACHE_WB_BATCH    4   /* blocks written back per lock hold */
+
+#define BCACHE_IN_SHARE        4   /* A1in keeps a quarter of the read buffers */
+#define BCACHE_GHOST_RATIO     2   /* A1out remembers twice as many numbers as there are read buffers */
+#define BCACHE_GROW_FREE_RATIO 4   /* grow only while more than a quarter of the pages are free */
+#define BCACHE_GHOST_EMPTY     ((UINT64)-1)
+#define BCACHE_BLOCK_PAGES(bc) (((bc)->blockSize + PAGE_SIZE - 1) >> PAGE_SHIFT)
 
 #ifdef DEBUG
 #define D(args) printf args
@@ -81,6 +97,7 @@ VOID BcacheAnalyse(UINT32 level)
 
 UINT32 g_syncThreadPrio = CONFIG_FS_FAT_SYNC_THREAD_PRIO;
 UINT32 g_dirtyRatio = CONFIG_FS_FAT_DIRTY_RATIO;
+UINT32 g_dirtyHardRatio = CONFIG_FS_FAT_DIRTY_HARD_RATIO;
 UINT32 g_syncInterval = CONFIG_FS_FAT_SYNC_INTERVAL;
 
 VOID LOS_SetDirtyRatioThreshold(UINT32 dirtyRatio)
@@ -90,6 +107,13 @@ VOID LOS_SetDirtyRatioThreshold(UINT32 dirtyRatio)
     }
 }
 
+VOID LOS_SetDirtyRatioLimit(UINT32 dirtyRatio)
+{
+    if ((dirtyRatio != g_dirtyHardRatio) && (dirtyRatio <= 100)) { /* The ratio cannot exceed 100% */
+        g_dirtyHardRatio = dirtyRatio;
+    }
+}
+
 VOID LOS_SetSyncThreadInterval(UINT32 interval)
 {
     g_syncInterval = interval;
@@ -150,6 +174,25 @@ static OsBcacheBlock *RbFindBlock(const OsBcache *bc, UINT64 num)
     return NULL;
 }
 
+/* the cached block with the lowest number from num on */
+static OsBcacheBlock *RbFindBlockFrom(const OsBcache *bc, UINT64 num)
+{
+    OsBcacheBlock *block = NULL;
+    OsBcacheBlock *found = NULL;
+    struct rb_node *node = bc->rbRoot.rb_node;
+
+    while (node != NULL) {
+        block = rb_entry(node, OsBcacheBlock, rbNode);
+        if (block->num < num) {
+            node = node->rb_right;
+        } else {
+            found = block;
+            node = node->rb_left;
+        }
+    }
+    return found;
+}
+
 static VOID RbAddBlock(OsBcache *bc, OsBcacheBlock *block)
 {
     struct rb_node *node = bc->rbRoot.rb_node;
@@ -188,6 +231,131 @@ static inline VOID FreeBlock(OsBcache *bc, OsBcacheBlock *block)
     LOS_ListAdd(&bc->freeListHead, &block->listNode);
 }
 
+/*
+ * The read buffers are kept by 2Q: a block enters A1in, a FIFO, and leaves it unchanged by
+ * further hits, which are taken as correlated with the first one. Its number is then remembered
+ * in A1out, and only a miss on a remembered number puts the block on Am, an LRU. A scan thus
+ * cycles through A1in and never evicts the metadata blocks that made it to Am.
+ */
+static inline VOID QueueAddBlock(OsBcache *bc, OsBcacheBlock *block, BOOL ghostHit)
+{
+    if (!block->readBuff) {
+        return;
+    }
+    if (ghostHit) {
+        block->queue = BCACHE_QUEUE_MAIN;
+        LOS_ListAdd(&bc->mainHead, &block->qNode);
+        bc->nMain++;
+    } else {
+        block->queue = BCACHE_QUEUE_IN;
+        LOS_ListAdd(&bc->inHead, &block->qNode);
+        bc->nIn++;
+    }
+}
+
+static inline VOID QueueDelBlock(OsBcache *bc, OsBcacheBlock *block)
+{
+    if (block->queue == BCACHE_QUEUE_NONE) {
+        return;
+    }
+    LOS_ListDelete(&block->qNode);
+    if (block->queue == BCACHE_QUEUE_IN) {
+        bc->nIn--;
+    } else {
+        bc->nMain--;
+    }
+    block->queue = BCACHE_QUEUE_NONE;
+}
+
+static inline VOID QueueHitBlock(OsBcache *bc, OsBcacheBlock *block)
+{
+    if (block->queue == BCACHE_QUEUE_MAIN) {
+        LOS_ListDelete(&block->qNode);
+        LOS_ListAdd(&bc->mainHead, &block->qNode);
+    }
+}
+
+/* A1in gives up its oldest block while over its share, then Am its least recently used one */
+static OsBcacheBlock *QueueVictim(const OsBcache *bc)
+{
+    const LOS_DL_LIST *head = &bc->mainHead;
+
+    if ((bc->nIn > MAX(bc->readBlocks / BCACHE_IN_SHARE, 1)) || LOS_ListEmpty(&bc->mainHead)) {
+        head = &bc->inHead;
+    }
+    if (LOS_ListEmpty(head)) {
+        return NULL;
+    }
+    return LOS_DL_LIST_ENTRY(head->pstPrev, OsBcacheBlock, qNode);
+}
+
+static BOOL GhostTake(OsBcache *bc, UINT64 num)
+{
+    UINT32 i;
+
+    for (i = 0; i < bc->ghostSize; i++) {
+        if (bc->ghost[i] == num) {
+            bc->ghost[i] = BCACHE_GHOST_EMPTY;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static VOID GhostAdd(OsBcache *bc, UINT64 num)
+{
+    if (bc->ghostSize == 0) {
+        return;
+    }
+    bc->ghost[bc->ghostNext] = num;
+    bc->ghostNext = (bc->ghostNext + 1) % bc->ghostSize;
+}
+
+#ifdef LOSCFG_KERNEL_VM
+/* Read buffers beyond the base pool are whole pages, so that giving them back frees pages */
+static OsBcacheBlock *DynamicBlockAlloc(OsBcache *bc)
+{
+    OsBcacheBlock *block = NULL;
+    UINT32 used = 0;
+    UINT32 total = 0;
+
+    if (bc->nDynamic >= bc->maxDynamic) {
+        return NULL;
+    }
+    OsVmPhysUsedInfoGet(&used, &total);
+    if ((total - used) <= (total / BCACHE_GROW_FREE_RATIO)) {
+        return NULL;
+    }
+
+    block = (OsBcacheBlock *)zalloc(sizeof(OsBcacheBlock));
+    if (block == NULL) {
+        return NULL;
+    }
+    block->data = (UINT8 *)LOS_PhysPagesAllocContiguous(BCACHE_BLOCK_PAGES(bc));
+    if (block->data == NULL) {
+        free(block);
+        return NULL;
+    }
+    block->readBuff = TRUE;
+    block->dynamic = TRUE;
+    block->used = TRUE;
+    bc->nDynamic++;
+    bc->readBlocks++;
+    bc->stat.grows++;
+    return block;
+}
+
+/* The block must be off all the lists */
+static VOID DynamicBlockFree(OsBcache *bc, OsBcacheBlock *block)
+{
+    LOS_PhysPagesFreeContiguous(block->data, BCACHE_BLOCK_PAGES(bc));
+    free(block);
+    bc->nDynamic--;
+    bc->readBlocks--;
+    bc->stat.shrinks++;
+}
+#endif
+
 static UINT32 GetValLog2(UINT32 val)
 {
     UINT32 i, log2;
@@ -254,6 +422,7 @@ static INT32 BlockRead(OsBcache *bc, OsBcacheBlock *block, UINT8 *buf)
             if (block->listNode.pstNext != NULL) {
                 LOS_ListDelete(&block->listNode); /* list del block */
                 RbDelBlock(bc, block);
+                QueueDelBlock(bc, block);
             }
             FreeBlock(bc, block);
         }
@@ -371,6 +540,7 @@ static INT32 BcacheSyncBlock(OsBcache *bc, OsBcacheBlock *block)
         if (ret == ENOERR) {
             block->modified = FALSE;
             bc->modifiedBlock--;
+            bc->stat.writebacks++;
         } else {
             PRINT_ERR("BcacheSyncBlock fail, ret = %d, len = %u, block->num = %llu, start = %u\n",
                       ret, len, block->num, start);
@@ -406,6 +576,7 @@ static void DelBlock(OsBcache *bc, OsBcacheBlock *block)
 {
     LOS_ListDelete(&block->listNode); /* lru list del */
     LOS_ListDelete(&block->numNode);  /* num list del */
+    QueueDelBlock(bc, block);         /* 2Q queue del */
     bc->sumNum -= block->num;
     bc->nBlock--;
     RbDelBlock(bc, block);            /* rb  tree del */
@@ -450,7 +621,23 @@ static OsBcacheBlock *GetBaseBlock(OsBcache *bc)
     return NULL;
 }
 
-/* try get free block first, if failed free a useless block */
+static OsBcacheBlock *RecycleBlock(OsBcache *bc, OsBcacheBlock *block)
+{
+    if (block->modified == TRUE) {
+        BcacheSyncBlock(bc, block);
+    }
+    if (block->queue == BCACHE_QUEUE_IN) {
+        GhostAdd(bc, block->num);
+    }
+
+    DelBlock(bc, block);
+    block->used = TRUE;
+    LOS_ListDelete(&block->listNode);
+    bc->stat.evictions++;
+    return block;
+}
+
+/* try get free block first, then a new read block while memory allows, if failed free a useless block */
 static OsBcacheBlock *GetSlowBlock(OsBcache *bc, BOOL read)
 {
     LOS_DL_LIST *node = NULL;
@@ -464,20 +651,26 @@ static OsBcacheBlock *GetSlowBlock(OsBcache *bc, BOOL read)
         }
     }
 
+    if (read) {
+#ifdef LOSCFG_KERNEL_VM
+        block = DynamicBlockAlloc(bc);
+        if (block != NULL) {
+            return block; /* get new one */
+        }
+#endif
+        block = QueueVictim(bc);
+        if (block != NULL) {
+            return RecycleBlock(bc, block); /* get 2Q victim */
+        }
+    }
+
     node = bc->listHead.pstPrev;
     while (node != &bc->listHead) {
         block = LOS_DL_LIST_ENTRY(node, OsBcacheBlock, listNode);
         node = block->listNode.pstPrev;
 
         if (block->readBuff == read) {
-            if (block->modified == TRUE) {
-                BcacheSyncBlock(bc, block);
-            }
-
-            DelBlock(bc, block);
-            block->used = TRUE;
-            LOS_ListDelete(&block->listNode);
-            return block; /* get used one */
+            return RecycleBlock(bc, block); /* get used one */
         }
     }
 
@@ -500,6 +693,7 @@ static VOID WriteMergedBlocks(OsBcache *bc, OsBcacheBlock *begin, int blocks)
     }
 
     bc->modifiedBlock -= blocks;
+    bc->stat.writebacks += blocks;
     cur = begin;
     while (blocks > 0) {
         next = LOS_DL_LIST_ENTRY(cur->numNode.pstNext, OsBcacheBlock, numNode);
@@ -580,6 +774,7 @@ static OsBcacheBlock *AllocNewBlock(OsBcache *bc, BOOL read, UINT64 num)
     if (prefer->used && !prefer->modified) {
         prefer->used = FALSE;
         DelBlock(bc, prefer);
+        bc->stat.evictions++;
     }
 
     if (prefer->used) {
@@ -589,6 +784,7 @@ static OsBcacheBlock *AllocNewBlock(OsBcache *bc, BOOL read, UINT64 num)
     if (prefer->used) {
         BcacheSyncBlock(bc, prefer);
         DelBlock(bc, prefer);
+        bc->stat.evictions++;
     }
 
     prefer->used = TRUE;
@@ -597,30 +793,132 @@ static OsBcacheBlock *AllocNewBlock(OsBcache *bc, BOOL read, UINT64 num)
     return prefer;
 }
 
-static INT32 BcacheSync(OsBcache *bc)
+static inline UINT32 BcacheDirtyRatio(const OsBcache *bc)
 {
+    return (bc->modifiedBlock * PERCENTAGE) / GetFatBlockNums();
+}
+
+/*
+ * The first modified block numbered from num on. The search starts in the tree, and the walk along
+ * the number list from there only passes the clean blocks up to the next dirty one, so a sweep of
+ * the whole cache costs one pass over the list.
+ */
+static OsBcacheBlock *BcacheNextDirty(const OsBcache *bc, UINT64 num)
+{
+    OsBcacheBlock *block = RbFindBlockFrom(bc, num);
     LOS_DL_LIST *node = NULL;
+
+    if (block == NULL) {
+        return NULL;
+    }
+    for (node = &block->numNode; node != &bc->numHead; node = node->pstNext) {
+        block = LOS_DL_LIST_ENTRY(node, OsBcacheBlock, numNode);
+        if (block->modified) {
+            return block;
+        }
+    }
+    return NULL;
+}
+
+/* a wholly dirty write buffer followed in the buffer array by the next block, also wholly dirty */
+static BOOL BcacheRunStarts(OsBcache *bc, OsBcacheBlock *block)
+{
+    OsBcacheBlock *next = block + 1;
+
+    return !block->readBuff && (next <= bc->wEnd) && next->used && (next->num == block->num + 1) &&
+           BlockAllDirty(bc, block) && BlockAllDirty(bc, next);
+}
+
+/*
+ * Write back about nBlock modified blocks in ascending block order, each call resuming where the
+ * last one stopped so that successive batches sweep the disk. A run of wholly dirty write buffers
+ * holding consecutive blocks goes out as one request.
+ */
+static INT32 BcacheWriteback(OsBcache *bc, UINT32 nBlock)
+{
     OsBcacheBlock *block = NULL;
+    UINT32 done = 0;
+    UINT32 dirty;
+    BOOL wrapped = FALSE;
     INT32 ret = ENOERR;
 
+    while ((done < nBlock) && (bc->modifiedBlock > 0)) {
+        block = BcacheNextDirty(bc, bc->wbCursor);
+        if (block == NULL) {
+            if (wrapped) {
+                break;
+            }
+            wrapped = TRUE;
+            bc->wbCursor = 0;
+            continue;
+        }
+
+        dirty = bc->modifiedBlock;
+        bc->wbCursor = block->num + 1;
+        if (BcacheRunStarts(bc, block)) {
+            MergeSyncBlocks(bc, block);
+            bc->wbCursor = block->num + (dirty - bc->modifiedBlock);
+        }
+        if (block->modified) {
+            ret = BcacheSyncBlock(bc, block);
+            if (ret != ENOERR) {
+                break;
+            }
+        }
+        done += dirty - bc->modifiedBlock;
+    }
+
+    return ret;
+}
+
+static INT32 BcacheSync(OsBcache *bc)
+{
+    INT32 ret;
+
     D(("bcache cache sync\n"));
 
     (VOID)pthread_mutex_lock(&bc->bcacheMutex);
-    node = bc->listHead.pstPrev;
-    while (&bc->listHead != node) {
-        block = LOS_DL_LIST_ENTRY(node, OsBcacheBlock, listNode);
-        ret = BcacheSyncBlock(bc, block);
-        if (ret != ENOERR) {
-            PRINT_ERR("BcacheSync error, ret = %d\n", ret);
-            break;
-        }
-        node = node->pstPrev;
+    bc->wbCursor = 0;
+    ret = BcacheWriteback(bc, bc->modifiedBlock);
+    if (ret != ENOERR) {
+        PRINT_ERR("BcacheSync error, ret = %d\n", ret);
     }
     (VOID)pthread_mutex_unlock(&bc->bcacheMutex);
 
     return ret;
 }
 
+#ifdef LOSCFG_FS_FAT_CACHE_SYNC_THREAD
+/*
+ * Called by a writer once its blocks are dirtied. Over the dirty ratio threshold the sync task is
+ * woken, over the hard limit the writer itself writes back blocks until the cache is under it
+ * again, so a burst of writes is paced by the disk instead of piling up for one long sync.
+ */
+static VOID BcacheBalanceDirty(OsBcache *bc)
+{
+    UINT32 dirty;
+
+    if (BcacheDirtyRatio(bc) <= g_dirtyRatio) {
+        return;
+    }
+    if (bc->syncTaskRun) {
+        (VOID)LOS_EventWrite(&bc->syncEvent, SYNC_EVENT_BIT);
+    }
+
+    (VOID)pthread_mutex_lock(&bc->bcacheMutex);
+    if (BcacheDirtyRatio(bc) > g_dirtyHardRatio) {
+        bc->stat.throttles++;
+    }
+    while (BcacheDirtyRatio(bc) > g_dirtyHardRatio) {
+        dirty = bc->modifiedBlock;
+        if ((BcacheWriteback(bc, BCACHE_WB_BATCH) != ENOERR) || (bc->modifiedBlock == dirty)) {
+            break;
+        }
+    }
+    (VOID)pthread_mutex_unlock(&bc->bcacheMutex);
+}
+#endif
+
 static VOID BlockInit(OsBcache *bc, OsBcacheBlock *block, UINT64 num)
 {
     (VOID)memset_s(block->flag, sizeof(block->flag), 0, sizeof(block->flag));
@@ -638,6 +936,7 @@ static INT32 BcacheGetBlock(OsBcache *bc, UINT64 num, BOOL readData, OsBcacheBlo
     INT32 ret;
     OsBcacheBlock *block = NULL;
     OsBcacheBlock *first = NULL;
+    BOOL ghostHit = FALSE;
 
     /*
      * First check if the most recently used block is the requested block,
@@ -653,12 +952,16 @@ static INT32 BcacheGetBlock(OsBcache *bc, UINT64 num, BOOL readData, OsBcacheBlo
 #ifdef BCACHE_ANALYSE
         UINT32 index = ((UINT32)(block->data - g_memStart)) / g_dataSize;
         PRINTK(", [HIT], %llu, %u\n", num, index);
-        g_hitTimes[index]++;
+        if (!block->dynamic) { /* only the base pool is analysed */
+            g_hitTimes[index]++;
+        }
 #endif
 
         if (first != block) {
             ListMoveBlockToHead(bc, block);
         }
+        QueueHitBlock(bc, block);
+        bc->stat.hits++;
         *dblock = block;
 
         if ((bc->prereadFun != NULL) && (readData == TRUE) && (block->pgHit == 1)) {
@@ -670,6 +973,11 @@ static INT32 BcacheGetBlock(OsBcache *bc, UINT64 num, BOOL readData, OsBcacheBlo
     }
 
     D(("bcache block = %llu NOT found in cache\n", num));
+    bc->stat.misses++;
+    if (GhostTake(bc, num)) {
+        ghostHit = TRUE;
+        bc->stat.ghostHits++;
+    }
 
     block = AllocNewBlock(bc, readData, num);
     if (block == NULL) {
@@ -682,7 +990,9 @@ static INT32 BcacheGetBlock(OsBcache *bc, UINT64 num, BOOL readData, OsBcacheBlo
 #ifdef BCACHE_ANALYSE
     UINT32 index = ((UINT32)(block->data - g_memStart)) / g_dataSize;
     PRINTK(", [MISS], %llu, %u\n", num, index);
-    g_switchTimes[index]++;
+    if (!block->dynamic) { /* only the base pool is analysed */
+        g_switchTimes[index]++;
+    }
 #endif
     BlockInit(bc, block, num);
 
@@ -699,6 +1009,7 @@ static INT32 BcacheGetBlock(OsBcache *bc, UINT64 num, BOOL readData, OsBcacheBlo
     }
 
     AddBlock(bc, block);
+    QueueAddBlock(bc, block, ghostHit);
 
     *dblock = block;
     return ENOERR;
@@ -726,8 +1037,13 @@ static INT32 BcacheInitCache(OsBcache *bc,
 
     LOS_ListInit(&bc->listHead);
     LOS_ListInit(&bc->numHead);
+    LOS_ListInit(&bc->inHead);
+    LOS_ListInit(&bc->mainHead);
     bc->sumNum = 0;
     bc->nBlock = 0;
+    bc->nIn = 0;
+    bc->nMain = 0;
+    bc->nDynamic = 0;
 
     if (!GetValLog2(blockSize)) {
         PRINT_ERR("GetValLog2(%u) return 0.\n", blockSize);
@@ -771,6 +1087,7 @@ static INT32 BcacheInitCache(OsBcache *bc,
     }
 
     bc->wEnd = block;
+    bc->readBlocks = MIN(blockNum, CONFIG_FS_FAT_READ_NUMS);
 
     return ENOERR;
 }
@@ -798,6 +1115,54 @@ static INT32 DrvBwrite(struct Vnode *priv, const UINT8 *buf, UINT32 len, UINT64
     return ENOERR;
 }
 
+#ifdef LOSCFG_KERNEL_VM
+/*
+ * A page-cache page being filled (locked) or written back (dirty) already holds the file data,
+ * so the blocks it covers are not cached a second time here.
+ */
+static BOOL BcacheIsFilePage(const UINT8 *buf, UINT32 len, UINT32 flag)
+{
+    LosVmPage *page = NULL;
+
+    if (!LOS_IsKernelAddressRange((VADDR_T)(UINTPTR)buf, len) ||
+        ((((UINTPTR)buf & (PAGE_SIZE - 1)) + len) > PAGE_SIZE)) {
+        return FALSE;
+    }
+    page = OsVmVaddrToPage((VOID *)buf);
+    return (page != NULL) && BIT_GET(page->flags, flag);
+}
+
+/* Move whole sectors between the disk and a page-cache page, as long as none of their blocks is cached */
+static INT32 BcacheDirectIo(OsBcache *bc, UINT8 *buf, UINT32 len, UINT64 sector, BOOL write)
+{
+    UINT64 num = (sector * bc->sectorSize) >> bc->blockSizeLog2;
+    UINT64 last = ((sector * bc->sectorSize) + len - 1) >> bc->blockSizeLog2;
+    INT32 ret;
+
+    if ((len == 0) || ((len % bc->sectorSize) != 0)) {
+        return -EAGAIN;
+    }
+
+    (VOID)pthread_mutex_lock(&bc->bcacheMutex);
+    for (; num <= last; num++) {
+        if (RbFindBlock(bc, num) != NULL) {
+            (VOID)pthread_mutex_unlock(&bc->bcacheMutex);
+            return -EAGAIN;
+        }
+    }
+    if (write) {
+        ret = bc->bwriteFun(bc->priv, buf, len / bc->sectorSize, sector);
+    } else {
+        ret = bc->breadFun(bc->priv, buf, len / bc->sectorSize, sector);
+    }
+    if (ret == ENOERR) {
+        bc->stat.bypasses++;
+    }
+    (VOID)pthread_mutex_unlock(&bc->bcacheMutex);
+    return ret;
+}
+#endif
+
 INT32 BlockCacheDrvCreate(VOID *handle,
                           UINT8 *memStart,
                           UINT32 memSize,
@@ -840,6 +1205,15 @@ INT32 BlockCacheRead(OsBcache *bc, UINT8 *buf, UINT32 *len, UINT64 sector, BOOL
     }
 
     size = *len;
+#ifdef LOSCFG_KERNEL_VM
+    if (BcacheIsFilePage(buf, size, FILE_PAGE_LOCKED)) {
+        ret = BcacheDirectIo(bc, buf, size, sector, FALSE);
+        if (ret != -EAGAIN) {
+            return ret;
+        }
+        ret = ENOERR;
+    }
+#endif
     pos = sector * bc->sectorSize;
     num = pos >> bc->blockSizeLog2;
     pos = pos & (bc->blockSize - 1);
@@ -903,6 +1277,15 @@ INT32 BlockCacheWrite(OsBcache *bc, const UINT8 *buf, UINT32 *len, UINT64 sector
     PRINTK("bcache write:\n");
 #endif
 
+#ifdef LOSCFG_KERNEL_VM
+    if (BcacheIsFilePage(buf, size, FILE_PAGE_DIRTY)) {
+        ret = BcacheDirectIo(bc, (UINT8 *)buf, size, sector, TRUE);
+        if (ret != -EAGAIN) {
+            return ret;
+        }
+        ret = ENOERR;
+    }
+#endif
     pos = sector * bc->sectorSize;
     num = pos >> bc->blockSizeLog2;
     pos = pos & (bc->blockSize - 1);
@@ -945,6 +1328,9 @@ INT32 BlockCacheWrite(OsBcache *bc, const UINT8 *buf, UINT32 *len, UINT64 sector
         pos = 0;
         num++;
     }
+#ifdef LOSCFG_FS_FAT_CACHE_SYNC_THREAD
+    BcacheBalanceDirty(bc);
+#endif
     *len -= size;
     return ret;
 }
@@ -1001,7 +1387,7 @@ INT32 BcacheGetDirtyRatio(INT32 id)
         return VFS_ERROR;
     }
     if ((disk->disk_status == STAT_INUSED) && (disk->bcache != NULL)) {
-        ret = (INT32)((disk->bcache->modifiedBlock * PERCENTAGE) / GetFatBlockNums());
+        ret = (INT32)BcacheDirtyRatio(disk->bcache);
     } else {
         ret = VFS_ERROR;
     }
@@ -1021,18 +1407,147 @@ INT32 LOS_GetDirtyRatioByName(const CHAR *name)
     return BcacheGetDirtyRatio(diskID);
 }
 
+INT32 BlockCacheStatGet(OsBcache *bc, OsBcacheStat *stat)
+{
+    if ((bc == NULL) || (stat == NULL)) {
+        return -EINVAL;
+    }
+
+    (VOID)pthread_mutex_lock(&bc->bcacheMutex);
+    *stat = bc->stat;
+    stat->nBlock = bc->nBlock;
+    stat->readBlocks = bc->readBlocks;
+    stat->nDynamic = bc->nDynamic;
+    stat->nIn = bc->nIn;
+    stat->nMain = bc->nMain;
+    stat->nDirty = bc->modifiedBlock;
+    (VOID)pthread_mutex_unlock(&bc->bcacheMutex);
+    return ENOERR;
+}
+
+#ifdef LOSCFG_KERNEL_VM
+/* Clean dynamic blocks go, the unused ones first, then from the cold ends of A1in and Am */
+static UINT32 BcacheShrink(OsBcache *bc, UINT32 nPage)
+{
+    OsBcacheBlock *block = NULL;
+    OsBcacheBlock *next = NULL;
+    LOS_DL_LIST *head = NULL;
+    LOS_DL_LIST *node = NULL;
+    UINT32 pages = BCACHE_BLOCK_PAGES(bc);
+    UINT32 freed = 0;
+    UINT32 q;
+
+    LOS_DL_LIST_FOR_EACH_ENTRY_SAFE(block, next, &bc->freeListHead, OsBcacheBlock, listNode) {
+        if (freed >= nPage) {
+            return freed;
+        }
+        if (block->dynamic) {
+            LOS_ListDelete(&block->listNode);
+            DynamicBlockFree(bc, block);
+            freed += pages;
+        }
+    }
+
+    for (q = 0; (q < 2) && (freed < nPage); q++) { /* A1in, then Am */
+        head = (q == 0) ? &bc->inHead : &bc->mainHead;
+        node = head->pstPrev;
+        while ((node != head) && (freed < nPage)) {
+            block = LOS_DL_LIST_ENTRY(node, OsBcacheBlock, qNode);
+            node = node->pstPrev;
+            if (!block->dynamic || block->modified) {
+                continue;
+            }
+            if (block->queue == BCACHE_QUEUE_IN) {
+                GhostAdd(bc, block->num);
+            }
+            DelBlock(bc, block);
+            LOS_ListDelete(&block->listNode);
+            DynamicBlockFree(bc, block);
+            freed += pages;
+        }
+    }
+    return freed;
+}
+#endif
+
+/*
+ * Called from the page reclaim path, which may run with any lock held: the caches are only
+ * trylocked, and one the caller itself is inside is left alone.
+ */
+UINT32 BcacheReclaim(UINT32 nPage)
+{
+#ifdef LOSCFG_KERNEL_VM
+    VOID *self = (VOID *)OsCurrTaskGet();
+    los_disk *disk = NULL;
+    OsBcache *bc = NULL;
+    UINT32 freed = 0;
+    INT32 i;
+
+    for (i = 0; (i < SYS_MAX_DISK) && (freed < nPage); i++) {
+        disk = get_disk(i);
+        if ((disk == NULL) || (disk->disk_mutex.owner == self) ||
+            (pthread_mutex_trylock(&disk->disk_mutex) != ENOERR)) {
+            continue;
+        }
+        bc = (disk->disk_status == STAT_INUSED) ? disk->bcache : NULL;
+        if ((bc != NULL) && (bc->nDynamic != 0) && (bc->bcacheMutex.owner != self) &&
+            (pthread_mutex_trylock(&bc->bcacheMutex) == ENOERR)) {
+            freed += BcacheShrink(bc, nPage - freed);
+            (VOID)pthread_mutex_unlock(&bc->bcacheMutex);
+        }
+        (VOID)pthread_mutex_unlock(&disk->disk_mutex);
+    }
+    return freed;
+#else
+    (VOID)nPage;
+    return 0;
+#endif
+}
+
 #ifdef LOSCFG_FS_FAT_CACHE_SYNC_THREAD
-static VOID BcacheSyncThread(UINT32 id)
-{
-    INT32 diskID = (INT32)id;
-    INT32 dirtyRatio;
-    while (1) {
-        dirtyRatio = BcacheGetDirtyRatio(diskID);
-        if (dirtyRatio > (INT32)g_dirtyRatio) {
-            (VOID)OsSdSync(diskID);
+/*
+ * Background writeback of one cache, in batches until the dirty ratio is back under the threshold.
+ * The lock is dropped between batches so that writers and readers are not held up behind it.
+ */
+static VOID BcacheBackgroundWriteback(OsBcache *bc)
+{
+    UINT32 dirty;
+    BOOL more = TRUE;
+
+    while (more && bc->syncTaskRun) {
+        more = FALSE;
+        (VOID)pthread_mutex_lock(&bc->bcacheMutex);
+        if (BcacheDirtyRatio(bc) > g_dirtyRatio) {
+            dirty = bc->modifiedBlock;
+            more = (BcacheWriteback(bc, BCACHE_WB_BATCH) == ENOERR) && (bc->modifiedBlock < dirty);
+        }
+        (VOID)pthread_mutex_unlock(&bc->bcacheMutex);
+    }
+}
+
+/*
+ * The flusher of a disk: woken by writers over the dirty ratio threshold, or by its interval. Dirty
+ * page-cache pages of the files on the disk go first, their writeback dirties blocks that the cache
+ * writeback then picks up.
+ */
+static VOID BcacheSyncThread(UINT32 id, OsBcache *bc)
+{
+    UINT32 event;
+
+    for (;;) {
+        event = LOS_EventRead(&bc->syncEvent, SYNC_EVENT_BIT | SYNC_EXIT_BIT, LOS_WAITMODE_OR | LOS_WAITMODE_CLR,
+                              LOS_MS2Tick(g_syncInterval));
+        if (!(event & LOS_ERRTYPE_ERROR) && (event & SYNC_EXIT_BIT)) {
+            break;
+        }
+#ifdef LOSCFG_KERNEL_VM
+        if (OsFileCacheOverDirty()) {
+            flush_file_mappings((int)id);
         }
-        msleep(g_syncInterval);
+#endif
+        BcacheBackgroundWriteback(bc);
     }
+    (VOID)LOS_EventWrite(&bc->syncEvent, SYNC_DONE_BIT);
 }
 
 VOID BcacheSyncThreadInit(OsBcache *bc, INT32 id)
@@ -1040,24 +1555,49 @@ VOID BcacheSyncThreadInit(OsBcache *bc, INT32 id)
     UINT32 ret;
     TSK_INIT_PARAM_S appTask;
 
+    ret = LOS_EventInit(&bc->syncEvent);
+    if (ret != ENOERR) {
+        PRINT_ERR("Sync event init failed in %s, %d\n", __FUNCTION__, __LINE__);
+        return;
+    }
+
     (VOID)memset_s(&appTask, sizeof(TSK_INIT_PARAM_S), 0, sizeof(TSK_INIT_PARAM_S));
     appTask.pfnTaskEntry = (TSK_ENTRY_FUNC)BcacheSyncThread;
     appTask.uwStackSize = BCACHE_STATCK_SIZE;
     appTask.pcName = "bcache_sync_task";
     appTask.usTaskPrio = g_syncThreadPrio;
     appTask.auwArgs[0] = (UINTPTR)id;
+    appTask.auwArgs[1] = (UINTPTR)bc;
     appTask.uwResved = LOS_TASK_STATUS_DETACHED;
     ret = LOS_TaskCreate(&bc->syncTaskId, &appTask);
     if (ret != ENOERR) {
         PRINT_ERR("Bcache sync task create failed in %s, %d\n", __FUNCTION__, __LINE__);
+        (VOID)LOS_EventDestroy(&bc->syncEvent);
+        return;
     }
+    bc->syncTaskRun = TRUE;
 }
 
-VOID BcacheSyncThreadDeinit(const OsBcache *bc)
+/*
+ * Ask the sync task to exit and wait until it has. The task writes back file pages through the file
+ * systems, which take the disk lock, so the caller must not hold it.
+ */
+VOID BcacheSyncThreadDeinit(OsBcache *bc)
 {
-    if (bc != NULL) {
-        if (LOS_TaskDelete(bc->syncTaskId) != ENOERR) {
-            PRINT_ERR("Bcache sync task delete failed in %s, %d\n", __FUNCTION__, __LINE__);
+    UINT32 ret;
+
+    if ((bc != NULL) && bc->syncTaskRun) {
+        bc->syncTaskRun = FALSE;
+        ret = LOS_EventWrite(&bc->syncEvent, SYNC_EXIT_BIT);
+        if (ret == ENOERR) {
+            ret = LOS_EventRead(&bc->syncEvent, SYNC_DONE_BIT, LOS_WAITMODE_OR | LOS_WAITMODE_CLR, LOS_WAIT_FOREVER);
+        }
+        if (ret != SYNC_DONE_BIT) {
+            PRINT_ERR("Bcache sync task exit failed in %s, %d\n", __FUNCTION__, __LINE__);
+            return;
+        }
+        if (LOS_EventDestroy(&bc->syncEvent) != ENOERR) {
+            PRINT_ERR("Sync event destroy failed in %s, %d\n", __FUNCTION__, __LINE__);
         }
     }
 }
@@ -1070,7 +1610,8 @@ OsBcache *BlockCacheInit(struct Vnode *devNode, UINT32 sectorSize, UINT32 sector
     struct Vnode *blkDriver = devNode;
     UINT8 *bcacheMem = NULL;
     UINT8 *rwBuffer = NULL;
-    UINT32 blockSize, memSize;
+    UINT64 *ghost = NULL;
+    UINT32 blockSize, memSize, ghostSize, maxDynamic;
 
     if ((blkDriver == NULL) || (sectorSize * sectorPerBlock * blockNum == 0) || (blockCount == 0)) {
         return NULL;
@@ -1102,17 +1643,35 @@ OsBcache *BlockCacheInit(struct Vnode *devNode, UINT32 sectorSize, UINT32 sector
         goto ERROR_OUT_WITH_MEM;
     }
 
+#ifdef LOSCFG_KERNEL_VM
+    maxDynamic = CONFIG_FS_FAT_DYNAMIC_NUMS;
+#else
+    maxDynamic = 0;
+#endif
+    ghostSize = (MIN(blockNum, CONFIG_FS_FAT_READ_NUMS) + maxDynamic) * BCACHE_GHOST_RATIO;
+    ghost = (UINT64 *)malloc(ghostSize * sizeof(UINT64));
+    if (ghost == NULL) {
+        PRINT_ERR("bcache_init : malloc %u Bytes failed!\n", ghostSize * sizeof(UINT64));
+        goto ERROR_OUT_WITH_BUFFER;
+    }
+    (VOID)memset_s(ghost, ghostSize * sizeof(UINT64), 0xFF, ghostSize * sizeof(UINT64)); /* BCACHE_GHOST_EMPTY */
+
     bcache->rwBuffer = rwBuffer;
     bcache->sectorSize = sectorSize;
     bcache->sectorPerBlock = sectorPerBlock;
     bcache->blockCount = blockCount;
+    bcache->ghost = ghost;
+    bcache->ghostSize = ghostSize;
+    bcache->maxDynamic = maxDynamic;
 
     if (BlockCacheDrvCreate(blkDriver, bcacheMem, memSize, blockSize, bcache) != ENOERR) {
-        goto ERROR_OUT_WITH_BUFFER;
+        goto ERROR_OUT_WITH_GHOST;
     }
 
     return bcache;
 
+ERROR_OUT_WITH_GHOST:
+    free(ghost);
 ERROR_OUT_WITH_BUFFER:
     free(rwBuffer);
 ERROR_OUT_WITH_MEM:
@@ -1122,14 +1681,39 @@ ERROR_OUT_WITH_BCACHE:
     return NULL;
 }
 
+#ifdef LOSCFG_KERNEL_VM
+static VOID DynamicBlocksFreeAll(OsBcache *bc)
+{
+    OsBcacheBlock *block = NULL;
+    OsBcacheBlock *next = NULL;
+
+    LOS_DL_LIST_FOR_EACH_ENTRY_SAFE(block, next, &bc->listHead, OsBcacheBlock, listNode) {
+        if (block->dynamic) {
+            DelBlock(bc, block);
+        }
+    }
+    LOS_DL_LIST_FOR_EACH_ENTRY_SAFE(block, next, &bc->freeListHead, OsBcacheBlock, listNode) {
+        if (block->dynamic) {
+            LOS_ListDelete(&block->listNode);
+            DynamicBlockFree(bc, block);
+        }
+    }
+}
+#endif
+
 VOID BlockCacheDeinit(OsBcache *bcache)
 {
     if (bcache != NULL) {
+#ifdef LOSCFG_KERNEL_VM
+        DynamicBlocksFreeAll(bcache);
+#endif
         (VOID)pthread_mutex_destroy(&bcache->bcacheMutex);
         free(bcache->memStart);
         bcache->memStart = NULL;
         free(bcache->rwBuffer);
         bcache->rwBuffer = NULL;
+        free(bcache->ghost);
+        bcache->ghost = NULL;
         free(bcache);
     }
 }
@@ -1158,14 +1742,13 @@ static VOID BcacheAsyncPrereadThread(VOID *arg)
             ret = BcacheGetBlock(bc, bc->curBlockNum + i, TRUE, &block);
             if (ret != ENOERR) {
                 PRINT_ERR("read block %llu error : %d!\n", bc->curBlockNum, ret);
+            } else if ((i == PREREAD_BLOCK_NUM) || ((bc->curBlockNum + i + 1) >= bc->blockCount)) {
+                /* marked under the lock, a dynamic block may be given back once it is dropped */
+                block->pgHit = 1; /* preread complete */
             }
 
             (VOID)pthread_mutex_unlock(&bc->bcacheMutex);
         }
-
-        if (block != NULL) {
-            block->pgHit = 1; /* preread complete */
-        }
     }
 }
 
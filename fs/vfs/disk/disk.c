@@ -1217,6 +1217,21 @@ static OsBcache *DiskCacheInit(UINT32 diskID, const struct geometry *diskInfo, s
     return bc;
 }
 
+#ifdef LOSCFG_FS_FAT_CACHE_SYNC_THREAD
+/* the sync task writes back through the file systems, which take the disk lock, it is stopped without it */
+static VOID DiskSyncThreadDeinit(los_disk *disk)
+{
+    OsBcache *bc = NULL;
+
+    DISK_LOCK(&disk->disk_mutex);
+    bc = disk->bcache;
+    DISK_UNLOCK(&disk->disk_mutex);
+    if ((bc != NULL) && (GetDiskUsbStatus(disk->disk_id) == FALSE)) {
+        BcacheSyncThreadDeinit(bc);
+    }
+}
+#endif
+
 static VOID DiskCacheDeinit(los_disk *disk)
 {
     UINT32 diskID = disk->disk_id;
@@ -1224,9 +1239,6 @@ static VOID DiskCacheDeinit(los_disk *disk)
         if (BcacheAsyncPrereadDeinit(disk->bcache) != LOS_OK) {
             PRINT_ERR("Blib async preread deinit failed in %s, %d\n", __FUNCTION__, __LINE__);
         }
-#ifdef LOSCFG_FS_FAT_CACHE_SYNC_THREAD
-        BcacheSyncThreadDeinit(disk->bcache);
-#endif
     }
 
     BlockCacheDeinit(disk->bcache);
@@ -1315,6 +1327,9 @@ static INT32 DiskDeinit(los_disk *disk)
         }
     }
 
+#ifdef LOSCFG_FS_FAT_CACHE_SYNC_THREAD
+    DiskSyncThreadDeinit(disk);
+#endif
     DISK_LOCK(&disk->disk_mutex);
 
 #ifdef LOSCFG_FS_FAT_CACHE
@@ -1480,6 +1495,9 @@ INT32 los_disk_set_bcache(INT32 drvID, UINT32 sectorPerBlock, UINT32 blockNum)
         return EINVAL;
     }
 
+#ifdef LOSCFG_FS_FAT_CACHE_SYNC_THREAD
+    DiskSyncThreadDeinit(disk);
+#endif
     DISK_LOCK(&disk->disk_mutex);
 
     if (disk->disk_status != STAT_INUSED) {
@@ -1489,6 +1507,11 @@ INT32 los_disk_set_bcache(INT32 drvID, UINT32 sectorPerBlock, UINT32 blockNum)
     if (disk->bcache != NULL) {
         ret = BlockCacheSync(disk->bcache);
         if (ret != ENOERR) {
+#ifdef LOSCFG_FS_FAT_CACHE_SYNC_THREAD
+            if (GetDiskUsbStatus((UINT32)drvID) == FALSE) {
+                BcacheSyncThreadInit(disk->bcache, drvID);
+            }
+#endif
             DISK_UNLOCK(&disk->disk_mutex);
             return ret;
         }
@@ -54,6 +54,11 @@ extern "C" {
 #define PERCENTAGE            100
 #define PREREAD_EVENT_MASK    0xf
 
+/* 2Q queues of the read buffers */
+#define BCACHE_QUEUE_NONE     0
+#define BCACHE_QUEUE_IN       1   /* A1in: seen once, FIFO */
+#define BCACHE_QUEUE_MAIN     2   /* Am: seen again after leaving A1in, LRU */
+
 #if CONFIG_FS_FAT_SECTOR_PER_BLOCK < UNSIGNED_INTEGER_BITS
 #error cache too small
 #else
@@ -73,6 +78,9 @@ typedef struct {
     BOOL readBuff;          /* read write buffer */
     BOOL used;              /* used or free for write buf */
     BOOL allDirty;          /* the whole block is dirty */
+    LOS_DL_LIST qNode;      /* 2Q queue node, read buffers only */
+    UINT8 queue;            /* 2Q queue the block is on */
+    BOOL dynamic;           /* allocated beyond the base pool, given back on reclaim */
 } OsBcacheBlock;
 
 typedef INT32 (*BcacheReadFun)(struct Vnode *, /* private data */
@@ -85,6 +93,24 @@ typedef INT32 (*BcacheWriteFun)(struct Vnode *, /* private data */
                                 UINT32,         /* number of blocks to write */
                                 UINT64);        /* starting block number */
 
+typedef struct {
+    UINT64 hits;            /* lookups found in the cache */
+    UINT64 misses;          /* lookups that had to take a block */
+    UINT64 ghostHits;       /* misses on a block recently dropped from A1in */
+    UINT64 evictions;       /* cached blocks recycled for another block number */
+    UINT64 writebacks;      /* blocks written back to the disk */
+    UINT64 bypasses;        /* page-cache fills and writebacks that went straight to the disk */
+    UINT64 throttles;       /* writes that wrote back blocks themselves over the hard dirty limit */
+    UINT32 grows;           /* dynamic blocks allocated */
+    UINT32 shrinks;         /* dynamic blocks given back */
+    UINT32 nBlock;          /* blocks holding data */
+    UINT32 readBlocks;      /* read buffers, base and dynamic */
+    UINT32 nDynamic;        /* dynamic blocks */
+    UINT32 nIn;             /* blocks on A1in */
+    UINT32 nMain;           /* blocks on Am */
+    UINT32 nDirty;          /* modified blocks */
+} OsBcacheStat;
+
 struct tagOsBcache;
 
 typedef VOID (*BcachePrereadFun)(struct tagOsBcache *,   /* block cache instance space holder */
@@ -113,11 +139,25 @@ typedef struct tagOsBcache {
     UINT32 modifiedBlock;         /* number of modified blocks */
 #ifdef LOSCFG_FS_FAT_CACHE_SYNC_THREAD
     UINT32 syncTaskId;            /* sync task id */
+    EVENT_CB_S syncEvent;         /* wakes the sync task before its interval is up */
+    BOOL syncTaskRun;             /* the sync task runs, cleared to stop it */
 #endif
+    UINT64 wbCursor;              /* writeback resumes from this block number */
     OsBcacheBlock *wStart;        /* write start block */
     OsBcacheBlock *wEnd;          /* write end block */
     UINT64 sumNum;                /* block num sum val */
     UINT32 nBlock;                /* current block count */
+    LOS_DL_LIST inHead;           /* 2Q A1in of the read buffers */
+    LOS_DL_LIST mainHead;         /* 2Q Am of the read buffers */
+    UINT32 nIn;                   /* blocks on inHead */
+    UINT32 nMain;                 /* blocks on mainHead */
+    UINT64 *ghost;                /* 2Q A1out: numbers of blocks last dropped from A1in */
+    UINT32 ghostSize;             /* slots of the ghost ring */
+    UINT32 ghostNext;             /* next ghost slot to overwrite */
+    UINT32 readBlocks;            /* read buffers, base and dynamic */
+    UINT32 nDynamic;              /* read buffers allocated beyond the base pool */
+    UINT32 maxDynamic;            /* limit of nDynamic */
+    OsBcacheStat stat;            /* counters, the size fields are filled on read */
 } OsBcache;
 
 /**
@@ -254,11 +294,46 @@ OsBcache *BlockCacheInit(struct Vnode *devNode,
 VOID BlockCacheDeinit(OsBcache *bc);
 
 INT32 BcacheClearCache(OsBcache *bc);
+
+/**
+ * @ingroup  bcache
+ *
+ * @par Description:
+ * The BlockCacheStatGet() function shall copy the counters and the current sizes of the bcache.
+ *
+ * @param  bc    [IN]  block cache instance
+ * @param  stat  [OUT] counters and sizes
+ *
+ * @retval #0           succeded
+ * @retval #INT32       failed
+ *
+ * @par Dependency:
+ * <ul><li>bcache.h</li></ul>
+ *
+ */
+INT32 BlockCacheStatGet(OsBcache *bc, OsBcacheStat *stat);
+
+/**
+ * @ingroup  bcache
+ *
+ * @par Description:
+ * The BcacheReclaim() function shall give back clean dynamic blocks of all the disk caches, it is
+ * called from the page reclaim path.
+ *
+ * @param  nPage [IN]  number of pages wanted
+ *
+ * @retval #UINT32      number of pages given back
+ *
+ * @par Dependency:
+ * <ul><li>bcache.h</li></ul>
+ *
+ */
+UINT32 BcacheReclaim(UINT32 nPage);
 INT32 OsSdSync(INT32 id);
 
 #ifdef LOSCFG_FS_FAT_CACHE_SYNC_THREAD
 VOID BcacheSyncThreadInit(OsBcache *bc, INT32 id);
-VOID BcacheSyncThreadDeinit(const OsBcache *bc);
+VOID BcacheSyncThreadDeinit(OsBcache *bc);
 #endif
 
 UINT32 BcacheAsyncPrereadInit(OsBcache *bc);
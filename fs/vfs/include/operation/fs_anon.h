@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _FS_ANON_H
+#define _FS_ANON_H
+
+#include "los_typedef.h"
+#include "los_atomic.h"
+#include "fs_epoll.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+struct file;
+struct file_operations_vfs;
+
+/*
+ * Header of the private object behind an anonymous file (epoll, eventfd, timerfd, signalfd).
+ * Anonymous files share one pinned virtual vnode and are never visible in the namespace.
+ */
+struct AnonFile {
+    struct EpollWatch watch;                    /* readiness hook, ops may stay NULL */
+    Atomic refCount;                            /* the fd holds one reference, epoll items one each */
+    VOID (*release)(struct AnonFile *anon);     /* called when the last reference is dropped */
+};
+
+VOID AnonFileInit(struct AnonFile *anon, const struct EpollWatchOps *watchOps,
+                  VOID (*release)(struct AnonFile *anon));
+int AnonFileAlloc(const struct file_operations_vfs *fops, struct AnonFile *anon, int oflags);
+struct AnonFile *AnonFileGet(const struct file *filep);
+VOID AnonFileHold(struct AnonFile *anon);
+VOID AnonFileDrop(struct AnonFile *anon);
+VOID AnonWatchHold(struct EpollWatch *watch);
+VOID AnonWatchDrop(struct EpollWatch *watch);
+int AnonFileCopyOut(VOID *dst, const VOID *src, size_t len);
+int AnonFileCopyIn(VOID *dst, const VOID *src, size_t len);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#endif /* _FS_ANON_H */
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _FS_EPOLL_H
+#define _FS_EPOLL_H
+
+#include "los_typedef.h"
+#include "los_list.h"
+#include "los_spinlock.h"
+#include "sys/epoll.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#define EPOLL_MAX_EVENTS        1024    /* upper bound of maxevents accepted by one epoll_wait */
+
+struct EpollWatch;
+
+struct EpollWatchOps {
+    UINT32 (*getEvents)(struct EpollWatch *watch);  /* current readiness of the source, POLL* bits */
+    VOID (*hold)(struct EpollWatch *watch);         /* optional, pins the source while an item refers to it */
+    VOID (*drop)(struct EpollWatch *watch);
+};
+
+/*
+ * Embedded in a pollable object so that epoll instances can be told about readiness changes
+ * instead of polling it. A source without a watch is polled through its file poll method.
+ */
+struct EpollWatch {
+    SPIN_LOCK_S lock;
+    LOS_DL_LIST itemList;               /* epoll items attached to this source */
+    const struct EpollWatchOps *ops;    /* NULL until EpollWatchInit, notifications are ignored */
+};
+
+VOID EpollWatchInit(struct EpollWatch *watch, const struct EpollWatchOps *ops);
+VOID EpollWatchNotify(struct EpollWatch *watch, UINT32 events);
+VOID EpollWatchDetach(struct EpollWatch *watch);
+
+struct file;
+struct file_operations_vfs;
+
+/* Returns the watch of a file opened through a registered driver, NULL to have epoll poll() it */
+typedef struct EpollWatch *(*EpollWatchLookup)(struct file *filep);
+
+/*
+ * Drivers that keep their own wait queue register their file operations here, so that epoll
+ * finds the watch of their files instead of polling them. The watch must stay valid until the
+ * driver has detached it and unregistered.
+ */
+int EpollDriverRegister(const struct file_operations_vfs *fops, EpollWatchLookup lookup);
+VOID EpollDriverUnregister(const struct file_operations_vfs *fops);
+
+int EpollCreate(int flags);
+int EpollCtl(int epSysFd, int op, int sysFd, const struct epoll_event *event);
+int EpollWait(int epSysFd, struct epoll_event *events, int maxEvents, int timeout);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#endif /* _FS_EPOLL_H */
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _FS_PKTRING_H
+#define _FS_PKTRING_H
+
+#include "los_typedef.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+/*
+ * Frame ring ABI shared with user space, laid out as the Linux TPACKET_V1 PACKET_RX_RING and
+ * PACKET_TX_RING. The ring is a set of blocks, each holding tp_frame_size sized frames that start
+ * with a struct tpacket_hdr. Ownership of a frame moves with tp_status: the kernel only touches
+ * frames it owns and hands them over by writing tp_status last.
+ */
+#ifndef SOL_PACKET
+#define SOL_PACKET              263
+#endif
+#ifndef PACKET_RX_RING
+#define PACKET_RX_RING          5
+#endif
+#ifndef PACKET_TX_RING
+#define PACKET_TX_RING          13
+#endif
+
+struct tpacket_req {
+    UINT32 tp_block_size;       /* multiple of the page size */
+    UINT32 tp_block_nr;
+    UINT32 tp_frame_size;       /* multiple of TPACKET_ALIGNMENT, frames do not straddle blocks */
+    UINT32 tp_frame_nr;         /* tp_block_nr * (tp_block_size / tp_frame_size) */
+};
+
+struct tpacket_hdr {
+    unsigned long tp_status;
+    UINT32 tp_len;
+    UINT32 tp_snaplen;
+    UINT16 tp_mac;
+    UINT16 tp_net;
+    UINT32 tp_sec;
+    UINT32 tp_usec;
+};
+
+/* rx frame status */
+#define TP_STATUS_KERNEL        0x0
+#define TP_STATUS_USER          0x1
+#define TP_STATUS_LOSING        0x4     /* packets were dropped since this frame was filled */
+#define TP_STATUS_TRUNCATED     0x8     /* tp_snaplen < tp_len */
+
+/* tx frame status */
+#define TP_STATUS_AVAILABLE     0x0
+#define TP_STATUS_SEND_REQUEST  0x1
+#define TP_STATUS_SENDING       0x2
+#define TP_STATUS_WRONG_FORMAT  0x4
+
+#define TPACKET_ALIGNMENT       16
+#define TPACKET_ALIGN(x)        (((x) + TPACKET_ALIGNMENT - 1) & ~(TPACKET_ALIGNMENT - 1))
+
+#define PKTRING_RX              0
+#define PKTRING_TX              1
+#define PKTRING_DIRS            2
+#define PKTRING_SIZE_MAX        (8 * 1024 * 1024) /* per direction */
+
+struct PktRing;
+
+/*
+ * A ring object is an anonymous file: PktRingCreate returns its system fd, which the owner keeps
+ * open and maps for the user. The RX area comes first in the mapping, the TX area follows it.
+ * PktRingClaim takes the next frame if it is in the given status (TP_STATUS_KERNEL for rx,
+ * TP_STATUS_SEND_REQUEST for tx), PktRingHandOver publishes it with a new status. PktRingPeek
+ * reports the status of the next frame, or of the one claimed last when previous is TRUE.
+ * PktRingHold keeps the object alive past a close of its fd until the matching PktRingPut.
+ */
+int PktRingCreate(struct PktRing **ringp);
+int PktRingSetup(struct PktRing *ring, UINT32 dir, const struct tpacket_req *req);
+VOID PktRingHold(struct PktRing *ring);
+VOID PktRingPut(struct PktRing *ring);
+BOOL PktRingActive(const struct PktRing *ring, UINT32 dir);
+struct tpacket_hdr *PktRingClaim(struct PktRing *ring, UINT32 dir, unsigned long status, UINT32 *frameSize);
+VOID PktRingHandOver(struct PktRing *ring, struct tpacket_hdr *hdr, unsigned long status);
+unsigned long PktRingPeek(struct PktRing *ring, UINT32 dir, BOOL previous);
+UINT32 PktRingDrops(struct PktRing *ring);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#endif /* _FS_PKTRING_H */
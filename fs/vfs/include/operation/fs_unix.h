@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _FS_UNIX_H
+#define _FS_UNIX_H
+
+#include "los_typedef.h"
+#include "sys/socket.h"
+#include "sys/un.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+/* Largest msg_control area accepted by UnixSendMsg and filled by UnixRecvMsg */
+#define UNIX_CMSG_MAX           4096
+
+/*
+ * AF_UNIX sockets are anonymous files, so read/write/poll/epoll/close go through the VFS like
+ * any other descriptor. The socket calls below take system fds and return -errno on failure.
+ * Addresses, socket options and msg_name/msg_control must be kernel buffers; payload buffers
+ * (iov_base) may be user buffers that the caller has range-checked.
+ *
+ * The fd table has no close-on-exec bit, so SOCK_CLOEXEC and MSG_CMSG_CLOEXEC are refused with
+ * -EINVAL rather than silently ignored.
+ */
+int UnixSocketCreate(int type, int protocol);
+int UnixSocketPair(int type, int protocol, int sv[2]);
+BOOL UnixSocketIs(int sysFd);
+
+int UnixBind(int sysFd, const struct sockaddr *addr, socklen_t addrLen);
+int UnixConnect(int sysFd, const struct sockaddr *addr, socklen_t addrLen);
+int UnixListen(int sysFd, int backlog);
+int UnixAccept(int sysFd, struct sockaddr *addr, socklen_t *addrLen, int flags);
+int UnixShutdown(int sysFd, int how);
+int UnixGetName(int sysFd, struct sockaddr *addr, socklen_t *addrLen, BOOL peer);
+int UnixSetSockOpt(int sysFd, int level, int optName, const void *optValue, socklen_t optLen);
+int UnixGetSockOpt(int sysFd, int level, int optName, void *optValue, socklen_t *optLen);
+
+ssize_t UnixSendMsg(int sysFd, const struct msghdr *msg, int flags);
+ssize_t UnixRecvMsg(int sysFd, struct msghdr *msg, int flags);
+/* Close the descriptors UnixRecvMsg installed from msg_control, when it cannot reach the caller */
+void UnixCtlRevoke(const struct msghdr *msg);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#endif /* _FS_UNIX_H */
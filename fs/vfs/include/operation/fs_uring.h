@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _FS_URING_H
+#define _FS_URING_H
+
+#include "los_typedef.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+/*
+ * Submission/completion ring ABI shared with user space. The layout matches the Linux io_uring
+ * structures so existing ring helpers can be used unchanged.
+ */
+struct io_uring_sqe {
+    UINT8 opcode;
+    UINT8 flags;
+    UINT16 ioprio;
+    INT32 fd;
+    UINT64 off;
+    UINT64 addr;
+    UINT32 len;
+    union {
+        UINT32 rw_flags;
+        UINT32 fsync_flags;
+        UINT32 msg_flags;
+    };
+    UINT64 user_data;
+    UINT64 __pad2[3];
+};
+
+struct io_uring_cqe {
+    UINT64 user_data;
+    INT32 res;
+    UINT32 flags;
+};
+
+struct io_sqring_offsets {
+    UINT32 head;
+    UINT32 tail;
+    UINT32 ring_mask;
+    UINT32 ring_entries;
+    UINT32 flags;
+    UINT32 dropped;
+    UINT32 array;
+    UINT32 resv1;
+    UINT64 resv2;
+};
+
+struct io_cqring_offsets {
+    UINT32 head;
+    UINT32 tail;
+    UINT32 ring_mask;
+    UINT32 ring_entries;
+    UINT32 overflow;
+    UINT32 cqes;
+    UINT32 flags;
+    UINT32 resv1;
+    UINT64 resv2;
+};
+
+struct io_uring_params {
+    UINT32 sq_entries;
+    UINT32 cq_entries;
+    UINT32 flags;
+    UINT32 sq_thread_cpu;
+    UINT32 sq_thread_idle;
+    UINT32 features;
+    UINT32 wq_fd;
+    UINT32 resv[3];
+    struct io_sqring_offsets sq_off;
+    struct io_cqring_offsets cq_off;
+};
+
+/* io_uring_setup flags */
+#define IORING_SETUP_IOPOLL     (1U << 0)
+#define IORING_SETUP_SQPOLL     (1U << 1)
+#define IORING_SETUP_SQ_AFF     (1U << 2)
+#define IORING_SETUP_CQSIZE     (1U << 3)
+
+/* io_uring_params features */
+#define IORING_FEAT_SINGLE_MMAP (1U << 0)
+#define IORING_FEAT_NODROP      (1U << 1)
+
+/* io_uring_enter flags */
+#define IORING_ENTER_GETEVENTS  (1U << 0)
+#define IORING_ENTER_SQ_WAKEUP  (1U << 1)
+
+/* sqe fsync_flags */
+#define IORING_FSYNC_DATASYNC   (1U << 0)
+
+/* mmap offsets of the shared areas */
+#define IORING_OFF_SQ_RING      0ULL
+#define IORING_OFF_CQ_RING      0x8000000ULL
+#define IORING_OFF_SQES         0x10000000ULL
+
+/* supported opcodes, numbered as in Linux */
+#define IORING_OP_NOP           0
+#define IORING_OP_READV         1
+#define IORING_OP_WRITEV        2
+#define IORING_OP_FSYNC         3
+#define IORING_OP_READ          22
+#define IORING_OP_WRITE         23
+#define IORING_OP_SEND          26
+#define IORING_OP_RECV          27
+
+#define URING_ENTRIES_MAX       1024
+#define URING_IOV_MAX           16
+
+int UringSetup(UINT32 entries, struct io_uring_params *params);
+int UringEnter(int sysFd, UINT32 toSubmit, UINT32 minComplete, UINT32 flags);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#endif /* _FS_URING_H */
@@ -54,6 +54,7 @@ struct Mount* MountAlloc(struct Vnode* vnodeBeCovered, struct MountOps* fsop)
 
     mnt->vnodeBeCovered = vnodeBeCovered;
     vnodeBeCovered->newMount = mnt;
+    mnt->diskId = -1;
 #ifdef LOSCFG_DRIVERS_RANDOM
     HiRandomHwInit();
     (VOID)HiRandomHwGetInteger(&mnt->hashseed);
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fs_anon.h"
+#include "errno.h"
+#include "fcntl.h"
+#include "sys/stat.h"
+#include "fs/file.h"
+#include "fs/vnode.h"
+#include "fs_file.h"
+#include "los_vm_map.h"
+#include "user_copy.h"
+#include "securec.h"
+
+#define ANON_VNODE_MODE (S_IFCHR | S_IRUSR | S_IWUSR)
+
+STATIC struct Vnode *g_anonVnode = NULL;
+
+STATIC struct Vnode *AnonVnodeGet(VOID)
+{
+    struct Vnode *vnode = NULL;
+
+    VnodeHold();
+    if (g_anonVnode == NULL) {
+        if (VnodeAlloc(NULL, &vnode) == LOS_OK) {
+            vnode->type = VNODE_TYPE_CHR;
+            vnode->mode = ANON_VNODE_MODE;
+            vnode->useCount++; /* shared by every anonymous file and never released */
+            g_anonVnode = vnode;
+        }
+    }
+    vnode = g_anonVnode;
+    VnodeDrop();
+
+    return vnode;
+}
+
+VOID AnonFileInit(struct AnonFile *anon, const struct EpollWatchOps *watchOps,
+                  VOID (*release)(struct AnonFile *anon))
+{
+    EpollWatchInit(&anon->watch, watchOps);
+    LOS_AtomicSet(&anon->refCount, 1);
+    anon->release = release;
+}
+
+int AnonFileAlloc(const struct file_operations_vfs *fops, struct AnonFile *anon, int oflags)
+{
+    struct Vnode *vnode = AnonVnodeGet();
+    struct file *filep = NULL;
+    int sysFd;
+
+    if (vnode == NULL) {
+        return -ENOMEM;
+    }
+
+    sysFd = files_allocate(vnode, oflags, 0, anon, MIN_START_FD);
+    if (sysFd < 0) {
+        return -EMFILE;
+    }
+
+    if (fs_getfilep(sysFd, &filep) < 0) {
+        return -EBADF;
+    }
+    filep->ops = (struct file_operations_vfs *)fops;
+
+    return sysFd;
+}
+
+struct AnonFile *AnonFileGet(const struct file *filep)
+{
+    if ((filep == NULL) || (g_anonVnode == NULL) || (filep->f_vnode != g_anonVnode)) {
+        return NULL;
+    }
+
+    return (struct AnonFile *)filep->f_priv;
+}
+
+VOID AnonFileHold(struct AnonFile *anon)
+{
+    LOS_AtomicInc(&anon->refCount);
+}
+
+VOID AnonFileDrop(struct AnonFile *anon)
+{
+    if ((LOS_AtomicDecRet(&anon->refCount) == 0) && (anon->release != NULL)) {
+        anon->release(anon);
+    }
+}
+
+/* EpollWatchOps helpers, the watch is the first member of struct AnonFile */
+VOID AnonWatchHold(struct EpollWatch *watch)
+{
+    AnonFileHold((struct AnonFile *)watch);
+}
+
+VOID AnonWatchDrop(struct EpollWatch *watch)
+{
+    AnonFileDrop((struct AnonFile *)watch);
+}
+
+/* Buffers handed to file read/write may live in user space or in the kernel. */
+int AnonFileCopyOut(VOID *dst, const VOID *src, size_t len)
+{
+    if (LOS_IsUserAddressRange((vaddr_t)(UINTPTR)dst, len)) {
+        return (LOS_ArchCopyToUser(dst, src, len) != 0) ? -EFAULT : LOS_OK;
+    }
+
+    return (memcpy_s(dst, len, src, len) != EOK) ? -EFAULT : LOS_OK;
+}
+
+int AnonFileCopyIn(VOID *dst, const VOID *src, size_t len)
+{
+    if (LOS_IsUserAddressRange((vaddr_t)(UINTPTR)src, len)) {
+        return (LOS_ArchCopyFromUser(dst, src, len) != 0) ? -EFAULT : LOS_OK;
+    }
+
+    return (memcpy_s(dst, len, src, len) != EOK) ? -EFAULT : LOS_OK;
+}
@@ -0,0 +1,897 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fs_epoll.h"
+#include "errno.h"
+#include "fcntl.h"
+#include "poll.h"
+#include "stdlib.h"
+#include "securec.h"
+#include "linux/wait.h"
+#include "los_mux.h"
+#include "los_sys_pri.h"
+#include "fs/file.h"
+#include "fs/fs.h"
+#include "fs_anon.h"
+#include "fs_poll_pri.h"
+#ifdef LOSCFG_NET_LWIP_SACK
+#include "lwip/sockets.h"
+#endif
+
+#define EPOLL_HASH_SIZE         64
+#define EPOLL_HASH(fd)          ((UINT32)(fd) & (EPOLL_HASH_SIZE - 1))
+#define EPOLL_ALWAYS_EVENTS     (EPOLLERR | EPOLLHUP)
+#define EPOLL_CTRL_EVENTS       (EPOLLET | EPOLLONESHOT | EPOLLWAKEUP | EPOLLEXCLUSIVE)
+#define EPOLL_DRIVER_MAX        8       /* drivers that can register a readiness hook */
+
+typedef struct {
+    struct AnonFile anon;               /* makes the epoll fd pollable and nestable, must be first */
+    LosMux mux;                         /* serializes ctl and harvesting, protects the interest set */
+    SPIN_LOCK_S lock;                   /* protects the ready list, taken from source notifications */
+    LOS_DL_LIST hash[EPOLL_HASH_SIZE];  /* interest set keyed by system fd */
+    LOS_DL_LIST readyList;              /* hooked items with pending events */
+    LOS_DL_LIST pollList;               /* items whose source has no watch, checked with poll() */
+    UINT32 pollCount;
+    BOOL pollDirty;                     /* pollFds no longer matches pollList */
+    struct pollfd *pollFds;
+    VOID **pollItems;
+    UINT32 pollCap;
+    UINT32 nestCount;                   /* epoll fds in the interest set */
+    wait_queue_head_t wq;
+    int sysFd;
+} EpollHead;
+
+typedef struct {
+    LOS_DL_LIST hashNode;
+    LOS_DL_LIST readyNode;              /* on readyList while ready, on pollList if unhooked */
+    LOS_DL_LIST watchNode;              /* on watch->itemList until the source detaches */
+    EpollHead *head;
+    struct EpollWatch *watch;           /* NULL for sources polled with poll() */
+    int sysFd;
+    UINT32 fileMagic;                   /* detects the fd being closed and reused */
+    struct epoll_event event;
+    UINT32 revents;                     /* events notified since the last harvest */
+    UINT32 lastEvents;                  /* edge detection state of unhooked items */
+    BOOL ready;
+    BOOL dead;                          /* the source has been closed */
+    BOOL disabled;                      /* EPOLLONESHOT fired, waiting for EPOLL_CTL_MOD */
+    BOOL nested;
+} EpollItem;
+
+typedef struct {
+    const struct file_operations_vfs *fops;
+    EpollWatchLookup lookup;
+} EpollDriver;
+
+STATIC EpollDriver g_epollDriver[EPOLL_DRIVER_MAX];
+LITE_OS_SEC_BSS STATIC SPIN_LOCK_INIT(g_epollDriverSpin);
+
+STATIC int EpollClose(struct file *filep);
+#ifndef CONFIG_DISABLE_POLL
+STATIC int EpollPoll(struct file *filep, poll_table *table);
+#endif
+
+STATIC const struct file_operations_vfs g_epollFops = {
+    NULL,           /* open */
+    EpollClose,     /* close */
+    NULL,           /* read */
+    NULL,           /* write */
+    NULL,           /* seek */
+    NULL,           /* ioctl */
+    NULL,           /* mmap */
+#ifndef CONFIG_DISABLE_POLL
+    EpollPoll,      /* poll */
+#endif
+    NULL,           /* unlink */
+};
+
+VOID EpollWatchInit(struct EpollWatch *watch, const struct EpollWatchOps *ops)
+{
+    LOS_SpinInit(&watch->lock);
+    LOS_ListInit(&watch->itemList);
+    watch->ops = ops;
+}
+
+int EpollDriverRegister(const struct file_operations_vfs *fops, EpollWatchLookup lookup)
+{
+    UINT32 intSave;
+    UINT32 index;
+    int ret = -ENOSPC;
+
+    if ((fops == NULL) || (lookup == NULL)) {
+        return -EINVAL;
+    }
+
+    LOS_SpinLockSave(&g_epollDriverSpin, &intSave);
+    for (index = 0; index < EPOLL_DRIVER_MAX; index++) {
+        if ((g_epollDriver[index].fops == NULL) || (g_epollDriver[index].fops == fops)) {
+            g_epollDriver[index].fops = fops;
+            g_epollDriver[index].lookup = lookup;
+            ret = LOS_OK;
+            break;
+        }
+    }
+    LOS_SpinUnlockRestore(&g_epollDriverSpin, intSave);
+
+    return ret;
+}
+
+VOID EpollDriverUnregister(const struct file_operations_vfs *fops)
+{
+    UINT32 intSave;
+    UINT32 index;
+
+    LOS_SpinLockSave(&g_epollDriverSpin, &intSave);
+    for (index = 0; index < EPOLL_DRIVER_MAX; index++) {
+        if (g_epollDriver[index].fops == fops) {
+            g_epollDriver[index].fops = NULL;
+            g_epollDriver[index].lookup = NULL;
+        }
+    }
+    LOS_SpinUnlockRestore(&g_epollDriverSpin, intSave);
+}
+
+/* The watch of a driver file, the lookup runs under the registry lock and must not sleep */
+STATIC struct EpollWatch *EpollDriverWatch(struct file *filep)
+{
+    struct EpollWatch *watch = NULL;
+    UINT32 intSave;
+    UINT32 index;
+
+    LOS_SpinLockSave(&g_epollDriverSpin, &intSave);
+    for (index = 0; index < EPOLL_DRIVER_MAX; index++) {
+        if (g_epollDriver[index].fops == filep->ops) {
+            watch = g_epollDriver[index].lookup(filep);
+            break;
+        }
+    }
+    LOS_SpinUnlockRestore(&g_epollDriverSpin, intSave);
+
+    if ((watch != NULL) && (watch->ops == NULL)) {
+        return NULL;
+    }
+    return watch;
+}
+
+STATIC BOOL EpollHasReady(EpollHead *head)
+{
+    UINT32 intSave;
+    BOOL ready;
+
+    LOS_SpinLockSave(&head->lock, &intSave);
+    ready = !LOS_ListEmpty(&head->readyList);
+    LOS_SpinUnlockRestore(&head->lock, intSave);
+
+    return ready;
+}
+
+STATIC VOID EpollHeadWake(EpollHead *head)
+{
+    notify_poll(&head->wq);
+    EpollWatchNotify(&head->anon.watch, POLLIN | POLLRDNORM);
+}
+
+/* Put the item on the ready list, returns TRUE if the epoll instance must be woken up. */
+STATIC BOOL EpollItemQueue(EpollItem *item, UINT32 events)
+{
+    EpollHead *head = item->head;
+    UINT32 intSave;
+    BOOL wake = FALSE;
+
+    LOS_SpinLockSave(&head->lock, &intSave);
+    if (!item->disabled && ((events & (item->event.events | EPOLL_ALWAYS_EVENTS)) != 0)) {
+        item->revents |= events;
+        if (!item->ready) {
+            LOS_ListTailInsert(&head->readyList, &item->readyNode);
+            item->ready = TRUE;
+            wake = TRUE;
+        }
+    }
+    LOS_SpinUnlockRestore(&head->lock, intSave);
+
+    return wake;
+}
+
+STATIC BOOL EpollWatchIdle(struct EpollWatch *watch)
+{
+    UINT32 intSave;
+    BOOL idle;
+
+    LOS_SpinLockSave(&watch->lock, &intSave);
+    idle = LOS_ListEmpty(&watch->itemList);
+    LOS_SpinUnlockRestore(&watch->lock, intSave);
+
+    return idle;
+}
+
+VOID EpollWatchNotify(struct EpollWatch *watch, UINT32 events)
+{
+    EpollItem *item = NULL;
+    UINT32 intSave;
+
+    if ((watch->ops == NULL) || (events == 0)) {
+        return;
+    }
+
+    LOS_SpinLockSave(&watch->lock, &intSave);
+    LOS_DL_LIST_FOR_EACH_ENTRY(item, &watch->itemList, EpollItem, watchNode) {
+        if (EpollItemQueue(item, events)) {
+            EpollHeadWake(item->head);
+        }
+    }
+    LOS_SpinUnlockRestore(&watch->lock, intSave);
+}
+
+/*
+ * Called by the source when it goes away. Items are only marked dead and left on the ready
+ * list, the owning epoll instance frees them the next time it looks at the ready list.
+ */
+VOID EpollWatchDetach(struct EpollWatch *watch)
+{
+    EpollItem *item = NULL;
+    EpollHead *head = NULL;
+    UINT32 intSave;
+
+    if (watch->ops == NULL) {
+        return;
+    }
+
+    LOS_SpinLockSave(&watch->lock, &intSave);
+    while (!LOS_ListEmpty(&watch->itemList)) {
+        item = LOS_DL_LIST_ENTRY(watch->itemList.pstNext, EpollItem, watchNode);
+        LOS_ListDelete(&item->watchNode);
+        head = item->head;
+        LOS_SpinLock(&head->lock);
+        item->dead = TRUE;
+        if (!item->ready) {
+            LOS_ListTailInsert(&head->readyList, &item->readyNode);
+            item->ready = TRUE;
+        }
+        LOS_SpinUnlock(&head->lock);
+    }
+    LOS_SpinUnlockRestore(&watch->lock, intSave);
+}
+
+STATIC VOID EpollItemRemove(EpollHead *head, EpollItem *item)
+{
+    struct EpollWatch *watch = item->watch;
+    UINT32 intSave;
+
+    if (watch != NULL) {
+        LOS_SpinLockSave(&watch->lock, &intSave);
+        LOS_SpinLock(&head->lock);
+        if (!item->dead) {
+            LOS_ListDelete(&item->watchNode);
+        }
+        if (item->ready) {
+            LOS_ListDelete(&item->readyNode);
+        }
+        LOS_SpinUnlock(&head->lock);
+        LOS_SpinUnlockRestore(&watch->lock, intSave);
+        if (watch->ops->drop != NULL) {
+            watch->ops->drop(watch);
+        }
+    } else {
+        LOS_ListDelete(&item->readyNode);
+        head->pollCount--;
+        head->pollDirty = TRUE;
+    }
+
+    if (item->nested) {
+        head->nestCount--;
+    }
+    LOS_ListDelete(&item->hashNode);
+    free(item);
+}
+
+/*
+ * Sources that are not sockets do not tell us when their fd is closed, so check that the
+ * fd still refers to the file that was added. A recycled fd must not inherit the item.
+ */
+STATIC BOOL EpollItemClosed(const EpollItem *item)
+{
+    struct file *filep = NULL;
+
+    if (item->dead) {
+        return TRUE;
+    }
+#ifdef LOSCFG_NET_LWIP_SACK
+    if (item->sysFd >= CONFIG_NFILE_DESCRIPTORS) {
+        return FALSE; /* sockets detach their watch on final close */
+    }
+#endif
+    if (fs_getfilep(item->sysFd, &filep) < 0) {
+        return TRUE;
+    }
+
+    return (filep->f_magicnum != item->fileMagic);
+}
+
+STATIC EpollItem *EpollItemFind(EpollHead *head, int sysFd)
+{
+    EpollItem *item = NULL;
+
+    LOS_DL_LIST_FOR_EACH_ENTRY(item, &head->hash[EPOLL_HASH(sysFd)], EpollItem, hashNode) {
+        if (item->sysFd != sysFd) {
+            continue;
+        }
+        if (EpollItemClosed(item)) {
+            /* the fd number has been recycled since the old source was closed */
+            EpollItemRemove(head, item);
+            return NULL;
+        }
+        return item;
+    }
+
+    return NULL;
+}
+
+STATIC EpollHead *EpollHeadGet(int sysFd, int *err)
+{
+    struct file *filep = NULL;
+
+    if (fs_getfilep(sysFd, &filep) < 0) {
+        *err = -EBADF;
+        return NULL;
+    }
+    if (filep->ops != &g_epollFops) {
+        *err = -EINVAL;
+        return NULL;
+    }
+
+    return (EpollHead *)AnonFileGet(filep);
+}
+
+STATIC int EpollSourceGet(EpollHead *head, int sysFd, struct EpollWatch **watch, UINT32 *fileMagic,
+                          BOOL *nested)
+{
+    struct file *filep = NULL;
+    struct AnonFile *anon = NULL;
+    const EpollHead *target = NULL;
+
+#ifdef LOSCFG_NET_LWIP_SACK
+    if ((sysFd >= CONFIG_NFILE_DESCRIPTORS) && (sysFd < FD_SETSIZE)) {
+        *watch = socks_epoll_watch(sysFd);
+        return (*watch != NULL) ? LOS_OK : -EBADF;
+    }
+#endif
+
+    if (fs_getfilep(sysFd, &filep) < 0) {
+        return -EBADF;
+    }
+    *fileMagic = filep->f_magicnum;
+#ifndef CONFIG_DISABLE_POLL
+    if ((filep->ops == NULL) || (filep->ops->poll == NULL)) {
+        return -EPERM;
+    }
+#else
+    return -EPERM;
+#endif
+
+    anon = AnonFileGet(filep);
+    if (anon == NULL) {
+        /* only files whose driver has no readiness hook fall back to poll() */
+        *watch = EpollDriverWatch(filep);
+        return LOS_OK;
+    }
+    if (anon->watch.ops == NULL) {
+        return LOS_OK;
+    }
+
+    if (filep->ops == &g_epollFops) {
+        /* only one level of nesting is allowed, which rules out loops */
+        target = (const EpollHead *)anon;
+        if ((target->nestCount != 0) || !EpollWatchIdle(&head->anon.watch)) {
+            return -ELOOP;
+        }
+        *nested = TRUE;
+    }
+    *watch = &anon->watch;
+
+    return LOS_OK;
+}
+
+STATIC int EpollItemAdd(EpollHead *head, int sysFd, const struct epoll_event *event)
+{
+    struct EpollWatch *watch = NULL;
+    EpollItem *item = NULL;
+    BOOL nested = FALSE;
+    UINT32 fileMagic = 0;
+    UINT32 intSave;
+    int ret;
+
+    ret = EpollSourceGet(head, sysFd, &watch, &fileMagic, &nested);
+    if (ret != LOS_OK) {
+        return ret;
+    }
+
+    item = (EpollItem *)zalloc(sizeof(EpollItem));
+    if (item == NULL) {
+        return -ENOMEM;
+    }
+    item->head = head;
+    item->watch = watch;
+    item->sysFd = sysFd;
+    item->fileMagic = fileMagic;
+    item->event = *event;
+    item->nested = nested;
+    LOS_ListTailInsert(&head->hash[EPOLL_HASH(sysFd)], &item->hashNode);
+    if (nested) {
+        head->nestCount++;
+    }
+
+    if (watch == NULL) {
+        LOS_ListTailInsert(&head->pollList, &item->readyNode);
+        head->pollCount++;
+        head->pollDirty = TRUE;
+        return LOS_OK;
+    }
+
+    if (watch->ops->hold != NULL) {
+        watch->ops->hold(watch);
+    }
+    LOS_SpinLockSave(&watch->lock, &intSave);
+    LOS_ListTailInsert(&watch->itemList, &item->watchNode);
+    LOS_SpinUnlockRestore(&watch->lock, intSave);
+
+    /* the source may already be ready, notifications only report later changes */
+    if (EpollItemQueue(item, watch->ops->getEvents(watch))) {
+        EpollHeadWake(head);
+    }
+
+    return LOS_OK;
+}
+
+STATIC int EpollItemModify(EpollHead *head, EpollItem *item, const struct epoll_event *event)
+{
+    struct EpollWatch *watch = item->watch;
+    UINT32 intSave;
+
+    LOS_SpinLockSave(&head->lock, &intSave);
+    item->event = *event;
+    item->revents = 0;
+    item->lastEvents = 0;
+    item->disabled = FALSE;
+    LOS_SpinUnlockRestore(&head->lock, intSave);
+
+    if (watch == NULL) {
+        head->pollDirty = TRUE;
+    } else if (EpollItemQueue(item, watch->ops->getEvents(watch))) {
+        EpollHeadWake(head);
+    }
+
+    return LOS_OK;
+}
+
+int EpollCtl(int epSysFd, int op, int sysFd, const struct epoll_event *event)
+{
+    EpollHead *head = NULL;
+    EpollItem *item = NULL;
+    int ret = -EBADF;
+
+    head = EpollHeadGet(epSysFd, &ret);
+    if (head == NULL) {
+        return ret;
+    }
+    if (sysFd == epSysFd) {
+        return -EINVAL;
+    }
+    if ((op != EPOLL_CTL_DEL) && (event == NULL)) {
+        return -EFAULT;
+    }
+
+    (VOID)LOS_MuxLock(&head->mux, LOS_WAIT_FOREVER);
+    item = EpollItemFind(head, sysFd);
+    switch (op) {
+        case EPOLL_CTL_ADD:
+            ret = (item != NULL) ? -EEXIST : EpollItemAdd(head, sysFd, event);
+            break;
+        case EPOLL_CTL_MOD:
+            ret = (item == NULL) ? -ENOENT : EpollItemModify(head, item, event);
+            break;
+        case EPOLL_CTL_DEL:
+            if (item == NULL) {
+                ret = -ENOENT;
+                break;
+            }
+            EpollItemRemove(head, item);
+            ret = LOS_OK;
+            break;
+        default:
+            ret = -EINVAL;
+            break;
+    }
+    (VOID)LOS_MuxUnlock(&head->mux);
+
+    return ret;
+}
+
+STATIC VOID EpollReport(EpollItem *item, UINT32 events, struct epoll_event *out)
+{
+    out->events = events;
+    out->data = item->event.data;
+}
+
+/* Move the items left on the local list back to the ready list, keeping their order. */
+STATIC VOID EpollRequeue(EpollHead *head, LOS_DL_LIST *list)
+{
+    EpollItem *item = NULL;
+    UINT32 intSave;
+
+    LOS_SpinLockSave(&head->lock, &intSave);
+    while (!LOS_ListEmpty(list)) {
+        item = LOS_DL_LIST_ENTRY(list->pstNext, EpollItem, readyNode);
+        LOS_ListDelete(&item->readyNode);
+        LOS_ListTailInsert(&head->readyList, &item->readyNode);
+    }
+    LOS_SpinUnlockRestore(&head->lock, intSave);
+}
+
+/*
+ * Walk the ready list once. Level triggered items that are still ready go back to the tail,
+ * so the cost is proportional to the number of ready sources and busy ones can not starve
+ * the others.
+ */
+STATIC int EpollHarvestReady(EpollHead *head, struct epoll_event *events, int maxEvents)
+{
+    LOS_DL_LIST requeue;
+    EpollItem *item = NULL;
+    UINT32 intSave;
+    UINT32 revents;
+    int count = 0;
+
+    LOS_ListInit(&requeue);
+    while (count < maxEvents) {
+        LOS_SpinLockSave(&head->lock, &intSave);
+        if (LOS_ListEmpty(&head->readyList)) {
+            LOS_SpinUnlockRestore(&head->lock, intSave);
+            break;
+        }
+        item = LOS_DL_LIST_ENTRY(head->readyList.pstNext, EpollItem, readyNode);
+        LOS_ListDelete(&item->readyNode);
+        item->ready = FALSE;
+        item->revents = 0;
+        LOS_SpinUnlockRestore(&head->lock, intSave);
+
+        if (EpollItemClosed(item)) {
+            EpollItemRemove(head, item);
+            continue;
+        }
+
+        revents = item->watch->ops->getEvents(item->watch) & (item->event.events | EPOLL_ALWAYS_EVENTS);
+        if (revents == 0) {
+            continue;
+        }
+
+        LOS_SpinLockSave(&head->lock, &intSave);
+        if (item->disabled) {
+            LOS_SpinUnlockRestore(&head->lock, intSave);
+            continue;
+        }
+        EpollReport(item, revents, &events[count++]);
+        if (item->event.events & EPOLLONESHOT) {
+            item->disabled = TRUE;
+        } else if (!(item->event.events & EPOLLET) && !item->ready) {
+            LOS_ListTailInsert(&requeue, &item->readyNode);
+            item->ready = TRUE;
+        }
+        LOS_SpinUnlockRestore(&head->lock, intSave);
+    }
+    EpollRequeue(head, &requeue);
+
+    return count;
+}
+
+STATIC int EpollPollArrayBuild(EpollHead *head)
+{
+    EpollItem *item = NULL;
+    struct pollfd *pollFds = NULL;
+    VOID **pollItems = NULL;
+    UINT32 index = 0;
+
+    if (!head->pollDirty) {
+        return LOS_OK;
+    }
+
+    if (head->pollCount > head->pollCap) {
+        pollFds = (struct pollfd *)malloc(sizeof(struct pollfd) * head->pollCount);
+        pollItems = (VOID **)malloc(sizeof(VOID *) * head->pollCount);
+        if ((pollFds == NULL) || (pollItems == NULL)) {
+            free(pollFds);
+            free(pollItems);
+            return -ENOMEM;
+        }
+        free(head->pollFds);
+        free(head->pollItems);
+        head->pollFds = pollFds;
+        head->pollItems = pollItems;
+        head->pollCap = head->pollCount;
+    }
+
+    LOS_DL_LIST_FOR_EACH_ENTRY(item, &head->pollList, EpollItem, readyNode) {
+        head->pollFds[index].fd = item->sysFd;
+        head->pollFds[index].events = (short)(item->event.events & ~EPOLL_CTRL_EVENTS);
+        head->pollFds[index].revents = 0;
+        head->pollItems[index] = item;
+        index++;
+    }
+    head->pollDirty = FALSE;
+
+    return LOS_OK;
+}
+
+/* Drop the unhooked items whose fd has been closed, poll() would report the fd's new file. */
+STATIC VOID EpollPollPrune(EpollHead *head)
+{
+    EpollItem *item = NULL;
+    EpollItem *next = NULL;
+
+    LOS_DL_LIST_FOR_EACH_ENTRY_SAFE(item, next, &head->pollList, EpollItem, readyNode) {
+        if (EpollItemClosed(item)) {
+            EpollItemRemove(head, item);
+        }
+    }
+}
+
+/*
+ * Sources without a watch are checked with a zero timeout poll on every harvest. These are only
+ * the files of drivers that registered no readiness hook, such as pipes.
+ */
+STATIC int EpollHarvestPolled(EpollHead *head, struct epoll_event *events, int count, int maxEvents)
+{
+    EpollItem *item = NULL;
+    UINT32 revents;
+    UINT32 pollCount;
+    UINT32 index;
+
+    if ((head->pollCount == 0) || (count >= maxEvents)) {
+        return count;
+    }
+    EpollPollPrune(head);
+    if ((head->pollCount == 0) || (EpollPollArrayBuild(head) != LOS_OK)) {
+        return count;
+    }
+
+    pollCount = head->pollCount;
+    if (poll(head->pollFds, pollCount, 0) <= 0) {
+        return count;
+    }
+
+    for (index = 0; (index < pollCount) && (count < maxEvents); index++) {
+        item = (EpollItem *)head->pollItems[index];
+        revents = (UINT32)(UINT16)head->pollFds[index].revents;
+        if (revents & POLLNVAL) {
+            EpollItemRemove(head, item);
+            continue;
+        }
+        if (item->disabled) {
+            continue;
+        }
+        revents &= item->event.events | EPOLL_ALWAYS_EVENTS;
+        if (item->event.events & EPOLLET) {
+            UINT32 rising = revents & ~item->lastEvents;
+            item->lastEvents = revents;
+            revents = rising;
+        }
+        if (revents == 0) {
+            continue;
+        }
+        EpollReport(item, revents, &events[count++]);
+        if (item->event.events & EPOLLONESHOT) {
+            item->disabled = TRUE;
+        }
+    }
+
+    return count;
+}
+
+/* Sleep until a hooked source becomes ready, an unhooked one polls ready or the timeout expires. */
+STATIC int EpollBlock(EpollHead *head, int timeout)
+{
+    struct pollfd self;
+    struct pollfd *pollFds = &self;
+    UINT32 pollCount;
+    int ret;
+
+    (VOID)LOS_MuxLock(&head->mux, LOS_WAIT_FOREVER);
+    EpollPollPrune(head);
+    pollCount = head->pollCount;
+    if ((pollCount != 0) && (EpollPollArrayBuild(head) == LOS_OK)) {
+        pollFds = (struct pollfd *)malloc(sizeof(struct pollfd) * (pollCount + 1));
+        if (pollFds == NULL) {
+            (VOID)LOS_MuxUnlock(&head->mux);
+            return -ENOMEM;
+        }
+        (VOID)memcpy_s(pollFds, sizeof(struct pollfd) * pollCount,
+                       head->pollFds, sizeof(struct pollfd) * pollCount);
+    } else {
+        pollCount = 0;
+    }
+    (VOID)LOS_MuxUnlock(&head->mux);
+
+    pollFds[pollCount].fd = head->sysFd;
+    pollFds[pollCount].events = POLLIN;
+    pollFds[pollCount].revents = 0;
+    ret = poll(pollFds, pollCount + 1, timeout);
+    if (ret < 0) {
+        ret = -get_errno();
+    }
+
+    if (pollFds != &self) {
+        free(pollFds);
+    }
+
+    return ret;
+}
+
+STATIC int EpollTimeoutLeft(UINT64 start, int timeout)
+{
+    UINT64 elapsed;
+
+    if (timeout < 0) {
+        return timeout;
+    }
+
+    elapsed = (LOS_TickCountGet() - start) * OS_SYS_MS_PER_SECOND / LOSCFG_BASE_CORE_TICK_PER_SECOND;
+    return (elapsed >= (UINT64)timeout) ? 0 : (int)((UINT64)timeout - elapsed);
+}
+
+int EpollWait(int epSysFd, struct epoll_event *events, int maxEvents, int timeout)
+{
+    EpollHead *head = NULL;
+    UINT64 start = LOS_TickCountGet();
+    int ret = -EBADF;
+    int count;
+
+    head = EpollHeadGet(epSysFd, &ret);
+    if (head == NULL) {
+        return ret;
+    }
+    if ((events == NULL) || (maxEvents <= 0) || (maxEvents > EPOLL_MAX_EVENTS)) {
+        return -EINVAL;
+    }
+
+    while (TRUE) {
+        (VOID)LOS_MuxLock(&head->mux, LOS_WAIT_FOREVER);
+        count = EpollHarvestReady(head, events, maxEvents);
+        count = EpollHarvestPolled(head, events, count, maxEvents);
+        (VOID)LOS_MuxUnlock(&head->mux);
+        if (count != 0) {
+            return count;
+        }
+
+        timeout = EpollTimeoutLeft(start, timeout);
+        if (timeout == 0) {
+            return 0;
+        }
+        ret = EpollBlock(head, timeout);
+        if (ret <= 0) {
+            return ret;
+        }
+    }
+}
+
+STATIC UINT32 EpollGetEvents(struct EpollWatch *watch)
+{
+    return EpollHasReady((EpollHead *)watch) ? (POLLIN | POLLRDNORM) : 0;
+}
+
+STATIC const struct EpollWatchOps g_epollWatchOps = {
+    EpollGetEvents,
+    AnonWatchHold,
+    AnonWatchDrop,
+};
+
+STATIC VOID EpollRelease(struct AnonFile *anon)
+{
+    EpollHead *head = (EpollHead *)anon;
+
+    (VOID)LOS_MuxDestroy(&head->mux);
+    free(head->pollFds);
+    free(head->pollItems);
+    free(head);
+}
+
+int EpollCreate(int flags)
+{
+    EpollHead *head = NULL;
+    UINT32 index;
+    int sysFd;
+
+    if ((flags & ~EPOLL_CLOEXEC) != 0) {
+        return -EINVAL;
+    }
+
+    head = (EpollHead *)zalloc(sizeof(EpollHead));
+    if (head == NULL) {
+        return -ENOMEM;
+    }
+    if (LOS_MuxInit(&head->mux, NULL) != LOS_OK) {
+        free(head);
+        return -ENOMEM;
+    }
+    LOS_SpinInit(&head->lock);
+    for (index = 0; index < EPOLL_HASH_SIZE; index++) {
+        LOS_ListInit(&head->hash[index]);
+    }
+    LOS_ListInit(&head->readyList);
+    LOS_ListInit(&head->pollList);
+    init_waitqueue_head(&head->wq);
+    AnonFileInit(&head->anon, &g_epollWatchOps, EpollRelease);
+
+    sysFd = AnonFileAlloc(&g_epollFops, &head->anon, O_RDWR);
+    if (sysFd < 0) {
+        EpollRelease(&head->anon);
+        return sysFd;
+    }
+    head->sysFd = sysFd;
+
+    return sysFd;
+}
+
+STATIC int EpollClose(struct file *filep)
+{
+    EpollHead *head = (EpollHead *)AnonFileGet(filep);
+    EpollItem *item = NULL;
+    EpollItem *next = NULL;
+    UINT32 index;
+
+    if (head == NULL) {
+        return -EBADF;
+    }
+
+    EpollWatchDetach(&head->anon.watch);
+
+    (VOID)LOS_MuxLock(&head->mux, LOS_WAIT_FOREVER);
+    for (index = 0; index < EPOLL_HASH_SIZE; index++) {
+        LOS_DL_LIST_FOR_EACH_ENTRY_SAFE(item, next, &head->hash[index], EpollItem, hashNode) {
+            EpollItemRemove(head, item);
+        }
+    }
+    (VOID)LOS_MuxUnlock(&head->mux);
+
+    AnonFileDrop(&head->anon);
+    return LOS_OK;
+}
+
+#ifndef CONFIG_DISABLE_POLL
+STATIC int EpollPoll(struct file *filep, poll_table *table)
+{
+    EpollHead *head = (EpollHead *)AnonFileGet(filep);
+
+    if (head == NULL) {
+        return POLLERR;
+    }
+
+    poll_wait(filep, &head->wq, table);
+    return EpollHasReady(head) ? (POLLIN | POLLRDNORM) : 0;
+}
+#endif
@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fs_eventfd.h"
+#include "errno.h"
+#include "fcntl.h"
+#include "poll.h"
+#include "stdlib.h"
+#include "linux/wait.h"
+#include "los_event.h"
+#include "los_spinlock.h"
+#include "fs/file.h"
+#include "fs_anon.h"
+#include "fs_poll_pri.h"
+
+#define EVENTFD_EVENT_READABLE  0x01U
+#define EVENTFD_EVENT_WRITABLE  0x02U
+#define EVENTFD_COUNT_MAX       0xFFFFFFFFFFFFFFFEULL
+
+typedef struct {
+    struct AnonFile anon;   /* must be first */
+    SPIN_LOCK_S lock;
+    UINT64 count;
+    BOOL semaphore;
+    EVENT_CB_S event;       /* blocking readers and writers sleep here */
+    wait_queue_head_t wq;
+} Eventfd;
+
+STATIC UINT32 EventfdEventsLocked(const Eventfd *efd)
+{
+    UINT32 events = 0;
+
+    if (efd->count > 0) {
+        events |= POLLIN | POLLRDNORM;
+    }
+    if (efd->count < EVENTFD_COUNT_MAX) {
+        events |= POLLOUT | POLLWRNORM;
+    }
+
+    return events;
+}
+
+STATIC UINT32 EventfdGetEvents(struct EpollWatch *watch)
+{
+    Eventfd *efd = (Eventfd *)watch;
+    UINT32 intSave;
+    UINT32 events;
+
+    LOS_SpinLockSave(&efd->lock, &intSave);
+    events = EventfdEventsLocked(efd);
+    LOS_SpinUnlockRestore(&efd->lock, intSave);
+
+    return events;
+}
+
+STATIC VOID EventfdWake(Eventfd *efd, UINT32 events)
+{
+    (VOID)LOS_EventWrite(&efd->event, (events & POLLIN) ? EVENTFD_EVENT_READABLE : EVENTFD_EVENT_WRITABLE);
+    notify_poll(&efd->wq);
+    EpollWatchNotify(&efd->anon.watch, events);
+}
+
+STATIC ssize_t EventfdRead(struct file *filep, char *buffer, size_t buflen)
+{
+    Eventfd *efd = (Eventfd *)AnonFileGet(filep);
+    UINT64 value;
+    UINT32 intSave;
+    BOOL more = FALSE;
+    int ret;
+
+    if (efd == NULL) {
+        return -EBADF;
+    }
+    if (buflen < sizeof(UINT64)) {
+        return -EINVAL;
+    }
+
+    while (TRUE) {
+        LOS_SpinLockSave(&efd->lock, &intSave);
+        if (efd->count > 0) {
+            value = efd->semaphore ? 1 : efd->count;
+            efd->count -= value;
+            more = (efd->count > 0);
+            LOS_SpinUnlockRestore(&efd->lock, intSave);
+            break;
+        }
+        LOS_SpinUnlockRestore(&efd->lock, intSave);
+
+        if (filep->f_oflags & O_NONBLOCK) {
+            return -EAGAIN;
+        }
+        (VOID)LOS_EventRead(&efd->event, EVENTFD_EVENT_READABLE, LOS_WAITMODE_OR | LOS_WAITMODE_CLR,
+                            LOS_WAIT_FOREVER);
+    }
+
+    /* pass the wakeup on to the next reader when the counter is not exhausted */
+    if (more) {
+        (VOID)LOS_EventWrite(&efd->event, EVENTFD_EVENT_READABLE);
+    }
+    EventfdWake(efd, POLLOUT | POLLWRNORM);
+
+    ret = AnonFileCopyOut(buffer, &value, sizeof(UINT64));
+    return (ret != LOS_OK) ? ret : (ssize_t)sizeof(UINT64);
+}
+
+STATIC ssize_t EventfdWrite(struct file *filep, const char *buffer, size_t buflen)
+{
+    Eventfd *efd = (Eventfd *)AnonFileGet(filep);
+    UINT64 value;
+    UINT32 intSave;
+    int ret;
+
+    if (efd == NULL) {
+        return -EBADF;
+    }
+    if (buflen < sizeof(UINT64)) {
+        return -EINVAL;
+    }
+    ret = AnonFileCopyIn(&value, buffer, sizeof(UINT64));
+    if (ret != LOS_OK) {
+        return ret;
+    }
+    if (value > EVENTFD_COUNT_MAX) {
+        return -EINVAL;
+    }
+
+    while (TRUE) {
+        LOS_SpinLockSave(&efd->lock, &intSave);
+        if (value <= (EVENTFD_COUNT_MAX - efd->count)) {
+            efd->count += value;
+            LOS_SpinUnlockRestore(&efd->lock, intSave);
+            break;
+        }
+        LOS_SpinUnlockRestore(&efd->lock, intSave);
+
+        if (filep->f_oflags & O_NONBLOCK) {
+            return -EAGAIN;
+        }
+        (VOID)LOS_EventRead(&efd->event, EVENTFD_EVENT_WRITABLE, LOS_WAITMODE_OR | LOS_WAITMODE_CLR,
+                            LOS_WAIT_FOREVER);
+    }
+
+    if (value != 0) {
+        EventfdWake(efd, POLLIN | POLLRDNORM);
+    }
+
+    return (ssize_t)sizeof(UINT64);
+}
+
+#ifndef CONFIG_DISABLE_POLL
+STATIC int EventfdPoll(struct file *filep, poll_table *table)
+{
+    Eventfd *efd = (Eventfd *)AnonFileGet(filep);
+
+    if (efd == NULL) {
+        return POLLERR;
+    }
+
+    poll_wait(filep, &efd->wq, table);
+    return (int)EventfdGetEvents(&efd->anon.watch);
+}
+#endif
+
+STATIC int EventfdClose(struct file *filep)
+{
+    Eventfd *efd = (Eventfd *)AnonFileGet(filep);
+
+    if (efd == NULL) {
+        return -EBADF;
+    }
+
+    EpollWatchDetach(&efd->anon.watch);
+    AnonFileDrop(&efd->anon);
+    return LOS_OK;
+}
+
+STATIC VOID EventfdRelease(struct AnonFile *anon)
+{
+    Eventfd *efd = (Eventfd *)anon;
+
+    (VOID)LOS_EventDestroy(&efd->event);
+    free(efd);
+}
+
+STATIC const struct file_operations_vfs g_eventfdFops = {
+    NULL,           /* open */
+    EventfdClose,   /* close */
+    EventfdRead,    /* read */
+    EventfdWrite,   /* write */
+    NULL,           /* seek */
+    NULL,           /* ioctl */
+    NULL,           /* mmap */
+#ifndef CONFIG_DISABLE_POLL
+    EventfdPoll,    /* poll */
+#endif
+    NULL,           /* unlink */
+};
+
+STATIC const struct EpollWatchOps g_eventfdWatchOps = {
+    EventfdGetEvents,
+    AnonWatchHold,
+    AnonWatchDrop,
+};
+
+int EventfdCreate(unsigned int initval, int flags)
+{
+    Eventfd *efd = NULL;
+    int sysFd;
+
+    if ((flags & ~(EFD_SEMAPHORE | EFD_NONBLOCK | EFD_CLOEXEC)) != 0) {
+        return -EINVAL;
+    }
+
+    efd = (Eventfd *)zalloc(sizeof(Eventfd));
+    if (efd == NULL) {
+        return -ENOMEM;
+    }
+    if (LOS_EventInit(&efd->event) != LOS_OK) {
+        free(efd);
+        return -ENOMEM;
+    }
+    LOS_SpinInit(&efd->lock);
+    efd->count = initval;
+    efd->semaphore = (flags & EFD_SEMAPHORE) ? TRUE : FALSE;
+    init_waitqueue_head(&efd->wq);
+    AnonFileInit(&efd->anon, &g_eventfdWatchOps, EventfdRelease);
+
+    sysFd = AnonFileAlloc(&g_eventfdFops, &efd->anon, O_RDWR | (flags & EFD_NONBLOCK));
+    if (sysFd < 0) {
+        EventfdRelease(&efd->anon);
+    }
+
+    return sysFd;
+}
@@ -32,6 +32,8 @@
 #include "fs/file.h"
 #include "fs/fs.h"
 #include "fs/fs_operation.h"
+#include "fs/mount.h"
+#include "fs/vnode.h"
 #include "unistd.h"
 #include "los_mux.h"
 #include "los_list.h"
@@ -42,6 +44,24 @@
 
 static struct file_map g_file_mapping = {0};
 
+/*
+ * A batch of mappings one task writes back with g_file_mapping.lock dropped. Each holds a
+ * reference on its mapping; one removed by remove_mapping meanwhile is off the list already
+ * and is freed by the last batch that holds it.
+ */
+typedef struct {
+    struct page_mapping *mapping;
+    BOOL removed;
+} FileMapPin;
+
+typedef struct {
+    LOS_DL_LIST node; /* on g_file_map_wb while the batch is written back */
+    FileMapPin *pin;
+    UINT32 count;
+} FileMapWriteback;
+
+static LOS_DL_LIST_HEAD(g_file_map_wb);
+
 uint init_file_mapping()
 {
     uint ret;
@@ -136,6 +156,36 @@ out:
     (VOID)LOS_MuxUnlock(&g_file_mapping.lock);
 }
 
+static void free_mapping_nolock(struct page_mapping *mapping)
+{
+    struct file_map *fmap = LOS_DL_LIST_ENTRY(mapping, struct file_map, mapping);
+
+    (VOID)LOS_MuxDestroy(&mapping->mux_lock);
+    OsFileCacheRemove(mapping);
+    if (fmap->rename) {
+        LOS_MemFree(m_aucSysMem0, fmap->rename);
+    }
+    LOS_MemFree(m_aucSysMem0, fmap);
+}
+
+/* mark mapping removed in the batches being written back, TRUE if there was one */
+static BOOL unpin_removed_nolock(const struct page_mapping *mapping)
+{
+    FileMapWriteback *wb = NULL;
+    BOOL pinned = FALSE;
+    UINT32 i;
+
+    LOS_DL_LIST_FOR_EACH_ENTRY(wb, &g_file_map_wb, FileMapWriteback, node) {
+        for (i = 0; i < wb->count; i++) {
+            if (wb->pin[i].mapping == mapping) {
+                wb->pin[i].removed = TRUE;
+                pinned = TRUE;
+            }
+        }
+    }
+    return pinned;
+}
+
 int remove_mapping_nolock(struct page_mapping *mapping)
 {
     struct file_map *fmap = NULL;
@@ -145,15 +195,12 @@ int remove_mapping_nolock(struct page_mapping *mapping)
         return EINVAL;
     }
 
-    (VOID)LOS_MuxDestroy(&mapping->mux_lock);
     clear_file_mapping(mapping);
-    OsFileCacheRemove(mapping);
     fmap = LOS_DL_LIST_ENTRY(mapping, struct file_map, mapping);
     LOS_ListDelete(&fmap->head);
-    if (fmap->rename) {
-        LOS_MemFree(m_aucSysMem0, fmap->rename);
+    if (!unpin_removed_nolock(mapping)) {
+        free_mapping_nolock(mapping);
     }
-    LOS_MemFree(m_aucSysMem0, fmap);
 
     return OK;
 }
@@ -178,6 +225,117 @@ void dec_mapping_nolock(struct page_mapping *mapping)
     (VOID)LOS_MuxUnlock(&g_file_mapping.lock);
 }
 
+/* the disk the file of mapping is on, -1 if it is not on one */
+static int mapping_disk(const struct page_mapping *mapping)
+{
+    struct file *host = mapping->host;
+
+    if ((host == NULL) || (host->f_vnode == NULL) || (host->f_vnode->originMount == NULL)) {
+        return -1;
+    }
+    return host->f_vnode->originMount->diskId;
+}
+
+/*
+ * Pin the mappings of the files on disk: take a reference on each and put the batch on
+ * g_file_map_wb, so that the lock can be dropped while they are written back.
+ */
+static UINT32 pin_file_mappings(int disk, FileMapWriteback *wb)
+{
+    struct file_map *fmap = NULL;
+    UINT32 count = 0;
+
+    wb->pin = NULL;
+    wb->count = 0;
+    (VOID)LOS_MuxLock(&g_file_mapping.lock, LOS_WAIT_FOREVER);
+    LOS_DL_LIST_FOR_EACH_ENTRY(fmap, &g_file_mapping.head, struct file_map, head) {
+        if ((LOS_AtomicRead(&fmap->mapping.ref) > 0) && (mapping_disk(&fmap->mapping) == disk)) {
+            count++;
+        }
+    }
+    if (count != 0) {
+        wb->pin = (FileMapPin *)LOS_MemAlloc(m_aucSysMem0, count * sizeof(FileMapPin));
+    }
+    if (wb->pin == NULL) {
+        (VOID)LOS_MuxUnlock(&g_file_mapping.lock);
+        return 0;
+    }
+    LOS_DL_LIST_FOR_EACH_ENTRY(fmap, &g_file_mapping.head, struct file_map, head) {
+        if ((LOS_AtomicRead(&fmap->mapping.ref) > 0) && (mapping_disk(&fmap->mapping) == disk)) {
+            LOS_AtomicInc(&fmap->mapping.ref);
+            wb->pin[wb->count].mapping = &fmap->mapping;
+            wb->pin[wb->count].removed = FALSE;
+            wb->count++;
+        }
+    }
+    LOS_ListTailInsert(&g_file_map_wb, &wb->node);
+    (VOID)LOS_MuxUnlock(&g_file_mapping.lock);
+    return wb->count;
+}
+
+static void unpin_file_mappings(FileMapWriteback *wb)
+{
+    struct page_mapping *mapping = NULL;
+    UINT32 i;
+
+    (VOID)LOS_MuxLock(&g_file_mapping.lock, LOS_WAIT_FOREVER);
+    LOS_ListDelete(&wb->node);
+    for (i = 0; i < wb->count; i++) {
+        mapping = wb->pin[i].mapping;
+        if (wb->pin[i].removed) {
+            /* off the list already, the last batch that holds it frees it */
+            if (!unpin_removed_nolock(mapping)) {
+                free_mapping_nolock(mapping);
+            }
+            continue;
+        }
+        LOS_AtomicDec(&mapping->ref);
+        if (LOS_AtomicRead(&mapping->ref) <= 0) {
+            (VOID)remove_mapping_nolock(mapping);
+        }
+    }
+    (VOID)LOS_MuxUnlock(&g_file_mapping.lock);
+    LOS_MemFree(m_aucSysMem0, wb->pin);
+}
+
+/*
+ * Write back the dirty page cache of the files on disk, called by the sync task of the disk
+ * and by writers over the hard limit. No lock is held while the pages are written.
+ */
+void flush_file_mappings(int disk)
+{
+    FileMapWriteback wb;
+    UINT32 i;
+
+    if (pin_file_mappings(disk, &wb) == 0) {
+        return;
+    }
+    for (i = 0; i < wb.count; i++) {
+        OsFileCacheFlush(wb.pin[i].mapping);
+    }
+    unpin_file_mappings(&wb);
+}
+
+/*
+ * Called after a write(2) to filep. Over the hard limit of dirty file pages the writer writes
+ * back the page cache of its disk, so it is paced like a task dirtying a shared mapping.
+ */
+void balance_file_mappings(struct file *filep)
+{
+    int disk;
+
+    if ((filep == NULL) || !OsFileCacheOverHardLimit()) {
+        return;
+    }
+    disk = ((filep->f_vnode != NULL) && (filep->f_vnode->originMount != NULL)) ?
+        filep->f_vnode->originMount->diskId : -1;
+    if (disk >= 0) {
+        flush_file_mappings(disk);
+    } else if (filep->f_mapping != NULL) {
+        OsFileCacheFlush(filep->f_mapping);
+    }
+}
+
 int remove_mapping(const char *fullpath)
 {
     int ret;
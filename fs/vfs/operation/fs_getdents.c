@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fs_getdents.h"
+#include "errno.h"
+#include "stddef.h"
+#include "dirent.h"
+#include "limits.h"
+#include "string.h"
+#include "los_memory.h"
+#include "user_copy.h"
+#include "fs/file.h"
+#include "fs/dirent_fs.h"
+#include "fs/vnode.h"
+
+#define GETDENTS_ALIGN(len)     (((len) + 7) & ~(size_t)7) /* records start 8 byte aligned */
+#define GETDENTS_DT_SHIFT       12 /* DT_x << 12 is the S_IFx of the same file type */
+
+STATIC size_t GetdentsRecLen(size_t nameLen, BOOL withStat)
+{
+    size_t head = withStat ? offsetof(struct dirent_plus, d_name) : offsetof(struct dirent, d_name);
+
+    return GETDENTS_ALIGN(head + nameLen + 1);
+}
+
+/*
+ * Attributes of an entry, from its vnode: a cached one, or one the file system looks up as stat()
+ * would. Only when that fails does the entry get what Readdir returned. The caller holds the
+ * vnode lock.
+ */
+STATIC VOID GetdentsStat(struct Vnode *dir, const struct dirent *de, size_t len, struct stat *st)
+{
+    struct Vnode *vnode = NULL;
+    const char *name = de->d_name;
+
+    if ((len == 1) && (name[0] == '.')) {
+        vnode = dir;
+    } else if ((len == 2) && (name[0] == '.') && (name[1] == '.')) { /* 2: length of ".." */
+        vnode = (dir->parent != NULL) ? dir->parent : dir;
+    } else if ((len > NAME_MAX) || (VnodeLookupAt(dir, name, (uint8_t)len, &vnode) != LOS_OK)) {
+        vnode = NULL;
+    }
+
+    if ((vnode != NULL) && (vnode->vop != NULL) && (vnode->vop->Getattr != NULL) &&
+        (vnode->vop->Getattr(vnode, st) == LOS_OK)) {
+        return;
+    }
+    (VOID)memset_s(st, sizeof(struct stat), 0, sizeof(struct stat));
+    st->st_ino = de->d_ino;
+    st->st_mode = (mode_t)de->d_type << GETDENTS_DT_SHIFT;
+}
+
+/* Pack cnt entries read by the file system into buf, returns the bytes used */
+STATIC size_t GetdentsPack(struct Vnode *dir, const struct fs_dirent_s *idir, int cnt, char *buf, BOOL withStat)
+{
+    const struct dirent *de = NULL;
+    struct dirent_plus *dp = NULL;
+    struct dirent *out = NULL;
+    size_t used = 0;
+    size_t nameLen;
+    size_t recLen;
+    int i;
+
+    for (i = 0; i < cnt; i++) {
+        de = &idir->fd_dir[i];
+        nameLen = strnlen(de->d_name, sizeof(de->d_name) - 1);
+        recLen = GetdentsRecLen(nameLen, withStat);
+        (VOID)memset_s(buf + used, recLen, 0, recLen);
+        if (withStat) {
+            dp = (struct dirent_plus *)(buf + used);
+            GetdentsStat(dir, de, nameLen, &dp->d_stat);
+            dp->d_ino = de->d_ino;
+            dp->d_off = de->d_off;
+            dp->d_reclen = (unsigned short)recLen;
+            dp->d_type = de->d_type;
+            (VOID)memcpy_s(dp->d_name, nameLen + 1, de->d_name, nameLen);
+        } else {
+            out = (struct dirent *)(buf + used);
+            out->d_ino = de->d_ino;
+            out->d_off = de->d_off;
+            out->d_reclen = (unsigned short)recLen;
+            out->d_type = de->d_type;
+            (VOID)memcpy_s(out->d_name, nameLen + 1, de->d_name, nameLen);
+        }
+        used += recLen;
+    }
+    return used;
+}
+
+ssize_t GetdentsFill(int sysFd, VOID *userBuf, size_t count, BOOL withStat)
+{
+    struct file *filep = NULL;
+    struct fs_dirent_s *idir = NULL;
+    struct Vnode *dir = NULL;
+    size_t maxRec = GetdentsRecLen(NAME_MAX, withStat);
+    size_t batch;
+    size_t filled = 0;
+    size_t used;
+    char *buf = NULL;
+    ssize_t ret = 0;
+    int cnt;
+
+    if (count < maxRec) {
+        return -EINVAL;
+    }
+    if (fs_getfilep(sysFd, &filep) < 0) {
+        return -EBADF;
+    }
+    idir = (struct fs_dirent_s *)filep->f_dir;
+    if ((idir == NULL) || (idir->fd_root == NULL)) {
+        return -ENOTDIR;
+    }
+    dir = idir->fd_root;
+    if ((dir->vop == NULL) || (dir->vop->Readdir == NULL)) {
+        return -ENOSYS;
+    }
+
+    batch = sizeof(idir->fd_dir) / sizeof(idir->fd_dir[0]);
+    buf = (char *)LOS_MemAlloc(m_aucSysMem0, batch * maxRec);
+    if (buf == NULL) {
+        return -ENOMEM;
+    }
+
+    /*
+     * Only as many entries are asked for as surely fit, the file system cannot give any back. The
+     * vnode lock is taken once per batch for the lookups, and dropped before the copy to the user.
+     */
+    while ((count - filled) >= maxRec) {
+        idir->read_cnt = (int)((((count - filled) / maxRec) < batch) ? ((count - filled) / maxRec) : batch);
+        (VOID)VnodeHold();
+        cnt = dir->vop->Readdir(dir, idir);
+        if (cnt <= 0) {
+            (VOID)VnodeDrop();
+            ret = cnt;
+            break;
+        }
+        used = GetdentsPack(dir, idir, cnt, buf, withStat);
+        (VOID)VnodeDrop();
+        if (LOS_ArchCopyToUser((char *)userBuf + filled, buf, used) != 0) {
+            ret = -EFAULT;
+            break;
+        }
+        filled += used;
+        if (cnt < idir->read_cnt) {
+            break; /* end of the directory */
+        }
+    }
+
+    (VOID)LOS_MemFree(m_aucSysMem0, buf);
+    if ((ret == -EFAULT) || (filled == 0)) {
+        return ret;
+    }
+    return (ssize_t)filled;
+}
@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fs_pktring.h"
+#include "errno.h"
+#include "fcntl.h"
+#include "stdlib.h"
+#include "securec.h"
+#include "los_base.h"
+#include "los_hw_cpu.h"
+#include "los_mux.h"
+#include "los_spinlock.h"
+#include "los_vm_map.h"
+#include "los_vm_page.h"
+#include "los_vm_phys.h"
+#include "los_vm_common.h"
+#include "los_arch_mmu.h"
+#include "fs/file.h"
+#include "fs_anon.h"
+
+typedef struct {
+    CHAR *base;                     /* page backed, shared with the user mapping */
+    size_t size;
+    UINT32 blockSize;
+    UINT32 frameSize;
+    UINT32 framesPerBlock;
+    UINT32 frameNr;
+    UINT32 head;                    /* next frame the kernel claims */
+} PktRingArea;
+
+struct PktRing {
+    struct AnonFile anon;           /* must be first */
+    struct page_mapping mapping;    /* lets the file fault path map ring pages into the owner */
+    SPIN_LOCK_S lock;               /* protects the area heads and the drop accounting */
+    PktRingArea area[PKTRING_DIRS];
+    BOOL mapped;                    /* the layout is fixed once user space has mapped it */
+    BOOL losing;                    /* an rx packet was dropped since the last frame was handed over */
+    UINT32 drops;
+};
+
+STATIC struct tpacket_hdr *PktRingFrame(const PktRingArea *area, UINT32 index)
+{
+    return (struct tpacket_hdr *)(area->base + ((index / area->framesPerBlock) * area->blockSize) +
+                                  ((index % area->framesPerBlock) * area->frameSize));
+}
+
+STATIC VOID *PktRingPageKVaddr(const struct PktRing *ring, VM_OFFSET_T pgoff)
+{
+    UINT32 dir;
+
+    for (dir = 0; dir < PKTRING_DIRS; dir++) {
+        if (pgoff < (ring->area[dir].size >> PAGE_SHIFT)) {
+            return ring->area[dir].base + (pgoff << PAGE_SHIFT);
+        }
+        pgoff -= ring->area[dir].size >> PAGE_SHIFT;
+    }
+    return NULL;
+}
+
+STATIC INT32 PktRingVmFault(LosVmMapRegion *region, LosVmPgFault *vmf)
+{
+    struct PktRing *ring = (struct PktRing *)AnonFileGet(region->unTypeData.rf.file);
+    VOID *kvaddr = NULL;
+
+    if (ring == NULL) {
+        return LOS_NOK;
+    }
+    kvaddr = PktRingPageKVaddr(ring, vmf->pgoff);
+    if (kvaddr == NULL) {
+        return LOS_NOK;
+    }
+
+    /* the fault path takes a page reference for the new mapping, PktRingVmRemove drops it */
+    vmf->pageKVaddr = (VADDR_T *)kvaddr;
+    return LOS_OK;
+}
+
+STATIC VOID PktRingVmRemove(LosVmMapRegion *region, LosArchMmu *archMmu, VM_OFFSET_T pgoff)
+{
+    VADDR_T vaddr = region->range.base + ((UINT32)(pgoff - region->pgOff) << PAGE_SHIFT);
+    PADDR_T paddr;
+
+    if (LOS_ArchMmuQuery(archMmu, vaddr, &paddr, NULL) != LOS_OK) {
+        return;
+    }
+    (VOID)LOS_ArchMmuUnmap(archMmu, vaddr, 1);
+    LOS_PhysPageFree(LOS_VmPageGet(paddr));
+}
+
+STATIC const LosVmFileOps g_pktRingVmOps = {
+    .open = NULL,
+    .close = NULL,
+    .fault = PktRingVmFault,
+    .remove = PktRingVmRemove,
+};
+
+STATIC int PktRingMmap(struct file *filep, LosVmMapRegion *region)
+{
+    struct PktRing *ring = (struct PktRing *)AnonFileGet(filep);
+    UINT32 pages = region->range.size >> PAGE_SHIFT;
+    UINT32 intSave;
+
+    if (ring == NULL) {
+        return -EBADF;
+    }
+    /* frames change hands through tp_status, a private copy would never see them */
+    if (!(region->regionFlags & VM_MAP_REGION_FLAG_SHARED)) {
+        return -EINVAL;
+    }
+    if ((PktRingPageKVaddr(ring, region->pgOff) == NULL) ||
+        (PktRingPageKVaddr(ring, region->pgOff + pages - 1) == NULL)) {
+        return -EINVAL;
+    }
+
+    LOS_SpinLockSave(&ring->lock, &intSave);
+    ring->mapped = TRUE;
+    LOS_SpinUnlockRestore(&ring->lock, intSave);
+
+    LOS_SetRegionTypeFile(region);
+    region->unTypeData.rf.vmFOps = &g_pktRingVmOps;
+    region->unTypeData.rf.file = filep;
+    region->unTypeData.rf.fileMagic = filep->f_magicnum;
+    return LOS_OK;
+}
+
+STATIC int PktRingClose(struct file *filep)
+{
+    struct PktRing *ring = (struct PktRing *)AnonFileGet(filep);
+
+    if (ring == NULL) {
+        return -EBADF;
+    }
+
+    /* mapped pages keep their own references, later faults on the mapping fail */
+    filep->f_mapping = NULL;
+    AnonFileDrop(&ring->anon);
+    return LOS_OK;
+}
+
+STATIC VOID PktRingRelease(struct AnonFile *anon)
+{
+    struct PktRing *ring = (struct PktRing *)anon;
+    UINT32 dir;
+
+    for (dir = 0; dir < PKTRING_DIRS; dir++) {
+        if (ring->area[dir].base != NULL) {
+            LOS_VFree(ring->area[dir].base);
+        }
+    }
+    (VOID)LOS_MuxDestroy(&ring->mapping.mux_lock);
+    free(ring);
+}
+
+STATIC const struct file_operations_vfs g_pktRingFops = {
+    NULL,           /* open */
+    PktRingClose,   /* close */
+    NULL,           /* read */
+    NULL,           /* write */
+    NULL,           /* seek */
+    NULL,           /* ioctl */
+    PktRingMmap,    /* mmap */
+#ifndef CONFIG_DISABLE_POLL
+    NULL,           /* poll, readiness is reported by the owner */
+#endif
+    NULL,           /* unlink */
+};
+
+int PktRingCreate(struct PktRing **ringp)
+{
+    struct PktRing *ring = NULL;
+    struct file *filep = NULL;
+    int sysFd;
+
+    ring = (struct PktRing *)zalloc(sizeof(struct PktRing));
+    if (ring == NULL) {
+        return -ENOMEM;
+    }
+    (VOID)LOS_MuxInit(&ring->mapping.mux_lock, NULL);
+    LOS_ListInit(&ring->mapping.page_list);
+    LOS_SpinInit(&ring->mapping.list_lock);
+    LOS_AtomicSet(&ring->mapping.ref, 1);
+    LOS_SpinInit(&ring->lock);
+    AnonFileInit(&ring->anon, NULL, PktRingRelease);
+
+    sysFd = AnonFileAlloc(&g_pktRingFops, &ring->anon, O_RDWR);
+    if (sysFd < 0) {
+        PktRingRelease(&ring->anon);
+        return sysFd;
+    }
+    if (fs_getfilep(sysFd, &filep) == 0) {
+        filep->f_mapping = &ring->mapping;
+        ring->mapping.host = filep;
+    }
+
+    *ringp = ring;
+    return sysFd;
+}
+
+int PktRingSetup(struct PktRing *ring, UINT32 dir, const struct tpacket_req *req)
+{
+    PktRingArea area;
+    UINT32 intSave;
+
+    if ((dir >= PKTRING_DIRS) || (req->tp_block_size == 0) || (req->tp_block_size % PAGE_SIZE) ||
+        (req->tp_frame_size < TPACKET_ALIGN(sizeof(struct tpacket_hdr))) ||
+        (req->tp_frame_size % TPACKET_ALIGNMENT) || (req->tp_frame_size > req->tp_block_size) ||
+        (req->tp_block_nr == 0) || (req->tp_block_nr > (PKTRING_SIZE_MAX / req->tp_block_size)) ||
+        (req->tp_frame_nr != req->tp_block_nr * (req->tp_block_size / req->tp_frame_size))) {
+        return -EINVAL;
+    }
+
+    (VOID)memset_s(&area, sizeof(area), 0, sizeof(area));
+    area.size = (size_t)req->tp_block_size * req->tp_block_nr;
+    area.blockSize = req->tp_block_size;
+    area.frameSize = req->tp_frame_size;
+    area.framesPerBlock = req->tp_block_size / req->tp_frame_size;
+    area.frameNr = req->tp_frame_nr;
+    area.base = (CHAR *)LOS_VMalloc(area.size);
+    if (area.base == NULL) {
+        return -ENOMEM;
+    }
+    (VOID)memset_s(area.base, area.size, 0, area.size);
+
+    LOS_SpinLockSave(&ring->lock, &intSave);
+    if (ring->mapped || (ring->area[dir].base != NULL)) {
+        LOS_SpinUnlockRestore(&ring->lock, intSave);
+        LOS_VFree(area.base);
+        return -EBUSY;
+    }
+    ring->area[dir] = area;
+    LOS_SpinUnlockRestore(&ring->lock, intSave);
+    return LOS_OK;
+}
+
+VOID PktRingHold(struct PktRing *ring)
+{
+    AnonFileHold(&ring->anon);
+}
+
+VOID PktRingPut(struct PktRing *ring)
+{
+    AnonFileDrop(&ring->anon);
+}
+
+BOOL PktRingActive(const struct PktRing *ring, UINT32 dir)
+{
+    return (ring != NULL) && (dir < PKTRING_DIRS) && (ring->area[dir].base != NULL);
+}
+
+struct tpacket_hdr *PktRingClaim(struct PktRing *ring, UINT32 dir, unsigned long status, UINT32 *frameSize)
+{
+    PktRingArea *area = &ring->area[dir];
+    struct tpacket_hdr *hdr = NULL;
+    UINT32 intSave;
+
+    LOS_SpinLockSave(&ring->lock, &intSave);
+    if (area->base == NULL) {
+        LOS_SpinUnlockRestore(&ring->lock, intSave);
+        return NULL;
+    }
+    hdr = PktRingFrame(area, area->head);
+    if (*(volatile unsigned long *)&hdr->tp_status != status) {
+        if (dir == PKTRING_RX) {
+            ring->drops++;
+            ring->losing = TRUE;
+        }
+        LOS_SpinUnlockRestore(&ring->lock, intSave);
+        return NULL;
+    }
+    /* the frame body is only read after its status said it is ours */
+    DMB;
+    if (dir == PKTRING_TX) {
+        hdr->tp_status = TP_STATUS_SENDING;
+    }
+    area->head = (area->head + 1) % area->frameNr;
+    LOS_SpinUnlockRestore(&ring->lock, intSave);
+
+    *frameSize = area->frameSize;
+    return hdr;
+}
+
+VOID PktRingHandOver(struct PktRing *ring, struct tpacket_hdr *hdr, unsigned long status)
+{
+    UINT32 intSave;
+
+    if (status & TP_STATUS_USER) {
+        LOS_SpinLockSave(&ring->lock, &intSave);
+        if (ring->losing) {
+            status |= TP_STATUS_LOSING;
+            ring->losing = FALSE;
+        }
+        LOS_SpinUnlockRestore(&ring->lock, intSave);
+    }
+
+    /* the frame body has to be visible before the status that hands it over */
+    DMB;
+    *(volatile unsigned long *)&hdr->tp_status = status;
+}
+
+unsigned long PktRingPeek(struct PktRing *ring, UINT32 dir, BOOL previous)
+{
+    PktRingArea *area = &ring->area[dir];
+    UINT32 index;
+
+    if (area->base == NULL) {
+        return TP_STATUS_KERNEL;
+    }
+    index = previous ? ((area->head + area->frameNr - 1) % area->frameNr) : area->head;
+    return *(volatile unsigned long *)&PktRingFrame(area, index)->tp_status;
+}
+
+UINT32 PktRingDrops(struct PktRing *ring)
+{
+    UINT32 intSave;
+    UINT32 drops;
+
+    LOS_SpinLockSave(&ring->lock, &intSave);
+    drops = ring->drops;
+    ring->drops = 0;
+    LOS_SpinUnlockRestore(&ring->lock, intSave);
+    return drops;
+}
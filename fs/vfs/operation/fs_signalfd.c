@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fs_eventfd.h"
+#include "errno.h"
+#include "fcntl.h"
+#include "poll.h"
+#include "stdlib.h"
+#include "securec.h"
+#include "sys/signalfd.h"
+#include "linux/wait.h"
+#include "los_process_pri.h"
+#include "los_sched_pri.h"
+#include "los_signal.h"
+#include "fs/file.h"
+#include "fs_anon.h"
+#include "fs_poll_pri.h"
+
+typedef struct {
+    struct AnonFile anon;   /* must be first */
+    LOS_DL_LIST node;       /* on g_signalfdList */
+    UINT32 processID;       /* signals pending on the threads of this process are reported */
+    sigset_t mask;
+    wait_queue_head_t wq;
+} Signalfd;
+
+STATIC LOS_DL_LIST g_signalfdList = { &g_signalfdList, &g_signalfdList };
+LITE_OS_SEC_BSS STATIC SPIN_LOCK_INIT(g_signalfdSpin);
+
+/* must be called with the scheduler lock held */
+STATIC sigset_t SignalfdPendingLocked(const Signalfd *sfd)
+{
+    LosProcessCB *processCB = OS_PCB_FROM_PID(sfd->processID);
+    LosTaskCB *taskCB = NULL;
+    sigset_t pending = NULL_SIGNAL_SET;
+
+    if (OsProcessIsUnused(processCB)) {
+        return NULL_SIGNAL_SET;
+    }
+    LOS_DL_LIST_FOR_EACH_ENTRY(taskCB, &processCB->threadSiblingList, LosTaskCB, threadList) {
+        pending |= taskCB->sig.sigPendFlag;
+    }
+
+    return pending & sfd->mask;
+}
+
+STATIC UINT32 SignalfdGetEvents(struct EpollWatch *watch)
+{
+    Signalfd *sfd = (Signalfd *)watch;
+    sigset_t pending;
+    UINT32 intSave;
+
+    SCHEDULER_LOCK(intSave);
+    pending = SignalfdPendingLocked(sfd);
+    SCHEDULER_UNLOCK(intSave);
+
+    return (pending != NULL_SIGNAL_SET) ? (POLLIN | POLLRDNORM) : 0;
+}
+
+STATIC VOID SignalfdNotify(unsigned int processID)
+{
+    Signalfd *sfd = NULL;
+    UINT32 intSave;
+    UINT32 events;
+
+    LOS_SpinLockSave(&g_signalfdSpin, &intSave);
+    LOS_DL_LIST_FOR_EACH_ENTRY(sfd, &g_signalfdList, Signalfd, node) {
+        if (sfd->processID != processID) {
+            continue;
+        }
+        events = SignalfdGetEvents(&sfd->anon.watch);
+        if (events != 0) {
+            notify_poll(&sfd->wq);
+            EpollWatchNotify(&sfd->anon.watch, events);
+        }
+    }
+    LOS_SpinUnlockRestore(&g_signalfdSpin, intSave);
+}
+
+/*
+ * Take the lowest pending signal in the mask, preferring the calling thread and then the other
+ * threads of the process, which is where process directed signals have been queued.
+ */
+STATIC int SignalfdDequeue(const Signalfd *sfd, struct signalfd_siginfo *info)
+{
+    LosTaskCB *runTask = OsCurrTaskGet();
+    LosTaskCB *taskCB = NULL;
+    LosProcessCB *processCB = NULL;
+    sigset_t pending;
+    UINT32 intSave;
+    int signo = 0;
+
+    SCHEDULER_LOCK(intSave);
+    taskCB = runTask;
+    if ((runTask->sig.sigPendFlag & sfd->mask) == NULL_SIGNAL_SET) {
+        taskCB = NULL;
+        processCB = OS_PCB_FROM_PID(sfd->processID);
+        LOS_DL_LIST_FOR_EACH_ENTRY(taskCB, &processCB->threadSiblingList, LosTaskCB, threadList) {
+            if ((taskCB->sig.sigPendFlag & sfd->mask) != NULL_SIGNAL_SET) {
+                break;
+            }
+        }
+        if (&taskCB->threadList == &processCB->threadSiblingList) {
+            SCHEDULER_UNLOCK(intSave);
+            return 0;
+        }
+    }
+
+    pending = taskCB->sig.sigPendFlag & sfd->mask;
+    signo = __builtin_ctzll(pending);
+    taskCB->sig.sigPendFlag &= ~SIGNO2SET((unsigned int)signo);
+    signo += 1;
+    info->ssi_signo = (uint32_t)signo;
+    if (taskCB->sig.sigunbinfo.si_signo == signo) {
+        info->ssi_code = taskCB->sig.sigunbinfo.si_code;
+        info->ssi_int = taskCB->sig.sigunbinfo.si_value.sival_int;
+        info->ssi_ptr = (uint64_t)(UINTPTR)taskCB->sig.sigunbinfo.si_value.sival_ptr;
+    }
+    SCHEDULER_UNLOCK(intSave);
+
+    return signo;
+}
+
+STATIC ssize_t SignalfdRead(struct file *filep, char *buffer, size_t buflen)
+{
+    Signalfd *sfd = (Signalfd *)AnonFileGet(filep);
+    struct signalfd_siginfo info;
+    siginfo_t sigInfo;
+    sigset_t waitSet;
+    size_t total = 0;
+    int ret;
+
+    if (sfd == NULL) {
+        return -EBADF;
+    }
+    if (buflen < sizeof(struct signalfd_siginfo)) {
+        return -EINVAL;
+    }
+
+    while ((buflen - total) >= sizeof(struct signalfd_siginfo)) {
+        (VOID)memset_s(&info, sizeof(info), 0, sizeof(info));
+        if (SignalfdDequeue(sfd, &info) == 0) {
+            if (total != 0) {
+                break;
+            }
+            if ((filep->f_oflags & O_NONBLOCK) || (sfd->processID != OsCurrProcessGet()->processID)) {
+                return -EAGAIN;
+            }
+            /* nothing pending anywhere in the process, sleep like sigwaitinfo on the mask */
+            waitSet = sfd->mask;
+            ret = OsSigTimedWait(&waitSet, &sigInfo, LOS_WAIT_FOREVER);
+            if (ret < 0) {
+                return ret;
+            }
+            /* the wait always includes SIGKILL and SIGSTOP, they are never reported here */
+            if (OsSigIsMember(&sfd->mask, sigInfo.si_signo) != 1) {
+                return -EINTR;
+            }
+            info.ssi_signo = (uint32_t)sigInfo.si_signo;
+            info.ssi_code = sigInfo.si_code;
+            info.ssi_int = sigInfo.si_value.sival_int;
+            info.ssi_ptr = (uint64_t)(UINTPTR)sigInfo.si_value.sival_ptr;
+        }
+
+        ret = AnonFileCopyOut(buffer + total, &info, sizeof(info));
+        if (ret != LOS_OK) {
+            return (total != 0) ? (ssize_t)total : ret;
+        }
+        total += sizeof(info);
+    }
+
+    return (ssize_t)total;
+}
+
+#ifndef CONFIG_DISABLE_POLL
+STATIC int SignalfdPoll(struct file *filep, poll_table *table)
+{
+    Signalfd *sfd = (Signalfd *)AnonFileGet(filep);
+
+    if (sfd == NULL) {
+        return POLLERR;
+    }
+
+    poll_wait(filep, &sfd->wq, table);
+    return (int)SignalfdGetEvents(&sfd->anon.watch);
+}
+#endif
+
+STATIC int SignalfdClose(struct file *filep)
+{
+    Signalfd *sfd = (Signalfd *)AnonFileGet(filep);
+    UINT32 intSave;
+
+    if (sfd == NULL) {
+        return -EBADF;
+    }
+
+    LOS_SpinLockSave(&g_signalfdSpin, &intSave);
+    LOS_ListDelete(&sfd->node);
+    LOS_SpinUnlockRestore(&g_signalfdSpin, intSave);
+
+    EpollWatchDetach(&sfd->anon.watch);
+    AnonFileDrop(&sfd->anon);
+    return LOS_OK;
+}
+
+STATIC VOID SignalfdRelease(struct AnonFile *anon)
+{
+    free(anon);
+}
+
+STATIC const struct file_operations_vfs g_signalfdFops = {
+    NULL,           /* open */
+    SignalfdClose,  /* close */
+    SignalfdRead,   /* read */
+    NULL,           /* write */
+    NULL,           /* seek */
+    NULL,           /* ioctl */
+    NULL,           /* mmap */
+#ifndef CONFIG_DISABLE_POLL
+    SignalfdPoll,   /* poll */
+#endif
+    NULL,           /* unlink */
+};
+
+STATIC const struct EpollWatchOps g_signalfdWatchOps = {
+    SignalfdGetEvents,
+    AnonWatchHold,
+    AnonWatchDrop,
+};
+
+/* SIGKILL and SIGSTOP can not be received through a signalfd */
+STATIC sigset_t SignalfdMask(sigset_t mask)
+{
+    return mask & ~(SIGNO2SET(SIGKILL - 1) | SIGNO2SET(SIGSTOP - 1));
+}
+
+int SignalfdCreate(sigset_t mask, int flags)
+{
+    Signalfd *sfd = NULL;
+    UINT32 intSave;
+    int sysFd;
+
+    if ((flags & ~(SFD_NONBLOCK | SFD_CLOEXEC)) != 0) {
+        return -EINVAL;
+    }
+
+    sfd = (Signalfd *)zalloc(sizeof(Signalfd));
+    if (sfd == NULL) {
+        return -ENOMEM;
+    }
+    sfd->processID = OsCurrProcessGet()->processID;
+    sfd->mask = SignalfdMask(mask);
+    init_waitqueue_head(&sfd->wq);
+    AnonFileInit(&sfd->anon, &g_signalfdWatchOps, SignalfdRelease);
+
+    sysFd = AnonFileAlloc(&g_signalfdFops, &sfd->anon, O_RDONLY | (flags & SFD_NONBLOCK));
+    if (sysFd < 0) {
+        SignalfdRelease(&sfd->anon);
+        return sysFd;
+    }
+
+    OsSigNotifyHookRegister(SignalfdNotify);
+    LOS_SpinLockSave(&g_signalfdSpin, &intSave);
+    LOS_ListTailInsert(&g_signalfdList, &sfd->node);
+    LOS_SpinUnlockRestore(&g_signalfdSpin, intSave);
+
+    return sysFd;
+}
+
+int SignalfdUpdate(int sysFd, sigset_t mask)
+{
+    struct file *filep = NULL;
+    Signalfd *sfd = NULL;
+    UINT32 events;
+
+    if ((fs_getfilep(sysFd, &filep) < 0) || (filep->ops != &g_signalfdFops)) {
+        return -EINVAL;
+    }
+    sfd = (Signalfd *)AnonFileGet(filep);
+    sfd->mask = SignalfdMask(mask);
+
+    events = SignalfdGetEvents(&sfd->anon.watch);
+    if (events != 0) {
+        notify_poll(&sfd->wq);
+        EpollWatchNotify(&sfd->anon.watch, events);
+    }
+
+    return LOS_OK;
+}
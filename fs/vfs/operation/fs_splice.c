@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fs_splice.h"
+#include "errno.h"
+#include "fcntl.h"
+#include "poll.h"
+#include "unistd.h"
+#include "sys/stat.h"
+#include "los_base.h"
+#include "los_vm_common.h"
+#include "los_vm_page.h"
+#include "los_vm_phys.h"
+#include "los_vm_filemap.h"
+#include "fs/file.h"
+#include "fs/vnode.h"
+#ifdef LOSCFG_NET_LWIP_SACK
+#include "lwip/sockets.h"
+#endif
+
+#define SPLICE_ZC_PAGES         16      /* pages in flight on one connection, covers TCP_SND_BUF */
+#define SPLICE_WAIT_MS          100     /* re-check period while a detached connection drains */
+
+STATIC BOOL SpliceIsSocket(int sysFd)
+{
+#ifdef LOSCFG_NET_LWIP_SACK
+    return (sysFd >= CONFIG_NFILE_DESCRIPTORS) ? TRUE : FALSE;
+#else
+    (VOID)sysFd;
+    return FALSE;
+#endif
+}
+
+STATIC BOOL SpliceIsRegular(int sysFd)
+{
+    struct file *filep = NULL;
+
+    if (SpliceIsSocket(sysFd) || (fs_getfilep(sysFd, &filep) < 0) || (filep->f_vnode == NULL)) {
+        return FALSE;
+    }
+    return (filep->f_vnode->type == VNODE_TYPE_REG) ? TRUE : FALSE;
+}
+
+#if defined(LOSCFG_NET_LWIP_SACK) && defined(LOSCFG_KERNEL_VM)
+typedef struct {
+    LosVmPage *page;
+    struct socks_zc_ref ref;
+} SpliceZcSlot;
+
+typedef struct {
+    int sockFd;
+    UINT32 head;
+    UINT32 count;
+    SpliceZcSlot slots[SPLICE_ZC_PAGES];
+} SpliceZcQueue;
+
+STATIC VOID SpliceWaitWritable(int sockFd)
+{
+    struct pollfd pfd;
+
+    pfd.fd = sockFd;
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+    (VOID)poll(&pfd, 1, SPLICE_WAIT_MS);
+}
+
+/* release the oldest pages whose bytes have left the stack, or all of them when drain is set */
+STATIC VOID SpliceZcReap(SpliceZcQueue *queue, BOOL drain)
+{
+    SpliceZcSlot *slot = NULL;
+
+    while (queue->count > 0) {
+        slot = &queue->slots[queue->head];
+        while (socks_zc_pending(queue->sockFd, &slot->ref)) {
+            if (!drain && (queue->count < SPLICE_ZC_PAGES)) {
+                return;
+            }
+            SpliceWaitWritable(queue->sockFd);
+        }
+        LOS_PhysPageFree(slot->page);
+        queue->head = (queue->head + 1) % SPLICE_ZC_PAGES;
+        queue->count--;
+    }
+}
+
+/* a page holding the file bytes at pos, straight from the page cache when it is there */
+STATIC LosVmPage *SpliceZcGetPage(int inSysFd, const struct file *filep, off_t pos, size_t *len)
+{
+    LosVmPage *page = NULL;
+    UINT32 inPage = (UINT32)pos & (PAGE_SIZE - 1);
+    ssize_t ret;
+
+    if (filep->f_mapping != NULL) {
+        page = OsPageCacheGetPinned(filep->f_mapping, (VM_OFFSET_T)pos >> PAGE_SHIFT);
+        if (page != NULL) {
+            *len = MIN2(*len, PAGE_SIZE - inPage);
+            return page;
+        }
+    }
+
+    page = LOS_PhysPageAlloc();
+    if (page == NULL) {
+        *len = 0;
+        return NULL;
+    }
+
+    ret = pread(inSysFd, (CHAR *)OsVmPageToVaddr(page) + inPage, MIN2(*len, PAGE_SIZE - inPage), pos);
+    if (ret <= 0) {
+        LOS_PhysPageFree(page);
+        *len = (ret < 0) ? (size_t)-get_errno() : 0;
+        return NULL;
+    }
+    *len = (size_t)ret;
+    return page;
+}
+
+/* queue one page on the connection, returns the bytes taken or a negative errno */
+STATIC ssize_t SpliceZcSendPage(SpliceZcQueue *queue, LosVmPage *page, UINT32 inPage, size_t len)
+{
+    SpliceZcSlot *slot = NULL;
+    CHAR *data = (CHAR *)OsVmPageToVaddr(page) + inPage;
+    size_t done = 0;
+    ssize_t ret = 0;
+
+    if (queue->count == SPLICE_ZC_PAGES) {
+        SpliceZcReap(queue, FALSE);
+    }
+    /* reaping moves head and count in step, so this slot stays the free one */
+    slot = &queue->slots[(queue->head + queue->count) % SPLICE_ZC_PAGES];
+    slot->page = page;
+    slot->ref.pcb = NULL;
+    while (done < len) {
+        ret = socks_zc_send(queue->sockFd, data + done, len - done, &slot->ref);
+        if (ret < 0) {
+            break;
+        } else if (ret == 0) {
+            SpliceZcReap(queue, FALSE);
+            SpliceWaitWritable(queue->sockFd);
+            continue;
+        }
+        done += (size_t)ret;
+    }
+
+    /* whatever was queued still points at the page, so it has to wait for the acks either way */
+    if (slot->ref.pcb != NULL) {
+        queue->count++;
+    } else {
+        LOS_PhysPageFree(page);
+    }
+    return (done > 0) ? (ssize_t)done : ret;
+}
+
+ssize_t SpliceSendFile(int outSysFd, int inSysFd, off_t *offset, size_t count)
+{
+    SpliceZcQueue *queue = NULL;
+    struct file *filep = NULL;
+    struct stat st;
+    LosVmPage *page = NULL;
+    off_t pos;
+    size_t len;
+    size_t sent = 0;
+    ssize_t ret = 0;
+
+    if (!SpliceIsSocket(outSysFd) || !SpliceIsRegular(inSysFd) || (fs_getfilep(inSysFd, &filep) < 0) ||
+        (fstat(inSysFd, &st) < 0)) {
+        return -EOPNOTSUPP;
+    }
+
+    queue = (SpliceZcQueue *)LOS_MemAlloc(m_aucSysMem0, sizeof(SpliceZcQueue));
+    if (queue == NULL) {
+        return -EOPNOTSUPP;
+    }
+    queue->sockFd = outSysFd;
+    queue->head = 0;
+    queue->count = 0;
+
+    /* keeps a concurrent close from tearing the socket down under the queued pages */
+    socks_refer(outSysFd);
+
+    pos = (offset != NULL) ? *offset : filep->f_pos;
+    while ((sent < count) && (pos < st.st_size)) {
+        len = MIN2(count - sent, (size_t)(st.st_size - pos));
+        page = SpliceZcGetPage(inSysFd, filep, pos, &len);
+        if (page == NULL) {
+            ret = -(ssize_t)len;
+            break;
+        }
+
+        ret = SpliceZcSendPage(queue, page, (UINT32)pos & (PAGE_SIZE - 1), len);
+        if (ret <= 0) {
+            break;
+        }
+        sent += (size_t)ret;
+        pos += ret;
+        if ((size_t)ret < len) {
+            break;
+        }
+    }
+
+    SpliceZcReap(queue, TRUE);
+    (VOID)socks_close(outSysFd);
+    LOS_MemFree(m_aucSysMem0, queue);
+
+    if ((sent == 0) && (ret < 0)) {
+        return ret;
+    }
+    if (offset != NULL) {
+        *offset = pos;
+    } else {
+        (VOID)lseek(inSysFd, pos, SEEK_SET);
+    }
+    return (ssize_t)sent;
+}
+#else
+ssize_t SpliceSendFile(int outSysFd, int inSysFd, off_t *offset, size_t count)
+{
+    (VOID)outSysFd;
+    (VOID)inSysFd;
+    (VOID)offset;
+    (VOID)count;
+    return -EOPNOTSUPP;
+}
+#endif
+
+STATIC ssize_t SpliceWriteAll(int outSysFd, off_t *offOut, const CHAR *buf, size_t len)
+{
+    size_t done = 0;
+    ssize_t ret;
+
+    while (done < len) {
+        if (offOut != NULL) {
+            ret = pwrite(outSysFd, buf + done, len - done, *offOut);
+        } else {
+            ret = write(outSysFd, buf + done, len - done);
+        }
+        if (ret <= 0) {
+            return (done > 0) ? (ssize_t)done : ((ret < 0) ? -get_errno() : -EIO);
+        }
+        if (offOut != NULL) {
+            *offOut += ret;
+        }
+        done += (size_t)ret;
+    }
+    return (ssize_t)done;
+}
+
+ssize_t SpliceFd(int inSysFd, off_t *offIn, int outSysFd, off_t *offOut, size_t len, UINT32 flags)
+{
+    CHAR *buf = NULL;
+    BOOL inRegular = SpliceIsRegular(inSysFd);
+    size_t moved = 0;
+    ssize_t nread, nwrite;
+    ssize_t ret = 0;
+
+    (VOID)flags;
+
+    if (((offIn != NULL) && SpliceIsSocket(inSysFd)) || ((offOut != NULL) && SpliceIsSocket(outSysFd))) {
+        return -ESPIPE;
+    }
+    if (((offIn != NULL) && (*offIn < 0)) || ((offOut != NULL) && (*offOut < 0))) {
+        return -EINVAL;
+    }
+    if (len == 0) {
+        return 0;
+    }
+
+    if (inRegular && SpliceIsSocket(outSysFd)) {
+        ret = SpliceSendFile(outSysFd, inSysFd, offIn, len);
+        if (ret != -EOPNOTSUPP) {
+            return ret;
+        }
+    }
+
+    buf = (CHAR *)LOS_MemAlloc(m_aucSysMem0, PAGE_SIZE);
+    if (buf == NULL) {
+        return -ENOMEM;
+    }
+
+    while (moved < len) {
+        if (offIn != NULL) {
+            nread = pread(inSysFd, buf, MIN2(len - moved, PAGE_SIZE), *offIn);
+        } else {
+            nread = read(inSysFd, buf, MIN2(len - moved, PAGE_SIZE));
+        }
+        if (nread <= 0) {
+            ret = (nread < 0) ? -get_errno() : 0;
+            break;
+        }
+        if (offIn != NULL) {
+            *offIn += nread;
+        }
+
+        nwrite = SpliceWriteAll(outSysFd, offOut, buf, (size_t)nread);
+        if (nwrite < 0) {
+            ret = nwrite;
+            break;
+        }
+        moved += (size_t)nwrite;
+        if (nwrite < nread) {
+            break;
+        }
+
+        /* pipes and sockets return what was there, later reads could block on an idle peer */
+        if (!inRegular) {
+            break;
+        }
+    }
+
+    LOS_MemFree(m_aucSysMem0, buf);
+    return (moved > 0) ? (ssize_t)moved : ret;
+}
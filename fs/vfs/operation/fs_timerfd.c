@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fs_eventfd.h"
+#include "errno.h"
+#include "fcntl.h"
+#include "poll.h"
+#include "stdlib.h"
+#include "linux/wait.h"
+#include "los_event.h"
+#include "los_swtmr_pri.h"
+#include "time_posix.h"
+#include "fs/file.h"
+#include "fs_anon.h"
+#include "fs_poll_pri.h"
+
+#define TIMERFD_EVENT_EXPIRED   0x01U
+
+typedef struct {
+    struct AnonFile anon;   /* must be first */
+    UINT16 swtmrID;
+    clockid_t clockid;
+    UINT64 expirations;     /* protected by g_timerfdSpin */
+    EVENT_CB_S event;       /* blocking readers sleep here */
+    wait_queue_head_t wq;
+} Timerfd;
+
+/*
+ * Expiry callbacks are queued to the software timer task and may run after the timerfd has been
+ * closed, so they carry the timer id and look the timerfd up here instead of holding a pointer.
+ */
+STATIC Timerfd *g_timerfdTable[LOSCFG_BASE_CORE_SWTMR_LIMIT];
+LITE_OS_SEC_BSS STATIC SPIN_LOCK_INIT(g_timerfdSpin);
+
+STATIC UINT32 TimerfdGetEvents(struct EpollWatch *watch)
+{
+    Timerfd *tfd = (Timerfd *)watch;
+    UINT32 intSave;
+    UINT32 events;
+
+    LOS_SpinLockSave(&g_timerfdSpin, &intSave);
+    events = (tfd->expirations != 0) ? (POLLIN | POLLRDNORM) : 0;
+    LOS_SpinUnlockRestore(&g_timerfdSpin, intSave);
+
+    return events;
+}
+
+STATIC VOID TimerfdExpire(UINTPTR arg)
+{
+    UINT16 swtmrID = (UINT16)arg;
+    Timerfd *tfd = NULL;
+    UINT32 intSave;
+
+    LOS_SpinLockSave(&g_timerfdSpin, &intSave);
+    tfd = g_timerfdTable[swtmrID % LOSCFG_BASE_CORE_SWTMR_LIMIT];
+    if ((tfd == NULL) || (tfd->swtmrID != swtmrID)) {
+        LOS_SpinUnlockRestore(&g_timerfdSpin, intSave);
+        return;
+    }
+    tfd->expirations++;
+    /* the wakeups take other locks, keep the timerfd alive instead of holding g_timerfdSpin */
+    AnonFileHold(&tfd->anon);
+    LOS_SpinUnlockRestore(&g_timerfdSpin, intSave);
+
+    (VOID)LOS_EventWrite(&tfd->event, TIMERFD_EVENT_EXPIRED);
+    notify_poll(&tfd->wq);
+    EpollWatchNotify(&tfd->anon.watch, POLLIN | POLLRDNORM);
+    AnonFileDrop(&tfd->anon);
+}
+
+STATIC ssize_t TimerfdRead(struct file *filep, char *buffer, size_t buflen)
+{
+    Timerfd *tfd = (Timerfd *)AnonFileGet(filep);
+    UINT64 value;
+    UINT32 intSave;
+    int ret;
+
+    if (tfd == NULL) {
+        return -EBADF;
+    }
+    if (buflen < sizeof(UINT64)) {
+        return -EINVAL;
+    }
+
+    while (TRUE) {
+        LOS_SpinLockSave(&g_timerfdSpin, &intSave);
+        value = tfd->expirations;
+        tfd->expirations = 0;
+        LOS_SpinUnlockRestore(&g_timerfdSpin, intSave);
+        if (value != 0) {
+            break;
+        }
+
+        if (filep->f_oflags & O_NONBLOCK) {
+            return -EAGAIN;
+        }
+        (VOID)LOS_EventRead(&tfd->event, TIMERFD_EVENT_EXPIRED, LOS_WAITMODE_OR | LOS_WAITMODE_CLR,
+                            LOS_WAIT_FOREVER);
+    }
+
+    ret = AnonFileCopyOut(buffer, &value, sizeof(UINT64));
+    return (ret != LOS_OK) ? ret : (ssize_t)sizeof(UINT64);
+}
+
+#ifndef CONFIG_DISABLE_POLL
+STATIC int TimerfdPoll(struct file *filep, poll_table *table)
+{
+    Timerfd *tfd = (Timerfd *)AnonFileGet(filep);
+
+    if (tfd == NULL) {
+        return POLLERR;
+    }
+
+    poll_wait(filep, &tfd->wq, table);
+    return (int)TimerfdGetEvents(&tfd->anon.watch);
+}
+#endif
+
+STATIC int TimerfdClose(struct file *filep)
+{
+    Timerfd *tfd = (Timerfd *)AnonFileGet(filep);
+    UINT32 intSave;
+
+    if (tfd == NULL) {
+        return -EBADF;
+    }
+
+    (VOID)LOS_SwtmrDelete(tfd->swtmrID);
+    LOS_SpinLockSave(&g_timerfdSpin, &intSave);
+    g_timerfdTable[tfd->swtmrID % LOSCFG_BASE_CORE_SWTMR_LIMIT] = NULL;
+    LOS_SpinUnlockRestore(&g_timerfdSpin, intSave);
+
+    EpollWatchDetach(&tfd->anon.watch);
+    AnonFileDrop(&tfd->anon);
+    return LOS_OK;
+}
+
+STATIC VOID TimerfdRelease(struct AnonFile *anon)
+{
+    Timerfd *tfd = (Timerfd *)anon;
+
+    (VOID)LOS_EventDestroy(&tfd->event);
+    free(tfd);
+}
+
+STATIC const struct file_operations_vfs g_timerfdFops = {
+    NULL,           /* open */
+    TimerfdClose,   /* close */
+    TimerfdRead,    /* read */
+    NULL,           /* write */
+    NULL,           /* seek */
+    NULL,           /* ioctl */
+    NULL,           /* mmap */
+#ifndef CONFIG_DISABLE_POLL
+    TimerfdPoll,    /* poll */
+#endif
+    NULL,           /* unlink */
+};
+
+STATIC const struct EpollWatchOps g_timerfdWatchOps = {
+    TimerfdGetEvents,
+    AnonWatchHold,
+    AnonWatchDrop,
+};
+
+STATIC Timerfd *TimerfdGet(int sysFd)
+{
+    struct file *filep = NULL;
+
+    if ((fs_getfilep(sysFd, &filep) < 0) || (filep->ops != &g_timerfdFops)) {
+        return NULL;
+    }
+
+    return (Timerfd *)AnonFileGet(filep);
+}
+
+int TimerfdCreate(int clockid, int flags)
+{
+    Timerfd *tfd = NULL;
+    SWTMR_CTRL_S *swtmr = NULL;
+    UINT32 intSave;
+    int sysFd;
+
+    if ((clockid != CLOCK_REALTIME) && (clockid != CLOCK_MONOTONIC)) {
+        return -EINVAL;
+    }
+    if ((flags & ~(TFD_NONBLOCK | TFD_CLOEXEC)) != 0) {
+        return -EINVAL;
+    }
+
+    tfd = (Timerfd *)zalloc(sizeof(Timerfd));
+    if (tfd == NULL) {
+        return -ENOMEM;
+    }
+    if (LOS_EventInit(&tfd->event) != LOS_OK) {
+        free(tfd);
+        return -ENOMEM;
+    }
+    tfd->clockid = clockid;
+    init_waitqueue_head(&tfd->wq);
+    AnonFileInit(&tfd->anon, &g_timerfdWatchOps, TimerfdRelease);
+
+    if (LOS_SwtmrCreate(1, LOS_SWTMR_MODE_NO_SELFDELETE, TimerfdExpire, &tfd->swtmrID, 0) != LOS_OK) {
+        TimerfdRelease(&tfd->anon);
+        return -ENOMEM;
+    }
+    swtmr = OS_SWT_FROM_SID(tfd->swtmrID);
+    LOS_SpinLockSave(&g_swtmrSpin, &intSave);
+    swtmr->uwArg = tfd->swtmrID;
+    LOS_SpinUnlockRestore(&g_swtmrSpin, intSave);
+
+    sysFd = AnonFileAlloc(&g_timerfdFops, &tfd->anon, O_RDONLY | (flags & TFD_NONBLOCK));
+    if (sysFd < 0) {
+        (VOID)LOS_SwtmrDelete(tfd->swtmrID);
+        TimerfdRelease(&tfd->anon);
+        return sysFd;
+    }
+
+    LOS_SpinLockSave(&g_timerfdSpin, &intSave);
+    g_timerfdTable[tfd->swtmrID % LOSCFG_BASE_CORE_SWTMR_LIMIT] = tfd;
+    LOS_SpinUnlockRestore(&g_timerfdSpin, intSave);
+
+    return sysFd;
+}
+
+int TimerfdGettime(int sysFd, struct itimerspec *value)
+{
+    Timerfd *tfd = TimerfdGet(sysFd);
+    SWTMR_CTRL_S *swtmr = NULL;
+    UINT32 tick = 0;
+    UINT32 ret;
+
+    if (tfd == NULL) {
+        return -EINVAL;
+    }
+
+    swtmr = OS_SWT_FROM_SID(tfd->swtmrID);
+    ret = LOS_SwtmrTimeGet(tfd->swtmrID, &tick);
+    if ((ret != LOS_OK) && (ret != LOS_ERRNO_SWTMR_NOT_STARTED)) {
+        return -EINVAL;
+    }
+
+    OsTick2TimeSpec(&value->it_value, tick);
+    OsTick2TimeSpec(&value->it_interval, (swtmr->ucMode == LOS_SWTMR_MODE_OPP) ? swtmr->uwInterval : 0);
+    return LOS_OK;
+}
+
+/* Turn an absolute expiry on the timerfd clock into a relative one, expired times fire at once. */
+STATIC VOID TimerfdAbsToRel(const Timerfd *tfd, const struct timespec *abs, struct timespec *rel)
+{
+    struct timespec now = { 0 };
+    INT64 ns;
+
+    (VOID)clock_gettime(tfd->clockid, &now);
+    ns = ((INT64)abs->tv_sec - now.tv_sec) * OS_SYS_NS_PER_SECOND + (abs->tv_nsec - now.tv_nsec);
+    if (ns <= 0) {
+        ns = 1;
+    }
+    rel->tv_sec = (time_t)(ns / OS_SYS_NS_PER_SECOND);
+    rel->tv_nsec = (long)(ns % OS_SYS_NS_PER_SECOND);
+}
+
+int TimerfdSettime(int sysFd, int flags, const struct itimerspec *value, struct itimerspec *oldValue)
+{
+    Timerfd *tfd = TimerfdGet(sysFd);
+    SWTMR_CTRL_S *swtmr = NULL;
+    struct timespec expiry = value->it_value;
+    UINT32 expiryTick, intervalTick, ret;
+    UINT32 intSave;
+
+    if ((tfd == NULL) || ((flags & ~TFD_TIMER_ABSTIME) != 0)) {
+        return -EINVAL;
+    }
+    if (!ValidTimeSpec(&value->it_value) || !ValidTimeSpec(&value->it_interval)) {
+        return -EINVAL;
+    }
+
+    if (oldValue != NULL) {
+        (VOID)TimerfdGettime(sysFd, oldValue);
+    }
+
+    swtmr = OS_SWT_FROM_SID(tfd->swtmrID);
+    ret = LOS_SwtmrStop(tfd->swtmrID);
+    if ((ret != LOS_OK) && (ret != LOS_ERRNO_SWTMR_NOT_STARTED)) {
+        return -EINVAL;
+    }
+
+    LOS_SpinLockSave(&g_timerfdSpin, &intSave);
+    tfd->expirations = 0;
+    LOS_SpinUnlockRestore(&g_timerfdSpin, intSave);
+
+    if ((value->it_value.tv_sec == 0) && (value->it_value.tv_nsec == 0)) {
+        return LOS_OK; /* disarm */
+    }
+
+    if (flags & TFD_TIMER_ABSTIME) {
+        TimerfdAbsToRel(tfd, &value->it_value, &expiry);
+    }
+    expiryTick = OsTimeSpec2Tick(&expiry);
+    intervalTick = OsTimeSpec2Tick(&value->it_interval);
+
+    LOS_SpinLockSave(&g_swtmrSpin, &intSave);
+    swtmr->ucMode = intervalTick ? LOS_SWTMR_MODE_OPP : LOS_SWTMR_MODE_NO_SELFDELETE;
+    swtmr->uwExpiry = expiryTick + !!expiryTick; /* skip the first tick because it is not a full tick */
+    swtmr->uwInterval = intervalTick;
+    swtmr->uwOverrun = 0;
+    LOS_SpinUnlockRestore(&g_swtmrSpin, intSave);
+
+    if (LOS_SwtmrStart(tfd->swtmrID) != LOS_OK) {
+        return -EINVAL;
+    }
+
+    return LOS_OK;
+}
@@ -0,0 +1,1831 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define _GNU_SOURCE
+#include "fs_unix.h"
+#include "errno.h"
+#include "fcntl.h"
+#include "poll.h"
+#include "stdlib.h"
+#include "string.h"
+#include "unistd.h"
+#include "securec.h"
+#include "sys/ioctl.h"
+#include "linux/wait.h"
+#include "los_event.h"
+#include "los_mux.h"
+#include "los_process.h"
+#include "los_spinlock.h"
+#include "fs/fd_table.h"
+#include "fs/file.h"
+#include "fs_anon.h"
+#include "fs_file.h"
+#include "fs_poll_pri.h"
+
+#define UNIX_EVENT_READABLE     0x01U   /* data, a connection or a hangup arrived */
+#define UNIX_EVENT_WRITABLE     0x02U   /* receive space was freed, senders sleep on the receiver */
+#define UNIX_EVENT_BACKLOG      0x04U   /* a connection left the accept queue */
+
+#define UNIX_RCVBUF_DEFAULT     0x20000U
+#define UNIX_RCVBUF_MIN         0x800U
+#define UNIX_RCVBUF_MAX         0x400000U
+#define UNIX_CHUNK_MAX          0x10000U    /* stream writes are queued in pieces of at most this */
+#define UNIX_DGRAM_MAX          0x10000U
+#define UNIX_BACKLOG_MAX        128U
+#define UNIX_SCM_MAX_FD         253U
+
+#define UNIX_SHUT_RCV           0x1U
+#define UNIX_SHUT_SEND          0x2U
+#define UNIX_SHUT_MASK          (UNIX_SHUT_RCV | UNIX_SHUT_SEND)
+
+#define UNIX_ADDR_MIN           ((socklen_t)offsetof(struct sockaddr_un, sun_path))
+#define UNIX_MSG_TRUESIZE(len)  (sizeof(UnixMsg) + (len))
+
+#define UNIX_POLL_IN            (POLLIN | POLLRDNORM)
+#define UNIX_POLL_OUT           (POLLOUT | POLLWRNORM)
+
+enum UnixState {
+    UNIX_SS_UNCONNECTED,
+    UNIX_SS_CONNECTING,
+    UNIX_SS_CONNECTED,
+    UNIX_SS_LISTENING,
+    UNIX_SS_CLOSED,
+};
+
+typedef struct {
+    LOS_DL_LIST node;
+    UINT32 len;
+    UINT32 off;                 /* bytes already read, stream sockets only */
+    struct ucred cred;          /* of the sender */
+    int *fds;                   /* SCM_RIGHTS in flight, each system fd holds a file reference */
+    UINT32 nfds;
+    socklen_t fromLen;          /* name of the sending socket, 0 when it is unbound */
+    struct sockaddr_un from;
+    CHAR data[0];
+} UnixMsg;
+
+typedef struct UnixSock {
+    struct AnonFile anon;       /* must be first */
+    SPIN_LOCK_S lock;           /* protects the connection state and both queues */
+    LosMux rxMux;               /* serializes readers, so the head message can be copied out unlocked */
+    int type;
+    UINT32 state;
+    UINT32 shut;                /* UNIX_SHUT_*, a SHUT_WR by the peer shows up here as UNIX_SHUT_RCV */
+    BOOL passCred;
+    struct UnixSock *peer;      /* holds a reference, cleared by whoever breaks the link */
+    LOS_DL_LIST rxQueue;        /* UnixMsg */
+    UINT32 rxBytes;             /* unread payload on rxQueue */
+    UINT32 rxMem;               /* rxBytes plus per-message overhead, checked against rxLimit */
+    UINT32 rxLimit;             /* SO_RCVBUF */
+    LOS_DL_LIST acceptQueue;    /* connected embryos waiting for accept, each holds a reference */
+    LOS_DL_LIST acceptNode;
+    UINT32 backlog;
+    UINT32 pending;
+    struct ucred cred;          /* of the creator, or of the listener for accepted sockets */
+    struct ucred peerCred;      /* SO_PEERCRED */
+    LOS_DL_LIST nameNode;       /* on g_unixNames while bound */
+    socklen_t addrLen;          /* 0 when unbound, both fields protected by g_unixNameSpin */
+    struct sockaddr_un addr;
+    EVENT_CB_S event;           /* blocking readers, writers, acceptors and connectors sleep here */
+    wait_queue_head_t wq;
+} UnixSock;
+
+typedef struct {
+    const struct iovec *iov;
+    size_t iovcnt;
+    size_t index;
+    size_t off;
+    size_t len;                 /* total of the vector */
+    int flags;                  /* MSG_* */
+    BOOL nonblock;
+    struct msghdr *msg;         /* receive side only, NULL for read() */
+    socklen_t ctlSpace;         /* size of msg->msg_control */
+} UnixIo;
+
+typedef struct {
+    int *fds;
+    UINT32 nfds;
+    BOOL hasCred;
+    struct ucred cred;
+} UnixCtl;
+
+/*
+ * Bound names live in this table rather than in the VFS namespace: path names and abstract names
+ * are both plain keys, so binding never creates a file and a stale name goes away with its socket.
+ */
+STATIC LOS_DL_LIST_HEAD(g_unixNames);
+LITE_OS_SEC_BSS STATIC SPIN_LOCK_INIT(g_unixNameSpin);
+
+STATIC VOID UnixCredGet(struct ucred *cred)
+{
+    cred->pid = (pid_t)LOS_GetCurrProcessID();
+    cred->uid = (uid_t)LOS_GetUserID();
+    cred->gid = (gid_t)LOS_GetGroupID();
+}
+
+STATIC VOID UnixListSplice(LOS_DL_LIST *from, LOS_DL_LIST *to)
+{
+    if (!LOS_ListEmpty(from)) {
+        LOS_DL_LIST *first = from->pstNext;
+        LOS_ListDelInit(from);
+        LOS_ListTailInsertList(to, first);
+    }
+}
+
+/* ---------------- in-flight messages ---------------- */
+
+STATIC UnixMsg *UnixMsgAlloc(UINT32 len)
+{
+    UnixMsg *msg = (UnixMsg *)malloc(UNIX_MSG_TRUESIZE(len));
+
+    if (msg == NULL) {
+        return NULL;
+    }
+    (VOID)memset_s(msg, sizeof(UnixMsg), 0, sizeof(UnixMsg));
+    msg->len = len;
+    UnixCredGet(&msg->cred);
+    return msg;
+}
+
+STATIC VOID UnixFdsRelease(int *fds, UINT32 nfds)
+{
+    UINT32 i;
+
+    for (i = 0; i < nfds; i++) {
+        (VOID)close(fds[i]);
+    }
+    free(fds);
+}
+
+STATIC VOID UnixMsgFree(UnixMsg *msg)
+{
+    if (msg->fds != NULL) {
+        UnixFdsRelease(msg->fds, msg->nfds);
+    }
+    free(msg);
+}
+
+/* Must not be called with a spinlock held, closing an in-flight descriptor may sleep */
+STATIC VOID UnixMsgPurge(LOS_DL_LIST *list)
+{
+    UnixMsg *msg = NULL;
+    UnixMsg *next = NULL;
+
+    LOS_DL_LIST_FOR_EACH_ENTRY_SAFE(msg, next, list, UnixMsg, node) {
+        LOS_ListDelete(&msg->node);
+        UnixMsgFree(msg);
+    }
+}
+
+/* ---------------- payload and control data ---------------- */
+
+STATIC int UnixIoInit(UnixIo *io, const struct iovec *iov, size_t iovcnt, int flags, BOOL nonblock)
+{
+    size_t i;
+
+    (VOID)memset_s(io, sizeof(UnixIo), 0, sizeof(UnixIo));
+    if ((iovcnt != 0) && (iov == NULL)) {
+        return -EINVAL;
+    }
+    for (i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len > (SSIZE_MAX - io->len)) {
+            return -EINVAL;
+        }
+        io->len += iov[i].iov_len;
+    }
+    io->iov = iov;
+    io->iovcnt = iovcnt;
+    io->flags = flags;
+    io->nonblock = nonblock || ((flags & MSG_DONTWAIT) != 0);
+    return LOS_OK;
+}
+
+/* Move len bytes between buf and the next unread part of the vector */
+STATIC int UnixIoCopy(UnixIo *io, CHAR *buf, size_t len, BOOL toIov)
+{
+    size_t n;
+    int ret;
+
+    while (len > 0) {
+        while ((io->index < io->iovcnt) && (io->off == io->iov[io->index].iov_len)) {
+            io->index++;
+            io->off = 0;
+        }
+        if (io->index == io->iovcnt) {
+            return -EFAULT;
+        }
+        n = MIN(len, io->iov[io->index].iov_len - io->off);
+        if (toIov) {
+            ret = AnonFileCopyOut((CHAR *)io->iov[io->index].iov_base + io->off, buf, n);
+        } else {
+            ret = AnonFileCopyIn(buf, (const CHAR *)io->iov[io->index].iov_base + io->off, n);
+        }
+        if (ret != LOS_OK) {
+            return ret;
+        }
+        io->off += n;
+        buf += n;
+        len -= n;
+    }
+    return LOS_OK;
+}
+
+STATIC VOID UnixCtlRelease(UnixCtl *ctl)
+{
+    if (ctl->fds != NULL) {
+        UnixFdsRelease(ctl->fds, ctl->nfds);
+        ctl->fds = NULL;
+        ctl->nfds = 0;
+    }
+}
+
+/* Turn the sender's process fds into system fds, each pinned until the message is received */
+STATIC int UnixCtlFds(UnixCtl *ctl, const int *procFds, UINT32 nfds)
+{
+    int sysFd;
+
+    if ((ctl->fds != NULL) || (nfds == 0) || (nfds > UNIX_SCM_MAX_FD)) {
+        return -EINVAL;
+    }
+    ctl->fds = (int *)malloc(nfds * sizeof(int));
+    if (ctl->fds == NULL) {
+        return -ENOMEM;
+    }
+    for (ctl->nfds = 0; ctl->nfds < nfds; ctl->nfds++) {
+        sysFd = GetAssociatedSystemFd(procFds[ctl->nfds]);
+        if (sysFd < 0) {
+            return -EBADF;
+        }
+        /* lwIP sockets live outside the file table and cannot be pinned by files_refer() */
+        if (sysFd >= CONFIG_NFILE_DESCRIPTORS) {
+            return -EOPNOTSUPP;
+        }
+        files_refer(sysFd);
+        ctl->fds[ctl->nfds] = sysFd;
+    }
+    return LOS_OK;
+}
+
+STATIC int UnixCtlParse(const struct msghdr *msg, UnixCtl *ctl)
+{
+    struct cmsghdr *cmsg = NULL;
+    struct ucred self;
+    int ret = LOS_OK;
+
+    (VOID)memset_s(ctl, sizeof(UnixCtl), 0, sizeof(UnixCtl));
+    if ((msg->msg_control == NULL) || (msg->msg_controllen == 0)) {
+        return LOS_OK;
+    }
+
+    for (cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR((struct msghdr *)msg, cmsg)) {
+        if ((cmsg->cmsg_len < CMSG_LEN(0)) || (cmsg->cmsg_level != SOL_SOCKET)) {
+            ret = -EINVAL;
+            break;
+        }
+        if (cmsg->cmsg_type == SCM_RIGHTS) {
+            ret = UnixCtlFds(ctl, (const int *)CMSG_DATA(cmsg), (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+        } else if (cmsg->cmsg_type == SCM_CREDENTIALS) {
+            if (cmsg->cmsg_len != CMSG_LEN(sizeof(struct ucred))) {
+                ret = -EINVAL;
+                break;
+            }
+            (VOID)memcpy_s(&ctl->cred, sizeof(struct ucred), CMSG_DATA(cmsg), sizeof(struct ucred));
+            UnixCredGet(&self);
+            /* only the superuser may speak for somebody else */
+            if ((self.uid != 0) &&
+                ((ctl->cred.pid != self.pid) || (ctl->cred.uid != self.uid) || (ctl->cred.gid != self.gid))) {
+                ret = -EPERM;
+            }
+            ctl->hasCred = TRUE;
+        } else {
+            ret = -EINVAL;
+        }
+        if (ret != LOS_OK) {
+            break;
+        }
+    }
+
+    if (ret != LOS_OK) {
+        UnixCtlRelease(ctl);
+    }
+    return ret;
+}
+
+STATIC VOID UnixCtlAttach(UnixMsg *msg, UnixCtl *ctl)
+{
+    msg->fds = ctl->fds;
+    msg->nfds = ctl->nfds;
+    ctl->fds = NULL;
+    ctl->nfds = 0;
+    if (ctl->hasCred) {
+        msg->cred = ctl->cred;
+    }
+}
+
+/*
+ * Fill msg_control for the message at the head of the queue. Descriptors are installed into the
+ * receiving process the first time the message is read; the ones that do not fit are closed and
+ * MSG_CTRUNC is reported, as they are when the caller passes no control buffer at all.
+ */
+STATIC VOID UnixCtlDeliver(const UnixSock *sock, UnixMsg *m, UnixIo *io)
+{
+    struct msghdr *msg = io->msg;
+    struct cmsghdr *cmsg = NULL;
+    socklen_t used = (msg != NULL) ? msg->msg_controllen : 0;
+    socklen_t space = (msg != NULL) ? io->ctlSpace : 0;
+    UINT32 fit = 0;
+    UINT32 i;
+    int procFd;
+
+    if ((msg != NULL) && sock->passCred) {
+        if ((space - used) >= CMSG_SPACE(sizeof(struct ucred))) {
+            cmsg = (struct cmsghdr *)((CHAR *)msg->msg_control + used);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_CREDENTIALS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(struct ucred));
+            (VOID)memcpy_s(CMSG_DATA(cmsg), sizeof(struct ucred), &m->cred, sizeof(struct ucred));
+            used += CMSG_SPACE(sizeof(struct ucred));
+        } else {
+            msg->msg_flags |= MSG_CTRUNC;
+        }
+    }
+
+    if ((m->nfds != 0) && !(io->flags & MSG_PEEK)) {
+        if ((msg != NULL) && ((space - used) >= CMSG_LEN(sizeof(int)))) {
+            fit = MIN(m->nfds, (UINT32)((space - used - CMSG_LEN(0)) / sizeof(int)));
+            cmsg = (struct cmsghdr *)((CHAR *)msg->msg_control + used);
+        }
+        for (i = 0; i < fit; i++) {
+            procFd = AllocAndAssocProcessFd(m->fds[i], MIN_START_FD);
+            if (procFd < 0) {
+                break;
+            }
+            ((int *)CMSG_DATA(cmsg))[i] = procFd;
+        }
+        if (i > 0) {
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(i * sizeof(int));
+            used = MIN(space, used + CMSG_SPACE(i * sizeof(int)));
+        }
+        if ((i < m->nfds) && (msg != NULL)) {
+            msg->msg_flags |= MSG_CTRUNC;
+        }
+        /* installed references now belong to the receiver's fd table, close the rest */
+        for (; i < m->nfds; i++) {
+            (VOID)close(m->fds[i]);
+        }
+        free(m->fds);
+        m->fds = NULL;
+        m->nfds = 0;
+    }
+
+    if (msg != NULL) {
+        msg->msg_controllen = used;
+    }
+}
+
+void UnixCtlRevoke(const struct msghdr *msg)
+{
+    struct cmsghdr *cmsg = NULL;
+    const int *procFds = NULL;
+    UINT32 nfds;
+    UINT32 i;
+    int sysFd;
+
+    if ((msg->msg_control == NULL) || (msg->msg_controllen == 0)) {
+        return;
+    }
+    for (cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR((struct msghdr *)msg, cmsg)) {
+        if ((cmsg->cmsg_level != SOL_SOCKET) || (cmsg->cmsg_type != SCM_RIGHTS)) {
+            continue;
+        }
+        procFds = (const int *)CMSG_DATA(cmsg);
+        nfds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (i = 0; i < nfds; i++) {
+            sysFd = DisassociateProcessFd(procFds[i]);
+            if (sysFd >= 0) {
+                (VOID)close(sysFd);
+            }
+            FreeProcessFd(procFds[i]);
+        }
+    }
+}
+
+/* ---------------- names ---------------- */
+
+/* Validate a sockaddr_un, path names end at their first NUL while abstract names use every byte */
+STATIC int UnixAddrLen(const struct sockaddr *addr, socklen_t addrLen, socklen_t *len)
+{
+    const struct sockaddr_un *sun = (const struct sockaddr_un *)addr;
+
+    if ((addr == NULL) || (addrLen <= UNIX_ADDR_MIN) || (addrLen > sizeof(struct sockaddr_un))) {
+        return -EINVAL;
+    }
+    if (sun->sun_family != AF_UNIX) {
+        return -EINVAL;
+    }
+    if (sun->sun_path[0] != '\0') {
+        *len = UNIX_ADDR_MIN + (socklen_t)strnlen(sun->sun_path, addrLen - UNIX_ADDR_MIN);
+    } else {
+        *len = addrLen;
+    }
+    return LOS_OK;
+}
+
+/* Report a name the way getsockname() does: unnamed sockets have only a family */
+STATIC VOID UnixAddrOut(const struct sockaddr_un *name, socklen_t len, struct sockaddr *addr, socklen_t *addrLen)
+{
+    struct sockaddr_un unnamed;
+
+    if ((addr == NULL) || (addrLen == NULL)) {
+        return;
+    }
+    if (len == 0) {
+        (VOID)memset_s(&unnamed, sizeof(unnamed), 0, sizeof(unnamed));
+        unnamed.sun_family = AF_UNIX;
+        name = &unnamed;
+        len = sizeof(sa_family_t);
+    } else if ((name->sun_path[0] != '\0') && (len < sizeof(struct sockaddr_un))) {
+        len++;  /* path names are reported with their terminating NUL */
+    }
+    (VOID)memcpy_s(addr, *addrLen, name, MIN(*addrLen, len));
+    *addrLen = len;
+}
+
+STATIC VOID UnixNameGet(const UnixSock *sock, struct sockaddr_un *name, socklen_t *len)
+{
+    UINT32 intSave;
+
+    LOS_SpinLockSave(&g_unixNameSpin, &intSave);
+    *len = sock->addrLen;
+    (VOID)memcpy_s(name, sizeof(struct sockaddr_un), &sock->addr, sizeof(struct sockaddr_un));
+    LOS_SpinUnlockRestore(&g_unixNameSpin, intSave);
+}
+
+STATIC UnixSock *UnixNameLookup(const struct sockaddr *addr, socklen_t addrLen, int *err)
+{
+    UnixSock *sock = NULL;
+    socklen_t len = 0;
+    UINT32 intSave;
+
+    *err = UnixAddrLen(addr, addrLen, &len);
+    if (*err != LOS_OK) {
+        return NULL;
+    }
+
+    LOS_SpinLockSave(&g_unixNameSpin, &intSave);
+    LOS_DL_LIST_FOR_EACH_ENTRY(sock, &g_unixNames, UnixSock, nameNode) {
+        if ((sock->addrLen == len) && (memcmp(&sock->addr, addr, len) == 0)) {
+            AnonFileHold(&sock->anon);
+            LOS_SpinUnlockRestore(&g_unixNameSpin, intSave);
+            return sock;
+        }
+    }
+    LOS_SpinUnlockRestore(&g_unixNameSpin, intSave);
+
+    *err = -ECONNREFUSED;
+    return NULL;
+}
+
+STATIC VOID UnixNameRemove(UnixSock *sock)
+{
+    UINT32 intSave;
+
+    LOS_SpinLockSave(&g_unixNameSpin, &intSave);
+    if (!LOS_ListEmpty(&sock->nameNode)) {
+        LOS_ListDelInit(&sock->nameNode);
+    }
+    LOS_SpinUnlockRestore(&g_unixNameSpin, intSave);
+}
+
+/* ---------------- readiness ---------------- */
+
+STATIC UINT32 UnixEventsLocked(const UnixSock *sock)
+{
+    const UnixSock *peer = sock->peer;
+    UINT32 events = 0;
+
+    if (sock->state == UNIX_SS_LISTENING) {
+        return LOS_ListEmpty(&sock->acceptQueue) ? 0 : UNIX_POLL_IN;
+    }
+
+    if (!LOS_ListEmpty(&sock->rxQueue) || (sock->shut & UNIX_SHUT_RCV)) {
+        events |= UNIX_POLL_IN;
+    }
+    if (sock->shut & UNIX_SHUT_RCV) {
+        events |= POLLRDHUP;
+    }
+    if ((sock->shut == UNIX_SHUT_MASK) ||
+        ((sock->type != SOCK_DGRAM) && (sock->state == UNIX_SS_UNCONNECTED))) {
+        events |= POLLHUP;
+    }
+    if (!(sock->shut & UNIX_SHUT_SEND)) {
+        /* the peer's counters are only a hint here, a sender rechecks them under the peer's lock */
+        if (peer != NULL) {
+            if (peer->rxMem < peer->rxLimit) {
+                events |= UNIX_POLL_OUT;
+            }
+        } else if (sock->type == SOCK_DGRAM) {
+            events |= UNIX_POLL_OUT;
+        }
+    }
+
+    return events;
+}
+
+STATIC UINT32 UnixGetEvents(struct EpollWatch *watch)
+{
+    UnixSock *sock = (UnixSock *)watch;
+    UINT32 intSave;
+    UINT32 events;
+
+    LOS_SpinLockSave(&sock->lock, &intSave);
+    events = UnixEventsLocked(sock);
+    LOS_SpinUnlockRestore(&sock->lock, intSave);
+
+    return events;
+}
+
+STATIC VOID UnixNotify(UnixSock *sock, UINT32 events)
+{
+    notify_poll(&sock->wq);
+    EpollWatchNotify(&sock->anon.watch, events);
+}
+
+STATIC VOID UnixWake(UnixSock *sock, UINT32 wakeup, UINT32 events)
+{
+    (VOID)LOS_EventWrite(&sock->event, wakeup);
+    UnixNotify(sock, events);
+}
+
+STATIC VOID UnixWait(UnixSock *sock, UINT32 wakeup)
+{
+    (VOID)LOS_EventRead(&sock->event, wakeup, LOS_WAITMODE_OR | LOS_WAITMODE_CLR, LOS_WAIT_FOREVER);
+}
+
+STATIC UnixSock *UnixPeerGet(UnixSock *sock)
+{
+    UnixSock *peer = NULL;
+    UINT32 intSave;
+
+    LOS_SpinLockSave(&sock->lock, &intSave);
+    peer = sock->peer;
+    if (peer != NULL) {
+        AnonFileHold(&peer->anon);
+    }
+    LOS_SpinUnlockRestore(&sock->lock, intSave);
+
+    return peer;
+}
+
+/* Receive space was freed: wake blocked senders and tell the connected peer it may write again */
+STATIC VOID UnixRxDrained(UnixSock *sock)
+{
+    UnixSock *peer = UnixPeerGet(sock);
+
+    (VOID)LOS_EventWrite(&sock->event, UNIX_EVENT_WRITABLE);
+    if (peer != NULL) {
+        UnixNotify(peer, UNIX_POLL_OUT);
+        AnonFileDrop(&peer->anon);
+    }
+}
+
+/* ---------------- lifetime ---------------- */
+
+STATIC const struct EpollWatchOps g_unixWatchOps = {
+    UnixGetEvents,
+    AnonWatchHold,
+    AnonWatchDrop,
+};
+
+STATIC VOID UnixSockRelease(struct AnonFile *anon)
+{
+    UnixSock *sock = (UnixSock *)anon;
+
+    UnixMsgPurge(&sock->rxQueue);
+    (VOID)LOS_MuxDestroy(&sock->rxMux);
+    (VOID)LOS_EventDestroy(&sock->event);
+    free(sock);
+}
+
+STATIC UnixSock *UnixSockAlloc(int type)
+{
+    UnixSock *sock = (UnixSock *)zalloc(sizeof(UnixSock));
+
+    if (sock == NULL) {
+        return NULL;
+    }
+    if (LOS_EventInit(&sock->event) != LOS_OK) {
+        free(sock);
+        return NULL;
+    }
+    if (LOS_MuxInit(&sock->rxMux, NULL) != LOS_OK) {
+        (VOID)LOS_EventDestroy(&sock->event);
+        free(sock);
+        return NULL;
+    }
+    LOS_SpinInit(&sock->lock);
+    sock->type = type;
+    sock->state = UNIX_SS_UNCONNECTED;
+    sock->rxLimit = UNIX_RCVBUF_DEFAULT;
+    LOS_ListInit(&sock->rxQueue);
+    LOS_ListInit(&sock->acceptQueue);
+    LOS_ListInit(&sock->acceptNode);
+    LOS_ListInit(&sock->nameNode);
+    UnixCredGet(&sock->cred);
+    sock->peerCred.uid = (uid_t)-1;
+    sock->peerCred.gid = (gid_t)-1;
+    init_waitqueue_head(&sock->wq);
+    AnonFileInit(&sock->anon, &g_unixWatchOps, UnixSockRelease);
+
+    return sock;
+}
+
+/* Connect two fresh sockets to each other, each side holds a reference on the other */
+STATIC VOID UnixPairLink(UnixSock *a, UnixSock *b)
+{
+    AnonFileHold(&a->anon);
+    AnonFileHold(&b->anon);
+    a->peer = b;
+    b->peer = a;
+    a->state = UNIX_SS_CONNECTED;
+    b->state = UNIX_SS_CONNECTED;
+    a->peerCred = b->cred;
+    b->peerCred = a->cred;
+}
+
+/*
+ * Break every link a socket has, called once when its descriptor is closed (or for an embryo
+ * nobody accepted). The rule for peer references is that whoever clears X->peer drops that one.
+ */
+STATIC VOID UnixSockDisconnect(UnixSock *sock)
+{
+    LOS_DL_LIST rx;
+    LOS_DL_LIST embryos;
+    UnixSock *peer = NULL;
+    UnixSock *child = NULL;
+    UnixSock *next = NULL;
+    BOOL linked = FALSE;
+    UINT32 intSave;
+
+    UnixNameRemove(sock);
+    LOS_ListInit(&rx);
+    LOS_ListInit(&embryos);
+
+    LOS_SpinLockSave(&sock->lock, &intSave);
+    sock->state = UNIX_SS_CLOSED;
+    sock->shut = UNIX_SHUT_MASK;
+    peer = sock->peer;
+    sock->peer = NULL;
+    UnixListSplice(&sock->rxQueue, &rx);
+    sock->rxBytes = 0;
+    sock->rxMem = 0;
+    UnixListSplice(&sock->acceptQueue, &embryos);
+    sock->pending = 0;
+    LOS_SpinUnlockRestore(&sock->lock, intSave);
+
+    if (peer != NULL) {
+        LOS_SpinLockSave(&peer->lock, &intSave);
+        if (peer->peer == sock) {
+            peer->peer = NULL;
+            if (sock->type != SOCK_DGRAM) {
+                peer->shut = UNIX_SHUT_MASK;
+            }
+            linked = TRUE;
+        }
+        LOS_SpinUnlockRestore(&peer->lock, intSave);
+
+        if (linked) {
+            UnixWake(peer, UNIX_EVENT_READABLE | UNIX_EVENT_WRITABLE,
+                     UNIX_POLL_IN | UNIX_POLL_OUT | POLLHUP | POLLRDHUP);
+            AnonFileDrop(&sock->anon);
+        }
+        AnonFileDrop(&peer->anon);
+    }
+
+    LOS_DL_LIST_FOR_EACH_ENTRY_SAFE(child, next, &embryos, UnixSock, acceptNode) {
+        LOS_ListDelInit(&child->acceptNode);
+        UnixSockDisconnect(child);
+        AnonFileDrop(&child->anon);
+    }
+    UnixMsgPurge(&rx);
+
+    /* anyone still sleeping on this socket must see it closed */
+    UnixWake(sock, UNIX_EVENT_READABLE | UNIX_EVENT_WRITABLE | UNIX_EVENT_BACKLOG, 0);
+}
+
+/* ---------------- send ---------------- */
+
+STATIC int UnixEnqueue(UnixSock *peer, UnixMsg *msg, BOOL nonblock)
+{
+    UINT32 intSave;
+    BOOL more = FALSE;
+
+    while (TRUE) {
+        LOS_SpinLockSave(&peer->lock, &intSave);
+        if ((peer->state == UNIX_SS_CLOSED) || (peer->shut & UNIX_SHUT_RCV)) {
+            LOS_SpinUnlockRestore(&peer->lock, intSave);
+            return (peer->type == SOCK_DGRAM) ? -ECONNREFUSED : -EPIPE;
+        }
+        if (peer->rxMem < peer->rxLimit) {
+            LOS_ListTailInsert(&peer->rxQueue, &msg->node);
+            peer->rxBytes += msg->len;
+            peer->rxMem += UNIX_MSG_TRUESIZE(msg->len);
+            more = (peer->rxMem < peer->rxLimit);
+            LOS_SpinUnlockRestore(&peer->lock, intSave);
+            break;
+        }
+        LOS_SpinUnlockRestore(&peer->lock, intSave);
+
+        if (nonblock) {
+            return -EAGAIN;
+        }
+        UnixWait(peer, UNIX_EVENT_WRITABLE);
+    }
+
+    /* pass the wakeup on to the next sender while there is still room */
+    UnixWake(peer, more ? (UNIX_EVENT_READABLE | UNIX_EVENT_WRITABLE) : UNIX_EVENT_READABLE, UNIX_POLL_IN);
+    return LOS_OK;
+}
+
+STATIC ssize_t UnixStreamSend(UnixSock *peer, UnixIo *io, UnixCtl *ctl)
+{
+    size_t sent = 0;
+    UINT32 chunk;
+    UnixMsg *msg = NULL;
+    int ret = LOS_OK;
+
+    while (sent < io->len) {
+        chunk = (UINT32)MIN(io->len - sent, UNIX_CHUNK_MAX);
+        msg = UnixMsgAlloc(chunk);
+        if (msg == NULL) {
+            ret = -ENOMEM;
+            break;
+        }
+        ret = UnixIoCopy(io, msg->data, chunk, FALSE);
+        if (ret != LOS_OK) {
+            UnixMsgFree(msg);
+            break;
+        }
+        /* ancillary data rides on the first byte of the write */
+        if (sent == 0) {
+            UnixCtlAttach(msg, ctl);
+        }
+        ret = UnixEnqueue(peer, msg, io->nonblock);
+        if (ret != LOS_OK) {
+            UnixMsgFree(msg);
+            break;
+        }
+        sent += chunk;
+    }
+
+    return (sent > 0) ? (ssize_t)sent : ret;
+}
+
+STATIC ssize_t UnixDgramSend(const UnixSock *sock, UnixSock *peer, UnixIo *io, UnixCtl *ctl)
+{
+    UnixMsg *msg = NULL;
+    int ret;
+
+    if ((io->len > UNIX_DGRAM_MAX) || (UNIX_MSG_TRUESIZE(io->len) > peer->rxLimit)) {
+        return -EMSGSIZE;
+    }
+    msg = UnixMsgAlloc((UINT32)io->len);
+    if (msg == NULL) {
+        return -ENOMEM;
+    }
+    ret = UnixIoCopy(io, msg->data, io->len, FALSE);
+    if (ret == LOS_OK) {
+        UnixNameGet(sock, &msg->from, &msg->fromLen);
+        UnixCtlAttach(msg, ctl);
+        ret = UnixEnqueue(peer, msg, io->nonblock);
+    }
+    if (ret != LOS_OK) {
+        UnixMsgFree(msg);
+        return ret;
+    }
+
+    return (ssize_t)io->len;
+}
+
+STATIC ssize_t UnixSend(UnixSock *sock, UnixIo *io, const struct sockaddr *to, socklen_t toLen, UnixCtl *ctl)
+{
+    UnixSock *peer = NULL;
+    UINT32 intSave;
+    int err = LOS_OK;
+    ssize_t ret;
+
+    if (io->flags & MSG_OOB) {
+        return -EOPNOTSUPP;
+    }
+
+    LOS_SpinLockSave(&sock->lock, &intSave);
+    if (sock->shut & UNIX_SHUT_SEND) {
+        LOS_SpinUnlockRestore(&sock->lock, intSave);
+        return -EPIPE;
+    }
+    if ((to != NULL) && (sock->type != SOCK_DGRAM)) {
+        err = (sock->state == UNIX_SS_CONNECTED) ? -EISCONN : -EOPNOTSUPP;
+    } else if (to == NULL) {
+        peer = sock->peer;
+        if (peer == NULL) {
+            err = -ENOTCONN;
+        } else {
+            AnonFileHold(&peer->anon);
+        }
+    }
+    LOS_SpinUnlockRestore(&sock->lock, intSave);
+    if (err != LOS_OK) {
+        return err;
+    }
+
+    if (to != NULL) {
+        peer = UnixNameLookup(to, toLen, &err);
+        if (peer == NULL) {
+            return err;
+        }
+        if (peer->type != SOCK_DGRAM) {
+            AnonFileDrop(&peer->anon);
+            return -EPROTOTYPE;
+        }
+    }
+
+    if (sock->type == SOCK_STREAM) {
+        ret = UnixStreamSend(peer, io, ctl);
+    } else {
+        ret = UnixDgramSend(sock, peer, io, ctl);
+    }
+    AnonFileDrop(&peer->anon);
+
+    return ret;
+}
+
+/* ---------------- receive ---------------- */
+
+/* Wait for the queue to fill; returns 1 with data queued, 0 at end of stream, or -errno */
+STATIC int UnixRecvWait(UnixSock *sock, const UnixIo *io)
+{
+    UINT32 intSave;
+    UINT32 state;
+    UINT32 shut;
+
+    while (TRUE) {
+        LOS_SpinLockSave(&sock->lock, &intSave);
+        if (!LOS_ListEmpty(&sock->rxQueue)) {
+            LOS_SpinUnlockRestore(&sock->lock, intSave);
+            return 1;
+        }
+        state = sock->state;
+        shut = sock->shut;
+        LOS_SpinUnlockRestore(&sock->lock, intSave);
+
+        if (shut & UNIX_SHUT_RCV) {
+            return 0;
+        }
+        if ((sock->type != SOCK_DGRAM) && (state != UNIX_SS_CONNECTED) && (state != UNIX_SS_CONNECTING)) {
+            return -ENOTCONN;
+        }
+        if (io->nonblock) {
+            return -EAGAIN;
+        }
+        UnixWait(sock, UNIX_EVENT_READABLE);
+    }
+}
+
+STATIC ssize_t UnixStreamRecv(UnixSock *sock, UnixIo *io)
+{
+    UnixMsg *m = NULL;
+    size_t copied = 0;
+    UINT32 n;
+    UINT32 intSave;
+    BOOL consumed = FALSE;
+    BOOL done;
+    int ret = LOS_OK;
+
+    while (copied < io->len) {
+        if ((copied > 0) && !(io->flags & MSG_WAITALL)) {
+            LOS_SpinLockSave(&sock->lock, &intSave);
+            done = LOS_ListEmpty(&sock->rxQueue);
+            LOS_SpinUnlockRestore(&sock->lock, intSave);
+            if (done) {
+                break;
+            }
+        }
+        ret = UnixRecvWait(sock, io);
+        if (ret <= 0) {
+            break;
+        }
+
+        /* only readers remove messages and they are serialized, so the head stays put */
+        LOS_SpinLockSave(&sock->lock, &intSave);
+        m = LOS_DL_LIST_ENTRY(sock->rxQueue.pstNext, UnixMsg, node);
+        LOS_SpinUnlockRestore(&sock->lock, intSave);
+
+        /* never read across the start of a write that carries descriptors */
+        if ((copied > 0) && (m->nfds != 0)) {
+            break;
+        }
+        if (copied == 0) {
+            UnixCtlDeliver(sock, m, io);
+        }
+
+        n = (UINT32)MIN(io->len - copied, m->len - m->off);
+        ret = UnixIoCopy(io, m->data + m->off, n, TRUE);
+        if (ret != LOS_OK) {
+            break;
+        }
+        copied += n;
+        if (io->flags & MSG_PEEK) {
+            break;
+        }
+
+        LOS_SpinLockSave(&sock->lock, &intSave);
+        m->off += n;
+        sock->rxBytes -= n;
+        done = (m->off == m->len);
+        if (done) {
+            LOS_ListDelete(&m->node);
+            sock->rxMem -= UNIX_MSG_TRUESIZE(m->len);
+        }
+        LOS_SpinUnlockRestore(&sock->lock, intSave);
+        if (done) {
+            UnixMsgFree(m);
+            consumed = TRUE;
+        }
+    }
+
+    if (consumed) {
+        UnixRxDrained(sock);
+    }
+    return (copied > 0) ? (ssize_t)copied : ret;
+}
+
+STATIC ssize_t UnixDgramRecv(UnixSock *sock, UnixIo *io)
+{
+    UnixMsg *m = NULL;
+    UINT32 intSave;
+    size_t n;
+    size_t len;
+    int ret;
+
+    ret = UnixRecvWait(sock, io);
+    if (ret <= 0) {
+        return ret;
+    }
+
+    LOS_SpinLockSave(&sock->lock, &intSave);
+    m = LOS_DL_LIST_ENTRY(sock->rxQueue.pstNext, UnixMsg, node);
+    if (!(io->flags & MSG_PEEK)) {
+        LOS_ListDelete(&m->node);
+        sock->rxBytes -= m->len;
+        sock->rxMem -= UNIX_MSG_TRUESIZE(m->len);
+    }
+    LOS_SpinUnlockRestore(&sock->lock, intSave);
+
+    len = m->len;
+    n = MIN(io->len, len);
+    ret = UnixIoCopy(io, m->data, n, TRUE);
+    if (io->msg != NULL) {
+        if (len > n) {
+            io->msg->msg_flags |= MSG_TRUNC;
+        }
+        if (sock->type == SOCK_DGRAM) {
+            UnixAddrOut(&m->from, m->fromLen, (struct sockaddr *)io->msg->msg_name, &io->msg->msg_namelen);
+        }
+    }
+    UnixCtlDeliver(sock, m, io);
+
+    if (!(io->flags & MSG_PEEK)) {
+        UnixMsgFree(m);
+        UnixRxDrained(sock);
+    }
+    if (ret != LOS_OK) {
+        return ret;
+    }
+    return (io->flags & MSG_TRUNC) ? (ssize_t)len : (ssize_t)n;
+}
+
+STATIC ssize_t UnixRecv(UnixSock *sock, UnixIo *io)
+{
+    ssize_t ret;
+
+    if (io->flags & MSG_OOB) {
+        return -EOPNOTSUPP;
+    }
+    if (sock->state == UNIX_SS_LISTENING) {
+        return -EINVAL;
+    }
+
+    (VOID)LOS_MuxLock(&sock->rxMux, LOS_WAIT_FOREVER);
+    if (sock->type == SOCK_STREAM) {
+        ret = UnixStreamRecv(sock, io);
+    } else {
+        ret = UnixDgramRecv(sock, io);
+    }
+    (VOID)LOS_MuxUnlock(&sock->rxMux);
+
+    return ret;
+}
+
+/* ---------------- file operations ---------------- */
+
+STATIC ssize_t UnixRead(struct file *filep, char *buffer, size_t buflen)
+{
+    UnixSock *sock = (UnixSock *)AnonFileGet(filep);
+    struct iovec iov = { buffer, buflen };
+    UnixIo io;
+    int ret;
+
+    if (sock == NULL) {
+        return -EBADF;
+    }
+    ret = UnixIoInit(&io, &iov, 1, 0, (filep->f_oflags & O_NONBLOCK) ? TRUE : FALSE);
+    if (ret != LOS_OK) {
+        return ret;
+    }
+    return UnixRecv(sock, &io);
+}
+
+STATIC ssize_t UnixWrite(struct file *filep, const char *buffer, size_t buflen)
+{
+    UnixSock *sock = (UnixSock *)AnonFileGet(filep);
+    struct iovec iov = { (char *)buffer, buflen };
+    UnixCtl ctl;
+    UnixIo io;
+    int ret;
+
+    if (sock == NULL) {
+        return -EBADF;
+    }
+    ret = UnixIoInit(&io, &iov, 1, 0, (filep->f_oflags & O_NONBLOCK) ? TRUE : FALSE);
+    if (ret != LOS_OK) {
+        return ret;
+    }
+    (VOID)memset_s(&ctl, sizeof(ctl), 0, sizeof(ctl));
+    return UnixSend(sock, &io, NULL, 0, &ctl);
+}
+
+STATIC int UnixIoctl(struct file *filep, int cmd, unsigned long arg)
+{
+    UnixSock *sock = (UnixSock *)AnonFileGet(filep);
+    UINT32 intSave;
+    int avail = 0;
+
+    if (sock == NULL) {
+        return -EBADF;
+    }
+
+    switch (cmd) {
+        case FIONREAD:
+            LOS_SpinLockSave(&sock->lock, &intSave);
+            if (sock->type == SOCK_STREAM) {
+                avail = (int)sock->rxBytes;
+            } else if (!LOS_ListEmpty(&sock->rxQueue)) {
+                avail = (int)LOS_DL_LIST_ENTRY(sock->rxQueue.pstNext, UnixMsg, node)->len;
+            }
+            LOS_SpinUnlockRestore(&sock->lock, intSave);
+            return AnonFileCopyOut((VOID *)(UINTPTR)arg, &avail, sizeof(int));
+        default:
+            return -ENOTTY;
+    }
+}
+
+#ifndef CONFIG_DISABLE_POLL
+STATIC int UnixPoll(struct file *filep, poll_table *table)
+{
+    UnixSock *sock = (UnixSock *)AnonFileGet(filep);
+
+    if (sock == NULL) {
+        return POLLERR;
+    }
+
+    poll_wait(filep, &sock->wq, table);
+    return (int)UnixGetEvents(&sock->anon.watch);
+}
+#endif
+
+STATIC int UnixClose(struct file *filep)
+{
+    UnixSock *sock = (UnixSock *)AnonFileGet(filep);
+
+    if (sock == NULL) {
+        return -EBADF;
+    }
+
+    EpollWatchDetach(&sock->anon.watch);
+    UnixSockDisconnect(sock);
+    AnonFileDrop(&sock->anon);
+    return LOS_OK;
+}
+
+STATIC const struct file_operations_vfs g_unixFops = {
+    NULL,           /* open */
+    UnixClose,      /* close */
+    UnixRead,       /* read */
+    UnixWrite,      /* write */
+    NULL,           /* seek */
+    UnixIoctl,      /* ioctl */
+    NULL,           /* mmap */
+#ifndef CONFIG_DISABLE_POLL
+    UnixPoll,       /* poll */
+#endif
+    NULL,           /* unlink */
+};
+
+STATIC int UnixSockInstall(UnixSock *sock, int flags)
+{
+    return AnonFileAlloc(&g_unixFops, &sock->anon, O_RDWR | ((flags & SOCK_NONBLOCK) ? O_NONBLOCK : 0));
+}
+
+/* Look a system fd up as an AF_UNIX socket and pin it for the duration of a call */
+STATIC UnixSock *UnixSockGet(int sysFd, BOOL *nonblock)
+{
+    struct file *filep = NULL;
+    UnixSock *sock = NULL;
+
+    if ((sysFd < 0) || (sysFd >= CONFIG_NFILE_DESCRIPTORS) || (fs_getfilep(sysFd, &filep) < 0) ||
+        (filep->ops != &g_unixFops)) {
+        return NULL;
+    }
+    sock = (UnixSock *)AnonFileGet(filep);
+    if (sock != NULL) {
+        AnonFileHold(&sock->anon);
+        if (nonblock != NULL) {
+            *nonblock = (filep->f_oflags & O_NONBLOCK) ? TRUE : FALSE;
+        }
+    }
+    return sock;
+}
+
+STATIC INLINE VOID UnixSockPut(UnixSock *sock)
+{
+    AnonFileDrop(&sock->anon);
+}
+
+/* ---------------- socket calls ---------------- */
+
+BOOL UnixSocketIs(int sysFd)
+{
+    struct file *filep = NULL;
+
+    if ((sysFd < 0) || (sysFd >= CONFIG_NFILE_DESCRIPTORS) || (fs_getfilep(sysFd, &filep) < 0)) {
+        return FALSE;
+    }
+    return (filep->ops == &g_unixFops) ? TRUE : FALSE;
+}
+
+STATIC int UnixTypeCheck(int type, int protocol)
+{
+    if ((type != SOCK_STREAM) && (type != SOCK_DGRAM) && (type != SOCK_SEQPACKET)) {
+        return -ESOCKTNOSUPPORT;
+    }
+    if ((protocol != 0) && (protocol != PF_UNIX)) {
+        return -EPROTONOSUPPORT;
+    }
+    return LOS_OK;
+}
+
+int UnixSocketCreate(int type, int protocol)
+{
+    int flags = type & SOCK_NONBLOCK;
+    UnixSock *sock = NULL;
+    int sysFd;
+
+    /* close-on-exec is not tracked by the fd table, as for the other anonymous fds */
+    type &= ~(SOCK_NONBLOCK | SOCK_CLOEXEC);
+    sysFd = UnixTypeCheck(type, protocol);
+    if (sysFd != LOS_OK) {
+        return sysFd;
+    }
+
+    sock = UnixSockAlloc(type);
+    if (sock == NULL) {
+        return -ENOMEM;
+    }
+    sysFd = UnixSockInstall(sock, flags);
+    if (sysFd < 0) {
+        AnonFileDrop(&sock->anon);
+    }
+
+    return sysFd;
+}
+
+int UnixSocketPair(int type, int protocol, int sv[2])
+{
+    int flags = type & SOCK_NONBLOCK;
+    UnixSock *a = NULL;
+    UnixSock *b = NULL;
+    int ret;
+
+    /* close-on-exec is not tracked by the fd table, as for the other anonymous fds */
+    type &= ~(SOCK_NONBLOCK | SOCK_CLOEXEC);
+    ret = UnixTypeCheck(type, protocol);
+    if (ret != LOS_OK) {
+        return ret;
+    }
+
+    a = UnixSockAlloc(type);
+    b = UnixSockAlloc(type);
+    if ((a == NULL) || (b == NULL)) {
+        if (a != NULL) {
+            AnonFileDrop(&a->anon);
+        }
+        if (b != NULL) {
+            AnonFileDrop(&b->anon);
+        }
+        return -ENOMEM;
+    }
+    UnixPairLink(a, b);
+
+    sv[0] = UnixSockInstall(a, flags);
+    if (sv[0] < 0) {
+        ret = sv[0];
+        UnixSockDisconnect(a);
+        AnonFileDrop(&a->anon);
+        UnixSockDisconnect(b);
+        AnonFileDrop(&b->anon);
+        return ret;
+    }
+    sv[1] = UnixSockInstall(b, flags);
+    if (sv[1] < 0) {
+        ret = sv[1];
+        (VOID)close(sv[0]);
+        UnixSockDisconnect(b);
+        AnonFileDrop(&b->anon);
+        return ret;
+    }
+
+    return LOS_OK;
+}
+
+int UnixBind(int sysFd, const struct sockaddr *addr, socklen_t addrLen)
+{
+    UnixSock *sock = UnixSockGet(sysFd, NULL);
+    UnixSock *other = NULL;
+    socklen_t len = 0;
+    UINT32 intSave;
+    int ret;
+
+    if (sock == NULL) {
+        return -EBADF;
+    }
+    ret = UnixAddrLen(addr, addrLen, &len);
+    if (ret != LOS_OK) {
+        goto OUT;
+    }
+
+    LOS_SpinLockSave(&g_unixNameSpin, &intSave);
+    if (sock->addrLen != 0) {
+        ret = -EINVAL;
+    } else {
+        LOS_DL_LIST_FOR_EACH_ENTRY(other, &g_unixNames, UnixSock, nameNode) {
+            if ((other->addrLen == len) && (memcmp(&other->addr, addr, len) == 0)) {
+                ret = -EADDRINUSE;
+                break;
+            }
+        }
+    }
+    if (ret == LOS_OK) {
+        (VOID)memset_s(&sock->addr, sizeof(sock->addr), 0, sizeof(sock->addr));
+        (VOID)memcpy_s(&sock->addr, sizeof(sock->addr), addr, len);
+        sock->addrLen = len;
+        LOS_ListTailInsert(&g_unixNames, &sock->nameNode);
+    }
+    LOS_SpinUnlockRestore(&g_unixNameSpin, intSave);
+
+OUT:
+    UnixSockPut(sock);
+    return ret;
+}
+
+int UnixListen(int sysFd, int backlog)
+{
+    UnixSock *sock = UnixSockGet(sysFd, NULL);
+    UINT32 intSave;
+    int ret = LOS_OK;
+
+    if (sock == NULL) {
+        return -EBADF;
+    }
+    if (sock->type == SOCK_DGRAM) {
+        UnixSockPut(sock);
+        return -EOPNOTSUPP;
+    }
+
+    LOS_SpinLockSave(&sock->lock, &intSave);
+    if ((sock->addrLen == 0) ||
+        ((sock->state != UNIX_SS_UNCONNECTED) && (sock->state != UNIX_SS_LISTENING))) {
+        ret = -EINVAL;
+    } else {
+        sock->backlog = (backlog <= 0) ? 1 : MIN((UINT32)backlog, UNIX_BACKLOG_MAX);
+        if (sock->state == UNIX_SS_UNCONNECTED) {
+            UnixCredGet(&sock->cred);
+            sock->state = UNIX_SS_LISTENING;
+        }
+    }
+    LOS_SpinUnlockRestore(&sock->lock, intSave);
+
+    /* a larger backlog may admit connectors that are already waiting */
+    UnixWake(sock, UNIX_EVENT_BACKLOG, 0);
+    UnixSockPut(sock);
+    return ret;
+}
+
+/*
+ * Queue an embryo on the listener. The embryo is the accepting end: it is already connected to
+ * sock, so the server can talk to it as soon as accept() returns it.
+ */
+STATIC int UnixStreamConnect(UnixSock *sock, UnixSock *listener, BOOL nonblock)
+{
+    UnixSock *child = NULL;
+    UINT32 intSave;
+    BOOL linked = FALSE;
+    int ret = LOS_OK;
+
+    if (listener->type != sock->type) {
+        return -EPROTOTYPE;
+    }
+
+    LOS_SpinLockSave(&sock->lock, &intSave);
+    if (sock->state != UNIX_SS_UNCONNECTED) {
+        ret = (sock->state == UNIX_SS_CONNECTED) ? -EISCONN :
+              ((sock->state == UNIX_SS_CONNECTING) ? -EALREADY : -EINVAL);
+    } else {
+        sock->state = UNIX_SS_CONNECTING;
+    }
+    LOS_SpinUnlockRestore(&sock->lock, intSave);
+    if (ret != LOS_OK) {
+        return ret;
+    }
+
+    child = UnixSockAlloc(sock->type);
+    if (child == NULL) {
+        ret = -ENOMEM;
+        goto ERR;
+    }
+    AnonFileHold(&sock->anon);
+    child->peer = sock;
+    child->state = UNIX_SS_CONNECTED;
+    UnixCredGet(&child->peerCred);
+    UnixNameGet(listener, &child->addr, &child->addrLen);
+
+    while (TRUE) {
+        LOS_SpinLockSave(&listener->lock, &intSave);
+        if (listener->state != UNIX_SS_LISTENING) {
+            LOS_SpinUnlockRestore(&listener->lock, intSave);
+            ret = -ECONNREFUSED;
+            goto ERR;
+        }
+        if (listener->pending < listener->backlog) {
+            child->cred = listener->cred;
+            LOS_ListTailInsert(&listener->acceptQueue, &child->acceptNode);
+            listener->pending++;
+            LOS_SpinUnlockRestore(&listener->lock, intSave);
+            break;
+        }
+        LOS_SpinUnlockRestore(&listener->lock, intSave);
+
+        if (nonblock) {
+            ret = -EAGAIN;
+            goto ERR;
+        }
+        UnixWait(listener, UNIX_EVENT_BACKLOG);
+    }
+
+    LOS_SpinLockSave(&sock->lock, &intSave);
+    if (sock->state == UNIX_SS_CONNECTING) {
+        AnonFileHold(&child->anon);
+        sock->peer = child;
+        sock->peerCred = child->cred;
+        sock->state = UNIX_SS_CONNECTED;
+    } else {
+        ret = -ECONNABORTED;
+    }
+    LOS_SpinUnlockRestore(&sock->lock, intSave);
+
+    if (ret != LOS_OK) {
+        /* closed while connecting, the accepting end only ever sees a hangup */
+        LOS_SpinLockSave(&child->lock, &intSave);
+        if (child->peer == sock) {
+            child->peer = NULL;
+            child->shut = UNIX_SHUT_MASK;
+            linked = TRUE;
+        }
+        LOS_SpinUnlockRestore(&child->lock, intSave);
+        if (linked) {
+            AnonFileDrop(&sock->anon);
+        }
+    }
+
+    UnixWake(listener, UNIX_EVENT_READABLE, UNIX_POLL_IN);
+    return ret;
+
+ERR:
+    if (child != NULL) {
+        child->peer = NULL;
+        AnonFileDrop(&sock->anon);
+        AnonFileDrop(&child->anon);
+    }
+    LOS_SpinLockSave(&sock->lock, &intSave);
+    if (sock->state == UNIX_SS_CONNECTING) {
+        sock->state = UNIX_SS_UNCONNECTED;
+    }
+    LOS_SpinUnlockRestore(&sock->lock, intSave);
+    return ret;
+}
+
+/* Datagram connect only sets the default destination, the target does not learn about it */
+STATIC int UnixDgramConnect(UnixSock *sock, UnixSock *target)
+{
+    UnixSock *old = NULL;
+    UINT32 intSave;
+
+    if (target->type != SOCK_DGRAM) {
+        return -EPROTOTYPE;
+    }
+
+    AnonFileHold(&target->anon);
+    LOS_SpinLockSave(&sock->lock, &intSave);
+    if (sock->state == UNIX_SS_CLOSED) {
+        LOS_SpinUnlockRestore(&sock->lock, intSave);
+        AnonFileDrop(&target->anon);
+        return -EBADF;
+    }
+    old = sock->peer;
+    sock->peer = target;
+    sock->peerCred = target->cred;
+    sock->state = UNIX_SS_CONNECTED;
+    LOS_SpinUnlockRestore(&sock->lock, intSave);
+
+    if (old != NULL) {
+        AnonFileDrop(&old->anon);
+    }
+    return LOS_OK;
+}
+
+int UnixConnect(int sysFd, const struct sockaddr *addr, socklen_t addrLen)
+{
+    BOOL nonblock = FALSE;
+    UnixSock *sock = UnixSockGet(sysFd, &nonblock);
+    UnixSock *target = NULL;
+    int ret = LOS_OK;
+
+    if (sock == NULL) {
+        return -EBADF;
+    }
+
+    target = UnixNameLookup(addr, addrLen, &ret);
+    if (target != NULL) {
+        if (sock->type == SOCK_DGRAM) {
+            ret = UnixDgramConnect(sock, target);
+        } else {
+            ret = UnixStreamConnect(sock, target, nonblock);
+        }
+        AnonFileDrop(&target->anon);
+    }
+
+    UnixSockPut(sock);
+    return ret;
+}
+
+int UnixAccept(int sysFd, struct sockaddr *addr, socklen_t *addrLen, int flags)
+{
+    BOOL nonblock = FALSE;
+    UnixSock *sock = UnixSockGet(sysFd, &nonblock);
+    UnixSock *child = NULL;
+    UnixSock *peer = NULL;
+    struct sockaddr_un name;
+    socklen_t nameLen = 0;
+    UINT32 intSave;
+    BOOL more = FALSE;
+    int ret;
+
+    if (sock == NULL) {
+        return -EBADF;
+    }
+    if ((flags & ~(SOCK_NONBLOCK | SOCK_CLOEXEC)) != 0) {
+        ret = -EINVAL;
+        goto OUT;
+    }
+    if (sock->type == SOCK_DGRAM) {
+        ret = -EOPNOTSUPP;
+        goto OUT;
+    }
+
+    while (TRUE) {
+        LOS_SpinLockSave(&sock->lock, &intSave);
+        if (sock->state != UNIX_SS_LISTENING) {
+            LOS_SpinUnlockRestore(&sock->lock, intSave);
+            ret = -EINVAL;
+            goto OUT;
+        }
+        if (!LOS_ListEmpty(&sock->acceptQueue)) {
+            child = LOS_DL_LIST_ENTRY(sock->acceptQueue.pstNext, UnixSock, acceptNode);
+            LOS_ListDelInit(&child->acceptNode);
+            sock->pending--;
+            more = !LOS_ListEmpty(&sock->acceptQueue);
+            LOS_SpinUnlockRestore(&sock->lock, intSave);
+            break;
+        }
+        LOS_SpinUnlockRestore(&sock->lock, intSave);
+
+        if (nonblock) {
+            ret = -EAGAIN;
+            goto OUT;
+        }
+        UnixWait(sock, UNIX_EVENT_READABLE);
+    }
+
+    /* pass the wakeup on to the next acceptor, and let a waiting connector in */
+    (VOID)LOS_EventWrite(&sock->event, more ? (UNIX_EVENT_READABLE | UNIX_EVENT_BACKLOG) : UNIX_EVENT_BACKLOG);
+
+    peer = UnixPeerGet(child);
+    if (peer != NULL) {
+        UnixNameGet(peer, &name, &nameLen);
+        AnonFileDrop(&peer->anon);
+    }
+    ret = UnixSockInstall(child, flags);
+    if (ret < 0) {
+        UnixSockDisconnect(child);
+        AnonFileDrop(&child->anon);
+        goto OUT;
+    }
+    UnixAddrOut(&name, nameLen, addr, addrLen);
+
+OUT:
+    UnixSockPut(sock);
+    return ret;
+}
+
+int UnixShutdown(int sysFd, int how)
+{
+    UnixSock *sock = NULL;
+    UnixSock *peer = NULL;
+    UINT32 self;
+    UINT32 other;
+    UINT32 intSave;
+
+    switch (how) {
+        case SHUT_RD:
+            self = UNIX_SHUT_RCV;
+            other = UNIX_SHUT_SEND;
+            break;
+        case SHUT_WR:
+            self = UNIX_SHUT_SEND;
+            other = UNIX_SHUT_RCV;
+            break;
+        case SHUT_RDWR:
+            self = UNIX_SHUT_MASK;
+            other = UNIX_SHUT_MASK;
+            break;
+        default:
+            return -EINVAL;
+    }
+
+    sock = UnixSockGet(sysFd, NULL);
+    if (sock == NULL) {
+        return -EBADF;
+    }
+
+    LOS_SpinLockSave(&sock->lock, &intSave);
+    sock->shut |= self;
+    peer = sock->peer;
+    if ((peer != NULL) && (sock->type != SOCK_DGRAM)) {
+        AnonFileHold(&peer->anon);
+    } else {
+        peer = NULL;
+    }
+    LOS_SpinUnlockRestore(&sock->lock, intSave);
+    UnixWake(sock, UNIX_EVENT_READABLE | UNIX_EVENT_WRITABLE, UNIX_POLL_IN | UNIX_POLL_OUT | POLLRDHUP);
+
+    if (peer != NULL) {
+        LOS_SpinLockSave(&peer->lock, &intSave);
+        if (peer->peer == sock) {
+            peer->shut |= other;
+        }
+        LOS_SpinUnlockRestore(&peer->lock, intSave);
+        UnixWake(peer, UNIX_EVENT_READABLE | UNIX_EVENT_WRITABLE, UNIX_POLL_IN | UNIX_POLL_OUT | POLLRDHUP);
+        AnonFileDrop(&peer->anon);
+    }
+
+    UnixSockPut(sock);
+    return LOS_OK;
+}
+
+int UnixGetName(int sysFd, struct sockaddr *addr, socklen_t *addrLen, BOOL peer)
+{
+    UnixSock *sock = UnixSockGet(sysFd, NULL);
+    UnixSock *target = NULL;
+    struct sockaddr_un name;
+    socklen_t nameLen = 0;
+
+    if (sock == NULL) {
+        return -EBADF;
+    }
+
+    target = peer ? UnixPeerGet(sock) : sock;
+    if (target == NULL) {
+        UnixSockPut(sock);
+        return -ENOTCONN;
+    }
+    UnixNameGet(target, &name, &nameLen);
+    UnixAddrOut(&name, nameLen, addr, addrLen);
+
+    if (peer) {
+        AnonFileDrop(&target->anon);
+    }
+    UnixSockPut(sock);
+    return LOS_OK;
+}
+
+int UnixSetSockOpt(int sysFd, int level, int optName, const void *optValue, socklen_t optLen)
+{
+    UnixSock *sock = NULL;
+    UINT32 intSave;
+    int val;
+    int ret = LOS_OK;
+
+    if (level != SOL_SOCKET) {
+        return -ENOPROTOOPT;
+    }
+    if ((optValue == NULL) || (optLen < sizeof(int))) {
+        return -EINVAL;
+    }
+    val = *(const int *)optValue;
+
+    sock = UnixSockGet(sysFd, NULL);
+    if (sock == NULL) {
+        return -EBADF;
+    }
+
+    LOS_SpinLockSave(&sock->lock, &intSave);
+    switch (optName) {
+        case SO_PASSCRED:
+            sock->passCred = (val != 0) ? TRUE : FALSE;
+            break;
+        case SO_RCVBUF:
+            sock->rxLimit = (val < (int)UNIX_RCVBUF_MIN) ? UNIX_RCVBUF_MIN :
+                            (((UINT32)val > UNIX_RCVBUF_MAX) ? UNIX_RCVBUF_MAX : (UINT32)val);
+            break;
+        case SO_SNDBUF:
+            /* flow control is done against the receiver's buffer, accepted for compatibility */
+            break;
+        default:
+            ret = -ENOPROTOOPT;
+            break;
+    }
+    LOS_SpinUnlockRestore(&sock->lock, intSave);
+
+    if (optName == SO_RCVBUF) {
+        UnixRxDrained(sock);
+    }
+    UnixSockPut(sock);
+    return ret;
+}
+
+int UnixGetSockOpt(int sysFd, int level, int optName, void *optValue, socklen_t *optLen)
+{
+    UnixSock *sock = NULL;
+    struct ucred cred;
+    UINT32 intSave;
+    const VOID *src = NULL;
+    socklen_t len = sizeof(int);
+    int val = 0;
+    int ret = LOS_OK;
+
+    if (level != SOL_SOCKET) {
+        return -ENOPROTOOPT;
+    }
+    if ((optValue == NULL) || (optLen == NULL)) {
+        return -EINVAL;
+    }
+
+    sock = UnixSockGet(sysFd, NULL);
+    if (sock == NULL) {
+        return -EBADF;
+    }
+
+    src = &val;
+    LOS_SpinLockSave(&sock->lock, &intSave);
+    switch (optName) {
+        case SO_TYPE:
+            val = sock->type;
+            break;
+        case SO_ERROR:
+            val = 0;
+            break;
+        case SO_PASSCRED:
+            val = sock->passCred ? 1 : 0;
+            break;
+        case SO_ACCEPTCONN:
+            val = (sock->state == UNIX_SS_LISTENING) ? 1 : 0;
+            break;
+        case SO_RCVBUF:
+        case SO_SNDBUF:
+            val = (int)sock->rxLimit;
+            break;
+        case SO_PEERCRED:
+            cred = sock->peerCred;
+            src = &cred;
+            len = sizeof(struct ucred);
+            break;
+        default:
+            ret = -ENOPROTOOPT;
+            break;
+    }
+    LOS_SpinUnlockRestore(&sock->lock, intSave);
+
+    if (ret == LOS_OK) {
+        len = MIN(*optLen, len);
+        (VOID)memcpy_s(optValue, *optLen, src, len);
+        *optLen = len;
+    }
+    UnixSockPut(sock);
+    return ret;
+}
+
+ssize_t UnixSendMsg(int sysFd, const struct msghdr *msg, int flags)
+{
+    BOOL nonblock = FALSE;
+    UnixSock *sock = UnixSockGet(sysFd, &nonblock);
+    const struct sockaddr *to = NULL;
+    UnixCtl ctl;
+    UnixIo io;
+    ssize_t ret;
+
+    if (sock == NULL) {
+        return -EBADF;
+    }
+
+    ret = UnixIoInit(&io, msg->msg_iov, msg->msg_iovlen, flags, nonblock);
+    if (ret == LOS_OK) {
+        ret = UnixCtlParse(msg, &ctl);
+    }
+    if (ret == LOS_OK) {
+        if ((msg->msg_name != NULL) && (msg->msg_namelen != 0)) {
+            to = (const struct sockaddr *)msg->msg_name;
+        }
+        ret = UnixSend(sock, &io, to, msg->msg_namelen, &ctl);
+        UnixCtlRelease(&ctl);
+    }
+
+    UnixSockPut(sock);
+    return ret;
+}
+
+ssize_t UnixRecvMsg(int sysFd, struct msghdr *msg, int flags)
+{
+    BOOL nonblock = FALSE;
+    UnixSock *sock = UnixSockGet(sysFd, &nonblock);
+    UnixIo io;
+    ssize_t ret;
+
+    if (sock == NULL) {
+        return -EBADF;
+    }
+    flags &= ~MSG_CMSG_CLOEXEC; /* passed fds are installed without close-on-exec, which is not tracked */
+
+    ret = UnixIoInit(&io, msg->msg_iov, msg->msg_iovlen, flags, nonblock);
+    if (ret == LOS_OK) {
+        io.msg = msg;
+        io.ctlSpace = (msg->msg_control != NULL) ? msg->msg_controllen : 0;
+        msg->msg_controllen = 0;
+        msg->msg_flags = 0;
+        if (sock->type != SOCK_DGRAM) {
+            msg->msg_namelen = 0;
+        }
+        ret = UnixRecv(sock, &io);
+    }
+
+    UnixSockPut(sock);
+    return ret;
+}
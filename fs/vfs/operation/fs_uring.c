@@ -0,0 +1,1126 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fs_uring.h"
+#include "errno.h"
+#include "fcntl.h"
+#include "poll.h"
+#include "stdlib.h"
+#include "unistd.h"
+#include "sys/uio.h"
+#include "securec.h"
+#include "linux/wait.h"
+#include "los_base.h"
+#include "los_event.h"
+#include "los_mux.h"
+#include "los_spinlock.h"
+#include "los_task.h"
+#include "los_process_pri.h"
+#include "los_vm_map.h"
+#include "los_vm_page.h"
+#include "los_vm_phys.h"
+#include "los_vm_common.h"
+#include "los_arch_mmu.h"
+#include "user_copy.h"
+#include "fs/file.h"
+#include "fs/vnode.h"
+#include "fs_anon.h"
+#include "fs_eventfd.h"
+#include "fs_file.h"
+#include "fs_poll_pri.h"
+#ifdef LOSCFG_NET_LWIP_SACK
+#include "sys/socket.h"
+#endif
+
+#define URING_CQ_RING_PGOFF         (IORING_OFF_CQ_RING >> PAGE_SHIFT)
+#define URING_SQES_PGOFF            (IORING_OFF_SQES >> PAGE_SHIFT)
+
+#define URING_EVENT_CQ              0x01U
+#define URING_EVENT_DONE            0x02U
+
+/* a parked request moves at most this much, like a short non-blocking read or write */
+#define URING_PARK_BYTES            (64 * 1024)
+#define URING_PARK_SEGS             ((URING_PARK_BYTES >> PAGE_SHIFT) + (URING_IOV_MAX * 2))
+
+/*
+ * Ring indices and the completion array, shared with the owner process. Each side only writes
+ * the index it produces: the kernel owns sqHead and cqTail, the application sqTail and cqHead.
+ * The two halves sit on separate cache lines so submission and reaping do not false share.
+ */
+typedef struct {
+    UINT32 sqHead;
+    UINT32 sqTail;
+    UINT32 sqRingMask;
+    UINT32 sqRingEntries;
+    UINT32 sqFlags;
+    UINT32 sqDropped;
+    UINT32 sqPad[10];
+    UINT32 cqHead;
+    UINT32 cqTail;
+    UINT32 cqRingMask;
+    UINT32 cqRingEntries;
+    UINT32 cqOverflow;
+    UINT32 cqFlags;
+    UINT32 cqPad[10];
+    struct io_uring_cqe cqes[0];
+} UringRings;
+
+typedef struct {
+    struct AnonFile anon;           /* must be first */
+    struct page_mapping mapping;    /* lets the file fault path map ring pages into the owner */
+    SPIN_LOCK_S lock;               /* protects cqTail and inflight */
+    LosMux submitMux;               /* serializes submitters on sqHead, protects pendList and the worker */
+    UringRings *rings;
+    UINT32 *sqArray;
+    struct io_uring_sqe *sqes;
+    size_t ringsSize;
+    size_t sqesSize;
+    UINT32 sqEntries;
+    UINT32 cqEntries;
+    UINT32 inflight;                /* accepted requests whose completion is not posted yet */
+    LOS_DL_LIST pendList;           /* requests the worker runs once their fd is ready */
+    UINT32 pendCount;
+    int kickFd;                     /* eventfd waking the worker, -1 until the worker is started */
+    BOOL workerStop;
+    EVENT_CB_S event;               /* URING_EVENT_CQ per completion, URING_EVENT_DONE once the worker exits */
+    UINT32 processID;               /* fds and buffers in the sqes belong to this process */
+    wait_queue_head_t wq;
+} Uring;
+
+typedef struct {
+    LosVmPage *page;                /* pinned until the request is freed */
+    UINT16 off;
+    UINT16 len;
+} UringSeg;
+
+typedef struct {
+    LOS_DL_LIST node;               /* on the ring's pendList while waiting for its fd */
+    UINT64 userData;
+    UINT8 opcode;
+    BOOL isSocket;
+    BOOL mayBlock;                  /* only run once the fd polls ready */
+    int sysFd;
+    UINT32 fileMagic;               /* detects the fd being closed and reused while pending */
+    off_t off;                      /* -1 uses and advances the file position */
+    UINT32 flags;                   /* fsync or msg flags */
+    int iovcnt;
+    struct iovec iov[URING_IOV_MAX];    /* buffers in the owner's address space */
+    CHAR *buf;                      /* bounce buffer of a parked request */
+    size_t bufLen;
+    UINT32 segCnt;
+    UringSeg seg[URING_PARK_SEGS];  /* user pages a parked receive is copied to */
+} UringReq;
+
+STATIC const struct file_operations_vfs g_uringFops;
+
+STATIC INLINE UINT32 UringLoadAcquire(const UINT32 *index)
+{
+    UINT32 value = *(const volatile UINT32 *)index;
+    DMB;
+    return value;
+}
+
+STATIC INLINE VOID UringStoreRelease(UINT32 *index, UINT32 value)
+{
+    DMB;
+    *(volatile UINT32 *)index = value;
+}
+
+STATIC UINT32 UringEventsLocked(const Uring *ring)
+{
+    const UringRings *rings = ring->rings;
+    UINT32 events = 0;
+
+    if (rings->cqTail != UringLoadAcquire(&rings->cqHead)) {
+        events |= POLLIN | POLLRDNORM;
+    }
+    if ((UringLoadAcquire(&rings->sqTail) - rings->sqHead) < ring->sqEntries) {
+        events |= POLLOUT | POLLWRNORM;
+    }
+
+    return events;
+}
+
+STATIC UINT32 UringGetEvents(struct EpollWatch *watch)
+{
+    Uring *ring = (Uring *)watch;
+    UINT32 intSave;
+    UINT32 events;
+
+    LOS_SpinLockSave(&ring->lock, &intSave);
+    events = UringEventsLocked(ring);
+    LOS_SpinUnlockRestore(&ring->lock, intSave);
+
+    return events;
+}
+
+/* Posts one completion. Submission never accepts more requests than the cq can hold. */
+STATIC VOID UringComplete(Uring *ring, UINT64 userData, INT32 res)
+{
+    UringRings *rings = ring->rings;
+    struct io_uring_cqe *cqe = NULL;
+    UINT32 intSave;
+    UINT32 tail;
+
+    LOS_SpinLockSave(&ring->lock, &intSave);
+    tail = rings->cqTail;
+    if ((tail - UringLoadAcquire(&rings->cqHead)) < ring->cqEntries) {
+        cqe = &rings->cqes[tail & rings->cqRingMask];
+        cqe->user_data = userData;
+        cqe->res = res;
+        cqe->flags = 0;
+        UringStoreRelease(&rings->cqTail, tail + 1);
+    } else {
+        rings->cqOverflow++;
+    }
+    ring->inflight--;
+    LOS_SpinUnlockRestore(&ring->lock, intSave);
+
+    (VOID)LOS_EventWrite(&ring->event, URING_EVENT_CQ);
+    notify_poll(&ring->wq);
+    EpollWatchNotify(&ring->anon.watch, POLLIN | POLLRDNORM);
+}
+
+STATIC INT32 UringReqUserOne(UringReq *req, UINT64 addr, size_t len)
+{
+    req->iovcnt = 1;
+    req->iov[0].iov_base = (VOID *)(UINTPTR)addr;
+    req->iov[0].iov_len = len;
+
+    return ((len == 0) || LOS_IsUserAddressRange((VADDR_T)(UINTPTR)addr, len)) ? LOS_OK : -EFAULT;
+}
+
+STATIC INT32 UringReqUserVec(UringReq *req, UINT64 addr, UINT32 iovcnt)
+{
+    UINT32 i;
+
+    if ((iovcnt == 0) || (iovcnt > URING_IOV_MAX)) {
+        return -EINVAL;
+    }
+    if (LOS_ArchCopyFromUser(req->iov, (const VOID *)(UINTPTR)addr, iovcnt * sizeof(struct iovec)) != 0) {
+        return -EFAULT;
+    }
+    req->iovcnt = (int)iovcnt;
+
+    for (i = 0; i < iovcnt; i++) {
+        if ((req->iov[i].iov_len != 0) &&
+            !LOS_IsUserAddressRange((VADDR_T)(UINTPTR)req->iov[i].iov_base, req->iov[i].iov_len)) {
+            return -EFAULT;
+        }
+    }
+
+    return LOS_OK;
+}
+
+/* Resolves the fd and checks the buffers named by the sqe, which stay user addresses. */
+STATIC INT32 UringReqPrep(UringReq *req, const struct io_uring_sqe *sqe)
+{
+    struct file *filep = NULL;
+
+    req->opcode = sqe->opcode;
+    req->userData = sqe->user_data;
+    req->off = (off_t)sqe->off;
+    req->flags = sqe->msg_flags;
+    if (sqe->flags != 0) {
+        return -EINVAL; /* links, drains and fixed files are not supported */
+    }
+    if (req->opcode == IORING_OP_NOP) {
+        return LOS_OK;
+    }
+
+    req->sysFd = GetAssociatedSystemFd(sqe->fd);
+    if (req->sysFd < 0) {
+        return -EBADF;
+    }
+    req->isSocket = (req->sysFd >= CONFIG_NFILE_DESCRIPTORS) ? TRUE : FALSE;
+    req->mayBlock = req->isSocket;
+    if (!req->isSocket) {
+        if (fs_getfilep(req->sysFd, &filep) < 0) {
+            return -EBADF;
+        }
+        req->fileMagic = filep->f_magicnum;
+        /* regular files and block devices complete in bounded time, anything else may wait forever */
+        req->mayBlock = (filep->f_vnode == NULL) ||
+            ((filep->f_vnode->type != VNODE_TYPE_REG) && (filep->f_vnode->type != VNODE_TYPE_BLK));
+    }
+
+    switch (req->opcode) {
+        case IORING_OP_RECV:
+        case IORING_OP_SEND:
+            if (!req->isSocket) {
+                return -ENOTSOCK;
+            }
+            return UringReqUserOne(req, sqe->addr, sqe->len);
+        case IORING_OP_READ:
+        case IORING_OP_WRITE:
+            return UringReqUserOne(req, sqe->addr, sqe->len);
+        case IORING_OP_READV:
+        case IORING_OP_WRITEV:
+            return UringReqUserVec(req, sqe->addr, sqe->len);
+        case IORING_OP_FSYNC:
+            return LOS_OK;
+        default:
+            return -EINVAL;
+    }
+}
+
+STATIC INT16 UringReqPollEvents(const UringReq *req)
+{
+    switch (req->opcode) {
+        case IORING_OP_RECV:
+        case IORING_OP_READ:
+        case IORING_OP_READV:
+            return POLLIN;
+        case IORING_OP_SEND:
+        case IORING_OP_WRITE:
+        case IORING_OP_WRITEV:
+            return POLLOUT;
+        default:
+            return 0;
+    }
+}
+
+STATIC BOOL UringReqReady(const UringReq *req)
+{
+    struct pollfd pfd;
+
+    pfd.fd = req->sysFd;
+    pfd.events = UringReqPollEvents(req);
+    pfd.revents = 0;
+    if (pfd.events == 0) {
+        return TRUE;
+    }
+
+    /* errors and hangups are ready too, the operation reports them */
+    return (poll(&pfd, 1, 0) != 0) ? TRUE : FALSE;
+}
+
+STATIC ssize_t UringReqRw(const UringReq *req, const struct iovec *iov, int iovcnt)
+{
+    BOOL useFilePos = req->isSocket || (req->off == (off_t)-1);
+
+    if ((req->opcode == IORING_OP_READ) || (req->opcode == IORING_OP_READV)) {
+        if (iovcnt == 1) {
+            return useFilePos ? read(req->sysFd, iov->iov_base, iov->iov_len) :
+                pread(req->sysFd, iov->iov_base, iov->iov_len, req->off);
+        }
+        return useFilePos ? readv(req->sysFd, iov, iovcnt) : preadv(req->sysFd, iov, iovcnt, req->off);
+    }
+
+    if (iovcnt == 1) {
+        return useFilePos ? write(req->sysFd, iov->iov_base, iov->iov_len) :
+            pwrite(req->sysFd, iov->iov_base, iov->iov_len, req->off);
+    }
+    return useFilePos ? writev(req->sysFd, iov, iovcnt) : pwritev(req->sysFd, iov, iovcnt, req->off);
+}
+
+/*
+ * Does the I/O of a request on iov: the user buffers of the sqe when called in the owner's
+ * context from io_uring_enter, the bounce buffer when a parked request runs on the worker.
+ * Returns -EAGAIN when the request has to wait for its fd.
+ */
+STATIC INT32 UringReqRun(const UringReq *req, const struct iovec *iov, int iovcnt)
+{
+    struct file *filep = NULL;
+    ssize_t ret;
+    INT32 err;
+
+    if (req->opcode == IORING_OP_NOP) {
+        return 0;
+    }
+    if (!req->isSocket && ((fs_getfilep(req->sysFd, &filep) < 0) || (filep->f_magicnum != req->fileMagic))) {
+        return -EBADF;
+    }
+    if (req->mayBlock && !UringReqReady(req)) {
+        return -EAGAIN;
+    }
+
+    switch (req->opcode) {
+        case IORING_OP_FSYNC:
+            ret = fsync(req->sysFd);
+            break;
+#ifdef LOSCFG_NET_LWIP_SACK
+        case IORING_OP_SEND:
+            ret = send(req->sysFd, iov->iov_base, iov->iov_len, (int)req->flags | MSG_DONTWAIT);
+            break;
+        case IORING_OP_RECV:
+            ret = recv(req->sysFd, iov->iov_base, iov->iov_len, (int)req->flags | MSG_DONTWAIT);
+            break;
+#endif
+        case IORING_OP_READ:
+        case IORING_OP_READV:
+        case IORING_OP_WRITE:
+        case IORING_OP_WRITEV:
+            ret = UringReqRw(req, iov, iovcnt);
+            break;
+        default:
+            return -EOPNOTSUPP;
+    }
+    if (ret >= 0) {
+        return (INT32)ret;
+    }
+
+    err = get_errno();
+    return (err == EWOULDBLOCK) ? -EAGAIN : -err;
+}
+
+STATIC VOID UringReqFree(UringReq *req)
+{
+    UINT32 i;
+
+    for (i = 0; i < req->segCnt; i++) {
+        LOS_PhysPageFree(req->seg[i].page);
+    }
+    free(req->buf);
+    free(req);
+}
+
+/* Maps the user page in, breaking copy-on-write first when the worker will write to it. */
+STATIC INT32 UringUserTouch(LosVmSpace *space, VADDR_T uva, BOOL toUser)
+{
+    UINT32 flags = 0;
+    CHAR byte;
+
+    if ((LOS_ArchMmuQuery(&space->archMmu, uva, NULL, &flags) == LOS_OK) &&
+        (!toUser || (flags & VM_MAP_REGION_FLAG_PERM_WRITE))) {
+        return LOS_OK;
+    }
+    if (LOS_ArchCopyFromUser(&byte, (const VOID *)(UINTPTR)uva, 1) != 0) {
+        return -EFAULT;
+    }
+    if (toUser && (LOS_ArchCopyToUser((VOID *)(UINTPTR)uva, &byte, 1) != 0)) {
+        return -EFAULT;
+    }
+
+    return LOS_OK;
+}
+
+/*
+ * Pins the user pages behind the first len bytes of the buffers. The worker copies received
+ * data into them through the kernel mapping of the pages, after the owner has left the kernel.
+ */
+STATIC INT32 UringReqPin(UringReq *req, size_t len)
+{
+    LosVmSpace *space = OsCurrProcessGet()->vmSpace;
+    LosVmPage *page = NULL;
+    VADDR_T uva;
+    PADDR_T pa;
+    size_t left;
+    size_t chunk;
+    int i;
+
+    for (i = 0; (i < req->iovcnt) && (len > 0); i++) {
+        uva = (VADDR_T)(UINTPTR)req->iov[i].iov_base;
+        left = (req->iov[i].iov_len < len) ? req->iov[i].iov_len : len;
+        len -= left;
+        while (left > 0) {
+            chunk = PAGE_SIZE - (uva & (PAGE_SIZE - 1));
+            chunk = (chunk < left) ? chunk : left;
+            if (UringUserTouch(space, uva, TRUE) != LOS_OK) {
+                return -EFAULT;
+            }
+            (VOID)LOS_MuxAcquire(&space->regionMux);
+            if ((LOS_ArchMmuQuery(&space->archMmu, uva, &pa, NULL) != LOS_OK) ||
+                ((page = LOS_VmPageGet(pa)) == NULL)) {
+                (VOID)LOS_MuxRelease(&space->regionMux);
+                return -EFAULT;
+            }
+            LOS_AtomicInc(&page->refCounts); /* dropped by UringReqFree */
+            (VOID)LOS_MuxRelease(&space->regionMux);
+
+            req->seg[req->segCnt].page = page;
+            req->seg[req->segCnt].off = (UINT16)(uva & (PAGE_SIZE - 1));
+            req->seg[req->segCnt].len = (UINT16)chunk;
+            req->segCnt++;
+            uva += chunk;
+            left -= chunk;
+        }
+    }
+
+    return LOS_OK;
+}
+
+/* Copies the first len bytes of the buffers, the worker sends them once the fd is ready. */
+STATIC INT32 UringReqGather(UringReq *req, size_t len)
+{
+    size_t done = 0;
+    size_t chunk;
+    int i;
+
+    for (i = 0; (i < req->iovcnt) && (done < len); i++) {
+        chunk = ((len - done) < req->iov[i].iov_len) ? (len - done) : req->iov[i].iov_len;
+        if (LOS_ArchCopyFromUser(req->buf + done, req->iov[i].iov_base, chunk) != 0) {
+            return -EFAULT;
+        }
+        done += chunk;
+    }
+
+    return LOS_OK;
+}
+
+/* Called on the worker, copies what a parked request received to the pinned user pages. */
+STATIC VOID UringReqScatter(const UringReq *req, size_t len)
+{
+    const UringSeg *seg = NULL;
+    size_t done = 0;
+    size_t chunk;
+    UINT32 i;
+
+    for (i = 0; (i < req->segCnt) && (done < len); i++) {
+        seg = &req->seg[i];
+        chunk = ((len - done) < seg->len) ? (len - done) : seg->len;
+        (VOID)memcpy_s((CHAR *)LOS_PaddrToKVaddr(seg->page->physAddr) + seg->off, seg->len, req->buf + done, chunk);
+        done += chunk;
+    }
+}
+
+STATIC size_t UringReqParkLen(const UringReq *req)
+{
+    size_t len = 0;
+    int i;
+
+    for (i = 0; i < req->iovcnt; i++) {
+        len += req->iov[i].iov_len;
+        if (len >= URING_PARK_BYTES) {
+            return URING_PARK_BYTES;
+        }
+    }
+
+    return len;
+}
+
+STATIC VOID UringWorkerKick(Uring *ring)
+{
+    UINT64 one = 1;
+
+    (VOID)write(ring->kickFd, &one, sizeof(one));
+}
+
+/* Called with submitMux held on the worker, finishes the parked requests whose fd is ready. */
+STATIC VOID UringRunParked(Uring *ring)
+{
+    struct iovec iov;
+    UringReq *req = NULL;
+    UringReq *next = NULL;
+    INT32 res;
+
+    LOS_DL_LIST_FOR_EACH_ENTRY_SAFE(req, next, &ring->pendList, UringReq, node) {
+        iov.iov_base = req->buf;
+        iov.iov_len = req->bufLen;
+        res = UringReqRun(req, &iov, 1);
+        if (res == -EAGAIN) {
+            continue;
+        }
+        if ((res > 0) && (UringReqPollEvents(req) == POLLIN)) {
+            UringReqScatter(req, (size_t)res);
+        }
+        LOS_ListDelete(&req->node);
+        ring->pendCount--;
+        UringComplete(ring, req->userData, res);
+        UringReqFree(req);
+    }
+}
+
+/*
+ * Each ring gets one worker task with its first parked request. The worker sleeps in poll() on
+ * the fds of the parked requests and on its kick eventfd, and posts their completions as soon as
+ * they finish, so the owner never has to enter the kernel to make them progress. A request only
+ * runs once its fd polls ready and never blocks, so a quiet fd does not hold up the others.
+ */
+STATIC VOID UringWorker(UINTPTR arg)
+{
+    Uring *ring = (Uring *)arg;
+    struct pollfd *fds = NULL;
+    UringReq *req = NULL;
+    UINT64 kicks;
+    UINT32 count;
+    UINT32 index;
+
+    for (;;) {
+        (VOID)LOS_MuxLock(&ring->submitMux, LOS_WAIT_FOREVER);
+        UringRunParked(ring);
+        if (ring->workerStop) {
+            (VOID)LOS_MuxUnlock(&ring->submitMux);
+            break;
+        }
+        count = ring->pendCount;
+        fds = (struct pollfd *)malloc(sizeof(struct pollfd) * (count + 1));
+        if (fds == NULL) {
+            (VOID)LOS_MuxUnlock(&ring->submitMux);
+            (VOID)LOS_TaskDelay(1);
+            continue;
+        }
+        index = 0;
+        LOS_DL_LIST_FOR_EACH_ENTRY(req, &ring->pendList, UringReq, node) {
+            fds[index].fd = req->sysFd;
+            fds[index].events = UringReqPollEvents(req);
+            fds[index].revents = 0;
+            index++;
+        }
+        (VOID)LOS_MuxUnlock(&ring->submitMux);
+
+        fds[count].fd = ring->kickFd;
+        fds[count].events = POLLIN;
+        fds[count].revents = 0;
+        (VOID)poll(fds, count + 1, -1);
+        if (fds[count].revents & POLLIN) {
+            (VOID)read(ring->kickFd, &kicks, sizeof(kicks));
+        }
+        free(fds);
+    }
+
+    (VOID)LOS_EventWrite(&ring->event, URING_EVENT_DONE);
+}
+
+/* Called with submitMux held. */
+STATIC INT32 UringWorkerStart(Uring *ring)
+{
+    TSK_INIT_PARAM_S param;
+    UINT32 taskID;
+    int kickFd;
+
+    if (ring->workerStop) {
+        return -ECANCELED;
+    }
+    if (ring->kickFd >= 0) {
+        return LOS_OK;
+    }
+
+    kickFd = EventfdCreate(0, EFD_NONBLOCK);
+    if (kickFd < 0) {
+        return kickFd;
+    }
+    ring->kickFd = kickFd;
+
+    (VOID)memset_s(&param, sizeof(TSK_INIT_PARAM_S), 0, sizeof(TSK_INIT_PARAM_S));
+    param.pfnTaskEntry = (TSK_ENTRY_FUNC)UringWorker;
+    param.auwArgs[0] = (UINTPTR)ring;
+    param.uwStackSize = LOSCFG_BASE_CORE_TSK_DEFAULT_STACK_SIZE;
+    param.pcName = "IoRingWorker";
+    param.usTaskPrio = LOSCFG_BASE_CORE_TSK_DEFAULT_PRIO;
+    param.uwResved = LOS_TASK_STATUS_DETACHED;
+    if (LOS_TaskCreate(&taskID, &param) != LOS_OK) {
+        (VOID)close(kickFd);
+        ring->kickFd = -1;
+        return -ENOMEM;
+    }
+
+    return LOS_OK;
+}
+
+/* Called without submitMux when the ring goes away, returns once the worker has exited. */
+STATIC VOID UringWorkerStop(Uring *ring)
+{
+    BOOL started;
+
+    (VOID)LOS_MuxLock(&ring->submitMux, LOS_WAIT_FOREVER);
+    ring->workerStop = TRUE;
+    started = (ring->kickFd >= 0) ? TRUE : FALSE;
+    (VOID)LOS_MuxUnlock(&ring->submitMux);
+    if (!started) {
+        return;
+    }
+
+    UringWorkerKick(ring);
+    (VOID)LOS_EventRead(&ring->event, URING_EVENT_DONE, LOS_WAITMODE_OR | LOS_WAITMODE_CLR, LOS_WAIT_FOREVER);
+    (VOID)close(ring->kickFd);
+    ring->kickFd = -1;
+}
+
+/*
+ * Called with submitMux held in the owner's context for a request that has to wait for its fd.
+ * The worker finishes it on a bounce buffer: data to send is copied now, the pages to receive
+ * into are pinned.
+ */
+STATIC INT32 UringReqPark(Uring *ring, UringReq *req)
+{
+    INT32 ret;
+
+    ret = UringWorkerStart(ring);
+    if (ret != LOS_OK) {
+        return ret;
+    }
+
+    req->bufLen = UringReqParkLen(req);
+    req->buf = (CHAR *)malloc((req->bufLen != 0) ? req->bufLen : 1);
+    if (req->buf == NULL) {
+        return -ENOMEM;
+    }
+    ret = (UringReqPollEvents(req) == POLLIN) ? UringReqPin(req, req->bufLen) : UringReqGather(req, req->bufLen);
+    if (ret != LOS_OK) {
+        return ret;
+    }
+
+    LOS_ListTailInsert(&ring->pendList, &req->node);
+    ring->pendCount++;
+    UringWorkerKick(ring);
+    return LOS_OK;
+}
+
+/* Called with submitMux held: completes the request or parks it on the worker. */
+STATIC VOID UringReqIssue(Uring *ring, UringReq *req)
+{
+    INT32 res = UringReqRun(req, req->iov, req->iovcnt);
+
+    if ((res == -EAGAIN) && req->mayBlock) {
+        res = UringReqPark(ring, req);
+        if (res == LOS_OK) {
+            return;
+        }
+    }
+
+    UringComplete(ring, req->userData, res);
+    UringReqFree(req);
+}
+
+/* Called with submitMux held once the worker has exited. */
+STATIC VOID UringCancelPending(Uring *ring)
+{
+    UringReq *req = NULL;
+
+    while (!LOS_ListEmpty(&ring->pendList)) {
+        req = LOS_DL_LIST_ENTRY(ring->pendList.pstNext, UringReq, node);
+        LOS_ListDelete(&req->node);
+        UringComplete(ring, req->userData, -ECANCELED);
+        UringReqFree(req);
+    }
+    ring->pendCount = 0;
+}
+
+/* Completion slots not yet promised to a submitted request. */
+STATIC UINT32 UringCqRoom(Uring *ring)
+{
+    UINT32 intSave;
+    UINT32 used;
+
+    LOS_SpinLockSave(&ring->lock, &intSave);
+    used = (ring->rings->cqTail - UringLoadAcquire(&ring->rings->cqHead)) + ring->inflight;
+    LOS_SpinUnlockRestore(&ring->lock, intSave);
+
+    return (used < ring->cqEntries) ? (ring->cqEntries - used) : 0;
+}
+
+STATIC VOID UringReqStart(Uring *ring)
+{
+    UINT32 intSave;
+
+    LOS_SpinLockSave(&ring->lock, &intSave);
+    ring->inflight++;
+    LOS_SpinUnlockRestore(&ring->lock, intSave);
+}
+
+STATIC INT32 UringSubmit(Uring *ring, UINT32 toSubmit)
+{
+    UringRings *rings = ring->rings;
+    struct io_uring_sqe sqe;
+    UringReq *req = NULL;
+    UINT32 head;
+    UINT32 tail;
+    UINT32 index;
+    UINT32 room;
+    INT32 submitted = 0;
+    INT32 ret;
+
+    (VOID)LOS_MuxLock(&ring->submitMux, LOS_WAIT_FOREVER);
+    head = rings->sqHead;
+    tail = UringLoadAcquire(&rings->sqTail);
+    room = UringCqRoom(ring);
+    if ((room == 0) && (head != tail)) {
+        (VOID)LOS_MuxUnlock(&ring->submitMux);
+        return -EBUSY;
+    }
+
+    while (((UINT32)submitted < toSubmit) && (head != tail) && (room > 0)) {
+        index = ring->sqArray[head & rings->sqRingMask];
+        head++;
+        if (index >= ring->sqEntries) {
+            rings->sqDropped++;
+            continue;
+        }
+        /* snapshot the entry, the application may reuse the slot once sqHead moves */
+        (VOID)memcpy_s(&sqe, sizeof(sqe), &ring->sqes[index], sizeof(sqe));
+        submitted++;
+        room--;
+
+        UringReqStart(ring);
+        req = (UringReq *)zalloc(sizeof(UringReq));
+        if (req == NULL) {
+            UringComplete(ring, sqe.user_data, -ENOMEM);
+            continue;
+        }
+        ret = UringReqPrep(req, &sqe);
+        if (ret != LOS_OK) {
+            UringComplete(ring, sqe.user_data, ret);
+            free(req);
+            continue;
+        }
+        UringReqIssue(ring, req);
+    }
+    UringStoreRelease(&rings->sqHead, head);
+    (VOID)LOS_MuxUnlock(&ring->submitMux);
+
+    return submitted;
+}
+
+/*
+ * Waits until minComplete completions are posted, or until nothing in flight is left that could
+ * post one. Parked requests complete on the worker, which wakes the waiter through the ring event.
+ */
+STATIC INT32 UringWaitCq(Uring *ring, UINT32 minComplete)
+{
+    UINT32 intSave;
+    UINT32 ready;
+    UINT32 inflight;
+    UINT32 ret;
+
+    for (;;) {
+        LOS_SpinLockSave(&ring->lock, &intSave);
+        ready = ring->rings->cqTail - UringLoadAcquire(&ring->rings->cqHead);
+        inflight = ring->inflight;
+        LOS_SpinUnlockRestore(&ring->lock, intSave);
+        if ((ready >= minComplete) || (inflight == 0)) {
+            return LOS_OK;
+        }
+
+        ret = LOS_EventRead(&ring->event, URING_EVENT_CQ, LOS_WAITMODE_OR | LOS_WAITMODE_CLR, LOS_WAIT_FOREVER);
+        if (ret & LOS_ERRTYPE_ERROR) {
+            return -EINTR;
+        }
+    }
+}
+
+STATIC VM_OFFSET_T UringAreaBase(VM_OFFSET_T pgoff)
+{
+    if (pgoff >= URING_SQES_PGOFF) {
+        return URING_SQES_PGOFF;
+    }
+    return (pgoff >= URING_CQ_RING_PGOFF) ? URING_CQ_RING_PGOFF : 0;
+}
+
+STATIC VOID *UringPageKVaddr(const Uring *ring, VM_OFFSET_T pgoff)
+{
+    if (pgoff >= URING_SQES_PGOFF) {
+        pgoff -= URING_SQES_PGOFF;
+        return (pgoff < (ring->sqesSize >> PAGE_SHIFT)) ? ((CHAR *)ring->sqes + (pgoff << PAGE_SHIFT)) : NULL;
+    }
+    if (pgoff >= URING_CQ_RING_PGOFF) {
+        pgoff -= URING_CQ_RING_PGOFF;
+    }
+
+    return (pgoff < (ring->ringsSize >> PAGE_SHIFT)) ? ((CHAR *)ring->rings + (pgoff << PAGE_SHIFT)) : NULL;
+}
+
+STATIC INT32 UringVmFault(LosVmMapRegion *region, LosVmPgFault *vmf)
+{
+    Uring *ring = (Uring *)AnonFileGet(region->unTypeData.rf.file);
+    VOID *kvaddr = NULL;
+
+    if (ring == NULL) {
+        return LOS_NOK;
+    }
+    kvaddr = UringPageKVaddr(ring, vmf->pgoff);
+    if (kvaddr == NULL) {
+        return LOS_NOK;
+    }
+
+    /* the fault path takes a page reference for the new mapping, UringVmRemove drops it */
+    vmf->pageKVaddr = (VADDR_T *)kvaddr;
+    return LOS_OK;
+}
+
+STATIC VOID UringVmRemove(LosVmMapRegion *region, LosArchMmu *archMmu, VM_OFFSET_T pgoff)
+{
+    VADDR_T vaddr = region->range.base + ((UINT32)(pgoff - region->pgOff) << PAGE_SHIFT);
+    PADDR_T paddr;
+
+    if (LOS_ArchMmuQuery(archMmu, vaddr, &paddr, NULL) != LOS_OK) {
+        return;
+    }
+    (VOID)LOS_ArchMmuUnmap(archMmu, vaddr, 1);
+    LOS_PhysPageFree(LOS_VmPageGet(paddr));
+}
+
+STATIC const LosVmFileOps g_uringVmOps = {
+    .open = NULL,
+    .close = NULL,
+    .fault = UringVmFault,
+    .remove = UringVmRemove,
+};
+
+STATIC int UringMmap(struct file *filep, LosVmMapRegion *region)
+{
+    Uring *ring = (Uring *)AnonFileGet(filep);
+    UINT32 pages = region->range.size >> PAGE_SHIFT;
+
+    if (ring == NULL) {
+        return -EBADF;
+    }
+    /* the rings are shared with the kernel, a private copy would never see completions */
+    if (!(region->regionFlags & VM_MAP_REGION_FLAG_SHARED)) {
+        return -EINVAL;
+    }
+    /* one mapping covers one area: the rings (at either offset) or the sqes */
+    if ((UringPageKVaddr(ring, region->pgOff) == NULL) || (UringPageKVaddr(ring, region->pgOff + pages - 1) == NULL) ||
+        (UringAreaBase(region->pgOff) != UringAreaBase(region->pgOff + pages - 1))) {
+        return -EINVAL;
+    }
+
+    LOS_SetRegionTypeFile(region);
+    region->unTypeData.rf.vmFOps = &g_uringVmOps;
+    region->unTypeData.rf.file = filep;
+    region->unTypeData.rf.fileMagic = filep->f_magicnum;
+    return LOS_OK;
+}
+
+#ifndef CONFIG_DISABLE_POLL
+STATIC int UringPoll(struct file *filep, poll_table *table)
+{
+    Uring *ring = (Uring *)AnonFileGet(filep);
+
+    if (ring == NULL) {
+        return POLLERR;
+    }
+
+    poll_wait(filep, &ring->wq, table);
+    return (int)UringGetEvents(&ring->anon.watch);
+}
+#endif
+
+STATIC int UringClose(struct file *filep)
+{
+    Uring *ring = (Uring *)AnonFileGet(filep);
+
+    if (ring == NULL) {
+        return -EBADF;
+    }
+
+    UringWorkerStop(ring);
+    (VOID)LOS_MuxLock(&ring->submitMux, LOS_WAIT_FOREVER);
+    UringCancelPending(ring);
+    (VOID)LOS_MuxUnlock(&ring->submitMux);
+
+    /* mapped pages keep their own references, later faults on the mapping fail */
+    filep->f_mapping = NULL;
+    EpollWatchDetach(&ring->anon.watch);
+    AnonFileDrop(&ring->anon);
+    return LOS_OK;
+}
+
+STATIC VOID UringRelease(struct AnonFile *anon)
+{
+    Uring *ring = (Uring *)anon;
+
+    if (ring->sqes != NULL) {
+        LOS_VFree(ring->sqes);
+    }
+    if (ring->rings != NULL) {
+        LOS_VFree(ring->rings);
+    }
+    (VOID)LOS_MuxDestroy(&ring->mapping.mux_lock);
+    (VOID)LOS_MuxDestroy(&ring->submitMux);
+    (VOID)LOS_EventDestroy(&ring->event);
+    free(ring);
+}
+
+STATIC const struct file_operations_vfs g_uringFops = {
+    NULL,           /* open */
+    UringClose,     /* close */
+    NULL,           /* read */
+    NULL,           /* write */
+    NULL,           /* seek */
+    NULL,           /* ioctl */
+    UringMmap,      /* mmap */
+#ifndef CONFIG_DISABLE_POLL
+    UringPoll,      /* poll */
+#endif
+    NULL,           /* unlink */
+};
+
+STATIC const struct EpollWatchOps g_uringWatchOps = {
+    UringGetEvents,
+    AnonWatchHold,
+    AnonWatchDrop,
+};
+
+STATIC UINT32 UringRoundPow2(UINT32 value)
+{
+    UINT32 pow2 = 1;
+
+    while (pow2 < value) {
+        pow2 <<= 1;
+    }
+    return pow2;
+}
+
+STATIC INT32 UringRingsAlloc(Uring *ring)
+{
+    size_t sqArrayOff = sizeof(UringRings) + (ring->cqEntries * sizeof(struct io_uring_cqe));
+
+    ring->ringsSize = ROUNDUP(sqArrayOff + (ring->sqEntries * sizeof(UINT32)), PAGE_SIZE);
+    ring->sqesSize = ROUNDUP(ring->sqEntries * sizeof(struct io_uring_sqe), PAGE_SIZE);
+    ring->rings = (UringRings *)LOS_VMalloc(ring->ringsSize);
+    ring->sqes = (struct io_uring_sqe *)LOS_VMalloc(ring->sqesSize);
+    if ((ring->rings == NULL) || (ring->sqes == NULL)) {
+        return -ENOMEM;
+    }
+    (VOID)memset_s(ring->rings, ring->ringsSize, 0, ring->ringsSize);
+    (VOID)memset_s(ring->sqes, ring->sqesSize, 0, ring->sqesSize);
+
+    ring->sqArray = (UINT32 *)((CHAR *)ring->rings + sqArrayOff);
+    ring->rings->sqRingMask = ring->sqEntries - 1;
+    ring->rings->sqRingEntries = ring->sqEntries;
+    ring->rings->cqRingMask = ring->cqEntries - 1;
+    ring->rings->cqRingEntries = ring->cqEntries;
+    return LOS_OK;
+}
+
+STATIC VOID UringParamsFill(const Uring *ring, struct io_uring_params *params)
+{
+    params->sq_entries = ring->sqEntries;
+    params->cq_entries = ring->cqEntries;
+    params->features = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP;
+
+    (VOID)memset_s(&params->sq_off, sizeof(params->sq_off), 0, sizeof(params->sq_off));
+    params->sq_off.head = offsetof(UringRings, sqHead);
+    params->sq_off.tail = offsetof(UringRings, sqTail);
+    params->sq_off.ring_mask = offsetof(UringRings, sqRingMask);
+    params->sq_off.ring_entries = offsetof(UringRings, sqRingEntries);
+    params->sq_off.flags = offsetof(UringRings, sqFlags);
+    params->sq_off.dropped = offsetof(UringRings, sqDropped);
+    params->sq_off.array = (UINT32)((CHAR *)ring->sqArray - (CHAR *)ring->rings);
+
+    (VOID)memset_s(&params->cq_off, sizeof(params->cq_off), 0, sizeof(params->cq_off));
+    params->cq_off.head = offsetof(UringRings, cqHead);
+    params->cq_off.tail = offsetof(UringRings, cqTail);
+    params->cq_off.ring_mask = offsetof(UringRings, cqRingMask);
+    params->cq_off.ring_entries = offsetof(UringRings, cqRingEntries);
+    params->cq_off.overflow = offsetof(UringRings, cqOverflow);
+    params->cq_off.cqes = offsetof(UringRings, cqes);
+    params->cq_off.flags = offsetof(UringRings, cqFlags);
+}
+
+int UringSetup(UINT32 entries, struct io_uring_params *params)
+{
+    Uring *ring = NULL;
+    struct file *filep = NULL;
+    UINT32 cqEntries;
+    int sysFd;
+    INT32 ret;
+
+    if ((entries == 0) || (entries > URING_ENTRIES_MAX) || (params->flags & ~IORING_SETUP_CQSIZE)) {
+        return -EINVAL;
+    }
+    entries = UringRoundPow2(entries);
+    cqEntries = entries * 2; /* room for a full sq of completions while the previous batch is reaped */
+    if (params->flags & IORING_SETUP_CQSIZE) {
+        if ((params->cq_entries < entries) || (params->cq_entries > (URING_ENTRIES_MAX * 2))) {
+            return -EINVAL;
+        }
+        cqEntries = UringRoundPow2(params->cq_entries);
+    }
+
+    ring = (Uring *)zalloc(sizeof(Uring));
+    if (ring == NULL) {
+        return -ENOMEM;
+    }
+    (VOID)LOS_MuxInit(&ring->submitMux, NULL);
+    (VOID)LOS_MuxInit(&ring->mapping.mux_lock, NULL);
+    (VOID)LOS_EventInit(&ring->event);
+    LOS_ListInit(&ring->mapping.page_list);
+    LOS_SpinInit(&ring->mapping.list_lock);
+    LOS_AtomicSet(&ring->mapping.ref, 1);
+    LOS_SpinInit(&ring->lock);
+    LOS_ListInit(&ring->pendList);
+    ring->kickFd = -1;
+    init_waitqueue_head(&ring->wq);
+    ring->sqEntries = entries;
+    ring->cqEntries = cqEntries;
+    ring->processID = LOS_GetCurrProcessID();
+    AnonFileInit(&ring->anon, &g_uringWatchOps, UringRelease);
+
+    ret = UringRingsAlloc(ring);
+    if (ret != LOS_OK) {
+        UringRelease(&ring->anon);
+        return ret;
+    }
+
+    sysFd = AnonFileAlloc(&g_uringFops, &ring->anon, O_RDWR);
+    if (sysFd < 0) {
+        UringRelease(&ring->anon);
+        return sysFd;
+    }
+    if (fs_getfilep(sysFd, &filep) == 0) {
+        filep->f_mapping = &ring->mapping;
+        ring->mapping.host = filep;
+    }
+
+    UringParamsFill(ring, params);
+    return sysFd;
+}
+
+int UringEnter(int sysFd, UINT32 toSubmit, UINT32 minComplete, UINT32 flags)
+{
+    struct file *filep = NULL;
+    Uring *ring = NULL;
+    INT32 submitted = 0;
+    INT32 ret;
+
+    if (fs_getfilep(sysFd, &filep) < 0) {
+        return -EBADF;
+    }
+    if (filep->ops != &g_uringFops) {
+        return -EOPNOTSUPP;
+    }
+    if (flags & ~(IORING_ENTER_GETEVENTS | IORING_ENTER_SQ_WAKEUP)) {
+        return -EINVAL;
+    }
+    ring = (Uring *)AnonFileGet(filep);
+    if (ring == NULL) {
+        return -EBADF;
+    }
+    if (ring->processID != LOS_GetCurrProcessID()) {
+        return -EPERM; /* the sqes name fds and buffers of the creating process */
+    }
+
+    AnonFileHold(&ring->anon);
+    if (toSubmit > 0) {
+        submitted = UringSubmit(ring, toSubmit);
+    }
+    if ((submitted >= 0) && (flags & IORING_ENTER_GETEVENTS)) {
+        ret = UringWaitCq(ring, (minComplete > ring->cqEntries) ? ring->cqEntries : minComplete);
+        if ((ret != LOS_OK) && (submitted == 0)) {
+            submitted = ret;
+        }
+    }
+    AnonFileDrop(&ring->anon);
+
+    return submitted;
+}
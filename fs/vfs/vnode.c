@@ -436,6 +436,37 @@ OUT_FREE_PATH:
     return ret;
 }
 
+/*
+ * Look up one name in a directory, among the cached vnodes first and then by the file system,
+ * as one step of VnodeLookup does. The caller holds the vnode lock.
+ */
+int VnodeLookupAt(struct Vnode *parent, const char *name, uint8_t len, struct Vnode **result)
+{
+    int ret;
+    struct Vnode *vnode = NULL;
+
+    if (parent->type != VNODE_TYPE_DIR) {
+        return -ENOTDIR;
+    }
+
+    ret = PathCacheLookup(parent, name, len, &vnode);
+    if (ret != LOS_OK) {
+        if ((parent->vop == NULL) || (parent->vop->Lookup == NULL)) {
+            return -ENOSYS;
+        }
+        ret = parent->vop->Lookup(parent, name, len, &vnode);
+        if (ret != LOS_OK) {
+            return ret;
+        }
+        (void)PathCacheAlloc(parent, vnode, name, len);
+    }
+
+    vnode = ConvertVnodeIfMounted(vnode);
+    RefreshLRU(vnode);
+    *result = vnode;
+    return LOS_OK;
+}
+
 static void ChangeRootInternal(struct Vnode *rootOld, char *dirname)
 {
     int ret;
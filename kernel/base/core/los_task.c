@@ -1863,6 +1863,12 @@ LITE_OS_SEC_TEXT VOID OsWriteResourceEvent(UINT32 events)
     (VOID)LOS_EventWrite(&g_resourceEvent, events);
 }
 
+/* must be called with the scheduler lock held */
+LITE_OS_SEC_TEXT VOID OsWriteResourceEventUnsafe(UINT32 events)
+{
+    OsEventWriteUnsafe(&g_resourceEvent, events, FALSE, NULL);
+}
+
 //Դ߼
 STATIC VOID OsResourceRecoveryTask(VOID)
 {
@@ -1879,6 +1885,10 @@ STATIC VOID OsResourceRecoveryTask(VOID)
             OsProcessCBRecyleToFree(); //մնеĽ
         }
 
+        if (ret & OS_RESOURCE_EVENT_SIGNOTIFY) {
+            OsSigNotifyFlush();
+        }
+
 #ifdef LOSCFG_ENABLE_OOM_LOOP_TASK
         if (ret & OS_RESOURCE_EVENT_OOM) {
             (VOID)OomCheckProcess();   //ڵʣڴ״̬»һЩռõĻԴ
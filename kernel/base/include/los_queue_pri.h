@@ -33,6 +33,7 @@
 #define _LOS_QUEUE_PRI_H
 
 #include "los_queue.h"
+#include "los_spinlock.h"
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -76,6 +77,8 @@ typedef struct {
     UINT16 readWriteableCnt[OS_QUEUE_N_RW]; /**< Count of readable or writable resources, 0:readable, 1:writable */
     LOS_DL_LIST readWriteList[OS_QUEUE_N_RW]; /**< the linked list to be read or written, 0:readlist, 1:writelist */
     LOS_DL_LIST memList; /**< Pointer to the memory linked list */
+    SPIN_LOCK_S lock; /**< Protects the buffer and counters, taken inside the scheduler lock when both are needed */
+    UINT16 waiters[OS_QUEUE_N_RW]; /**< Tasks about to join readWriteList, 0:read, 1:write */
 } LosQueueCB;
 
 /* queue state */
@@ -166,6 +166,8 @@ extern VOID OsSchedTaskEnQueue(LosTaskCB *taskCB);
 
 extern UINT32 OsSchedTaskWait(LOS_DL_LIST *list, UINT32 timeout, BOOL needSched);
 
+extern UINT32 OsSchedTaskWaitUnlock(LOS_DL_LIST *list, UINT32 timeout, SPIN_LOCK_S *objLock);
+
 extern VOID OsSchedTaskWake(LosTaskCB *resumedTask);
 
 extern BOOL OsSchedModifyTaskSchedParam(LosTaskCB *taskCB, UINT16 policy, UINT16 priority);
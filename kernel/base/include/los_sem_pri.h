@@ -33,6 +33,7 @@
 #define _LOS_SEM_PRI_H
 
 #include "los_sem.h"
+#include "los_spinlock.h"
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -50,6 +51,8 @@ typedef struct {
     UINT16 maxSemCount;  /**< Max number of available semaphores */
     UINT32 semID; /**< Semaphore control structure ID */
     LOS_DL_LIST semList; /**< Queue of tasks that are waiting on a semaphore */
+    SPIN_LOCK_S lock; /**< Protects the count, taken inside the scheduler lock when both are needed */
+    UINT32 waiters; /**< Tasks about to join semList, with it a post that sees neither stays lock-local */
 } LosSemCB;
 
 /**
@@ -188,6 +188,10 @@ int OsSigTimedWait(sigset_t *set, siginfo_t *info, unsigned int timeout);
 int OsPause(void);
 int OsSigPending(sigset_t *set);
 int OsSigSuspend(const sigset_t *set);
+typedef void (*SigNotifyHook)(unsigned int processID);
+void OsSigNotifyHookRegister(SigNotifyHook hook);
+void OsSigNotify(unsigned int processID);
+void OsSigNotifyFlush(void);
 
 #ifdef __cplusplus
 #if __cplusplus
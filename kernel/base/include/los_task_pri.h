@@ -298,6 +298,7 @@ extern SPIN_LOCK_S g_taskSpin;
 #define OS_RESOURCE_EVENT_MASK          0xFF
 #define OS_RESOURCE_EVENT_OOM           0x02
 #define OS_RESOURCE_EVENT_FREE          0x04
+#define OS_RESOURCE_EVENT_SIGNOTIFY     0x08
 #define OS_TCB_NAME_LEN 32
 
 typedef struct {
@@ -488,6 +489,7 @@ extern VOID OsExecDestroyTaskGroup(VOID);
 extern VOID OsProcessSuspendAllTask(VOID);
 extern UINT32 OsUserTaskOperatePermissionsCheck(LosTaskCB *taskCB);
 extern VOID OsWriteResourceEvent(UINT32 events);
+extern VOID OsWriteResourceEventUnsafe(UINT32 events);
 extern UINT32 OsCreateResourceFreeTask(VOID);
 
 #define OS_TASK_WAIT_ANYPROCESS (1 << 0U)
@@ -107,14 +107,22 @@ STATIC INLINE VOID OsCleanPageLocked(LosVmPage *page)
     LOS_BitmapClr(&page->flags, FILE_PAGE_LOCKED);
 }
 
+extern Atomic g_fileDirtyPages; /* file pages waiting for writeback */
+
 STATIC INLINE VOID OsSetPageDirty(LosVmPage *page)
 {
-    LOS_BitmapSet(&page->flags, FILE_PAGE_DIRTY);
+    if (!BIT_GET(page->flags, FILE_PAGE_DIRTY)) {
+        LOS_BitmapSet(&page->flags, FILE_PAGE_DIRTY);
+        LOS_AtomicInc(&g_fileDirtyPages);
+    }
 }
 
 STATIC INLINE VOID OsCleanPageDirty(LosVmPage *page)
 {
-    LOS_BitmapClr(&page->flags, FILE_PAGE_DIRTY);
+    if (BIT_GET(page->flags, FILE_PAGE_DIRTY)) {
+        LOS_BitmapClr(&page->flags, FILE_PAGE_DIRTY);
+        LOS_AtomicDec(&g_fileDirtyPages);
+    }
 }
 
 STATIC INLINE VOID OsSetPageActive(LosVmPage *page)
@@ -196,10 +204,14 @@ STATIC INLINE BOOL OsIsPageShared(LosVmPage *page)
 INT32 OsVfsFileMmap(struct file *filep, LosVmMapRegion *region);
 LosFilePage *OsPageCacheAlloc(struct page_mapping *mapping, VM_OFFSET_T pgoff);
 LosFilePage *OsFindGetEntry(struct page_mapping *mapping, VM_OFFSET_T pgoff);
+LosVmPage *OsPageCacheGetPinned(struct page_mapping *mapping, VM_OFFSET_T pgoff);
 LosMapInfo *OsGetMapInfo(LosFilePage *page, LosArchMmu *archMmu, VADDR_T vaddr);
 VOID OsAddMapInfo(LosFilePage *page, LosArchMmu *archMmu, VADDR_T vaddr);
 VOID OsDelMapInfo(LosVmMapRegion *region, LosVmPgFault *pgFault, BOOL cleanDirty);
 VOID OsFileCacheFlush(struct page_mapping *mapping);
+BOOL OsFileCacheOverDirty(VOID);
+BOOL OsFileCacheOverHardLimit(VOID);
+VOID OsFileCacheBalanceDirty(struct page_mapping *mapping);
 VOID OsFileCacheRemove(struct page_mapping *mapping);
 VOID OsUnmapPageLocked(LosFilePage *page, LosMapInfo *info);
 VOID OsUnmapAllLocked(LosFilePage *page);
@@ -208,6 +220,7 @@ VOID OsLruCacheDel(LosFilePage *fpage);
 LosFilePage *OsDumpDirtyPage(LosFilePage *oldPage);
 VOID OsDoFlushDirtyPage(LosFilePage *fpage);
 VOID OsDeletePageCacheLru(LosFilePage *page);
+VOID OsPageCacheDel(LosFilePage *fpage);
 STATUS_T OsNamedMMap(struct file *filep, LosVmMapRegion *region);
 VOID OsPageRefDecNoLock(LosFilePage *page);
 VOID OsPageRefIncLocked(LosFilePage *page);
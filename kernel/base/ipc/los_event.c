@@ -45,6 +45,28 @@ extern "C" {
 #endif
 #endif /* __cplusplus */
 
+/*
+ * EVENT_CB_S is embedded by value all over the tree and los_event.h sits below los_spinlock.h in
+ * the include chain, so event control blocks share a small table of locks picked by address
+ * instead of carrying their own. A lock protects uwEventID of the blocks hashed to it and nests
+ * inside the scheduler lock, which still guards stEventList. Readers join stEventList with both
+ * held, and waiters counts the ones on their way there from any of those blocks: while it is zero
+ * and the list is empty a write only has to set bits.
+ */
+#define OS_EVENT_LOCK_NUM       32
+
+typedef struct {
+    SPIN_LOCK_S lock;
+    UINT32 waiters;
+} EventLock;
+
+STATIC EventLock g_eventLock[OS_EVENT_LOCK_NUM];
+
+STATIC INLINE EventLock *OsEventLockGet(const EVENT_CB_S *eventCB)
+{
+    return &g_eventLock[((UINTPTR)eventCB / sizeof(EVENT_CB_S)) % OS_EVENT_LOCK_NUM];
+}
+
 LITE_OS_SEC_TEXT_INIT UINT32 LOS_EventInit(PEVENT_CB_S eventCB)
 {
     UINT32 intSave;
@@ -82,13 +104,10 @@ LITE_OS_SEC_TEXT STATIC UINT32 OsEventParamCheck(const VOID *ptr, UINT32 eventMa
     return LOS_OK;
 }
 
-LITE_OS_SEC_TEXT UINT32 OsEventPoll(UINT32 *eventID, UINT32 eventMask, UINT32 mode)
+STATIC UINT32 OsEventPollLocked(UINT32 *eventID, UINT32 eventMask, UINT32 mode)
 {
     UINT32 ret = 0;
 
-    LOS_ASSERT(OsIntLocked());
-    LOS_ASSERT(LOS_SpinHeld(&g_taskSpin));
-
     if (mode & LOS_WAITMODE_OR) {
         if ((*eventID & eventMask) != 0) {
             ret = *eventID & eventMask;
@@ -106,6 +125,14 @@ LITE_OS_SEC_TEXT UINT32 OsEventPoll(UINT32 *eventID, UINT32 eventMask, UINT32 mo
     return ret;
 }
 
+LITE_OS_SEC_TEXT UINT32 OsEventPoll(UINT32 *eventID, UINT32 eventMask, UINT32 mode)
+{
+    LOS_ASSERT(OsIntLocked());
+    LOS_ASSERT(LOS_SpinHeld(&g_taskSpin));
+
+    return OsEventPollLocked(eventID, eventMask, mode);
+}
+
 LITE_OS_SEC_TEXT STATIC UINT32 OsEventReadCheck(const PEVENT_CB_S eventCB, UINT32 eventMask, UINT32 mode)
 {
     UINT32 ret;
@@ -128,39 +155,77 @@ LITE_OS_SEC_TEXT STATIC UINT32 OsEventReadCheck(const PEVENT_CB_S eventCB, UINT3
     return LOS_OK;
 }
 
-LITE_OS_SEC_TEXT STATIC UINT32 OsEventReadImp(PEVENT_CB_S eventCB, UINT32 eventMask, UINT32 mode,
-                                              UINT32 timeout, BOOL once)
+/*
+ * Slow path of a read that found none of its events, entered with the caller counted in waiters.
+ * The event lock is retaken under the scheduler lock and the task joins stEventList before it is
+ * dropped, so a writer that saw neither, and only set bits, cannot be missed. Once on the list
+ * the task is no longer counted, whatever takes it off again.
+ */
+LITE_OS_SEC_TEXT STATIC UINT32 OsEventReadWait(PEVENT_CB_S eventCB, EventLock *eventLock, UINT32 eventMask,
+                                               UINT32 mode, UINT32 timeout, BOOL once)
 {
     UINT32 ret = 0;
+    UINT32 intSave;
+    BOOL preemptable = FALSE;
     LosTaskCB *runTask = OsCurrTaskGet();
 
+    SCHEDULER_LOCK(intSave);
+    preemptable = OsPreemptableInSched();
+    LOS_SpinLock(&eventLock->lock);
+    eventLock->waiters--;
+
     if (once == FALSE) {
-        ret = OsEventPoll(&eventCB->uwEventID, eventMask, mode);
+        ret = OsEventPollLocked(&eventCB->uwEventID, eventMask, mode);
+        if (ret != 0) {
+            goto OUT;
+        }
     }
 
-    if (ret == 0) {
-        if (timeout == 0) {
-            return ret;
-        }
+    if (!preemptable) {
+        ret = LOS_ERRNO_EVENT_READ_IN_LOCK;
+        goto OUT;
+    }
 
-        if (!OsPreemptableInSched()) {
-            return LOS_ERRNO_EVENT_READ_IN_LOCK;
-        }
+    runTask->eventMask = eventMask;
+    runTask->eventMode = mode;
+    runTask->taskEvent = eventCB;
+    OsTaskWaitSetPendMask(OS_TASK_WAIT_EVENT, eventMask, timeout);
+    ret = OsSchedTaskWaitUnlock(&eventCB->stEventList, timeout, &eventLock->lock);
+    LOS_SpinLock(&eventLock->lock);
+    if (ret == LOS_ERRNO_TSK_TIMEOUT) {
+        ret = LOS_ERRNO_EVENT_READ_TIMEOUT;
+        goto OUT;
+    }
 
-        runTask->eventMask = eventMask;
-        runTask->eventMode = mode;
-        runTask->taskEvent = eventCB;
-        OsTaskWaitSetPendMask(OS_TASK_WAIT_EVENT, eventMask, timeout);
-        ret = OsSchedTaskWait(&eventCB->stEventList, timeout, TRUE);
-        if (ret == LOS_ERRNO_TSK_TIMEOUT) {
-            return LOS_ERRNO_EVENT_READ_TIMEOUT;
-        }
+    ret = OsEventPollLocked(&eventCB->uwEventID, eventMask, mode);
 
-        ret = OsEventPoll(&eventCB->uwEventID, eventMask, mode);
-    }
+OUT:
+    LOS_SpinUnlock(&eventLock->lock);
+    SCHEDULER_UNLOCK(intSave);
     return ret;
 }
 
+/* called with the event lock held, which is dropped before a wait */
+LITE_OS_SEC_TEXT STATIC UINT32 OsEventReadImp(PEVENT_CB_S eventCB, UINT32 eventMask, UINT32 mode,
+                                              UINT32 timeout, BOOL once, UINT32 intSave)
+{
+    UINT32 ret = 0;
+    EventLock *eventLock = OsEventLockGet(eventCB);
+
+    if (once == FALSE) {
+        ret = OsEventPollLocked(&eventCB->uwEventID, eventMask, mode);
+    }
+
+    if ((ret != 0) || (timeout == 0)) {
+        LOS_SpinUnlockRestore(&eventLock->lock, intSave);
+        return ret;
+    }
+
+    eventLock->waiters++;
+    LOS_SpinUnlockRestore(&eventLock->lock, intSave);
+    return OsEventReadWait(eventCB, eventLock, eventMask, mode, timeout, once);
+}
+
 LITE_OS_SEC_TEXT STATIC UINT32 OsEventRead(PEVENT_CB_S eventCB, UINT32 eventMask, UINT32 mode, UINT32 timeout,
                                            BOOL once)
 {
@@ -172,10 +237,8 @@ LITE_OS_SEC_TEXT STATIC UINT32 OsEventRead(PEVENT_CB_S eventCB, UINT32 eventMask
         return ret;
     }
 
-    SCHEDULER_LOCK(intSave);
-    ret = OsEventReadImp(eventCB, eventMask, mode, timeout, once);
-    SCHEDULER_UNLOCK(intSave);
-    return ret;
+    LOS_SpinLockSave(&OsEventLockGet(eventCB)->lock, &intSave);
+    return OsEventReadImp(eventCB, eventMask, mode, timeout, once, intSave);
 }
 
 LITE_OS_SEC_TEXT STATIC UINT8 OsEventResume(LosTaskCB *resumedTask, const PEVENT_CB_S eventCB, UINT32 events)
@@ -195,12 +258,15 @@ LITE_OS_SEC_TEXT STATIC UINT8 OsEventResume(LosTaskCB *resumedTask, const PEVENT
     return exitFlag;
 }
 
+/* called with the scheduler lock held */
 LITE_OS_SEC_TEXT VOID OsEventWriteUnsafe(PEVENT_CB_S eventCB, UINT32 events, BOOL once, UINT8 *exitFlag)
 {
     LosTaskCB *resumedTask = NULL;
     LosTaskCB *nextTask = NULL;
     BOOL schedFlag = FALSE;
+    EventLock *eventLock = OsEventLockGet(eventCB);
 
+    LOS_SpinLock(&eventLock->lock);
     eventCB->uwEventID |= events;
     if (!LOS_ListEmpty(&eventCB->stEventList)) {
         for (resumedTask = LOS_DL_LIST_ENTRY((&eventCB->stEventList)->pstNext, LosTaskCB, pendList);
@@ -215,6 +281,7 @@ LITE_OS_SEC_TEXT VOID OsEventWriteUnsafe(PEVENT_CB_S eventCB, UINT32 events, BOO
             resumedTask = nextTask;
         }
     }
+    LOS_SpinUnlock(&eventLock->lock);
 
     if ((exitFlag != NULL) && (schedFlag == TRUE)) {
         *exitFlag = 1;
@@ -225,6 +292,7 @@ LITE_OS_SEC_TEXT STATIC UINT32 OsEventWrite(PEVENT_CB_S eventCB, UINT32 events,
 {
     UINT32 intSave;
     UINT8 exitFlag = 0;
+    EventLock *eventLock = NULL;
 
     if (eventCB == NULL) {
         return LOS_ERRNO_EVENT_PTR_NULL;
@@ -234,6 +302,16 @@ LITE_OS_SEC_TEXT STATIC UINT32 OsEventWrite(PEVENT_CB_S eventCB, UINT32 events,
         return LOS_ERRNO_EVENT_SETBIT_INVALID;
     }
 
+    /* nobody can be pending on this block: setting the bits is the whole write */
+    eventLock = OsEventLockGet(eventCB);
+    LOS_SpinLockSave(&eventLock->lock, &intSave);
+    if ((eventLock->waiters == 0) && LOS_ListEmpty(&eventCB->stEventList)) {
+        eventCB->uwEventID |= events;
+        LOS_SpinUnlockRestore(&eventLock->lock, intSave);
+        return LOS_OK;
+    }
+    LOS_SpinUnlockRestore(&eventLock->lock, intSave);
+
     SCHEDULER_LOCK(intSave);
     OsEventWriteUnsafe(eventCB, events, once, &exitFlag);
     SCHEDULER_UNLOCK(intSave);
@@ -296,8 +374,10 @@ LITE_OS_SEC_TEXT_INIT UINT32 LOS_EventDestroy(PEVENT_CB_S eventCB)
         return LOS_ERRNO_EVENT_SHOULD_NOT_DESTORY;
     }
 
+    LOS_SpinLock(&OsEventLockGet(eventCB)->lock);
     eventCB->uwEventID = 0;
     LOS_ListDelInit(&eventCB->stEventList);
+    LOS_SpinUnlock(&OsEventLockGet(eventCB)->lock);
     SCHEDULER_UNLOCK(intSave);
 
     return LOS_OK;
@@ -310,9 +390,9 @@ LITE_OS_SEC_TEXT_MINOR UINT32 LOS_EventClear(PEVENT_CB_S eventCB, UINT32 events)
     if (eventCB == NULL) {
         return LOS_ERRNO_EVENT_PTR_NULL;
     }
-    SCHEDULER_LOCK(intSave);
+    LOS_SpinLockSave(&OsEventLockGet(eventCB)->lock, &intSave);
     eventCB->uwEventID &= events;
-    SCHEDULER_UNLOCK(intSave);
+    LOS_SpinUnlockRestore(&OsEventLockGet(eventCB)->lock, intSave);
 
     return LOS_OK;
 }
@@ -329,17 +409,15 @@ LITE_OS_SEC_TEXT UINT32 OsEventReadWithCond(const EventCond *cond, PEVENT_CB_S e
         return ret;
     }
 
-    SCHEDULER_LOCK(intSave);
+    LOS_SpinLockSave(&OsEventLockGet(eventCB)->lock, &intSave);
 
     if (*cond->realValue != cond->value) {
         eventCB->uwEventID &= cond->clearEvent;
-        goto OUT;
+        LOS_SpinUnlockRestore(&OsEventLockGet(eventCB)->lock, intSave);
+        return ret;
     }
 
-    ret = OsEventReadImp(eventCB, eventMask, mode, timeout, FALSE);
-OUT:
-    SCHEDULER_UNLOCK(intSave);
-    return ret;
+    return OsEventReadImp(eventCB, eventMask, mode, timeout, FALSE, intSave);
 }
 #endif
 
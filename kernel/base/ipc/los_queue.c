@@ -72,6 +72,7 @@ LITE_OS_SEC_TEXT_INIT UINT32 OsQueueInit(VOID)
     for (index = 0; index < LOSCFG_BASE_IPC_QUEUE_LIMIT; index++) {
         queueNode = ((LosQueueCB *)g_allQueue) + index;
         queueNode->queueID = index;
+        LOS_SpinInit(&queueNode->lock);
         LOS_ListTailInsert(&g_freeQueueList, &queueNode->readWriteList[OS_QUEUE_WRITE]);
     }
 
@@ -126,6 +127,7 @@ LITE_OS_SEC_TEXT_INIT UINT32 LOS_QueueCreate(CHAR *queueName, UINT16 len, UINT32
     unusedQueue = LOS_DL_LIST_FIRST(&g_freeQueueList);
     LOS_ListDelete(unusedQueue);
     queueCB = GET_QUEUE_LIST(unusedQueue);
+    LOS_SpinLock(&queueCB->lock);
     queueCB->queueLen = len;
     queueCB->queueSize = msgSize;
     queueCB->queueHandle = queue;
@@ -137,6 +139,9 @@ LITE_OS_SEC_TEXT_INIT UINT32 LOS_QueueCreate(CHAR *queueName, UINT16 len, UINT32
     LOS_ListInit(&queueCB->readWriteList[OS_QUEUE_READ]);
     LOS_ListInit(&queueCB->readWriteList[OS_QUEUE_WRITE]);
     LOS_ListInit(&queueCB->memList);
+    queueCB->waiters[OS_QUEUE_READ] = 0;
+    queueCB->waiters[OS_QUEUE_WRITE] = 0;
+    LOS_SpinUnlock(&queueCB->lock);
 
     OsQueueDbgUpdateHook(queueCB->queueID, OsCurrTaskGet()->taskEntry);
     SCHEDULER_UNLOCK(intSave);
@@ -261,16 +266,82 @@ STATIC UINT32 OsQueueOperateParamCheck(const LosQueueCB *queueCB, UINT32 queueID
     return LOS_OK;
 }
 
-UINT32 OsQueueOperate(UINT32 queueID, UINT32 operateType, VOID *bufferAddr, UINT32 *bufferSize, UINT32 timeout)
+/*
+ * Slow path of a read or write that found no free slot, entered with the caller counted in
+ * waiters. The queue lock nests inside the scheduler lock, so it is retaken under it before the
+ * recheck. The task then joins readWriteList before the queue lock is dropped and is accounted
+ * for by the list alone, so a peer holding only the queue lock either sees it there or sees it
+ * in waiters, and a task delete or timeout that unlinks it leaves no count behind.
+ * Returns with only the queue lock held.
+ */
+STATIC UINT32 OsQueueWait(LosQueueCB *queueCB, UINT32 queueID, UINT32 readWrite, UINT32 timeout, UINT32 *intSave)
+{
+    UINT32 ret = LOS_OK;
+    BOOL preemptable = FALSE;
+
+    SCHEDULER_LOCK(*intSave);
+    preemptable = OsPreemptableInSched();
+    LOS_SpinLock(&queueCB->lock);
+    queueCB->waiters[readWrite]--;
+
+    if ((queueCB->queueID != queueID) || (queueCB->queueState == OS_QUEUE_UNUSED)) {
+        ret = LOS_ERRNO_QUEUE_NOT_CREATE;
+        goto QUEUE_END;
+    }
+
+    if (queueCB->readWriteableCnt[readWrite] > 0) {
+        queueCB->readWriteableCnt[readWrite]--;
+        goto QUEUE_END;
+    }
+
+    if (!preemptable) {
+        ret = LOS_ERRNO_QUEUE_PEND_IN_LOCK;
+        goto QUEUE_END;
+    }
+
+    OsTaskWaitSetPendMask(OS_TASK_WAIT_QUEUE, queueCB->queueID, timeout);
+    ret = OsSchedTaskWaitUnlock(&queueCB->readWriteList[readWrite], timeout, &queueCB->lock);
+    if (ret == LOS_ERRNO_TSK_TIMEOUT) {
+        ret = LOS_ERRNO_QUEUE_TIMEOUT;
+    }
+    LOS_SpinLock(&queueCB->lock);
+
+QUEUE_END:
+    LOS_SpinUnlock(&g_taskSpin);
+    return ret;
+}
+
+/* hand the slot just filled or emptied to a task pending on the other side, or publish it */
+STATIC BOOL OsQueueWake(LosQueueCB *queueCB, UINT32 readWrite)
 {
-    LosQueueCB *queueCB = NULL;
     LosTaskCB *resumedTask = NULL;
+    BOOL needSched = FALSE;
+    UINT32 intSave;
+
+    SCHEDULER_LOCK(intSave);
+    LOS_SpinLock(&queueCB->lock);
+    if (!LOS_ListEmpty(&queueCB->readWriteList[!readWrite])) {
+        resumedTask = OS_TCB_FROM_PENDLIST(LOS_DL_LIST_FIRST(&queueCB->readWriteList[!readWrite]));
+        OsTaskWakeClearPendMask(resumedTask);
+        OsSchedTaskWake(resumedTask);
+        needSched = TRUE;
+    } else {
+        queueCB->readWriteableCnt[!readWrite]++;
+    }
+    LOS_SpinUnlock(&queueCB->lock);
+    SCHEDULER_UNLOCK(intSave);
+
+    return needSched;
+}
+
+UINT32 OsQueueOperate(UINT32 queueID, UINT32 operateType, VOID *bufferAddr, UINT32 *bufferSize, UINT32 timeout)
+{
+    LosQueueCB *queueCB = (LosQueueCB *)GET_QUEUE_HANDLE(queueID);
     UINT32 ret;
     UINT32 readWrite = OS_QUEUE_READ_WRITE_GET(operateType);
     UINT32 intSave;
 
-    SCHEDULER_LOCK(intSave);
-    queueCB = (LosQueueCB *)GET_QUEUE_HANDLE(queueID);
+    LOS_SpinLockSave(&queueCB->lock, &intSave);
     ret = OsQueueOperateParamCheck(queueCB, queueID, operateType, bufferSize);
     if (ret != LOS_OK) {
         goto QUEUE_END;
@@ -282,37 +353,33 @@ UINT32 OsQueueOperate(UINT32 queueID, UINT32 operateType, VOID *bufferAddr, UINT
             goto QUEUE_END;
         }
 
-        if (!OsPreemptableInSched()) {
-            ret = LOS_ERRNO_QUEUE_PEND_IN_LOCK;
-            goto QUEUE_END;
-        }
-
-        OsTaskWaitSetPendMask(OS_TASK_WAIT_QUEUE, queueCB->queueID, timeout);
-        ret = OsSchedTaskWait(&queueCB->readWriteList[readWrite], timeout, TRUE);
-        if (ret == LOS_ERRNO_TSK_TIMEOUT) {
-            ret = LOS_ERRNO_QUEUE_TIMEOUT;
+        queueCB->waiters[readWrite]++;
+        LOS_SpinUnlockRestore(&queueCB->lock, intSave);
+        ret = OsQueueWait(queueCB, queueID, readWrite, timeout, &intSave);
+        if (ret != LOS_OK) {
             goto QUEUE_END;
         }
     } else {
         queueCB->readWriteableCnt[readWrite]--;
     }
 
+    /* the slot is ours now, only this queue's lock is held across the copy */
     OsQueueBufferOperate(queueCB, operateType, bufferAddr, bufferSize);
 
-    if (!LOS_ListEmpty(&queueCB->readWriteList[!readWrite])) {
-        resumedTask = OS_TCB_FROM_PENDLIST(LOS_DL_LIST_FIRST(&queueCB->readWriteList[!readWrite]));
-        OsTaskWakeClearPendMask(resumedTask);
-        OsSchedTaskWake(resumedTask);
-        SCHEDULER_UNLOCK(intSave);
+    if ((queueCB->waiters[!readWrite] == 0) && LOS_ListEmpty(&queueCB->readWriteList[!readWrite])) {
+        queueCB->readWriteableCnt[!readWrite]++;
+        goto QUEUE_END;
+    }
+    LOS_SpinUnlockRestore(&queueCB->lock, intSave);
+
+    if (OsQueueWake(queueCB, readWrite)) {
         LOS_MpSchedule(OS_MP_CPU_ALL);
         LOS_Schedule();
-        return LOS_OK;
-    } else {
-        queueCB->readWriteableCnt[!readWrite]++;
     }
+    return LOS_OK;
 
 QUEUE_END:
-    SCHEDULER_UNLOCK(intSave);
+    LOS_SpinUnlockRestore(&queueCB->lock, intSave);
     return ret;
 }
 
@@ -406,11 +473,17 @@ LITE_OS_SEC_TEXT_INIT UINT32 LOS_QueueDelete(UINT32 queueID)
 
     SCHEDULER_LOCK(intSave);
     queueCB = (LosQueueCB *)GET_QUEUE_HANDLE(queueID);
+    LOS_SpinLock(&queueCB->lock);
     if ((queueCB->queueID != queueID) || (queueCB->queueState == OS_QUEUE_UNUSED)) {
         ret = LOS_ERRNO_QUEUE_NOT_CREATE;
         goto QUEUE_END;
     }
 
+    if ((queueCB->waiters[OS_QUEUE_READ] != 0) || (queueCB->waiters[OS_QUEUE_WRITE] != 0)) {
+        ret = LOS_ERRNO_QUEUE_IN_TSKUSE;
+        goto QUEUE_END;
+    }
+
     if (!LOS_ListEmpty(&queueCB->readWriteList[OS_QUEUE_READ])) {
         ret = LOS_ERRNO_QUEUE_IN_TSKUSE;
         goto QUEUE_END;
@@ -439,12 +512,14 @@ LITE_OS_SEC_TEXT_INIT UINT32 LOS_QueueDelete(UINT32 queueID)
     OsQueueDbgUpdateHook(queueCB->queueID, NULL);
 
     LOS_ListTailInsert(&g_freeQueueList, &queueCB->readWriteList[OS_QUEUE_WRITE]);
+    LOS_SpinUnlock(&queueCB->lock);
     SCHEDULER_UNLOCK(intSave);
 
     ret = LOS_MemFree(m_aucSysMem1, (VOID *)queue);
     return ret;
 
 QUEUE_END:
+    LOS_SpinUnlock(&queueCB->lock);
     SCHEDULER_UNLOCK(intSave);
     return ret;
 }
@@ -468,6 +543,7 @@ LITE_OS_SEC_TEXT_MINOR UINT32 LOS_QueueInfoGet(UINT32 queueID, QUEUE_INFO_S *que
     SCHEDULER_LOCK(intSave);
 
     queueCB = (LosQueueCB *)GET_QUEUE_HANDLE(queueID);
+    LOS_SpinLock(&queueCB->lock);
     if ((queueCB->queueID != queueID) || (queueCB->queueState == OS_QUEUE_UNUSED)) {
         ret = LOS_ERRNO_QUEUE_NOT_CREATE;
         goto QUEUE_END;
@@ -494,6 +570,7 @@ LITE_OS_SEC_TEXT_MINOR UINT32 LOS_QueueInfoGet(UINT32 queueID, QUEUE_INFO_S *que
     }
 
 QUEUE_END:
+    LOS_SpinUnlock(&queueCB->lock);
     SCHEDULER_UNLOCK(intSave);
     return ret;
 }
@@ -74,6 +74,7 @@ LITE_OS_SEC_TEXT_INIT UINT32 OsSemInit(VOID)
         semNode = ((LosSemCB *)g_allSem) + index;
         semNode->semID = SET_SEM_ID(0, index);
         semNode->semStat = OS_SEM_UNUSED;
+        LOS_SpinInit(&semNode->lock);
         LOS_ListTailInsert(&g_unusedSemList, &semNode->semList);
     }
 
@@ -121,6 +122,7 @@ LITE_OS_SEC_TEXT_INIT UINT32 OsSemCreate(UINT16 count, UINT16 maxCount, UINT32 *
     semCreated->semCount = count;
     semCreated->semStat = OS_SEM_USED;
     semCreated->maxSemCount = maxCount;
+    semCreated->waiters = 0;
     LOS_ListInit(&semCreated->semList);
     *semHandle = semCreated->semID;
 
@@ -161,7 +163,9 @@ LITE_OS_SEC_TEXT_INIT UINT32 LOS_SemDelete(UINT32 semHandle)
         OS_GOTO_ERR_HANDLER(LOS_ERRNO_SEM_INVALID);
     }
 
-    if (!LOS_ListEmpty(&semDeleted->semList)) {
+    LOS_SpinLock(&semDeleted->lock);
+    if (!LOS_ListEmpty(&semDeleted->semList) || (semDeleted->waiters != 0)) {
+        LOS_SpinUnlock(&semDeleted->lock);
         SCHEDULER_UNLOCK(intSave);
         OS_GOTO_ERR_HANDLER(LOS_ERRNO_SEM_PENDED);
     }
@@ -169,6 +173,7 @@ LITE_OS_SEC_TEXT_INIT UINT32 LOS_SemDelete(UINT32 semHandle)
     LOS_ListTailInsert(&g_unusedSemList, &semDeleted->semList);
     semDeleted->semStat = OS_SEM_UNUSED;
     semDeleted->semID = SET_SEM_ID(GET_SEM_COUNT(semDeleted->semID) + 1, GET_SEM_INDEX(semDeleted->semID));
+    LOS_SpinUnlock(&semDeleted->lock);
 
     OsSemDbgUpdateHook(semDeleted->semID, NULL, 0);
 
@@ -179,6 +184,55 @@ ERR_HANDLER:
     OS_RETURN_ERROR_P2(errLine, errNo);
 }
 
+/*
+ * Slow path of a pend: the count was zero and the caller is counted in waiters. The sem lock
+ * nests inside the scheduler lock, so it is dropped and retaken under it before the recheck.
+ * From there on the task is accounted for by semList instead of waiters: it joins the list
+ * before the sem lock goes, and whoever takes it off (post, timeout or task delete) has nothing
+ * else to undo.
+ */
+STATIC UINT32 OsSemPendWait(LosSemCB *semPended, UINT32 semHandle, UINT32 timeout)
+{
+    UINT32 intSave;
+    UINT32 retErr = LOS_OK;
+    BOOL preemptable = FALSE;
+
+    SCHEDULER_LOCK(intSave);
+    preemptable = OsPreemptableInSched();
+    LOS_SpinLock(&semPended->lock);
+    semPended->waiters--;
+
+    if ((semPended->semStat == OS_SEM_UNUSED) || (semPended->semID != semHandle)) {
+        retErr = LOS_ERRNO_SEM_INVALID;
+        goto OUT;
+    }
+
+    if (semPended->semCount > 0) {
+        semPended->semCount--;
+        goto OUT;
+    }
+
+    if (!preemptable) {
+        PRINT_ERR("!!!LOS_ERRNO_SEM_PEND_IN_LOCK!!!\n");
+        OsBackTrace();
+        retErr = LOS_ERRNO_SEM_PEND_IN_LOCK;
+        goto OUT;
+    }
+
+    OsTaskWaitSetPendMask(OS_TASK_WAIT_SEM, semPended->semID, timeout);
+    retErr = OsSchedTaskWaitUnlock(&semPended->semList, timeout, &semPended->lock);
+    if (retErr == LOS_ERRNO_TSK_TIMEOUT) {
+        retErr = LOS_ERRNO_SEM_TIMEOUT;
+    }
+    SCHEDULER_UNLOCK(intSave);
+    return retErr;
+
+OUT:
+    LOS_SpinUnlock(&semPended->lock);
+    SCHEDULER_UNLOCK(intSave);
+    return retErr;
+}
+
 LITE_OS_SEC_TEXT UINT32 LOS_SemPend(UINT32 semHandle, UINT32 timeout)
 {
     UINT32 intSave;
@@ -202,7 +256,7 @@ LITE_OS_SEC_TEXT UINT32 LOS_SemPend(UINT32 semHandle, UINT32 timeout)
         return LOS_ERRNO_SEM_PEND_IN_SYSTEM_TASK;
     }
 
-    SCHEDULER_LOCK(intSave);
+    LOS_SpinLockSave(&semPended->lock, &intSave);
 
     if ((semPended->semStat == OS_SEM_UNUSED) || (semPended->semID != semHandle)) {
         retErr = LOS_ERRNO_SEM_INVALID;
@@ -220,39 +274,35 @@ LITE_OS_SEC_TEXT UINT32 LOS_SemPend(UINT32 semHandle, UINT32 timeout)
         goto OUT;
     }
 
-    if (!OsPreemptableInSched()) {
-        PRINT_ERR("!!!LOS_ERRNO_SEM_PEND_IN_LOCK!!!\n");
-        OsBackTrace();
-        retErr = LOS_ERRNO_SEM_PEND_IN_LOCK;
-        goto OUT;
-    }
-
-    OsTaskWaitSetPendMask(OS_TASK_WAIT_SEM, semPended->semID, timeout);
-    retErr = OsSchedTaskWait(&semPended->semList, timeout, TRUE);
-    if (retErr == LOS_ERRNO_TSK_TIMEOUT) {
-        retErr = LOS_ERRNO_SEM_TIMEOUT;
-    }
+    semPended->waiters++;
+    LOS_SpinUnlockRestore(&semPended->lock, intSave);
+    return OsSemPendWait(semPended, semHandle, timeout);
 
 OUT:
-    SCHEDULER_UNLOCK(intSave);
+    LOS_SpinUnlockRestore(&semPended->lock, intSave);
     return retErr;
 }
 
+/* called with the scheduler lock held */
 LITE_OS_SEC_TEXT UINT32 OsSemPostUnsafe(UINT32 semHandle, BOOL *needSched)
 {
     LosSemCB *semPosted = NULL;
     LosTaskCB *resumedTask = NULL;
+    UINT32 ret = LOS_OK;
 
     semPosted = GET_SEM(semHandle);
+    LOS_SpinLock(&semPosted->lock);
     if ((semPosted->semID != semHandle) || (semPosted->semStat == OS_SEM_UNUSED)) {
-        return LOS_ERRNO_SEM_INVALID;
+        ret = LOS_ERRNO_SEM_INVALID;
+        goto OUT;
     }
 
     /* Update the operate time, no matter the actual Post success or not */
     OsSemDbgTimeUpdateHook(semHandle);
 
     if (semPosted->semCount == OS_SEM_COUNT_MAX) {
-        return LOS_ERRNO_SEM_OVERFLOW;
+        ret = LOS_ERRNO_SEM_OVERFLOW;
+        goto OUT;
     }
     if (!LOS_ListEmpty(&semPosted->semList)) {
         resumedTask = OS_TCB_FROM_PENDLIST(LOS_DL_LIST_FIRST(&(semPosted->semList)));
@@ -265,22 +315,40 @@ LITE_OS_SEC_TEXT UINT32 OsSemPostUnsafe(UINT32 semHandle, BOOL *needSched)
         semPosted->semCount++;
     }
 
-    return LOS_OK;
+OUT:
+    LOS_SpinUnlock(&semPosted->lock);
+    return ret;
 }
 
 LITE_OS_SEC_TEXT UINT32 LOS_SemPost(UINT32 semHandle)
 {
     UINT32 intSave;
     UINT32 ret;
+    LosSemCB *semPosted = NULL;
     BOOL needSched = FALSE;
 
     if (GET_SEM_INDEX(semHandle) >= LOSCFG_BASE_IPC_SEM_LIMIT) {
         return LOS_ERRNO_SEM_INVALID;
     }
 
+    /*
+     * nobody to wake: the count is all that changes, keep off the scheduler lock. Tasks join
+     * semList under the sem lock, so an empty list read here stays empty until it is dropped.
+     */
+    semPosted = GET_SEM(semHandle);
+    LOS_SpinLockSave(&semPosted->lock, &intSave);
+    if ((semPosted->semID == semHandle) && (semPosted->semStat != OS_SEM_UNUSED) && (semPosted->waiters == 0) &&
+        LOS_ListEmpty(&semPosted->semList) && (semPosted->semCount != OS_SEM_COUNT_MAX)) {
+        OsSemDbgTimeUpdateHook(semHandle);
+        semPosted->semCount++;
+        LOS_SpinUnlockRestore(&semPosted->lock, intSave);
+        return LOS_OK;
+    }
+    LOS_SpinUnlockRestore(&semPosted->lock, intSave);
+
     SCHEDULER_LOCK(intSave);
     ret = OsSemPostUnsafe(semHandle, &needSched);
-        SCHEDULER_UNLOCK(intSave);
+    SCHEDULER_UNLOCK(intSave);
     if (needSched) {
         LOS_MpSchedule(OS_MP_CPU_ALL);
         LOS_Schedule();
@@ -55,6 +55,26 @@ int raise(int sig)
 
 #define GETUNMASKSET(procmask, pendFlag) ((~(procmask)) & (sigset_t)(pendFlag))
 #define UINT64_BIT_SIZE 64
+#define UINT32_BIT_SIZE 32
+#define SIG_NOTIFY_WORDS ((LOSCFG_BASE_CORE_PROCESS_LIMIT + UINT32_BIT_SIZE - 1) / UINT32_BIT_SIZE)
+
+STATIC SigNotifyHook g_sigNotifyHook = NULL;
+/* processes with signals pending since the last notification, protected by the scheduler lock */
+STATIC UINT32 g_sigNotifyPending[SIG_NOTIFY_WORDS];
+
+/*
+ * Called with the scheduler lock held whenever a signal is left pending on a task. The hook
+ * can not run under that lock, so the resource recovery task runs it through OsSigNotifyFlush.
+ */
+STATIC VOID OsSigNotifyDefer(UINT32 processID)
+{
+    if ((g_sigNotifyHook == NULL) || (processID >= LOSCFG_BASE_CORE_PROCESS_LIMIT)) {
+        return;
+    }
+
+    g_sigNotifyPending[processID / UINT32_BIT_SIZE] |= 1U << (processID % UINT32_BIT_SIZE);
+    OsWriteResourceEventUnsafe(OS_RESOURCE_EVENT_SIGNOTIFY);
+}
 
 int OsSigIsMember(const sigset_t *set, int signo)
 {
@@ -100,6 +120,7 @@ int OsTcbDispatch(LosTaskCB *stcb, siginfo_t *info)
         }
     }
     (void) memcpy_s(&sigcb->sigunbinfo, sizeof(siginfo_t), info, sizeof(siginfo_t));
+    OsSigNotifyDefer(stcb->processID);
     return 0;
 }
 
@@ -291,6 +312,40 @@ int OsSigProcessSend(LosProcessCB *spcb, siginfo_t *sigInfo)
     return 0;
 }
 
+void OsSigNotifyHookRegister(SigNotifyHook hook)
+{
+    g_sigNotifyHook = hook;
+}
+
+/* Signals may have become pending for the process, must be called without the scheduler lock held */
+void OsSigNotify(unsigned int processID)
+{
+    SigNotifyHook hook = g_sigNotifyHook;
+
+    if (hook != NULL) {
+        hook(processID);
+    }
+}
+
+void OsSigNotifyFlush(void)
+{
+    UINT32 index;
+    UINT32 pending;
+    UINT32 intSave;
+
+    for (index = 0; index < SIG_NOTIFY_WORDS; index++) {
+        SCHEDULER_LOCK(intSave);
+        pending = g_sigNotifyPending[index];
+        g_sigNotifyPending[index] = 0;
+        SCHEDULER_UNLOCK(intSave);
+
+        while (pending != 0) {
+            OsSigNotify(index * UINT32_BIT_SIZE + (UINT32)__builtin_ctz(pending));
+            pending &= pending - 1;
+        }
+    }
+}
+
 int OsSigEmptySet(sigset_t *set)
 {
     *set = NULL_SIGNAL_SET;
@@ -643,9 +643,8 @@ VOID OsSchedDelay(LosTaskCB *runTask, UINT32 tick)
     OsSchedResched();
 }
 
-UINT32 OsSchedTaskWait(LOS_DL_LIST *list, UINT32 ticks, BOOL needSched)
+STATIC INLINE VOID OsSchedTaskPend(LosTaskCB *runTask, LOS_DL_LIST *list, UINT32 ticks)
 {
-    LosTaskCB *runTask = OsCurrTaskGet();
     OsSchedTaskDeQueue(runTask);
 
     runTask->taskStatus |= OS_TASK_STATUS_PENDING;
@@ -655,18 +654,44 @@ UINT32 OsSchedTaskWait(LOS_DL_LIST *list, UINT32 ticks, BOOL needSched)
         runTask->taskStatus |= OS_TASK_STATUS_PEND_TIME;
         runTask->waitTimes = ticks;
     }
+}
+
+STATIC INLINE UINT32 OsSchedTaskPendResched(LosTaskCB *runTask)
+{
+    OsSchedResched();
+    if (runTask->taskStatus & OS_TASK_STATUS_TIMEOUT) {
+        runTask->taskStatus &= ~OS_TASK_STATUS_TIMEOUT;
+        return LOS_ERRNO_TSK_TIMEOUT;
+    }
+
+    return LOS_OK;
+}
+
+UINT32 OsSchedTaskWait(LOS_DL_LIST *list, UINT32 ticks, BOOL needSched)
+{
+    LosTaskCB *runTask = OsCurrTaskGet();
 
+    OsSchedTaskPend(runTask, list, ticks);
     if (needSched == TRUE) {
-        OsSchedResched();
-        if (runTask->taskStatus & OS_TASK_STATUS_TIMEOUT) {
-            runTask->taskStatus &= ~OS_TASK_STATUS_TIMEOUT;
-            return LOS_ERRNO_TSK_TIMEOUT;
-        }
+        return OsSchedTaskPendResched(runTask);
     }
 
     return LOS_OK;
 }
 
+/*
+ * Join a pend list that is guarded by an object lock as well as the scheduler lock: the task is
+ * on the list before objLock is dropped, so a holder of objLock alone sees it there.
+ */
+UINT32 OsSchedTaskWaitUnlock(LOS_DL_LIST *list, UINT32 ticks, SPIN_LOCK_S *objLock)
+{
+    LosTaskCB *runTask = OsCurrTaskGet();
+
+    OsSchedTaskPend(runTask, list, ticks);
+    LOS_SpinUnlock(objLock);
+    return OsSchedTaskPendResched(runTask);
+}
+
 VOID OsSchedTaskWake(LosTaskCB *resumedTask)
 {
     LOS_ListDelete(&resumedTask->pendList);
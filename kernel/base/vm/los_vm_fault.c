@@ -314,6 +314,7 @@ status_t OsDoSharedFault(LosVmMapRegion *region, LosVmPgFault *vmPgFault)
             OsMarkPageDirty(fpage, region, 0, 0);
         }
         LOS_SpinUnlockRestore(&region->unTypeData.rf.file->f_mapping->list_lock, intSave);
+        OsFileCacheBalanceDirty(region->unTypeData.rf.file->f_mapping);
 
         return LOS_OK;
     }
@@ -339,6 +340,7 @@ status_t OsDoSharedFault(LosVmMapRegion *region, LosVmPgFault *vmPgFault)
         }
 
         (VOID)LOS_MuxRelease(&region->unTypeData.rf.file->f_mapping->mux_lock);
+        OsFileCacheBalanceDirty(region->unTypeData.rf.file->f_mapping);
         return LOS_OK;
     }
     (VOID)LOS_MuxRelease(&region->unTypeData.rf.file->f_mapping->mux_lock);
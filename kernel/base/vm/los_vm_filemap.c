@@ -40,6 +40,7 @@
 #include "los_vm_page.h"
 #include "los_vm_phys.h"
 #include "los_vm_common.h"
+#include "los_vm_dump.h"
 #include "los_vm_fault.h"
 #include "los_process_pri.h"
 #include "los_vm_lock.h"
@@ -52,6 +53,11 @@ extern "C" {
 
 #ifdef LOSCFG_KERNEL_VM
 
+#define FILE_DIRTY_RATIO        10  /* % of the pages dirty in files over which the sync tasks write them back */
+#define FILE_DIRTY_HARD_RATIO   20  /* % over which a task dirtying a page writes back the file itself */
+
+Atomic g_fileDirtyPages = 0;
+
 //ҳвҳ棬ҳƫpgoff
 STATIC VOID OsPageCacheAdd(LosFilePage *page, struct page_mapping *mapping, VM_OFFSET_T pgoff)
 {
@@ -398,6 +404,10 @@ VOID OsVmmFileRemove(LosVmMapRegion *region, LosArchMmu *archMmu, VM_OFFSET_T pg
 //ĳҳΪҳ
 VOID OsMarkPageDirty(LosFilePage *fpage, LosVmMapRegion *region, INT32 off, INT32 len)
 {
+    /* a mapping without a host file, such as a tmpfs file, holds the data itself */
+    if (fpage->mapping->host == NULL) {
+        return;
+    }
     if (region != NULL) {
 		//ҳں
         OsSetPageDirty(fpage->vmPage);
@@ -654,6 +664,120 @@ INT32 OsVmmFileFault(LosVmMapRegion *region, LosVmPgFault *vmf)
 }
 
 
+#define FILE_WB_CLUSTER 16 /* dirty pages written back by one file_write at most */
+
+/* the dirty pages from first on that continue one another in the file, one write can carry them */
+STATIC UINT32 OsDirtyRunLength(const LOS_DL_LIST *dirtyList, LosFilePage *first)
+{
+    LosFilePage *prev = first;
+    LosFilePage *next = NULL;
+    UINT32 n = 1;
+
+    while ((n < FILE_WB_CLUSTER) && (prev->node.pstNext != dirtyList)) {
+        next = LOS_DL_LIST_ENTRY(prev->node.pstNext, LosFilePage, node);
+        if ((next->pgoff != (prev->pgoff + 1)) || (next->dirtyOff != 0) ||
+            ((prev->dirtyEnd != 0) && (prev->dirtyEnd != PAGE_SIZE))) {
+            break;
+        }
+        prev = next;
+        n++;
+    }
+    return n;
+}
+
+/* Write back a run of n dirty pages gathered in one buffer, FALSE if the run was not written */
+STATIC BOOL OsFlushDirtyRun(LosFilePage *first, UINT32 n)
+{
+    struct file *file = first->mapping->host;
+    LosFilePage *fpage = first;
+    LosFilePage *last = NULL;
+    struct stat bufStat;
+    BOOL toEof = FALSE;
+    VM_OFFSET_T oldPos;
+    UINT32 begin;
+    UINT32 end;
+    INT32 ret;
+    char *buff = NULL;
+
+    if ((file == NULL) || (file->f_vnode == NULL)) {
+        return FALSE;
+    }
+    buff = (char *)LOS_MemAlloc(m_aucSysMem0, n << PAGE_SHIFT);
+    if (buff == NULL) {
+        return FALSE;
+    }
+
+    for (UINT32 i = 0; i < n; i++) {
+        (VOID)memcpy_s(buff + (i << PAGE_SHIFT), PAGE_SIZE, OsVmPageToVaddr(fpage->vmPage), PAGE_SIZE);
+        toEof = toEof || (fpage->dirtyEnd == 0);
+        last = fpage;
+        fpage = LOS_DL_LIST_ENTRY(fpage->node.pstNext, LosFilePage, node);
+    }
+
+    begin = ((UINT32)first->pgoff << PAGE_SHIFT) + first->dirtyOff;
+    end = ((UINT32)last->pgoff << PAGE_SHIFT) + ((last->dirtyEnd != 0) ? last->dirtyEnd : PAGE_SIZE);
+    if (toEof) {
+        /* pages dirtied through a mapping hold data up to the end of the file only */
+        if (stat(file->f_path, &bufStat) != OK) {
+            LOS_MemFree(m_aucSysMem0, buff);
+            return FALSE;
+        }
+        end = ((UINT32)bufStat.st_size < end) ? (UINT32)bufStat.st_size : end;
+    }
+
+    if (end > begin) {
+        oldPos = file_seek(file, 0, SEEK_CUR);
+        file_seek(file, begin, SEEK_SET);
+        ret = (INT32)file_write(file, buff + first->dirtyOff, end - begin);
+        if (ret <= 0) {
+            VM_ERR("WritePage error ret %d", ret);
+        }
+        (VOID)file_seek(file, oldPos, SEEK_SET);
+    }
+    LOS_MemFree(m_aucSysMem0, buff);
+    return TRUE;
+}
+
+/*
+ * Write back and free the dumped dirty pages of a mapping, in pgoff order. Runs of pages that
+ * continue one another go out as one write, the file system then sees one large request instead
+ * of a seek and a write per page.
+ */
+STATIC VOID OsFlushDirtyList(LOS_DL_LIST *dirtyList)
+{
+    LosFilePage *fpage = NULL;
+    LosFilePage *next = NULL;
+    BOOL written;
+    UINT32 n;
+
+    while (!LOS_ListEmpty(dirtyList)) {
+        fpage = LOS_DL_LIST_ENTRY(dirtyList->pstNext, LosFilePage, node);
+        n = OsDirtyRunLength(dirtyList, fpage);
+        written = (n > 1) && OsFlushDirtyRun(fpage, n);
+        while (n > 0) {
+            next = LOS_DL_LIST_ENTRY(fpage->node.pstNext, LosFilePage, node);
+            LOS_ListDelete(&fpage->node);
+            if (written) {
+                LOS_MemFree(m_aucSysMem0, fpage);
+            } else {
+                OsDoFlushDirtyPage(fpage);
+            }
+            fpage = next;
+            n--;
+        }
+    }
+}
+
+/* map the page read only wherever it is mapped, so the next write through a mapping dirties it again */
+STATIC VOID OsWriteProtectMaps(LosFilePage *fpage)
+{
+    LosMapInfo *info = NULL;
+
+    LOS_DL_LIST_FOR_EACH_ENTRY(info, &fpage->i_mmap, LosMapInfo, node) {
+        (VOID)LOS_ArchMmuChangeProt(info->archMmu, info->vaddr, 1, fpage->flags & ~VM_MAP_REGION_FLAG_PERM_WRITE);
+    }
+}
+
 //ļед
 VOID OsFileCacheFlush(struct page_mapping *mapping)
 {
@@ -675,19 +799,54 @@ VOID OsFileCacheFlush(struct page_mapping *mapping)
             ftemp = OsDumpDirtyPage(fpage);
             if (ftemp != NULL) {
                 LOS_ListTailInsert(&dirtyList, &ftemp->node);
+                OsWriteProtectMaps(fpage);
             }
         }
         LOS_SpinUnlockRestore(&fpage->physSeg->lruLock, lruLock);
     }
     LOS_SpinUnlockRestore(&mapping->list_lock, intSave);
 
-	//ҳ
-    LOS_DL_LIST_FOR_EACH_ENTRY_SAFE(fpage, ftemp, &dirtyList, LosFilePage, node) {
-    	//ҳд
-        OsDoFlushDirtyPage(fpage);
+    OsFlushDirtyList(&dirtyList); //write back the dirty pages, adjacent ones merged
+}
+
+/* the percentage of the pages that are dirty file pages */
+STATIC UINT32 OsFileDirtyRatio(VOID)
+{
+    UINT32 usedPages = 0;
+    UINT32 totalPages = 0;
+
+    OsVmPhysUsedInfoGet(&usedPages, &totalPages);
+    if (totalPages == 0) {
+        return 0;
     }
+    return ((UINT32)LOS_AtomicRead(&g_fileDirtyPages) * 100) / totalPages; /* 100: percentage */
 }
 
+/* TRUE once enough file pages are dirty for the background writeback to start on them */
+BOOL OsFileCacheOverDirty(VOID)
+{
+    return OsFileDirtyRatio() > FILE_DIRTY_RATIO;
+}
+
+/* TRUE once so many file pages are dirty that the tasks dirtying more write back themselves */
+BOOL OsFileCacheOverHardLimit(VOID)
+{
+    return OsFileDirtyRatio() > FILE_DIRTY_HARD_RATIO;
+}
+
+/*
+ * Called with no lock held by a task that just dirtied a page of mapping. Over the hard limit the
+ * task writes back the file itself, so writes through a shared mapping are paced by the disk.
+ */
+VOID OsFileCacheBalanceDirty(struct page_mapping *mapping)
+{
+    if ((mapping == NULL) || (mapping->host == NULL)) {
+        return;
+    }
+    if (OsFileCacheOverHardLimit()) {
+        OsFileCacheFlush(mapping);
+    }
+}
 
 //ļҳ
 VOID OsFileCacheRemove(struct page_mapping *mapping)
@@ -718,11 +877,7 @@ VOID OsFileCacheRemove(struct page_mapping *mapping)
     }
     LOS_SpinUnlockRestore(&mapping->list_lock, intSave);
 
-	//ҳ
-    LOS_DL_LIST_FOR_EACH_ENTRY_SAFE(fpage, fnext, &dirtyList, LosFilePage, node) {
-    	//ҳд
-        OsDoFlushDirtyPage(fpage);
-    }
+    OsFlushDirtyList(&dirtyList); //write back the dirty pages, adjacent ones merged
 }
 
 //ڴļ
@@ -791,6 +946,27 @@ LosFilePage *OsFindGetEntry(struct page_mapping *mapping, VM_OFFSET_T pgoff)
     return NULL;
 }
 
+/*
+ * Take a reference on the physical page caching pgoff of the file, if there is one. The page stays
+ * valid after it is dropped from the cache until the caller releases it with LOS_PhysPageFree.
+ */
+LosVmPage *OsPageCacheGetPinned(struct page_mapping *mapping, VM_OFFSET_T pgoff)
+{
+    UINT32 intSave;
+    LosFilePage *fpage = NULL;
+    LosVmPage *vmPage = NULL;
+
+    LOS_SpinLockSave(&mapping->list_lock, &intSave);
+    fpage = OsFindGetEntry(mapping, pgoff);
+    if (fpage != NULL) {
+        vmPage = fpage->vmPage;
+        LOS_AtomicInc(&vmPage->refCounts);
+    }
+    LOS_SpinUnlockRestore(&mapping->list_lock, intSave);
+
+    return vmPage;
+}
+
 /* need mutex & change memory to dma zone. */
 //ҳ
 LosFilePage *OsPageCacheAlloc(struct page_mapping *mapping, VM_OFFSET_T pgoff)
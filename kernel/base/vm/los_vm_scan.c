@@ -34,6 +34,9 @@
 
 #include "fs/file.h"
 #include "los_vm_filemap.h"
+#ifdef LOSCFG_FS_FAT_CACHE
+#include "bcache.h"
+#endif
 
 #ifdef LOSCFG_KERNEL_VM
 
@@ -381,6 +384,12 @@ int OsTryShrinkMemory(size_t nPage)
         OsDoFlushDirtyPage(fpage);  //ҳдļ
     }
 
+#ifdef LOSCFG_FS_FAT_CACHE
+    if (nReclaimed < nPage) {
+        nReclaimed += BcacheReclaim(nPage - nReclaimed);
+    }
+#endif
+
     return nReclaimed;
 }
 #else
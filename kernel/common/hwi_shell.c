@@ -72,7 +72,7 @@ LITE_OS_SEC_TEXT_MINOR UINT32 OsShellCmdHwi(INT32 argc, const CHAR **argv)
     for (i = OS_HWI_FORM_EXC_NUM; i < OS_HWI_MAX_NUM + OS_HWI_FORM_EXC_NUM; i++) {
         UINT32 count = OsGetHwiFormCnt(i);
         if (count) {
-            cycles = (((OsIrqCpupCB *)(&irqCpup[i]))->cpup.allTime * OS_NS_PER_CYCLE) / (count * OS_SYS_NS_PER_US);
+            cycles = (OsGetIrqCpupAllTime(i) * OS_NS_PER_CYCLE) / (count * OS_SYS_NS_PER_US);
         } else {
             cycles = 0;
         }
@@ -140,6 +140,34 @@ int LosBufPrintf(struct SeqBuf *seqBuf, const char *fmt, ...)
     return ret;
 }
 
+int LosBufWrite(struct SeqBuf *seqBuf, const void *data, size_t len)
+{
+    if ((seqBuf == NULL) || (data == NULL)) {
+        return -LOS_EPERM;
+    }
+
+    if (seqBuf->buf == NULL) {
+        seqBuf->size = SEQBUF_PAGE_SIZE;
+        seqBuf->buf = (char *)malloc(seqBuf->size);
+        if (seqBuf->buf == NULL) {
+            return -LOS_ENOMEM;
+        }
+        (void)memset_s(seqBuf->buf, seqBuf->size, 0, seqBuf->size);
+        seqBuf->count = 0;
+    }
+
+    while ((seqBuf->size - seqBuf->count) < len) {
+        if (ExpandSeqBuf(seqBuf, seqBuf->count) != 0) {
+            return -LOS_NOK;
+        }
+    }
+
+    (void)memcpy_s(seqBuf->buf + seqBuf->count, seqBuf->size - seqBuf->count, data, len);
+    seqBuf->count += len;
+
+    return 0;
+}
+
 int LosBufRelease(struct SeqBuf *seqBuf)
 {
     if (seqBuf == NULL) {
@@ -54,6 +54,7 @@ struct SeqBuf {
 struct SeqBuf *LosBufCreat(void);
 int LosBufPrintf(struct SeqBuf *seqBuf, const char *fmt, ...);
 int LosBufVprintf(struct SeqBuf *seqBuf, const char *fmt, va_list argList);
+int LosBufWrite(struct SeqBuf *seqBuf, const void *data, size_t len);
 int LosBufRelease(struct SeqBuf *seqBuf);
 
 #ifdef __cplusplus
@@ -51,6 +51,8 @@ VOID OsCmdCpupOperateOneParam(UINT32 mode)
         PRINTK("\nSysCpuUsage in 10s: ");
     } else if (mode == CPUP_LAST_ONE_SECONDS) {
         PRINTK("\nSysCpuUsage in 1s: ");
+    } else if (mode == CPUP_LAST_SIXTY_SECONDS) {
+        PRINTK("\nSysCpuUsage in 60s: ");
     } else {
         PRINTK("\nSysCpuUsage in all time: ");
     }
@@ -82,6 +84,7 @@ LITE_OS_SEC_TEXT STATIC VOID OsCpupCmdHelp(VOID)
     PRINTK("\r\nMode parameter description:\n"
            "  0       SysCpuUsage in 10s\n"
            "  1       SysCpuUsage in 1s\n"
+           "  2       SysCpuUsage in 60s\n"
            "  others  SysCpuUsage in all time\n");
 }
 
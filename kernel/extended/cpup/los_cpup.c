@@ -31,6 +31,7 @@
 
 #include "los_cpup_pri.h"
 #include "los_process_pri.h"
+#include "los_percpu_pri.h"
 #include "los_base.h"
 #include "los_swtmr.h"
 
@@ -53,7 +54,15 @@ LITE_OS_SEC_BSS STATIC UINT64 cpupStartCycles = 0;
 #ifdef LOSCFG_CPUP_INCLUDE_IRQ
 LITE_OS_SEC_BSS UINT64 timeInIrqSwitch[LOSCFG_KERNEL_CORE_NUM];
 LITE_OS_SEC_BSS STATIC UINT64 cpupIntTimeStart[LOSCFG_KERNEL_CORE_NUM];
+/* the 64-bit irq allTime counters can tear on 32-bit cores, guard every access */
+LITE_OS_SEC_BSS STATIC SPIN_LOCK_INIT(g_irqCpupSpin);
 #endif
+LITE_OS_SEC_BSS STATIC OsCpupPercpu g_cpupPercpu[LOSCFG_KERNEL_CORE_NUM];
+LITE_OS_SEC_BSS STATIC OsCpupStatSample g_cpupStatRecord[OS_CPUP_STAT_RECORD_NUM + 1];
+LITE_OS_SEC_BSS STATIC OsCpupStatSample g_cpupStatBase; /* accumulators at the last reset */
+LITE_OS_SEC_BSS STATIC UINT32 g_cpupStatPos = 0;        /* next sample to write */
+LITE_OS_SEC_BSS STATIC UINT32 g_cpupStatNum = 0;        /* valid samples in g_cpupStatRecord */
+LITE_OS_SEC_BSS STATIC volatile UINT32 g_cpupStatSeq = 0; /* guards the samples and the history positions */
 
 #define INVALID_ID ((UINT32)-1)
 
@@ -64,6 +73,9 @@ LITE_OS_SEC_BSS STATIC UINT64 cpupIntTimeStart[LOSCFG_KERNEL_CORE_NUM];
 #define CPUP_PRE_POS(pos) (((pos) == 0) ? (OS_CPUP_HISTORY_RECORD_NUM - 1) : ((pos) - 1))
 #define CPUP_POST_POS(pos) (((pos) == (OS_CPUP_HISTORY_RECORD_NUM - 1)) ? 0 : ((pos) + 1))
 
+#define CPUP_STAT_RECORD_SIZE (OS_CPUP_STAT_RECORD_NUM + 1)
+#define CPUP_STAT_POS(pos, back) (((pos) + CPUP_STAT_RECORD_SIZE - (back)) % CPUP_STAT_RECORD_SIZE)
+
 STATIC UINT64 OsGetCpuCycle(VOID)
 {
     UINT32 high;
@@ -85,6 +97,153 @@ STATIC UINT64 OsGetCpuCycle(VOID)
     return (cycles - cpupStartCycles);
 }
 
+/*
+ * The per-cpu accumulators and the one second samples are published through
+ * sequence counters. Every counter has a single writer which runs with the
+ * interrupt disabled, so the readers only have to retry instead of taking
+ * the scheduler lock.
+ */
+STATIC INLINE VOID OsCpupSeqWriteBegin(volatile UINT32 *seq)
+{
+    (*seq)++;
+    DMB;
+}
+
+STATIC INLINE VOID OsCpupSeqWriteEnd(volatile UINT32 *seq)
+{
+    DMB;
+    (*seq)++;
+}
+
+STATIC INLINE UINT32 OsCpupSeqReadBegin(const volatile UINT32 *seq)
+{
+    UINT32 start;
+
+    do {
+        start = *seq;
+    } while (start & 1);
+    DMB;
+
+    return start;
+}
+
+STATIC INLINE BOOL OsCpupSeqReadRetry(const volatile UINT32 *seq, UINT32 start)
+{
+    DMB;
+    return (*seq != start);
+}
+
+STATIC INLINE UINT16 OsCpupTaskStatType(UINT32 taskID)
+{
+    Percpu *percpu = OsPercpuGet();
+
+    if (taskID == percpu->idleTaskID) {
+        return OS_CPUP_STAT_IDLE;
+    } else if (taskID == percpu->swtmrTaskID) {
+        return OS_CPUP_STAT_SWTMR;
+    }
+    return OS_CPUP_STAT_TASK;
+}
+
+/* Charge the segment being accounted on the current core and start a new one of the given type. */
+STATIC INLINE VOID OsCpupPercpuSwitch(OsCpupPercpu *percpu, UINT64 cycle, UINT16 state)
+{
+    OsCpupSeqWriteBegin(&percpu->seq);
+    if (cycle > percpu->startTime) {
+        percpu->time[percpu->state] += cycle - percpu->startTime;
+    }
+    percpu->startTime = cycle;
+    percpu->state = state;
+    OsCpupSeqWriteEnd(&percpu->seq);
+}
+
+STATIC VOID OsCpupPercpuRead(UINT32 cpuid, UINT64 cycle, UINT64 *time)
+{
+    const OsCpupPercpu *percpu = &g_cpupPercpu[cpuid];
+    UINT64 startTime;
+    UINT32 start;
+    UINT16 state;
+    UINT32 loop;
+
+    do {
+        start = OsCpupSeqReadBegin(&percpu->seq);
+        for (loop = 0; loop < OS_CPUP_STAT_MAX; loop++) {
+            time[loop] = percpu->time[loop];
+        }
+        state = percpu->state;
+        startTime = percpu->startTime;
+    } while (OsCpupSeqReadRetry(&percpu->seq, start));
+
+    /* the segment still running on that core */
+    if (cycle > startTime) {
+        time[state] += cycle - startTime;
+    }
+}
+
+STATIC VOID OsCpupStatSampleGet(OsCpupStatSample *sample)
+{
+    UINT32 cpuid;
+
+    sample->cycle = OsGetCpuCycle();
+    for (cpuid = 0; cpuid < LOSCFG_KERNEL_CORE_NUM; cpuid++) {
+        OsCpupPercpuRead(cpuid, sample->cycle, sample->time[cpuid]);
+    }
+}
+
+STATIC UINT32 OsCpupStatWindowSeconds(UINT16 mode)
+{
+    switch (mode) {
+        case CPUP_LAST_ONE_SECONDS:
+            return 1;
+        case CPUP_LAST_TEN_SECONDS:
+            return 10; /* 10: ten seconds */
+        case CPUP_LAST_SIXTY_SECONDS:
+            return OS_CPUP_STAT_RECORD_NUM;
+        default:
+            return 0;
+    }
+}
+
+/*
+ * Get the two samples bounding the window of the mode. The windows end at the
+ * newest one second sample, the all time window and the windows that are not
+ * filled yet end now.
+ */
+STATIC VOID OsCpupStatWindowGet(UINT16 mode, OsCpupStatSample *begin, OsCpupStatSample *end)
+{
+    UINT32 window = OsCpupStatWindowSeconds(mode);
+    BOOL endNow = FALSE;
+    UINT32 start;
+
+    do {
+        start = OsCpupSeqReadBegin(&g_cpupStatSeq);
+        if ((window == 0) || (g_cpupStatNum <= window)) {
+            *begin = g_cpupStatBase;
+            endNow = TRUE;
+        } else {
+            *begin = g_cpupStatRecord[CPUP_STAT_POS(g_cpupStatPos, window + 1)];
+            *end = g_cpupStatRecord[CPUP_STAT_POS(g_cpupStatPos, 1)];
+            endNow = FALSE;
+        }
+    } while (OsCpupSeqReadRetry(&g_cpupStatSeq, start));
+
+    if (endNow) {
+        OsCpupStatSampleGet(end);
+    }
+}
+
+STATIC VOID OsCpupStatRecord(VOID)
+{
+    OsCpupStatSample sample;
+
+    OsCpupStatSampleGet(&sample);
+    g_cpupStatRecord[g_cpupStatPos] = sample;
+    g_cpupStatPos = (g_cpupStatPos + 1) % CPUP_STAT_RECORD_SIZE;
+    if (g_cpupStatNum < CPUP_STAT_RECORD_SIZE) {
+        g_cpupStatNum++;
+    }
+}
+
 LITE_OS_SEC_TEXT_INIT VOID OsCpupGuard(VOID)
 {
     UINT16 prevPos;
@@ -96,6 +255,8 @@ LITE_OS_SEC_TEXT_INIT VOID OsCpupGuard(VOID)
     LosProcessCB *processCB = NULL;
 
     SCHEDULER_LOCK(intSave);
+    OsCpupSeqWriteBegin(&g_cpupStatSeq);
+    OsCpupStatRecord();
 
     cycle = OsGetCpuCycle();
     prevPos = cpupHisPos;
@@ -103,9 +264,11 @@ LITE_OS_SEC_TEXT_INIT VOID OsCpupGuard(VOID)
     cpuHistoryTime[prevPos] = cycle;
 
 #ifdef LOSCFG_CPUP_INCLUDE_IRQ
+    LOS_SpinLock(&g_irqCpupSpin);
     for (loop = 0; loop < cpupMaxNum; loop++) {
         g_irqCpup[loop].cpup.historyTime[prevPos] = g_irqCpup[loop].cpup.allTime;
     }
+    LOS_SpinUnlock(&g_irqCpupSpin);
 #endif
 
     for (loop = 0; loop < g_processMaxNum; loop++) {
@@ -136,6 +299,7 @@ LITE_OS_SEC_TEXT_INIT VOID OsCpupGuard(VOID)
         processCB->processCpup.historyTime[prevPos] += cycleIncrement;
     }
 
+    OsCpupSeqWriteEnd(&g_cpupStatSeq);
     SCHEDULER_UNLOCK(intSave);
 }
 
@@ -171,6 +335,8 @@ LITE_OS_SEC_TEXT_INIT UINT32 OsCpupInit(VOID)
 
     for (loop = 0; loop < LOSCFG_KERNEL_CORE_NUM; loop++) {
         runningTasks[loop] = INVALID_ID;
+        g_cpupPercpu[loop].state = OS_CPUP_STAT_TASK;
+        g_cpupPercpu[loop].startTime = OsGetCpuCycle();
     }
     cpupInitFlg = 1;
     return LOS_OK;
@@ -200,9 +366,16 @@ LITE_OS_SEC_TEXT_INIT VOID LOS_CpupReset(VOID)
     (VOID)LOS_SwtmrStop(cpupSwtmrID);
     cycle = OsGetCpuCycle();
 
+    /* the guard may be running on another core, serialize the writers of the samples */
+    LOS_SpinLock(&g_taskSpin);
+    OsCpupSeqWriteBegin(&g_cpupStatSeq);
+    OsCpupStatSampleGet(&g_cpupStatBase);
+    g_cpupStatNum = 0;
     for (index = 0; index < (OS_CPUP_HISTORY_RECORD_NUM + 1); index++) {
         cpuHistoryTime[index] = cycle;
     }
+    OsCpupSeqWriteEnd(&g_cpupStatSeq);
+    LOS_SpinUnlock(&g_taskSpin);
 
     for (index = 0; index < g_processMaxNum; index++) {
         processCB = OS_PCB_FROM_PID(index);
@@ -216,9 +389,11 @@ LITE_OS_SEC_TEXT_INIT VOID LOS_CpupReset(VOID)
 
 #ifdef LOSCFG_CPUP_INCLUDE_IRQ
     if (g_irqCpup != NULL) {
+        LOS_SpinLock(&g_irqCpupSpin);
         for (index = 0; index < cpupMaxNum; index++) {
             OsResetCpup(&g_irqCpup[index].cpup, cycle);
         }
+        LOS_SpinUnlock(&g_irqCpupSpin);
 
         for (index = 0; index < LOSCFG_KERNEL_CORE_NUM; index++) {
             timeInIrqSwitch[index] = 0;
@@ -261,6 +436,7 @@ VOID OsCpupCycleEndStart(UINT32 runTaskID, UINT32 newTaskID)
 
     newTaskCpup->startTime = cpuCycle;
     runningTasks[cpuID] = newTaskID;
+    OsCpupPercpuSwitch(&g_cpupPercpu[cpuID], cpuCycle, OsCpupTaskStatType(newTaskID));
 }
 
 LITE_OS_SEC_TEXT_MINOR STATIC VOID OsCpupGetPos(UINT16 mode, UINT16 *curPosPointer, UINT16 *prePosPointer)
@@ -307,36 +483,65 @@ STATIC INLINE UINT32 OsCalculateCpupUsage(const OsCpupBase *cpup, UINT16 pos, UI
     return usage;
 }
 
-STATIC UINT32 OsHistorySysCpuUsageUnsafe(UINT16 mode)
+LITE_OS_SEC_TEXT_MINOR UINT32 LOS_HistorySysCpuUsage(UINT16 mode)
 {
+    OsCpupStatSample begin;
+    OsCpupStatSample end;
     UINT64 cpuAllCycle;
-    UINT16 pos;
-    UINT16 prePos;
-    UINT32 idleProcessID;
-    OsCpupBase *processCpup = NULL;
+    UINT64 idleCycle = 0;
+    UINT32 idleUsage = 0;
+    UINT32 cpuid;
 
     if (cpupInitFlg == 0) {
         return LOS_ERRNO_CPUP_NO_INIT;
     }
 
-    OsCpupGetPos(mode, &pos, &prePos);
-    cpuAllCycle = cpuHistoryTime[pos] - cpuHistoryTime[prePos];
+    /* read from the per-cpu accumulators, the scheduler lock is not needed */
+    OsCpupStatWindowGet(mode, &begin, &end);
+    cpuAllCycle = end.cycle - begin.cycle;
+    for (cpuid = 0; cpuid < LOSCFG_KERNEL_CORE_NUM; cpuid++) {
+        idleCycle += end.time[cpuid][OS_CPUP_STAT_IDLE] - begin.time[cpuid][OS_CPUP_STAT_IDLE];
+    }
 
-    idleProcessID = OsGetIdleProcessID();
-    processCpup = (OsCpupBase *)&(OS_PCB_FROM_PID(idleProcessID)->processCpup);
-    return (LOS_CPUP_PRECISION - OsCalculateCpupUsage(processCpup, pos, prePos, cpuAllCycle));
+    if (cpuAllCycle) {
+        idleUsage = (UINT32)((LOS_CPUP_SINGLE_CORE_PRECISION * idleCycle) / cpuAllCycle);
+    }
+    if (idleUsage > LOS_CPUP_PRECISION) {
+        idleUsage = LOS_CPUP_PRECISION;
+    }
+    return (LOS_CPUP_PRECISION - idleUsage);
 }
 
-LITE_OS_SEC_TEXT_MINOR UINT32 LOS_HistorySysCpuUsage(UINT16 mode)
+LITE_OS_SEC_TEXT_MINOR UINT32 LOS_GetCpuStat(UINT16 mode, CPUP_CPU_STAT_S *cpuStat, UINT32 len)
 {
-    UINT32 cpup;
-    UINT32 intSave;
+    OsCpupStatSample begin;
+    OsCpupStatSample end;
+    const UINT64 *beginTime = NULL;
+    const UINT64 *endTime = NULL;
+    UINT32 cpuid;
 
-    /* get end time of current process */
-    SCHEDULER_LOCK(intSave);
-    cpup = OsHistorySysCpuUsageUnsafe(mode);
-    SCHEDULER_UNLOCK(intSave);
-    return cpup;
+    if (cpupInitFlg == 0) {
+        return LOS_ERRNO_CPUP_NO_INIT;
+    }
+
+    if ((cpuStat == NULL) || (len < (sizeof(CPUP_CPU_STAT_S) * LOSCFG_KERNEL_CORE_NUM))) {
+        return LOS_ERRNO_CPUP_PTR_ERR;
+    }
+
+    OsCpupStatWindowGet(mode, &begin, &end);
+    for (cpuid = 0; cpuid < LOSCFG_KERNEL_CORE_NUM; cpuid++) {
+        beginTime = begin.time[cpuid];
+        endTime = end.time[cpuid];
+        cpuStat[cpuid].cpuid = cpuid;
+        cpuStat[cpuid].mode = mode;
+        cpuStat[cpuid].allTime = end.cycle - begin.cycle;
+        cpuStat[cpuid].taskTime = endTime[OS_CPUP_STAT_TASK] - beginTime[OS_CPUP_STAT_TASK];
+        cpuStat[cpuid].idleTime = endTime[OS_CPUP_STAT_IDLE] - beginTime[OS_CPUP_STAT_IDLE];
+        cpuStat[cpuid].swtmrTime = endTime[OS_CPUP_STAT_SWTMR] - beginTime[OS_CPUP_STAT_SWTMR];
+        cpuStat[cpuid].irqTime = endTime[OS_CPUP_STAT_IRQ] - beginTime[OS_CPUP_STAT_IRQ];
+    }
+
+    return LOS_OK;
 }
 
 STATIC UINT32 OsHistoryProcessCpuUsageUnsafe(UINT32 pid, UINT16 mode)
@@ -505,28 +710,36 @@ LITE_OS_SEC_TEXT_MINOR UINT32 OsGetAllProcessAndTaskCpuUsageUnsafe(UINT16 mode,
 #ifdef LOSCFG_CPUP_INCLUDE_IRQ
 LITE_OS_SEC_TEXT_MINOR VOID OsCpupIrqStart(VOID)
 {
-    UINT32 high;
-    UINT32 low;
+    UINT32 cpuID = ArchCurrCpuid();
+    OsCpupPercpu *percpu = &g_cpupPercpu[cpuID];
 
-    LOS_GetCpuCycle(&high, &low);
-    cpupIntTimeStart[ArchCurrCpuid()] = ((UINT64)high << HIGH_BITS) + low;
+    cpupIntTimeStart[cpuID] = OsGetCpuCycle();
+    if (cpupInitFlg == 0) {
+        return;
+    }
+
+    percpu->irqPrevState = percpu->state;
+    OsCpupPercpuSwitch(percpu, cpupIntTimeStart[cpuID], OS_CPUP_STAT_IRQ);
     return;
 }
 
 LITE_OS_SEC_TEXT_MINOR VOID OsCpupIrqEnd(UINT32 intNum)
 {
-    UINT32 high;
-    UINT32 low;
     UINT64 intTimeEnd;
     UINT32 cpuID = ArchCurrCpuid();
+    OsCpupPercpu *percpu = &g_cpupPercpu[cpuID];
 
-    LOS_GetCpuCycle(&high, &low);
-    intTimeEnd = ((UINT64)high << HIGH_BITS) + low;
+    intTimeEnd = OsGetCpuCycle();
+    if ((cpupInitFlg != 0) && (percpu->state == OS_CPUP_STAT_IRQ)) {
+        OsCpupPercpuSwitch(percpu, intTimeEnd, percpu->irqPrevState);
+    }
 
     g_irqCpup[intNum].id = intNum;
     g_irqCpup[intNum].status = OS_CPUP_USED;
     timeInIrqSwitch[cpuID] += (intTimeEnd - cpupIntTimeStart[cpuID]);
+    LOS_SpinLock(&g_irqCpupSpin);
     g_irqCpup[intNum].cpup.allTime += (intTimeEnd - cpupIntTimeStart[cpuID]);
+    LOS_SpinUnlock(&g_irqCpupSpin);
 
     return;
 }
@@ -536,6 +749,21 @@ LITE_OS_SEC_TEXT_MINOR OsIrqCpupCB *OsGetIrqCpupArrayBase(VOID)
     return g_irqCpup;
 }
 
+LITE_OS_SEC_TEXT_MINOR UINT64 OsGetIrqCpupAllTime(UINT32 intNum)
+{
+    UINT64 allTime;
+    UINT32 intSave;
+
+    if ((g_irqCpup == NULL) || (intNum >= cpupMaxNum)) {
+        return 0;
+    }
+
+    LOS_SpinLockSave(&g_irqCpupSpin, &intSave);
+    allTime = g_irqCpup[intNum].cpup.allTime;
+    LOS_SpinUnlockRestore(&g_irqCpupSpin, intSave);
+    return allTime;
+}
+
 LITE_OS_SEC_TEXT_MINOR UINT32 OsGetAllIrqCpuUsageUnsafe(UINT16 mode, CPUP_INFO_S *cpupInfo, UINT32 len)
 {
     UINT16 pos, prePos;
@@ -565,12 +793,14 @@ LITE_OS_SEC_TEXT_MINOR UINT32 OsGetAllIrqCpuUsageUnsafe(UINT16 mode, CPUP_INFO_S
 
 LITE_OS_SEC_TEXT_MINOR UINT32 LOS_GetAllIrqCpuUsage(UINT16 mode, CPUP_INFO_S *cpupInfo, UINT32 len)
 {
-    UINT32 intSave;
+    UINT32 start;
     UINT32 ret;
 
-    SCHEDULER_LOCK(intSave);
-    ret = OsGetAllIrqCpuUsageUnsafe(mode, cpupInfo, len);
-    SCHEDULER_UNLOCK(intSave);
+    /* irq history is only written by the guard, retry instead of taking the scheduler lock */
+    do {
+        start = OsCpupSeqReadBegin(&g_cpupStatSeq);
+        ret = OsGetAllIrqCpuUsageUnsafe(mode, cpupInfo, len);
+    } while (OsCpupSeqReadRetry(&g_cpupStatSeq, start));
     return ret;
 }
 #endif
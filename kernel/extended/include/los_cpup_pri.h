@@ -52,6 +52,38 @@ typedef struct {
     UINT64 historyTime[OS_CPUP_HISTORY_RECORD_NUM + 1]; /**< Historical running time, the last one saves zero */
 } OsCpupBase;
 
+/**
+* @ingroup los_cpup
+* Number of one second samples kept for the per-cpu statistics windows
+*/
+#define OS_CPUP_STAT_RECORD_NUM      60
+
+enum {
+    OS_CPUP_STAT_TASK = 0,   /**< Tasks other than the idle and swtmr tasks */
+    OS_CPUP_STAT_IDLE,       /**< Idle task */
+    OS_CPUP_STAT_SWTMR,      /**< Software timer task */
+    OS_CPUP_STAT_IRQ,        /**< Hardware interrupts */
+    OS_CPUP_STAT_MAX
+};
+
+/**
+ * @ingroup los_cpup
+ * Per-cpu time accumulators. They are written only by the owning core and
+ * read by the others through the sequence counter.
+ */
+typedef struct {
+    volatile UINT32 seq;             /**< Odd while the owning core is updating the accumulators */
+    UINT16 state;                    /**< Type of the segment being charged */
+    UINT16 irqPrevState;             /**< Type to restore when the interrupt returns */
+    UINT64 startTime;                /**< Start cycle of the segment being charged */
+    UINT64 time[OS_CPUP_STAT_MAX];   /**< Accumulated cycles of every type */
+} OsCpupPercpu;
+
+typedef struct {
+    UINT64 cycle;                                         /**< Cycle when the sample is taken */
+    UINT64 time[LOSCFG_KERNEL_CORE_NUM][OS_CPUP_STAT_MAX]; /**< Per-cpu accumulators at that cycle */
+} OsCpupStatSample;
+
 /**
  * @ingroup los_cpup
  * Count the CPU usage structures of a task.
@@ -73,6 +105,7 @@ extern UINT32 OsGetAllIrqCpuUsageUnsafe(UINT16 mode, CPUP_INFO_S *cpupInfo, UINT
 extern VOID OsCpupIrqStart(VOID);
 extern VOID OsCpupIrqEnd(UINT32);
 extern OsIrqCpupCB *OsGetIrqCpupArrayBase(VOID);
+extern UINT64 OsGetIrqCpupAllTime(UINT32 intNum);
 #endif
 
 #ifdef __cplusplus
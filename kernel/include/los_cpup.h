@@ -131,9 +131,24 @@ typedef struct tagCpupInfo {
 enum {
     CPUP_LAST_TEN_SECONDS = 0, /**< Display CPU usage in the last ten seconds. */
     CPUP_LAST_ONE_SECONDS = 1, /**< Display CPU usage in the last one seconds. */
+    CPUP_LAST_SIXTY_SECONDS = 2, /**< Display CPU usage in the last sixty seconds, per-cpu statistics only. */
     CPUP_ALL_TIME = 0xffff     /**< Display CPU usage from system startup to now. */
 };
 
+/**
+ * @ingroup los_cpup
+ * Per-cpu time statistics of one window. All times are in cycles.
+ */
+typedef struct tagCpupCpuStat {
+    UINT32 cpuid;      /**< Core the record belongs to */
+    UINT32 mode;       /**< Window of the record, CPUP_LAST_ONE_SECONDS and so on */
+    UINT64 allTime;    /**< Cycles elapsed in the window */
+    UINT64 taskTime;   /**< Cycles spent in tasks other than the idle and swtmr tasks */
+    UINT64 idleTime;   /**< Cycles spent in the idle task */
+    UINT64 swtmrTime;  /**< Cycles spent in the software timer task */
+    UINT64 irqTime;    /**< Cycles spent in hardware interrupts */
+} CPUP_CPU_STAT_S;
+
 /**
  * @ingroup los_cpup
  * @brief Obtain the historical CPU usage.
@@ -147,7 +162,8 @@ enum {
  * </ul>
  *
  * @param  mode     [IN] UINT16. process mode. The parameter value 0 indicates that the CPU usage within 10s will be
- *                               obtained, and the parameter value 1 indicates that the CPU usage in the former 1s will
+ *                               obtained, the parameter value 1 indicates that the CPU usage in the former 1s will
+ *                               be obtained, and the parameter value 2 indicates that the CPU usage within 60s will
  *                               be obtained. Other values indicate that the CPU usage in all time will be obtained.
  *
  * @retval #LOS_ERRNO_CPUP_NO_INIT           The CPU usage is not initialized.
@@ -159,6 +175,36 @@ enum {
  */
 extern UINT32 LOS_HistorySysCpuUsage(UINT16 mode);
 
+/**
+ * @ingroup los_cpup
+ * @brief Obtain the per-cpu time statistics.
+ *
+ * @par Description:
+ * This API is used to obtain the task, idle, swtmr and irq time of every core within a window.
+ * @attention
+ * <ul>
+ * <li>This API can be called only after the CPU usage is initialized. Otherwise, the CPU usage fails to be
+ * obtained.</li>
+ * <li>The statistics are read without the scheduler lock, so the API is cheap enough for periodic polling.</li>
+ * <li>The input parameter pointer should point to the structure array whose size be greater than
+ * (LOSCFG_KERNEL_CORE_NUM * sizeof (CPUP_CPU_STAT_S)).</li>
+ * </ul>
+ *
+ * @param mode       [IN] UINT16. Time mode. CPUP_LAST_ONE_SECONDS, CPUP_LAST_TEN_SECONDS and
+ *                                CPUP_LAST_SIXTY_SECONDS select a window, other values indicate all time.
+ * @param cpuStat    [OUT]Type.   CPUP_CPU_STAT_S* Pointer to the per-cpu statistics array to be obtained.
+ * @param len        [IN] UINT32. The size of the array in bytes.
+ *
+ * @retval #LOS_ERRNO_CPUP_NO_INIT                  The CPU usage is not initialized.
+ * @retval #LOS_ERRNO_CPUP_PTR_ERR                  The input parameter pointer is NULL or
+ *                                                  len less than LOSCFG_KERNEL_CORE_NUM * sizeof (CPUP_CPU_STAT_S).
+ * @retval #LOS_OK                                  The statistics of all cores are successfully obtained.
+ * @par Dependency:
+ * <ul><li>los_cpup.h: the header file that contains the API declaration.</li></ul>
+ * @see
+ */
+extern UINT32 LOS_GetCpuStat(UINT16 mode, CPUP_CPU_STAT_S *cpuStat, UINT32 len);
+
 /**
  * @ingroup los_cpup
  * @brief  Obtain the historical CPU usage of a specified process.
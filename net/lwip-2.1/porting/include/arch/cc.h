@@ -56,8 +56,14 @@
 #define LWIP_ERRNO_STDINCLUDE
 #define LWIP_SOCKET_STDINCLUDE
 
+/* Provide NEON routines, checksum and fused copy+checksum, when the FPU has them */
+#if defined(LOSCFG_ARCH_FPU_VFP_NEON)
+#define LWIP_CHKSUM             lwip_neon_chksum
+#define LWIP_CHKSUM_COPY(dst, src, len) lwip_neon_chksum_copy(dst, src, len)
+u16_t lwip_neon_chksum(const void *dataptr, int len);
+u16_t lwip_neon_chksum_copy(void *dst, const void *src, u16_t len);
 /* Provide Thumb-2 routines for GCC to improve performance */
-#if defined(TOOLCHAIN_GCC) && defined(__thumb2__)
+#elif defined(TOOLCHAIN_GCC) && defined(__thumb2__)
 #define LWIP_CHKSUM             thumb2_checksum
 u16_t thumb2_checksum(void* pData, int length);
 #else
@@ -70,6 +70,13 @@ typedef void *sys_prot_t;
 typedef uint32_t sys_thread_t;
 
 
+/**
+ * Core lock, see LOCK_TCPIP_CORE in lwipopts.h
+ */
+int sys_tcpip_core_locked(void);
+void driverif_tx_flush_all(void);
+
+
 #ifdef __cplusplus
 }
 #endif
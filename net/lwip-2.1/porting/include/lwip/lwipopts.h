@@ -106,6 +106,7 @@
 #define LWIP_COMPAT_SOCKETS             2
 #define LWIP_POSIX_SOCKETS_IO_NAMES     0
 #define LWIP_TCP_KEEPALIVE              1
+#define LWIP_TCP_PCB_NUM_EXT_ARGS       1 // generation tag of zero-copy sends, see socks_zc_send
 #define RECV_BUFSIZE_DEFAULT            65535
 #define SO_REUSE_RXTOALL                1
 
@@ -163,6 +164,18 @@
 #define TCPIP_MBOX_SIZE                 512
 #define TCPIP_THREAD_PRIO               5
 #define TCPIP_THREAD_STACKSIZE          0x6000
+#define LWIP_TCPIP_CORE_LOCKING         1 // socket calls run in the caller's context under the core lock
+#ifdef LOSCFG_KERNEL_SMP
+#define LWIP_NUM_INPUT_THREADS          LOSCFG_KERNEL_SMP_CORE_NUM // driver input workers, see sys_netif_input
+#else
+#define LWIP_NUM_INPUT_THREADS          1
+#endif
+#define LWIP_INPUT_BACKLOG              (TCPIP_MBOX_SIZE / LWIP_NUM_INPUT_THREADS) // packets queued per worker
+#define LWIP_INPUT_BUDGET               64 // packets per worker round, and per drv_poll call
+#define LWIP_GRO                        1 // merge in-order TCP segments of a worker round, see driverif_gro_receive
+#define LWIP_GRO_MAX_FLOWS              8 // flows merged at the same time per round
+#define LOCK_TCPIP_CORE()               sys_mutex_lock(&lock_tcpip_core)
+#define UNLOCK_TCPIP_CORE()             do { driverif_tx_flush_all(); sys_mutex_unlock(&lock_tcpip_core); } while (0)
 #define TCP_MAXRTX                      64
 #define TCP_MSS                         1400
 #define TCP_SND_BUF                     65535
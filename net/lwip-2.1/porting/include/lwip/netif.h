@@ -41,8 +41,19 @@
 #define LWIP_NETIF_CLIENT_DATA_INDEX_DHCP   LWIP_NETIF_CLIENT_DATA_INDEX_DHCP, \
                                             LWIP_NETIF_CLIENT_DATA_INDEX_DHCPS
 #endif
+/* Output queued per interface under the core lock, handed to the driver when the lock is released */
+#define DRIVERIF_TX_BATCH   16
+
 #define linkoutput      linkoutput; \
                         void (*drv_send)(struct netif *netif, struct pbuf *p); \
+                        void (*drv_send_batch)(struct netif *netif, struct pbuf **pkts, u32_t count); \
+                        u32_t (*drv_poll)(struct netif *netif, u32_t budget); \
+                        struct netif *napi_next; \
+                        u32_t napi_state; \
+                        struct netif *tx_next; \
+                        u16_t tx_count; \
+                        u16_t tx_pending; \
+                        struct pbuf *tx_batch[DRIVERIF_TX_BATCH]; \
                         u8_t (*drv_set_hwaddr)(struct netif *netif, u8_t *addr, u8_t len); \
                         void (*drv_config)(struct netif *netif, u32_t config_flags, u8_t setBit); \
                         char full_name[IFNAMSIZ]; \
@@ -69,10 +80,18 @@ extern "C" {
 
 err_t driverif_init(struct netif *netif);
 void driverif_input(struct netif *netif, struct pbuf *p);
+u32_t driverif_input_batch(struct netif *netif, struct pbuf **pkts, u32_t count);
+void driverif_rx_schedule(struct netif *netif);
+u32_t driverif_gro_receive(struct pbuf **pkts, u32_t count);
+
+/* netif->input for drivers, spreads packets over the per-core input threads by flow */
+err_t sys_netif_input(struct pbuf *p, struct netif *inp);
+u32_t sys_netif_input_batch(struct netif *inp, struct pbuf **pkts, u32_t count);
+void sys_netif_poll_schedule(struct netif *netif);
 
 #ifndef __LWIP__
 #define PF_PKT_SUPPORT              LWIP_NETIF_PROMISC
-#define netif_add(a, b, c, d)       netif_add(a, b, c, d, (a)->state, driverif_init, tcpip_input)
+#define netif_add(a, b, c, d)       netif_add(a, b, c, d, (a)->state, driverif_init, sys_netif_input)
 #else /* __LWIP__ */
 #define netif_get_name(netif)       ((netif)->full_name)
 #endif /* __LWIP__ */
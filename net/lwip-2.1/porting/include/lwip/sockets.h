@@ -77,11 +77,53 @@ extern "C" {
 int closesocket(int sockfd);
 #endif /* __LWIP__ */
 
+struct EpollWatch;
+
 int socks_poll(int sockfd, poll_table *wait);
+struct EpollWatch *socks_epoll_watch(int sockfd);
 int socks_ioctl(int sockfd, long cmd, void *argp);
 int socks_close(int sockfd);
 void socks_refer(int sockfd);
 
+struct tcp_pcb;
+
+/*
+ * Zero-copy TCP send. socks_zc_send() queues up to size bytes by reference and returns how many
+ * were taken, 0 when the send buffer is full, or a negative errno (-EOPNOTSUPP for sockets that
+ * are not blocking TCP streams). The data must stay untouched until socks_zc_pending() returns 0
+ * for the ref filled in by the send; both arm a POLLOUT wakeup before reporting that the caller
+ * has to wait.
+ */
+struct socks_zc_ref {
+    struct tcp_pcb *pcb;
+    u32_t gen;          /* tag left on the pcb, a recycled pcb does not carry it */
+    u32_t endseq;
+};
+
+ssize_t socks_zc_send(int sockfd, const void *data, size_t size, struct socks_zc_ref *ref);
+int socks_zc_pending(int sockfd, const struct socks_zc_ref *ref);
+
+struct tpacket_req;
+
+/*
+ * mmap'd frame rings for UDP sockets (fs_pktring.h): socks_ring_setsockopt() sets up an rx or tx
+ * ring, mmap() of the socket maps socks_ring_fd(), and send(NULL) on a socket with a tx ring
+ * calls socks_ring_send(). All return a negative errno on failure.
+ */
+int socks_ring_setsockopt(int sockfd, int optname, const struct tpacket_req *req);
+int socks_ring_fd(int sockfd);
+int socks_ring_tx_active(int sockfd);
+ssize_t socks_ring_send(int sockfd);
+
+struct mmsghdr;
+
+/*
+ * Batched sendmsg/recvmsg over kernel buffers, see SysSendMMsg/SysRecvMMsg. deadline is a
+ * sys_now() value or NULL. Both return the messages done, or a negative errno.
+ */
+int socks_sendmmsg(int sockfd, struct mmsghdr *msgvec, unsigned int vlen, int flags);
+int socks_recvmmsg(int sockfd, struct mmsghdr *msgvec, unsigned int vlen, int flags, const u32_t *deadline);
+
 #ifdef __cplusplus
 }
 #endif
@@ -50,6 +50,9 @@
 #define LWIP_NETIF_IFINDEX_MAX_EX 255
 #endif
 
+/* interfaces with output queued in tx_batch, protected by the tcpip core lock */
+static struct netif *g_txPending = NULL;
+
 LWIP_STATIC void
 driverif_init_ifname(struct netif *netif)
 {
@@ -92,6 +95,59 @@ driverif_init_ifname(struct netif *netif)
  *       dropped because of memory failure (except for the TCP timers).
  */
 
+LWIP_STATIC void
+driverif_tx_flush(struct netif *netif)
+{
+    u16_t count = netif->tx_count;
+    u16_t i;
+
+    if (count == 0) {
+        return;
+    }
+    netif->tx_count = 0;
+
+#if ETH_PAD_SIZE
+    for (i = 0; i < count; i++) {
+        (void)pbuf_header(netif->tx_batch[i], -ETH_PAD_SIZE); /* drop the padding word */
+    }
+#endif
+
+    if (netif->drv_send_batch != NULL) {
+        netif->drv_send_batch(netif, netif->tx_batch, count);
+    } else {
+        for (i = 0; i < count; i++) {
+            netif->drv_send(netif, netif->tx_batch[i]);
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+#if ETH_PAD_SIZE
+        (void)pbuf_header(netif->tx_batch[i], ETH_PAD_SIZE); /* reclaim the padding word */
+#endif
+        (void)pbuf_free(netif->tx_batch[i]);
+        netif->tx_batch[i] = NULL;
+    }
+}
+
+/*
+ * Hand all queued output to the drivers. Called by UNLOCK_TCPIP_CORE, so whatever the stack
+ * sent while it held the core lock (a burst of ACKs for one input batch, a whole socket write)
+ * reaches each driver as one batch.
+ */
+void
+driverif_tx_flush_all(void)
+{
+    struct netif *netif = NULL;
+
+    while (g_txPending != NULL) {
+        netif = g_txPending;
+        g_txPending = netif->tx_next;
+        netif->tx_next = NULL;
+        netif->tx_pending = 0;
+        driverif_tx_flush(netif);
+    }
+}
+
 LWIP_STATIC err_t
 driverif_output(struct netif *netif, struct pbuf *p)
 {
@@ -106,15 +162,29 @@ driverif_output(struct netif *netif, struct pbuf *p)
   }
 #endif
 
+    if (sys_tcpip_core_locked()) {
+        /* the reference keeps TCP from rewriting a queued segment for a retransmission */
+        pbuf_ref(p);
+        netif->tx_batch[netif->tx_count++] = p;
+        if (!netif->tx_pending) {
+            netif->tx_pending = 1;
+            netif->tx_next = g_txPending;
+            g_txPending = netif;
+        }
+        if (netif->tx_count == DRIVERIF_TX_BATCH) {
+            driverif_tx_flush(netif);
+        }
+    } else {
 #if ETH_PAD_SIZE
-    (void)pbuf_header(p, -ETH_PAD_SIZE); /* drop the padding word */
+        (void)pbuf_header(p, -ETH_PAD_SIZE); /* drop the padding word */
 #endif
 
-    netif->drv_send(netif, p);
+        netif->drv_send(netif, p);
 
 #if ETH_PAD_SIZE
-    (void)pbuf_header(p, ETH_PAD_SIZE); /* reclaim the padding word */
+        (void)pbuf_header(p, ETH_PAD_SIZE); /* reclaim the padding word */
 #endif
+    }
     MIB2_STATS_NETIF_ADD(netif, ifoutoctets, p->tot_len);
     LINK_STATS_INC(link.xmit);
 
@@ -227,6 +297,93 @@ driverif_input(struct netif *netif, struct pbuf *p)
     LWIP_DEBUGF(DRIVERIF_DEBUG, ("driverif_input : received packet is processed\n"));
 }
 
+/*
+ * Batched form of driverif_input for drivers that reap several packets per interrupt or per
+ * drv_poll call. The packets are handed to the input workers with one lock round trip per
+ * worker instead of one mailbox post per packet. Like driverif_input, it takes ownership of
+ * every pbuf; the return value is the number of packets the stack accepted, the others have
+ * been dropped and counted.
+ *
+ * @param netif the lwip network interface structure for this driverif
+ * @param pkts packets in pbuf structure format, the array itself is used as scratch space
+ * @param count number of packets in pkts
+ */
+u32_t
+driverif_input_batch(struct netif *netif, struct pbuf **pkts, u32_t count)
+{
+    u32_t accepted;
+    u32_t n = 0;
+    u32_t i;
+#if !PF_PKT_SUPPORT
+    u16_t ethhdr_type;
+#endif
+
+    LWIP_ERROR("driverif_input_batch : invalid arguments", ((netif != NULL) && (pkts != NULL)), return 0);
+
+    /* drop what driverif_input would drop and compact the rest */
+    for (i = 0; i < count; i++) {
+        MIB2_STATS_NETIF_ADD(netif, ifinoctets, pkts[i]->tot_len);
+        if (pkts[i]->len < SIZEOF_ETH_HDR) {
+            (void)pbuf_free(pkts[i]);
+            LINK_STATS_INC(link.drop);
+            LINK_STATS_INC(link.link_rx_drop);
+            continue;
+        }
+#if !PF_PKT_SUPPORT
+        ethhdr_type = ntohs(((struct eth_hdr *)pkts[i]->payload)->type);
+        if ((ethhdr_type != ETHTYPE_IP) && (ethhdr_type != ETHTYPE_IPV6) && (ethhdr_type != ETHTYPE_ARP)
+#if ETHARP_SUPPORT_VLAN
+            && (ethhdr_type != ETHTYPE_VLAN)
+#endif
+            ) {
+            (void)pbuf_free(pkts[i]);
+            LINK_STATS_INC(link.drop);
+            LINK_STATS_INC(link.link_rx_drop);
+            continue;
+        }
+#endif
+        pkts[n++] = pkts[i];
+    }
+
+    if (netif->input == sys_netif_input) {
+        accepted = sys_netif_input_batch(netif, pkts, n);
+    } else {
+        for (i = 0, accepted = 0; i < n; i++) {
+            if ((netif->input != NULL) && (netif->input(pkts[i], netif) == ERR_OK)) {
+                accepted++;
+            } else {
+                (void)pbuf_free(pkts[i]);
+            }
+        }
+    }
+
+    for (i = 0; i < n; i++) {
+        if (i < accepted) {
+            LINK_STATS_INC(link.recv);
+        } else {
+            LINK_STATS_INC(link.drop);
+            LINK_STATS_INC(link.link_rx_overrun);
+        }
+    }
+    return accepted;
+}
+
+/*
+ * Switch the interface to polling: called by the driver, typically from its receive interrupt
+ * after masking it. The input worker that owns the interface then calls netif->drv_poll with a
+ * budget until it returns less than the budget; the driver unmasks its interrupt before doing
+ * so. drv_poll delivers packets with driverif_input or driverif_input_batch.
+ *
+ * @param netif the lwip network interface structure for this driverif
+ */
+void
+driverif_rx_schedule(struct netif *netif)
+{
+    LWIP_ERROR("driverif_rx_schedule : invalid arguments", ((netif != NULL) && (netif->drv_poll != NULL)), return);
+
+    sys_netif_poll_schedule(netif);
+}
+
 /*
  * Should be called at the beginning of the program to set up the
  * network interface. It calls the function low_level_init() to do the
@@ -275,6 +432,11 @@ driverif_init(struct netif *netif)
 
     netif->output = etharp_output;
     netif->linkoutput = driverif_output;
+    netif->tx_next = NULL;
+    netif->tx_count = 0;
+    netif->tx_pending = 0;
+    netif->napi_next = NULL;
+    netif->napi_state = 0;
 
     /* init the netif's full name */
     driverif_init_ifname(netif);
@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <lwip/sys.h>
+#include <lwip/netif.h>
+#include <lwip/pbuf.h>
+#include <lwip/inet_chksum.h>
+#include <lwip/prot/ethernet.h>
+#include <lwip/prot/ip4.h>
+#include <lwip/prot/tcp.h>
+#include <string.h>
+
+#if LWIP_GRO
+/*
+ * Generic receive offload for IPv4 TCP.
+ *
+ * GRO runs over each batch an input worker takes from its backlog: in-order segments of one
+ * flow are chained onto the first segment of the flow, whose headers are then rewritten, so
+ * tcp_input sees one large segment. The merged checksum is derived from the checksums the
+ * sender put in each header, the payload is never read again.
+ */
+
+/* the merged frame, link header included, must still fit the u16_t pbuf tot_len */
+#define GRO_IP_LEN_MAX      (0xffff - SIZEOF_ETH_HDR)
+
+static u16_t offload_fold(u32_t sum)
+{
+    sum = (sum & 0xffff) + (sum >> 16);
+    sum = (sum & 0xffff) + (sum >> 16);
+    return (u16_t)sum;
+}
+
+/* one's complement sum of the TCP pseudo header, in the same byte order as the checksum field */
+static u32_t offload_pseudo_sum(const struct ip_hdr *iph, u16_t tcplen)
+{
+    u32_t src = iph->src.addr;
+    u32_t dst = iph->dest.addr;
+
+    return (src & 0xffff) + (src >> 16) + (dst & 0xffff) + (dst >> 16) +
+           PP_HTONS(IP_PROTO_TCP) + lwip_htons(tcplen);
+}
+
+/* one's complement sum of the header bytes themselves */
+static u16_t offload_sum(const void *data, u16_t len)
+{
+    return (u16_t)~inet_chksum(data, len);
+}
+
+typedef struct {
+    struct pbuf *p;         /* first segment of the flow, carries the headers */
+    struct ip_hdr *iph;
+    struct tcp_hdr *tcph;
+    u32_t nextSeq;          /* sequence number the next segment has to start at */
+    u32_t dsum;             /* one's complement sum of the payload merged so far */
+    u32_t dlen;             /* payload bytes merged so far */
+    u16_t segs;
+    u8_t flags;             /* TCP_PSH seen on a merged segment */
+} gro_flow_t;
+
+/*
+ * Returns the TCP header of p if it is an unfragmented IPv4 TCP segment for this host with all
+ * headers in the first pbuf and no link layer padding, NULL for anything GRO leaves alone.
+ */
+static struct tcp_hdr *gro_parse(struct pbuf *p, struct netif *netif, struct ip_hdr **iphp, u32_t *dlen)
+{
+    struct eth_hdr *ethhdr = (struct eth_hdr *)p->payload;
+    struct ip_hdr *iph = NULL;
+    struct tcp_hdr *tcph = NULL;
+    u16_t iplen;
+    u16_t hlen;
+
+    if ((netif == NULL) || !(netif->flags & NETIF_FLAG_ETHERNET) ||
+        (p->len < SIZEOF_ETH_HDR + IP_HLEN + TCP_HLEN) || (ethhdr->type != PP_HTONS(ETHTYPE_IP))) {
+        return NULL;
+    }
+    iph = (struct ip_hdr *)((u8_t *)p->payload + SIZEOF_ETH_HDR);
+    if ((IPH_V(iph) != 4) || (IPH_HL_BYTES(iph) != IP_HLEN) || (IPH_PROTO(iph) != IP_PROTO_TCP) ||
+        ((IPH_OFFSET(iph) & PP_HTONS(IP_MF | IP_OFFMASK)) != 0) ||
+        !ip4_addr_cmp(&iph->dest, netif_ip4_addr(netif))) {
+        return NULL;
+    }
+    iplen = lwip_ntohs(IPH_LEN(iph));
+    tcph = (struct tcp_hdr *)((u8_t *)iph + IP_HLEN);
+    hlen = TCPH_HDRLEN_BYTES(tcph);
+    if ((p->tot_len != SIZEOF_ETH_HDR + iplen) || (hlen < TCP_HLEN) ||
+        (p->len < SIZEOF_ETH_HDR + IP_HLEN + hlen) || (iplen < IP_HLEN + hlen)) {
+        return NULL;
+    }
+
+    *iphp = iph;
+    *dlen = iplen - IP_HLEN - hlen;
+    return tcph;
+}
+
+static int gro_same_flow(const gro_flow_t *f, const struct pbuf *p, const struct ip_hdr *iph,
+                         const struct tcp_hdr *tcph)
+{
+    return (f->p->if_idx == p->if_idx) && ip4_addr_cmp(&f->iph->src, &iph->src) &&
+           (f->tcph->src == tcph->src) && (f->tcph->dest == tcph->dest);
+}
+
+/* Contiguous, same ACK, window, header length, flags and options, and nothing after a PSH */
+static int gro_can_merge(const gro_flow_t *f, const struct ip_hdr *iph, const struct tcp_hdr *tcph, u32_t dlen)
+{
+    u16_t hlen = TCPH_HDRLEN_BYTES(tcph);
+
+    return (dlen != 0) && ((TCPH_FLAGS(tcph) & ~TCP_PSH) == TCP_ACK) && !(f->flags & TCP_PSH) &&
+           ((f->dlen & 1) == 0) && (IP_HLEN + hlen + f->dlen + dlen <= GRO_IP_LEN_MAX) &&
+           (lwip_ntohl(tcph->seqno) == f->nextSeq) && (tcph->ackno == f->tcph->ackno) &&
+           (tcph->wnd == f->tcph->wnd) &&
+           ((tcph->_hdrlen_rsvd_flags & ~PP_HTONS(TCP_PSH)) == f->tcph->_hdrlen_rsvd_flags) &&
+           (IPH_TOS(iph) == IPH_TOS(f->iph)) && (IPH_TTL(iph) == IPH_TTL(f->iph)) &&
+           (memcmp(tcph + 1, f->tcph + 1, hlen - TCP_HLEN) == 0);
+}
+
+/* A segment's payload sum is what its checksum field leaves over after the headers */
+static u16_t gro_payload_sum(const struct ip_hdr *iph, const struct tcp_hdr *tcph, u32_t dlen)
+{
+    u16_t hlen = TCPH_HDRLEN_BYTES(tcph);
+
+    return (u16_t)~offload_fold(offload_pseudo_sum(iph, (u16_t)(hlen + dlen)) + offload_sum(tcph, hlen));
+}
+
+static void gro_open(gro_flow_t *f, struct pbuf *p, struct ip_hdr *iph, struct tcp_hdr *tcph, u32_t dlen)
+{
+    f->p = p;
+    f->iph = iph;
+    f->tcph = tcph;
+    f->nextSeq = lwip_ntohl(tcph->seqno) + dlen;
+    f->dsum = gro_payload_sum(iph, tcph, dlen);
+    f->dlen = dlen;
+    f->segs = 1;
+    f->flags = 0;
+}
+
+static void gro_merge(gro_flow_t *f, struct pbuf *p, struct ip_hdr *iph, struct tcp_hdr *tcph, u32_t dlen)
+{
+    f->dsum += gro_payload_sum(iph, tcph, dlen);
+    f->flags |= (TCPH_FLAGS(tcph) & TCP_PSH);
+    f->nextSeq += dlen;
+    f->dlen += dlen;
+    f->segs++;
+
+    (void)pbuf_header(p, -(s16_t)(SIZEOF_ETH_HDR + IP_HLEN + TCPH_HDRLEN_BYTES(tcph)));
+    pbuf_cat(f->p, p);
+}
+
+/* Rewrite the head segment's headers for the merged payload */
+static void gro_close(gro_flow_t *f)
+{
+    u16_t hlen = TCPH_HDRLEN_BYTES(f->tcph);
+    u16_t tcplen = (u16_t)(hlen + f->dlen);
+
+    if (f->segs == 1) {
+        return;
+    }
+
+    IPH_LEN_SET(f->iph, lwip_htons((u16_t)(IP_HLEN + tcplen)));
+    IPH_CHKSUM_SET(f->iph, 0);
+    IPH_CHKSUM_SET(f->iph, inet_chksum(f->iph, IP_HLEN));
+
+    TCPH_SET_FLAG(f->tcph, f->flags);
+    f->tcph->chksum = 0;
+    f->tcph->chksum = (u16_t)~offload_fold(offload_pseudo_sum(f->iph, tcplen) + offload_sum(f->tcph, hlen) +
+                                           offload_fold(f->dsum));
+}
+
+/*
+ * Merge the TCP segments of pkts in place and return the new packet count. Packets keep their
+ * relative order: a segment is only ever appended to an earlier one of the same flow, and any
+ * other segment of a flow ends merging for that flow. Called with the core lock held, for
+ * netif_get_by_index.
+ *
+ * A segment with a corrupt checksum makes the whole merged segment fail verification in
+ * tcp_input, which drops it; the sender retransmits as it would have for the bad one alone.
+ */
+u32_t
+driverif_gro_receive(struct pbuf **pkts, u32_t count)
+{
+    gro_flow_t flows[LWIP_GRO_MAX_FLOWS];
+    struct ip_hdr *iph = NULL;
+    struct tcp_hdr *tcph = NULL;
+    struct pbuf *p = NULL;
+    u32_t nflows = 0;
+    u32_t victim = 0;
+    u32_t dlen = 0;
+    u32_t n = 0;
+    u32_t i;
+    u32_t j;
+
+    for (i = 0; i < count; i++) {
+        p = pkts[i];
+        tcph = gro_parse(p, netif_get_by_index(p->if_idx), &iph, &dlen);
+        if (tcph == NULL) {
+            pkts[n++] = p;
+            continue;
+        }
+
+        for (j = 0; (j < nflows) && !gro_same_flow(&flows[j], p, iph, tcph); j++) {
+        }
+        if (j < nflows) {
+            if (gro_can_merge(&flows[j], iph, tcph, dlen)) {
+                gro_merge(&flows[j], p, iph, tcph, dlen);
+                continue;
+            }
+            gro_close(&flows[j]);
+            flows[j] = flows[--nflows];
+        }
+
+        pkts[n++] = p;
+        if ((dlen == 0) || (TCPH_FLAGS(tcph) != TCP_ACK)) {
+            continue;
+        }
+        if (nflows == LWIP_GRO_MAX_FLOWS) {
+            j = victim;
+            victim = (victim + 1) % LWIP_GRO_MAX_FLOWS;
+            gro_close(&flows[j]);
+        } else {
+            j = nflows++;
+        }
+        gro_open(&flows[j], p, iph, tcph, dlen);
+    }
+
+    for (j = 0; j < nflows; j++) {
+        gro_close(&flows[j]);
+    }
+    return n;
+}
+#endif /* LWIP_GRO */
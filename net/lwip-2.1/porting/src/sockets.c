@@ -29,9 +29,19 @@
  * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#define _GNU_SOURCE /* struct mmsghdr */
 #include <lwip/sockets.h>
 #include <lwip/priv/tcpip_priv.h>
 #include <lwip/fixme.h>
+#include "fs_epoll.h"
+#if LWIP_UDP
+#include <sys/time.h>
+#include "fs_pktring.h"
+#endif
+
+#if LWIP_TCP
+#include "los_process.h"
+#endif
 
 #if LWIP_ENABLE_NET_CAPABILITY
 #include "capability_type.h"
@@ -66,6 +76,33 @@ static err_t lwip_do_ioctl_impl(struct tcpip_api_call_data *call);
 
 static void poll_check_waiters(int s, int check_waiters);
 
+#if LWIP_UDP
+/*
+ * mmap'd frame rings of a UDP socket. Entries change under the tcpip core lock and
+ * SYS_ARCH_PROTECT both, so either one keeps the ring alive; callers holding neither take a
+ * reference with socks_ring_get.
+ */
+struct socks_ring {
+    struct PktRing *ring;
+    int fd;                     /* system fd of the ring object, mapped in place of the socket */
+};
+
+static struct socks_ring g_sock_rings[NUM_SOCKETS];
+
+#define SOCKS_RING_ADDR         TPACKET_ALIGN(sizeof(struct tpacket_hdr))
+#define SOCKS_RING_DATA         TPACKET_ALIGN(SOCKS_RING_ADDR + sizeof(struct sockaddr_in6))
+#define SOCKS_RING_PAYLOAD_MIN  64
+#define SOCKS_RING_FRAME_MIN    TPACKET_ALIGN(SOCKS_RING_DATA + SOCKS_RING_PAYLOAD_MIN)
+
+static pollevent_t socks_ring_mask(int s);
+#endif
+
+#if LWIP_TCP
+static int socks_reuseport_setsockopt(int s, const void *optval, socklen_t optlen);
+static int socks_reuseport_getsockopt(int s, void *optval, socklen_t *optlen);
+static int socks_reuseport_listen(int s, int backlog);
+#endif
+
 static int lwip_socket_wrap(int domain, int type, int protocol);
 int lwip_socket(int domain, int type, int protocol)
 {
@@ -78,6 +115,18 @@ int lwip_setsockopt(int s, int level, int optname, const void *optval, socklen_t
     return lwip_setsockopt_wrap(s, level, optname, optval, optlen);
 }
 
+static int lwip_getsockopt_wrap(int s, int level, int optname, void *optval, socklen_t *optlen);
+int lwip_getsockopt(int s, int level, int optname, void *optval, socklen_t *optlen)
+{
+    return lwip_getsockopt_wrap(s, level, optname, optval, optlen);
+}
+
+static int lwip_listen_wrap(int s, int backlog);
+int lwip_listen(int s, int backlog)
+{
+    return lwip_listen_wrap(s, backlog);
+}
+
 static int lwip_bind_wrap(int s, const struct sockaddr *name, socklen_t namelen);
 int lwip_bind(int s, const struct sockaddr *name, socklen_t namelen)
 {
@@ -103,6 +152,18 @@ static int lwip_socket2(int domain, int type, int protocol);
 #define lwip_setsockopt static lwip_setsockopt2
 static int lwip_setsockopt2(int s, int level, int optname, const void *optval, socklen_t optlen);
 
+#ifdef lwip_getsockopt
+#undef lwip_getsockopt
+#endif
+#define lwip_getsockopt static lwip_getsockopt2
+static int lwip_getsockopt2(int s, int level, int optname, void *optval, socklen_t *optlen);
+
+#ifdef lwip_listen
+#undef lwip_listen
+#endif
+#define lwip_listen static lwip_listen2
+static int lwip_listen2(int s, int backlog);
+
 #ifdef lwip_bind
 #undef lwip_bind
 #endif
@@ -119,6 +180,8 @@ ssize_t lwip_sendto2(int s, const void *dataptr, size_t size, int flags, const s
 
 #undef lwip_socket
 #undef lwip_setsockopt
+#undef lwip_getsockopt
+#undef lwip_listen
 #undef lwip_bind
 #undef lwip_sendto
 
@@ -164,10 +227,34 @@ static int lwip_setsockopt_wrap(int s, int level, int optname, const void *optva
                 break;
         }
     }
+#endif
+#if LWIP_TCP
+    if ((level == SOL_SOCKET) && (optname == SO_REUSEPORT)) {
+        return socks_reuseport_setsockopt(s, optval, optlen);
+    }
 #endif
     return lwip_setsockopt2(s, level, optname, optval, optlen);
 }
 
+static int lwip_getsockopt_wrap(int s, int level, int optname, void *optval, socklen_t *optlen)
+{
+#if LWIP_TCP
+    if ((level == SOL_SOCKET) && (optname == SO_REUSEPORT)) {
+        return socks_reuseport_getsockopt(s, optval, optlen);
+    }
+#endif
+    return lwip_getsockopt2(s, level, optname, optval, optlen);
+}
+
+static int lwip_listen_wrap(int s, int backlog)
+{
+#if LWIP_TCP
+    return socks_reuseport_listen(s, backlog);
+#else
+    return lwip_listen2(s, backlog);
+#endif
+}
+
 #if LWIP_ENABLE_NET_CAPABILITY && LWIP_ENABLE_CAP_NET_BROADCAST
 static int ip_addr_isbroadcast_bysock(const ip_addr_t *ipaddr, int s)
 {
@@ -258,11 +345,23 @@ struct file;
 extern void poll_wait(struct file *filp, wait_queue_head_t *wait_address, poll_table *p);
 extern void __wake_up_interruptible_poll(wait_queue_head_t *wait, pollevent_t key);
 
+/* readiness hooks for epoll, a watch is set up the first time the socket is added to an epoll set */
+static struct EpollWatch g_sock_epoll_watch[NUM_SOCKETS];
+
+/* must be called with SYS_ARCH_PROTECT held */
+static struct EpollWatch *socks_epoll_watch_get(int s)
+{
+    struct EpollWatch *watch = &g_sock_epoll_watch[s - LWIP_SOCKET_OFFSET];
+
+    return (watch->ops != NULL) ? watch : NULL;
+}
+
 static void poll_check_waiters(int s, int check_waiters)
 {
     unsigned long int_save, wq_empty;
     pollevent_t mask = 0;
     struct lwip_sock *sock;
+    struct EpollWatch *watch;
     SYS_ARCH_DECL_PROTECT(lev);
 
     if (!check_waiters) {
@@ -279,6 +378,10 @@ static void poll_check_waiters(int s, int check_waiters)
     mask |= (sock->rcvevent > 0) ? (POLLIN | POLLPRI | POLLRDNORM | POLLRDBAND) : 0;
     mask |= (sock->sendevent != 0) ? (POLLOUT | POLLWRNORM | POLLWRBAND) : 0;
     mask |= (sock->errevent != 0) ? (POLLERR) : 0;
+#if LWIP_UDP
+    mask |= socks_ring_mask(s);
+#endif
+    watch = socks_epoll_watch_get(s);
 
     SYS_ARCH_UNPROTECT(lev);
 
@@ -290,15 +393,37 @@ static void poll_check_waiters(int s, int check_waiters)
         __wake_up_interruptible_poll(&sock->wq, mask);
     }
 
+    if (mask && watch) {
+        EpollWatchNotify(watch, mask);
+    }
+
     done_socket(sock);
 }
 
+static pollevent_t socks_poll_mask(struct lwip_sock *sock)
+{
+    pollevent_t mask = 0;
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    SYS_ARCH_PROTECT(lev);
+
+    mask |= (sock->rcvevent > 0 || sock->lastdata.pbuf) ? (POLLIN | POLLPRI | POLLRDNORM | POLLRDBAND) : 0;
+    mask |= (sock->sendevent != 0) ? (POLLOUT | POLLWRNORM | POLLWRBAND) : 0;
+    mask |= (sock->errevent != 0) ? (POLLERR) : 0;
+#if LWIP_UDP
+    mask |= socks_ring_mask((int)(sock - sockets) + LWIP_SOCKET_OFFSET);
+#endif
+
+    SYS_ARCH_UNPROTECT(lev);
+
+    return mask;
+}
+
 int socks_poll(int s, poll_table *wait)
 {
     int ret;
-    pollevent_t mask = 0;
+    pollevent_t mask;
     struct lwip_sock *sock;
-    SYS_ARCH_DECL_PROTECT(lev);
 
     LWIP_ERROR("sock_poll: invalid poll_table", (wait != NULL), return -EINVAL;);
 
@@ -309,13 +434,7 @@ int socks_poll(int s, poll_table *wait)
         return -EBADF; /* compatible with file poll */
     }
 
-    SYS_ARCH_PROTECT(lev);
-
-    mask |= (sock->rcvevent > 0 || sock->lastdata.pbuf) ? (POLLIN | POLLPRI | POLLRDNORM | POLLRDBAND) : 0;
-    mask |= (sock->sendevent != 0) ? (POLLOUT | POLLWRNORM | POLLWRBAND) : 0;
-    mask |= (sock->errevent != 0) ? (POLLERR) : 0;
-
-    SYS_ARCH_UNPROTECT(lev);
+    mask = socks_poll_mask(sock);
 
     ret = wait->key & mask;
     if (!ret) {
@@ -326,6 +445,66 @@ int socks_poll(int s, poll_table *wait)
     return ret;
 }
 
+static UINT32 socks_epoll_events(struct EpollWatch *watch)
+{
+    int s = (int)(watch - g_sock_epoll_watch) + LWIP_SOCKET_OFFSET;
+    pollevent_t mask;
+    struct lwip_sock *sock;
+
+    sock = get_socket(s);
+    if (!sock) {
+        return POLLHUP;
+    }
+
+    mask = socks_poll_mask(sock);
+
+    done_socket(sock);
+    return mask;
+}
+
+static const struct EpollWatchOps g_sock_epoll_watch_ops = {
+    socks_epoll_events,
+    NULL,
+    NULL,
+};
+
+struct EpollWatch *socks_epoll_watch(int s)
+{
+    struct EpollWatch *watch;
+    struct lwip_sock *sock;
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    sock = get_socket(s);
+    if (!sock) {
+        return NULL;
+    }
+
+    watch = &g_sock_epoll_watch[s - LWIP_SOCKET_OFFSET];
+
+    SYS_ARCH_PROTECT(lev);
+    if (watch->ops == NULL) {
+        EpollWatchInit(watch, &g_sock_epoll_watch_ops);
+    }
+    SYS_ARCH_UNPROTECT(lev);
+
+    done_socket(sock);
+    return watch;
+}
+
+static void socks_epoll_detach(int s)
+{
+    struct EpollWatch *watch;
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    SYS_ARCH_PROTECT(lev);
+    watch = socks_epoll_watch_get(s);
+    SYS_ARCH_UNPROTECT(lev);
+
+    if (watch) {
+        EpollWatchDetach(watch);
+    }
+}
+
 #endif /* LWIP_SOCKET_SELECT || LWIP_SOCKET_POLL */
 
 #if !LWIP_COMPAT_SOCKETS
@@ -1554,6 +1733,13 @@ void socks_refer(int sockfd)
     done_socket(sock);
 }
 
+#if LWIP_UDP
+static void socks_ring_release(int sockfd);
+#endif
+#if LWIP_TCP
+static void socks_reuseport_release(int sockfd);
+#endif
+
 int socks_close(int sockfd)
 {
     struct lwip_sock *sock = NULL;
@@ -1569,6 +1755,15 @@ int socks_close(int sockfd)
     if (sock->s_refcount == 0) {
         SYS_ARCH_UNPROTECT(lev);
         done_socket(sock);
+#if LWIP_SOCKET_SELECT || LWIP_SOCKET_POLL
+        socks_epoll_detach(sockfd);
+#endif
+#if LWIP_UDP
+        socks_ring_release(sockfd);
+#endif
+#if LWIP_TCP
+        socks_reuseport_release(sockfd);
+#endif
         return lwip_close(sockfd);
     }
 
@@ -1578,3 +1773,909 @@ int socks_close(int sockfd)
     done_socket(sock);
     return 0;
 }
+
+#if LWIP_TCP
+#include "lwip/priv/tcp_priv.h"
+
+struct socks_zc_apimsg {
+    struct tcpip_api_call_data call;
+    struct lwip_sock *sock;
+    const void *data;
+    size_t size;
+    struct socks_zc_ref *ref;
+    ssize_t ret;
+};
+
+#define SOCKS_ZC_ARG_NONE 0xFF
+
+static u8_t socks_zc_arg_id = SOCKS_ZC_ARG_NONE;  /* allocated on first use, under the core lock */
+static u32_t socks_zc_gen;
+
+/*
+ * pcbs are recycled as soon as they are freed, so a send is matched by a generation tag stored
+ * in the pcb's ext arg rather than by the pcb address. tcp_alloc clears the tag of a new pcb.
+ */
+static u32_t socks_zc_pcb_tag(struct tcp_pcb *pcb)
+{
+    void *tag = NULL;
+
+    if (socks_zc_arg_id == SOCKS_ZC_ARG_NONE) {
+        socks_zc_arg_id = tcp_ext_arg_alloc_id();
+    }
+
+    tag = tcp_ext_arg_get(pcb, socks_zc_arg_id);
+    if (tag == NULL) {
+        if (++socks_zc_gen == 0) {
+            socks_zc_gen = 1;
+        }
+        tag = (void *)(uintptr_t)socks_zc_gen;
+        tcp_ext_arg_set(pcb, socks_zc_arg_id, tag);
+    }
+    return (u32_t)(uintptr_t)tag;
+}
+
+static int socks_zc_pcb_match(const struct tcp_pcb *pcb, const struct socks_zc_ref *ref)
+{
+    return (pcb == ref->pcb) && (socks_zc_arg_id != SOCKS_ZC_ARG_NONE) &&
+           ((u32_t)(uintptr_t)tcp_ext_arg_get(pcb, socks_zc_arg_id) == ref->gen);
+}
+
+/* ask sent_tcp/err_tcp to raise NETCONN_EVT_SENDPLUS, so a POLLOUT waiter wakes on the next ack */
+static void socks_zc_arm_wakeup(struct netconn *conn)
+{
+    netconn_set_flags(conn, NETCONN_FLAG_CHECK_WRITESPACE);
+    API_EVENT(conn, NETCONN_EVT_SENDMINUS, 0);
+}
+
+static err_t lwip_do_zc_send(struct tcpip_api_call_data *call)
+{
+    struct socks_zc_apimsg *msg = (struct socks_zc_apimsg *)(void *)call;
+    struct netconn *conn = msg->sock->conn;
+    struct tcp_pcb *pcb = NULL;
+    u16_t len;
+    err_t err;
+
+    if ((conn == NULL) || (NETCONNTYPE_GROUP(netconn_type(conn)) != NETCONN_TCP) ||
+        netconn_is_nonblocking(conn)) {
+        msg->ret = -EOPNOTSUPP;
+        return ERR_OK;
+    }
+
+    pcb = conn->pcb.tcp;
+    if ((pcb == NULL) || ((pcb->state != ESTABLISHED) && (pcb->state != CLOSE_WAIT))) {
+        msg->ret = -EPIPE;
+        return ERR_OK;
+    }
+
+    len = (u16_t)LWIP_MIN(LWIP_MIN(msg->size, 0xFFFF), tcp_sndbuf(pcb));
+    if ((len == 0) || (tcp_sndqueuelen(pcb) >= TCP_SND_QUEUELEN)) {
+        socks_zc_arm_wakeup(conn);
+        msg->ret = 0;
+        return ERR_OK;
+    }
+
+    /* no TCP_WRITE_FLAG_COPY: the segments point at the caller's pages */
+    err = tcp_write(pcb, msg->data, len, 0);
+    if (err == ERR_MEM) {
+        socks_zc_arm_wakeup(conn);
+        msg->ret = 0;
+        return ERR_OK;
+    } else if (err != ERR_OK) {
+        msg->ret = -err_to_errno(err);
+        return ERR_OK;
+    }
+
+    (void)tcp_output(pcb);
+    msg->ref->pcb = pcb;
+    msg->ref->gen = socks_zc_pcb_tag(pcb);
+    msg->ref->endseq = pcb->snd_lbb;
+    msg->ret = len;
+    return ERR_OK;
+}
+
+static int socks_zc_seg_pending(const struct tcp_seg *seg, u32_t endseq)
+{
+    for (; seg != NULL; seg = seg->next) {
+        if (TCP_SEQ_LT(lwip_ntohl(seg->tcphdr->seqno), endseq)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static err_t lwip_do_zc_pending(struct tcpip_api_call_data *call)
+{
+    struct socks_zc_apimsg *msg = (struct socks_zc_apimsg *)(void *)call;
+    struct netconn *conn = (msg->sock != NULL) ? msg->sock->conn : NULL;
+    struct tcp_pcb *pcb = NULL;
+
+    /*
+     * The pcb may have been detached from the netconn by a shutdown while our segments are still
+     * queued, so look it up among the live pcbs instead of trusting conn->pcb. A pcb that is gone
+     * had its segments purged with it, and one reallocated at the same address carries another tag.
+     */
+    for (pcb = tcp_active_pcbs; pcb != NULL; pcb = pcb->next) {
+        if (socks_zc_pcb_match(pcb, msg->ref)) {
+            break;
+        }
+    }
+
+    if ((pcb == NULL) ||
+        (!socks_zc_seg_pending(pcb->unacked, msg->ref->endseq) &&
+         !socks_zc_seg_pending(pcb->unsent, msg->ref->endseq))) {
+        msg->ret = 0;
+        return ERR_OK;
+    }
+
+    if ((conn != NULL) && (conn->pcb.tcp == pcb)) {
+        socks_zc_arm_wakeup(conn);
+    }
+    msg->ret = 1;
+    return ERR_OK;
+}
+
+ssize_t socks_zc_send(int sockfd, const void *data, size_t size, struct socks_zc_ref *ref)
+{
+    struct socks_zc_apimsg msg;
+    struct lwip_sock *sock = NULL;
+
+    sock = get_socket(sockfd);
+    if (!sock) {
+        return -EBADF;
+    }
+
+    msg.sock = sock;
+    msg.data = data;
+    msg.size = size;
+    msg.ref = ref;
+    msg.ret = -EIO;
+    (void)tcpip_api_call(lwip_do_zc_send, &msg.call);
+
+    done_socket(sock);
+    return msg.ret;
+}
+
+int socks_zc_pending(int sockfd, const struct socks_zc_ref *ref)
+{
+    struct socks_zc_apimsg msg;
+    struct lwip_sock *sock = NULL;
+
+    if (ref->pcb == NULL) {
+        return 0;
+    }
+
+    /* the segments outlive the socket if it was closed meanwhile, so keep checking without it */
+    sock = get_socket(sockfd);
+
+    msg.sock = sock;
+    msg.ref = (struct socks_zc_ref *)ref;
+    msg.ret = 0;
+    (void)tcpip_api_call(lwip_do_zc_pending, &msg.call);
+
+    if (sock) {
+        done_socket(sock);
+    }
+    return (int)msg.ret;
+}
+#endif /* LWIP_TCP */
+
+#if LWIP_UDP
+/* The socket's ring with a reference held, NULL if it has none; drop it with PktRingPut */
+static struct PktRing *socks_ring_get(int sockfd)
+{
+    struct PktRing *ring = NULL;
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    if ((sockfd < LWIP_SOCKET_OFFSET) || (sockfd >= LWIP_SOCKET_OFFSET + NUM_SOCKETS)) {
+        return NULL;
+    }
+
+    SYS_ARCH_PROTECT(lev);
+    ring = g_sock_rings[sockfd - LWIP_SOCKET_OFFSET].ring;
+    if (ring != NULL) {
+        PktRingHold(ring);
+    }
+    SYS_ARCH_UNPROTECT(lev);
+    return ring;
+}
+
+/*
+ * Frame layout of UDP socket rings. rx frames carry the datagram length in tp_len, the bytes
+ * stored in tp_snaplen, the sender's sockaddr at tp_mac and the payload at tp_net. A tx frame
+ * holds tp_len payload bytes at tp_net (SOCKS_RING_DATA when 0) and, when tp_mac is not 0, a
+ * destination sockaddr of tp_snaplen bytes at tp_mac.
+ *
+ * socks_ring_mask must be called with SYS_ARCH_PROTECT held.
+ */
+static pollevent_t socks_ring_mask(int s)
+{
+    struct socks_ring *sr = &g_sock_rings[s - LWIP_SOCKET_OFFSET];
+    struct PktRing *ring = sr->ring;
+    pollevent_t mask = 0;
+
+    if (ring == NULL) {
+        return 0;
+    }
+    /* like packet sockets, rx is readable while the frame filled last is still with the user */
+    if (PktRingActive(ring, PKTRING_RX) && (PktRingPeek(ring, PKTRING_RX, TRUE) != TP_STATUS_KERNEL)) {
+        mask |= POLLIN | POLLRDNORM;
+    }
+    if (PktRingActive(ring, PKTRING_TX) && (PktRingPeek(ring, PKTRING_TX, FALSE) == TP_STATUS_AVAILABLE)) {
+        mask |= POLLOUT | POLLWRNORM;
+    }
+    return mask;
+}
+
+/* udp_recv callback in place of the netconn one: datagrams go straight into the rx ring */
+static void socks_ring_udp_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port)
+{
+    struct socks_ring *sr = (struct socks_ring *)arg;
+    union sockaddr_aligned saddr;
+    struct tpacket_hdr *hdr = NULL;
+    struct timeval tv;
+    u32_t snaplen;
+    u32_t room;
+
+    LWIP_UNUSED_ARG(pcb);
+
+    hdr = (sr->ring != NULL) ? PktRingClaim(sr->ring, PKTRING_RX, TP_STATUS_KERNEL, &room) : NULL;
+    if ((hdr == NULL) || (room < SOCKS_RING_FRAME_MIN)) {
+        if (hdr != NULL) {
+            PktRingHandOver(sr->ring, hdr, TP_STATUS_KERNEL);
+        }
+        (void)pbuf_free(p);
+        return;
+    }
+
+    IPADDR_PORT_TO_SOCKADDR(&saddr, addr, port);
+    (void)memcpy_s((u8_t *)hdr + SOCKS_RING_ADDR, SOCKS_RING_DATA - SOCKS_RING_ADDR, &saddr,
+                   IP_IS_V4(addr) ? sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6));
+    snaplen = LWIP_MIN(p->tot_len, room - SOCKS_RING_DATA);
+    (void)pbuf_copy_partial(p, (u8_t *)hdr + SOCKS_RING_DATA, (u16_t)snaplen, 0);
+
+    (void)gettimeofday(&tv, NULL);
+    hdr->tp_len = p->tot_len;
+    hdr->tp_snaplen = snaplen;
+    hdr->tp_mac = SOCKS_RING_ADDR;
+    hdr->tp_net = SOCKS_RING_DATA;
+    hdr->tp_sec = (u32_t)tv.tv_sec;
+    hdr->tp_usec = (u32_t)tv.tv_usec;
+    PktRingHandOver(sr->ring, hdr, TP_STATUS_USER | ((snaplen < p->tot_len) ? TP_STATUS_TRUNCATED : 0));
+    (void)pbuf_free(p);
+
+    poll_check_waiters((int)(sr - g_sock_rings) + LWIP_SOCKET_OFFSET, 1);
+}
+
+/*
+ * setsockopt(SOL_PACKET, PACKET_RX_RING/PACKET_TX_RING) on a UDP socket. The areas are fixed
+ * once mapped; an rx ring takes over reception, recv() no longer sees the datagrams.
+ */
+int socks_ring_setsockopt(int sockfd, int optname, const struct tpacket_req *req)
+{
+    struct socks_ring *sr = NULL;
+    struct lwip_sock *sock = NULL;
+    struct PktRing *ring = NULL;
+    UINT32 dir = (optname == PACKET_RX_RING) ? PKTRING_RX : PKTRING_TX;
+    int fd = -1;
+    int ret;
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    if ((optname != PACKET_RX_RING) && (optname != PACKET_TX_RING)) {
+        return -ENOPROTOOPT;
+    }
+    /* every frame must hold the header, a sockaddr and some payload */
+    if (req->tp_frame_size < SOCKS_RING_FRAME_MIN) {
+        return -EINVAL;
+    }
+    sock = get_socket(sockfd);
+    if (!sock) {
+        return -EBADF;
+    }
+    if ((sock->conn == NULL) || (NETCONNTYPE_GROUP(netconn_type(sock->conn)) != NETCONN_UDP)) {
+        done_socket(sock);
+        return -EOPNOTSUPP;
+    }
+    sr = &g_sock_rings[sockfd - LWIP_SOCKET_OFFSET];
+
+    /* the ring object is created outside the core lock, a racing caller's one is dropped */
+    if (sr->ring == NULL) {
+        fd = PktRingCreate(&ring);
+        if (fd < 0) {
+            done_socket(sock);
+            return fd;
+        }
+        LOCK_TCPIP_CORE();
+        if (sr->ring == NULL) {
+            SYS_ARCH_PROTECT(lev);
+            sr->ring = ring;
+            sr->fd = fd;
+            SYS_ARCH_UNPROTECT(lev);
+            fd = -1;
+        }
+        UNLOCK_TCPIP_CORE();
+        if (fd >= 0) {
+            (void)close(fd);
+        }
+    }
+
+    /* a racing close may release the ring as soon as it is published */
+    ring = socks_ring_get(sockfd);
+    if (ring == NULL) {
+        done_socket(sock);
+        return -EBADF;
+    }
+    ret = PktRingSetup(ring, dir, req);
+    PktRingPut(ring);
+    if ((ret == 0) && (dir == PKTRING_RX)) {
+        LOCK_TCPIP_CORE();
+        if ((sock->conn->pcb.udp != NULL) && (sr->ring != NULL)) {
+            udp_recv(sock->conn->pcb.udp, socks_ring_udp_recv, sr);
+        }
+        UNLOCK_TCPIP_CORE();
+    }
+
+    done_socket(sock);
+    return ret;
+}
+
+/* The system fd mmap() uses for a socket, the socket's ring object */
+int socks_ring_fd(int sockfd)
+{
+    struct socks_ring *sr = NULL;
+    int fd;
+
+    if ((sockfd < LWIP_SOCKET_OFFSET) || (sockfd >= LWIP_SOCKET_OFFSET + NUM_SOCKETS)) {
+        return -ENODEV;
+    }
+    sr = &g_sock_rings[sockfd - LWIP_SOCKET_OFFSET];
+
+    LOCK_TCPIP_CORE();
+    fd = (sr->ring != NULL) ? sr->fd : -ENODEV;
+    UNLOCK_TCPIP_CORE();
+    return fd;
+}
+
+int socks_ring_tx_active(int sockfd)
+{
+    struct PktRing *ring = socks_ring_get(sockfd);
+    int active;
+
+    if (ring == NULL) {
+        return 0;
+    }
+    active = PktRingActive(ring, PKTRING_TX);
+    PktRingPut(ring);
+    return active;
+}
+
+/*
+ * send(NULL) on a socket with a tx ring: send every frame the user marked TP_STATUS_SEND_REQUEST
+ * and hand it back as TP_STATUS_AVAILABLE, or TP_STATUS_WRONG_FORMAT if it could not be sent.
+ * The payload is copied from the ring by the stack, there is no copy from user space. Returns
+ * the bytes sent, or the first error if nothing could be sent.
+ */
+ssize_t socks_ring_send(int sockfd)
+{
+    struct PktRing *ring = socks_ring_get(sockfd);
+    struct tpacket_hdr *hdr = NULL;
+    const struct sockaddr *to = NULL;
+    ssize_t total = 0;
+    int err = 0;
+    u32_t room;
+    u32_t off;
+    u32_t len;
+    u32_t tolen;
+    int ret;
+
+    if (!PktRingActive(ring, PKTRING_TX)) {
+        if (ring != NULL) {
+            PktRingPut(ring);
+        }
+        return -EINVAL;
+    }
+
+    while ((hdr = PktRingClaim(ring, PKTRING_TX, TP_STATUS_SEND_REQUEST, &room)) != NULL) {
+        /* read once, the frame stays writable by the user */
+        off = (hdr->tp_net != 0) ? hdr->tp_net : SOCKS_RING_DATA;
+        len = hdr->tp_len;
+        tolen = (hdr->tp_mac != 0) ? hdr->tp_snaplen : 0;
+        to = (hdr->tp_mac != 0) ? (const struct sockaddr *)((u8_t *)hdr + hdr->tp_mac) : NULL;
+        if ((off < SOCKS_RING_ADDR) || (off > room) || (len > room - off) ||
+            ((to != NULL) && ((hdr->tp_mac < SOCKS_RING_ADDR) || (hdr->tp_mac > room) ||
+                              (tolen > room - hdr->tp_mac)))) {
+            PktRingHandOver(ring, hdr, TP_STATUS_WRONG_FORMAT);
+            err = (err != 0) ? err : EINVAL;
+            continue;
+        }
+
+        ret = lwip_sendto(sockfd, (u8_t *)hdr + off, len, 0, to, tolen);
+        if (ret < 0) {
+            PktRingHandOver(ring, hdr, TP_STATUS_WRONG_FORMAT);
+            err = (err != 0) ? err : get_errno();
+            continue;
+        }
+        PktRingHandOver(ring, hdr, TP_STATUS_AVAILABLE);
+        total += ret;
+    }
+    PktRingPut(ring);
+
+    poll_check_waiters(sockfd, 1);
+    return ((total == 0) && (err != 0)) ? -err : total;
+}
+
+/* Called on the last close, before the netconn goes: later datagrams are dropped by udp_input */
+static void socks_ring_release(int sockfd)
+{
+    struct socks_ring *sr = &g_sock_rings[sockfd - LWIP_SOCKET_OFFSET];
+    struct lwip_sock *sock = NULL;
+    int fd = -1;
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    sock = get_socket(sockfd);
+
+    LOCK_TCPIP_CORE();
+    if (sr->ring != NULL) {
+        if ((sock != NULL) && (sock->conn != NULL) &&
+            (NETCONNTYPE_GROUP(netconn_type(sock->conn)) == NETCONN_UDP) && (sock->conn->pcb.udp != NULL) &&
+            (sock->conn->pcb.udp->recv_arg == sr)) {
+            udp_recv(sock->conn->pcb.udp, NULL, NULL);
+        }
+        SYS_ARCH_PROTECT(lev);
+        fd = sr->fd;
+        sr->ring = NULL;
+        sr->fd = -1;
+        SYS_ARCH_UNPROTECT(lev);
+    }
+    UNLOCK_TCPIP_CORE();
+
+    if (sock) {
+        done_socket(sock);
+    }
+    if (fd >= 0) {
+        (void)close(fd);
+    }
+}
+#endif /* LWIP_UDP */
+
+#if LWIP_TCP
+/*
+ * SO_REUSEPORT: TCP listeners bound to the same address and port form a group, a ring linked
+ * through next. Every listen pcb of the group gets socks_reuseport_accept() as its accept
+ * callback, which hashes the 4-tuple of a new connection to the member whose accept queue it
+ * goes to, so each member is a shard with its own queue. A group only takes listeners of the
+ * user that turned the option on for its members, as on Linux. Entries are protected by the
+ * tcpip core lock.
+ */
+struct socks_reuseport {
+    u8_t enabled;
+    u8_t listening;
+    u32_t uid;                  /* user that turned the option on */
+    int next;                   /* index of the next listener of the group, itself when alone */
+    tcp_accept_fn accept;       /* the netconn's own accept callback */
+};
+
+static struct socks_reuseport g_sock_reuseport[NUM_SOCKETS];
+
+static u32_t socks_reuseport_hash(const struct tcp_pcb *pcb)
+{
+    u32_t hash = ((u32_t)pcb->remote_port << 16) | pcb->local_port;
+
+#if LWIP_IPV4
+    if (IP_IS_V4(&pcb->remote_ip)) {
+        hash ^= ip_2_ip4(&pcb->remote_ip)->addr ^ ip_2_ip4(&pcb->local_ip)->addr;
+    }
+#endif
+#if LWIP_IPV6
+    if (IP_IS_V6(&pcb->remote_ip)) {
+        for (int i = 0; i < 4; i++) {
+            hash ^= ip_2_ip6(&pcb->remote_ip)->addr[i] ^ ip_2_ip6(&pcb->local_ip)->addr[i];
+        }
+    }
+#endif
+
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3bU;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+/* A listener of the group pcb would join, other than self, or -1 */
+static int socks_reuseport_find(const struct tcp_pcb *pcb, int self, u32_t uid)
+{
+    const struct tcp_pcb *lpcb = NULL;
+    int i;
+
+    if (pcb->local_port == 0) {
+        return -1;
+    }
+    for (i = 0; i < NUM_SOCKETS; i++) {
+        if ((i == self) || !g_sock_reuseport[i].listening || (g_sock_reuseport[i].uid != uid) ||
+            (sockets[i].conn == NULL)) {
+            continue;
+        }
+        lpcb = sockets[i].conn->pcb.tcp;
+        if ((lpcb != NULL) && (lpcb->local_port == pcb->local_port) && ip_addr_cmp(&lpcb->local_ip, &pcb->local_ip)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Whichever listen pcb of the group tcp_input() picked, the member is chosen from the ring
+ * walked from its lowest index, so a flow always lands on the same one.
+ */
+static err_t socks_reuseport_accept(void *arg, struct tcp_pcb *newpcb, err_t err)
+{
+    struct netconn *conn = (struct netconn *)arg;
+    int self = conn->socket - LWIP_SOCKET_OFFSET;
+    int first = self;
+    int i = self;
+    u32_t n = 1;
+    u32_t hash;
+
+    if ((newpcb != NULL) && (err == ERR_OK)) {
+        for (i = g_sock_reuseport[self].next; i != self; i = g_sock_reuseport[i].next) {
+            first = LWIP_MIN(first, i);
+            n++;
+        }
+        for (hash = socks_reuseport_hash(newpcb) % n, i = first; hash != 0; hash--) {
+            i = g_sock_reuseport[i].next;
+        }
+    }
+    return g_sock_reuseport[i].accept(sockets[i].conn, newpcb, err);
+}
+
+static int socks_reuseport_setsockopt(int s, const void *optval, socklen_t optlen)
+{
+    struct socks_reuseport *rp = NULL;
+    struct lwip_sock *sock = NULL;
+    u32_t uid = (u32_t)LOS_GetUserID();
+    int err = 0;
+
+    if ((optval == NULL) || (optlen < sizeof(int))) {
+        set_errno(EINVAL);
+        return -1;
+    }
+    sock = get_socket(s);
+    if (!sock) {
+        return -1;
+    }
+    if ((sock->conn == NULL) || (NETCONNTYPE_GROUP(netconn_type(sock->conn)) != NETCONN_TCP)) {
+        done_socket(sock);
+        set_errno(ENOPROTOOPT);
+        return -1;
+    }
+    rp = &g_sock_reuseport[s - LWIP_SOCKET_OFFSET];
+
+    LOCK_TCPIP_CORE();
+    if (rp->listening) {
+        err = EINVAL;
+    } else {
+        rp->enabled = (*(const int *)optval != 0);
+        rp->uid = uid;
+        /* tcp_bind() lets two pcbs share a port when both have SOF_REUSEADDR */
+        if (rp->enabled && (sock->conn->pcb.tcp != NULL)) {
+            ip_set_option(sock->conn->pcb.tcp, SOF_REUSEADDR);
+        }
+    }
+    UNLOCK_TCPIP_CORE();
+
+    done_socket(sock);
+    if (err != 0) {
+        set_errno(err);
+        return -1;
+    }
+    return 0;
+}
+
+static int socks_reuseport_getsockopt(int s, void *optval, socklen_t *optlen)
+{
+    struct lwip_sock *sock = NULL;
+
+    if ((optval == NULL) || (optlen == NULL) || (*optlen < sizeof(int))) {
+        set_errno(EINVAL);
+        return -1;
+    }
+    sock = get_socket(s);
+    if (!sock) {
+        return -1;
+    }
+    *(int *)optval = g_sock_reuseport[s - LWIP_SOCKET_OFFSET].enabled;
+    *optlen = sizeof(int);
+    done_socket(sock);
+    return 0;
+}
+
+/*
+ * tcp_listen() refuses a second listener on an address only for SOF_REUSEADDR pcbs, so a
+ * member joining a group listens with the option cleared and gets it back after. A socket of
+ * another user finds no group and keeps the option, so its listen fails with EADDRINUSE.
+ */
+static int socks_reuseport_listen(int s, int backlog)
+{
+    int self = s - LWIP_SOCKET_OFFSET;
+    struct socks_reuseport *rp = NULL;
+    struct lwip_sock *sock = NULL;
+    struct tcp_pcb *pcb = NULL;
+    int head;
+    int ret;
+
+    if ((self < 0) || (self >= NUM_SOCKETS) || !g_sock_reuseport[self].enabled) {
+        return lwip_listen2(s, backlog);
+    }
+    sock = get_socket(s);
+    if (!sock) {
+        return -1;
+    }
+    rp = &g_sock_reuseport[self];
+
+    LOCK_TCPIP_CORE();
+    pcb = (sock->conn != NULL) ? sock->conn->pcb.tcp : NULL;
+    if (!rp->listening && (pcb != NULL) && (socks_reuseport_find(pcb, self, rp->uid) >= 0)) {
+        ip_reset_option(pcb, SOF_REUSEADDR);
+    }
+    UNLOCK_TCPIP_CORE();
+
+    ret = lwip_listen2(s, backlog);
+
+    LOCK_TCPIP_CORE();
+    pcb = (sock->conn != NULL) ? sock->conn->pcb.tcp : NULL;
+    if (pcb != NULL) {
+        ip_set_option(pcb, SOF_REUSEADDR);
+    }
+    if ((ret == 0) && rp->enabled && !rp->listening && (pcb != NULL) && (pcb->state == LISTEN)) {
+        rp->accept = ((struct tcp_pcb_listen *)pcb)->accept;
+        tcp_accept(pcb, socks_reuseport_accept);
+        rp->listening = 1;
+        /* look again, the group may have changed while unlocked */
+        head = socks_reuseport_find(pcb, self, rp->uid);
+        if (head >= 0) {
+            rp->next = g_sock_reuseport[head].next;
+            g_sock_reuseport[head].next = self;
+        } else {
+            rp->next = self;
+        }
+    }
+    UNLOCK_TCPIP_CORE();
+
+    done_socket(sock);
+    return ret;
+}
+
+/* Called on the last close, before the netconn goes: the listener takes back its own callback */
+static void socks_reuseport_release(int sockfd)
+{
+    int self = sockfd - LWIP_SOCKET_OFFSET;
+    struct socks_reuseport *rp = &g_sock_reuseport[self];
+    struct tcp_pcb *pcb = NULL;
+    int i;
+
+    LOCK_TCPIP_CORE();
+    if (rp->listening) {
+        i = self;
+        while (g_sock_reuseport[i].next != self) {
+            i = g_sock_reuseport[i].next;
+        }
+        g_sock_reuseport[i].next = rp->next;
+        pcb = (sockets[self].conn != NULL) ? sockets[self].conn->pcb.tcp : NULL;
+        if ((pcb != NULL) && (pcb->state == LISTEN)) {
+            tcp_accept(pcb, rp->accept);
+        }
+    }
+    (void)memset_s(rp, sizeof(*rp), 0, sizeof(*rp));
+    UNLOCK_TCPIP_CORE();
+}
+#endif /* LWIP_TCP */
+
+/*
+ * recvmmsg/sendmmsg over a vector of kernel messages: one socket reference covers the whole
+ * batch and the result of each message goes to its msg_len. Both return the number of messages
+ * done, or a negative errno if the first one failed; a later failure only ends the batch.
+ */
+#if LWIP_UDP
+#define SOCKS_MMSG_BATCH 16
+
+/* Copy one datagram into a pbuf and resolve its destination, NULL means the connected peer */
+static int socks_mmsg_prepare(int sockfd, struct lwip_sock *sock, const struct msghdr *msg,
+                              struct pbuf **p, ip_addr_t *addr, u16_t *port, const ip_addr_t **to)
+{
+    const struct sockaddr *name = (const struct sockaddr *)msg->msg_name;
+    size_t len = 0;
+    size_t off = 0;
+    int i;
+
+    (void)sockfd;
+    *to = NULL;
+    if (name != NULL) {
+        if (!IS_SOCK_ADDR_LEN_VALID(msg->msg_namelen) || !IS_SOCK_ADDR_TYPE_VALID(name) ||
+            !IS_SOCK_ADDR_ALIGNED(name) || !SOCK_ADDR_TYPE_MATCH(name, sock)) {
+            return EINVAL;
+        }
+        SOCKADDR_TO_IPADDR_PORT(name, addr, *port);
+#if LWIP_ENABLE_NET_CAPABILITY && LWIP_ENABLE_CAP_NET_BROADCAST
+        if ((ip_addr_ismulticast(addr) || ip_addr_isbroadcast_bysock(addr, sockfd)) &&
+            !IsCapPermit(CAP_NET_BROADCAST)) {
+            return EPERM;
+        }
+#endif
+#if LWIP_IPV4 && LWIP_IPV6
+        /* Dual-stack: unmap IPv4 mapped IPv6 addresses, as lwip_sendmsg does */
+        if (IP_IS_V6_VAL(*addr) && ip6_addr_isipv4mappedipv6(ip_2_ip6(addr))) {
+            unmap_ipv4_mapped_ipv6(ip_2_ip4(addr), ip_2_ip6(addr));
+            IP_SET_TYPE_VAL(*addr, IPADDR_TYPE_V4);
+        }
+#endif
+        *to = addr;
+    }
+
+    for (i = 0; i < (int)msg->msg_iovlen; i++) {
+        len += msg->msg_iov[i].iov_len;
+        if (len > 0xFFFF) {
+            return EMSGSIZE;
+        }
+    }
+    *p = pbuf_alloc(PBUF_TRANSPORT, (u16_t)len, PBUF_RAM);
+    if (*p == NULL) {
+        return ENOMEM;
+    }
+    for (i = 0; i < (int)msg->msg_iovlen; i++) {
+        (void)pbuf_take_at(*p, msg->msg_iov[i].iov_base, (u16_t)msg->msg_iov[i].iov_len, (u16_t)off);
+        off += msg->msg_iov[i].iov_len;
+    }
+    return 0;
+}
+
+/*
+ * sendmmsg on a plain UDP socket: the datagrams are built outside the core lock, then handed to
+ * udp SOCKS_MMSG_BATCH at a time under a single hold of it, instead of one netconn call each.
+ */
+static int socks_sendmmsg_udp(int sockfd, struct lwip_sock *sock, struct mmsghdr *msgvec, unsigned int vlen)
+{
+    struct pbuf *p[SOCKS_MMSG_BATCH];
+    ip_addr_t addr[SOCKS_MMSG_BATCH];
+    const ip_addr_t *to[SOCKS_MMSG_BATCH];
+    u16_t port[SOCKS_MMSG_BATCH];
+    struct udp_pcb *pcb = NULL;
+    unsigned int done = 0;
+    unsigned int n;
+    unsigned int i;
+    err_t lerr = ERR_OK;
+    int err = 0;
+
+    while ((done < vlen) && (err == 0)) {
+        for (n = 0; (n < SOCKS_MMSG_BATCH) && (done + n < vlen); n++) {
+            err = socks_mmsg_prepare(sockfd, sock, &msgvec[done + n].msg_hdr, &p[n], &addr[n], &port[n], &to[n]);
+            if (err != 0) {
+                break;
+            }
+        }
+
+        LOCK_TCPIP_CORE();
+        pcb = sock->conn->pcb.udp;
+        for (i = 0; i < n; i++) {
+            if ((lerr == ERR_OK) && (pcb == NULL)) {
+                lerr = ERR_CONN;
+            } else if (lerr == ERR_OK) {
+                msgvec[done].msg_len = p[i]->tot_len;
+                lerr = (to[i] != NULL) ? udp_sendto(pcb, p[i], to[i], port[i]) : udp_send(pcb, p[i]);
+                done += (lerr == ERR_OK) ? 1 : 0;
+            }
+            pbuf_free(p[i]);
+        }
+        UNLOCK_TCPIP_CORE();
+
+        if (lerr != ERR_OK) {
+            err = err_to_errno(lerr);
+        }
+    }
+
+    return ((done == 0) && (err != 0)) ? -err : (int)done;
+}
+#endif /* LWIP_UDP */
+
+int socks_sendmmsg(int sockfd, struct mmsghdr *msgvec, unsigned int vlen, int flags)
+{
+    struct lwip_sock *sock = get_socket(sockfd);
+    unsigned int i;
+    ssize_t ret;
+    int err = 0;
+
+    if (!sock) {
+        return -EBADF;
+    }
+
+#if LWIP_UDP
+    if ((sock->conn != NULL) && (netconn_type(sock->conn) == NETCONN_UDP)) {
+        ret = socks_sendmmsg_udp(sockfd, sock, msgvec, vlen);
+        done_socket(sock);
+        return (int)ret;
+    }
+#endif
+
+    for (i = 0; i < vlen; i++) {
+        ret = lwip_sendmsg(sockfd, &msgvec[i].msg_hdr, flags);
+        if (ret < 0) {
+            err = get_errno();
+            break;
+        }
+        msgvec[i].msg_len = (unsigned int)ret;
+    }
+
+    done_socket(sock);
+    return ((i == 0) && (err != 0)) ? -err : (int)i;
+}
+
+/* One datagram off a UDP or raw socket already held, the checks lwip_recvmsg makes first */
+static ssize_t socks_recvmsg_dgram(int sockfd, struct lwip_sock *sock, struct msghdr *msg, int flags)
+{
+    ssize_t buflen = 0;
+    u16_t len = 0;
+    err_t err;
+    int i;
+
+    if ((msg->msg_iov == NULL) || (msg->msg_iovlen <= 0) || (msg->msg_iovlen > IOV_MAX)) {
+        return -EMSGSIZE;
+    }
+    for (i = 0; i < (int)msg->msg_iovlen; i++) {
+        if ((msg->msg_iov[i].iov_base == NULL) || ((ssize_t)msg->msg_iov[i].iov_len <= 0) ||
+            ((ssize_t)(buflen + (ssize_t)msg->msg_iov[i].iov_len) <= 0)) {
+            return -EINVAL;
+        }
+        buflen += (ssize_t)msg->msg_iov[i].iov_len;
+    }
+
+    err = lwip_recvfrom_udp_raw(sock, flags, msg, &len, sockfd);
+    if (err != ERR_OK) {
+        return -err_to_errno(err);
+    }
+    if (len > buflen) {
+        msg->msg_flags |= MSG_TRUNC;
+    }
+    return (ssize_t)len;
+}
+
+/*
+ * MSG_WAITFORONE turns on MSG_DONTWAIT after the first message. The deadline, a sys_now() value,
+ * is only checked after each message, as on Linux: a blocking receive is not cut short by it.
+ * Datagram sockets are read straight from the socket held for the batch.
+ */
+int socks_recvmmsg(int sockfd, struct mmsghdr *msgvec, unsigned int vlen, int flags, const u32_t *deadline)
+{
+    struct lwip_sock *sock = get_socket(sockfd);
+    int waitforone = flags & MSG_WAITFORONE;
+    int dgram;
+    unsigned int i;
+    ssize_t ret;
+    int err = 0;
+
+    if (!sock) {
+        return -EBADF;
+    }
+
+    dgram = (sock->conn != NULL) && (NETCONNTYPE_GROUP(netconn_type(sock->conn)) != NETCONN_TCP);
+    flags &= ~MSG_WAITFORONE;
+    for (i = 0; i < vlen; i++) {
+        if (dgram) {
+            ret = socks_recvmsg_dgram(sockfd, sock, &msgvec[i].msg_hdr, flags);
+            err = (ret < 0) ? (int)-ret : 0;
+        } else {
+            ret = lwip_recvmsg(sockfd, &msgvec[i].msg_hdr, flags);
+            err = (ret < 0) ? get_errno() : 0;
+        }
+        if (ret < 0) {
+            break;
+        }
+        msgvec[i].msg_len = (unsigned int)ret;
+        if (waitforone) {
+            flags |= MSG_DONTWAIT;
+        }
+        if ((deadline != NULL) && ((s32_t)(sys_now() - *deadline) >= 0)) {
+            i++;
+            break;
+        }
+    }
+
+    done_socket(sock);
+    return ((i == 0) && (err != 0)) ? -err : (int)i;
+}
@@ -32,13 +32,20 @@
 #include <arch/sys_arch.h>
 #include <lwip/sys.h>
 #include <lwip/debug.h>
+#include <lwip/ip.h>
+#include <lwip/netif.h>
+#include <lwip/tcpip.h>
+#include <lwip/prot/ethernet.h>
+#include <netif/ethernet.h>
 #include <los_task.h>
 #include <los_sys_pri.h>
+#include <los_task_pri.h>
 #include <los_tick.h>
 #include <los_queue.h>
 #include <los_sem.h>
 #include <los_mux.h>
 #include <los_spinlock.h>
+#include <securec.h>
 
 #if (LOSCFG_KERNEL_SMP == YES)
 SPIN_LOCK_INIT(arch_protect_spin);
@@ -48,6 +55,8 @@ static int lwprot_count = 0;
 
 #define ROUND_UP_DIV(val, div) (((val) + (div) - 1) / (div))
 
+static void sys_input_init(void);
+
 /**
  * Thread and System misc
  */
@@ -80,6 +89,8 @@ void sys_init(void)
     UINT32 seedhsb, seedlsb;
     LOS_GetCpuCycle(&seedhsb, &seedlsb);
     srand(seedlsb);
+
+    sys_input_init();
 }
 
 u32_t sys_now(void)
@@ -88,7 +99,26 @@ u32_t sys_now(void)
     return (u32_t)((LOS_TickCountGet() * OS_SYS_MS_PER_SECOND) / LOSCFG_BASE_CORE_TICK_PER_SECOND);
 }
 
-#if (LWIP_CHKSUM_ALGORITHM == 4) /* version #4, asm based */
+#if defined(LOSCFG_ARCH_FPU_VFP_NEON)
+#include "in_cksum.h"
+static inline u16_t sys_chksum_fold(u32_t sum)
+{
+    sum = (sum & 0xffff) + (sum >> 16);
+    sum = (sum & 0xffff) + (sum >> 16);
+    return (u16_t)sum;
+}
+
+u16_t lwip_neon_chksum(const void *dataptr, int len)
+{
+    return sys_chksum_fold(csum_partial_neon(dataptr, len, 0));
+}
+
+/* LWIP_CHECKSUM_ON_COPY: one pass over the data instead of memcpy followed by a checksum */
+u16_t lwip_neon_chksum_copy(void *dst, const void *src, u16_t len)
+{
+    return sys_chksum_fold(csum_partial_copy_neon(src, dst, len, 0));
+}
+#elif (LWIP_CHKSUM_ALGORITHM == 4) /* version #4, asm based */
 #include "in_cksum.h"
 u16_t lwip_standard_chksum(const void *dataptr, int len)
 {
@@ -142,6 +172,356 @@ void sys_arch_unprotect(sys_prot_t pval)
 }
 
 
+/**
+ * Input workers
+ *
+ * Packets from the drivers are queued on the backlog ring of one input thread per core, picked
+ * by a hash of their addresses so every flow stays in order on one thread. A worker takes up to
+ * LWIP_INPUT_BUDGET packets per round and runs their protocol input under a single hold of the
+ * tcpip core lock, the same way LWIP_TCPIP_CORE_LOCKING lets socket calls run in the caller's
+ * context; tcpip_thread is left with timers and callbacks. Producers only post the worker's
+ * semaphore when it is idle, so a busy worker takes no wakeups at all.
+ *
+ * The lwIP core is not reentrant, so protocol input itself is still serialized by the core lock
+ * across all workers, and the budget bounds how long one of them holds it. What runs in parallel
+ * is the rest: driver polling, queueing and the per-packet wakeups that a tcpip_thread mailbox
+ * used to cost, while the core lock is taken once per batch instead of once per packet.
+ *
+ * Interfaces with a drv_poll hook can switch to polling (NAPI style): the driver masks its
+ * receive interrupt and calls driverif_rx_schedule(), then the worker that owns the interface
+ * calls drv_poll with a budget each round, outside the core lock, until it returns less than
+ * the budget. At that point the driver must have unmasked its interrupt again.
+ */
+
+#define NAPI_STATE_SCHED    0x1U    /* on a poll list or being polled */
+#define NAPI_STATE_MISSED   0x2U    /* scheduled again while being polled */
+
+typedef struct {
+    SPIN_LOCK_S lock;                           /* protects everything below, taken from interrupts */
+    struct pbuf *ring[LWIP_INPUT_BACKLOG];
+    u32_t head;
+    u32_t count;
+    struct netif *pollList;                     /* interfaces scheduled for polling */
+    struct netif **pollTail;
+    int idle;                                   /* sleeping on sem, the next producer posts it */
+    sys_sem_t sem;
+} sys_input_worker_t;
+
+static sys_input_worker_t g_inputWorkers[LWIP_NUM_INPUT_THREADS];
+static volatile int g_inputReady = 0;
+
+#if LWIP_NUM_INPUT_THREADS > 1
+static u32_t sys_flow_hash(const struct pbuf *p)
+{
+    const u8_t *data = (const u8_t *)p->payload;
+    u16_t off = SIZEOF_ETH_HDR;
+    u16_t type;
+    u32_t hash = 0;
+    int i;
+
+    if (p->len < off) {
+        return 0;
+    }
+    type = ((const struct eth_hdr *)data)->type;
+    if (type == PP_HTONS(ETHTYPE_VLAN)) {
+        if (p->len < (off + SIZEOF_VLAN_HDR)) {
+            return 0;
+        }
+        type = ((const struct eth_vlan_hdr *)(data + off))->tpid;
+        off += SIZEOF_VLAN_HDR;
+    }
+
+    if (type == PP_HTONS(ETHTYPE_IP)) {
+        const struct ip_hdr *iph = (const struct ip_hdr *)(data + off);
+        if (p->len < (off + IP_HLEN)) {
+            return 0;
+        }
+        /*
+         * Only what every fragment of a datagram carries may pick the worker, or fragments and
+         * whole datagrams of one flow would be reordered against each other: addresses and
+         * protocol, never ports.
+         */
+        hash = iph->src.addr ^ iph->dest.addr ^ IPH_PROTO(iph);
+#if LWIP_IPV6
+    } else if (type == PP_HTONS(ETHTYPE_IPV6)) {
+        const struct ip6_hdr *ip6h = (const struct ip6_hdr *)(data + off);
+        if (p->len < (off + IP6_HLEN)) {
+            return 0;
+        }
+        /* the next header of a fragment is the fragment header, so IPv6 hashes addresses only */
+        for (i = 0; i < 4; i++) {
+            hash ^= ip6h->src.addr[i] ^ ip6h->dest.addr[i];
+        }
+#endif
+    } else {
+        return 0; /* ARP and the rest go to the first worker */
+    }
+
+    /* fold, so the low bits that pick the worker depend on every input bit */
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3bU;
+    hash ^= hash >> 16;
+    (void)i;
+    return hash;
+}
+
+#define SYS_INPUT_WORKER(p) (sys_flow_hash(p) % LWIP_NUM_INPUT_THREADS)
+#else
+#define SYS_INPUT_WORKER(p) 0
+#endif /* LWIP_NUM_INPUT_THREADS > 1 */
+
+static void sys_input_one(struct pbuf *p)
+{
+    struct netif *netif = NULL;
+    err_t ret;
+
+    /* the interface may have been removed while the packet was queued */
+    netif = netif_get_by_index(p->if_idx);
+    if (netif == NULL) {
+        ret = ERR_IF;
+    } else if (netif->flags & (NETIF_FLAG_ETHARP | NETIF_FLAG_ETHERNET)) {
+        ret = ethernet_input(p, netif);
+    } else {
+        ret = ip_input(p, netif);
+    }
+    if (ret != ERR_OK) {
+        (void)pbuf_free(p);
+    }
+}
+
+/* Queue up to count packets on one worker, returns how many fit; the caller owns the rest */
+static u32_t sys_input_enqueue(sys_input_worker_t *w, struct pbuf **pkts, u32_t count)
+{
+    u32_t intSave;
+    u32_t n = 0;
+    int wake;
+
+    LOS_SpinLockSave(&w->lock, &intSave);
+    while ((n < count) && (w->count < LWIP_INPUT_BACKLOG)) {
+        w->ring[(w->head + w->count) % LWIP_INPUT_BACKLOG] = pkts[n++];
+        w->count++;
+    }
+    wake = w->idle && (n != 0);
+    if (wake) {
+        w->idle = 0;
+    }
+    LOS_SpinUnlockRestore(&w->lock, intSave);
+
+    if (wake) {
+        sys_sem_signal(&w->sem);
+    }
+    return n;
+}
+
+/* Take the current poll list and poll each interface once, outside the core lock */
+static void sys_input_poll(sys_input_worker_t *w)
+{
+    struct netif *list = NULL;
+    struct netif *netif = NULL;
+    u32_t intSave;
+    u32_t done;
+
+    LOS_SpinLockSave(&w->lock, &intSave);
+    list = w->pollList;
+    w->pollList = NULL;
+    w->pollTail = &w->pollList;
+    LOS_SpinUnlockRestore(&w->lock, intSave);
+
+    while (list != NULL) {
+        netif = list;
+        list = netif->napi_next;
+        netif->napi_next = NULL;
+
+        done = netif->drv_poll(netif, LWIP_INPUT_BUDGET);
+
+        LOS_SpinLockSave(&w->lock, &intSave);
+        if ((done >= LWIP_INPUT_BUDGET) || (netif->napi_state & NAPI_STATE_MISSED)) {
+            /* still busy, or the interrupt fired while polling: poll again next round */
+            netif->napi_state = NAPI_STATE_SCHED;
+            *w->pollTail = netif;
+            w->pollTail = &netif->napi_next;
+        } else {
+            netif->napi_state = 0;
+        }
+        LOS_SpinUnlockRestore(&w->lock, intSave);
+    }
+}
+
+static void sys_input_drain(sys_input_worker_t *w)
+{
+    struct pbuf *batch[LWIP_INPUT_BUDGET];
+    u32_t intSave;
+    u32_t n = 0;
+    u32_t i;
+
+    LOS_SpinLockSave(&w->lock, &intSave);
+    while ((n < LWIP_INPUT_BUDGET) && (w->count > 0)) {
+        batch[n++] = w->ring[w->head];
+        w->head = (w->head + 1) % LWIP_INPUT_BACKLOG;
+        w->count--;
+    }
+    LOS_SpinUnlockRestore(&w->lock, intSave);
+
+    if (n == 0) {
+        return;
+    }
+    LOCK_TCPIP_CORE();
+#if LWIP_GRO
+    n = driverif_gro_receive(batch, n);
+#endif
+    for (i = 0; i < n; i++) {
+        sys_input_one(batch[i]);
+    }
+    UNLOCK_TCPIP_CORE();
+}
+
+static void sys_input_thread(void *arg)
+{
+    sys_input_worker_t *w = (sys_input_worker_t *)arg;
+    u32_t intSave;
+    int idle;
+
+    while (1) {
+        sys_input_poll(w);
+        sys_input_drain(w);
+
+        LOS_SpinLockSave(&w->lock, &intSave);
+        idle = (w->count == 0) && (w->pollList == NULL);
+        w->idle = idle;
+        LOS_SpinUnlockRestore(&w->lock, intSave);
+        if (idle) {
+            (void)sys_arch_sem_wait(&w->sem, 0);
+        }
+    }
+}
+
+static void sys_input_init(void)
+{
+    static char names[LWIP_NUM_INPUT_THREADS][sizeof("tcpip_in") + 3];
+    sys_input_worker_t *w = NULL;
+    sys_thread_t thread;
+    int i;
+
+    for (i = 0; i < LWIP_NUM_INPUT_THREADS; i++) {
+        w = &g_inputWorkers[i];
+        LOS_SpinInit(&w->lock);
+        w->pollTail = &w->pollList;
+        if (sys_sem_new(&w->sem, 0) != ERR_OK) {
+            return;
+        }
+        (void)snprintf_s(names[i], sizeof(names[i]), sizeof(names[i]) - 1, "tcpip_in%d", i);
+        thread = sys_thread_new(names[i], sys_input_thread, w, TCPIP_THREAD_STACKSIZE, TCPIP_THREAD_PRIO);
+        if (thread == (sys_thread_t)-1) {
+            return;
+        }
+#if (LOSCFG_KERNEL_SMP == YES)
+        (void)LOS_TaskCpuAffiSet(thread, CPUID_TO_AFFI_MASK(i % LOSCFG_KERNEL_CORE_NUM));
+#endif
+    }
+
+    /* until every worker is up, input keeps going through tcpip_thread */
+    g_inputReady = 1;
+}
+
+err_t sys_netif_input(struct pbuf *p, struct netif *inp)
+{
+    if (!g_inputReady) {
+        return tcpip_input(p, inp);
+    }
+
+    p->if_idx = netif_get_index(inp);
+    return (sys_input_enqueue(&g_inputWorkers[SYS_INPUT_WORKER(p)], &p, 1) == 1) ? ERR_OK : ERR_MEM;
+}
+
+u32_t sys_netif_input_batch(struct netif *inp, struct pbuf **pkts, u32_t count)
+{
+    struct pbuf *group[LWIP_INPUT_BUDGET];
+    u8_t worker[LWIP_INPUT_BUDGET];
+    u32_t accepted = 0;
+    u32_t chunk;
+    u32_t n;
+    u32_t i;
+    int w;
+    /* read once: the workers coming up halfway through must not split a chunk between paths */
+    int ready = g_inputReady;
+
+    while (count > 0) {
+        chunk = LWIP_MIN(count, LWIP_INPUT_BUDGET);
+        for (i = 0; i < chunk; i++) {
+            if (ready) {
+                pkts[i]->if_idx = netif_get_index(inp);
+                worker[i] = (u8_t)SYS_INPUT_WORKER(pkts[i]);
+            } else if (tcpip_input(pkts[i], inp) == ERR_OK) {
+                accepted++;
+                pkts[i] = NULL;
+            } else {
+                (void)pbuf_free(pkts[i]);
+                pkts[i] = NULL;
+            }
+        }
+
+        /* one lock round trip and at most one wakeup per worker for the whole chunk */
+        for (w = 0; ready && (w < LWIP_NUM_INPUT_THREADS); w++) {
+            for (i = 0, n = 0; i < chunk; i++) {
+                if (worker[i] == w) {
+                    group[n++] = pkts[i];
+                }
+            }
+            if (n == 0) {
+                continue;
+            }
+            i = sys_input_enqueue(&g_inputWorkers[w], group, n);
+            accepted += i;
+            for (; i < n; i++) {
+                (void)pbuf_free(group[i]);
+            }
+        }
+
+        pkts += chunk;
+        count -= chunk;
+    }
+
+    return accepted;
+}
+
+void sys_netif_poll_schedule(struct netif *netif)
+{
+    sys_input_worker_t *w = &g_inputWorkers[netif_get_index(netif) % LWIP_NUM_INPUT_THREADS];
+    u32_t intSave;
+    int wake;
+
+    if (!g_inputReady) {
+        /* no workers: poll to completion here, packets go through tcpip_thread */
+        while (netif->drv_poll(netif, LWIP_INPUT_BUDGET) >= LWIP_INPUT_BUDGET) {
+        }
+        return;
+    }
+
+    LOS_SpinLockSave(&w->lock, &intSave);
+    if (netif->napi_state & NAPI_STATE_SCHED) {
+        netif->napi_state |= NAPI_STATE_MISSED;
+        LOS_SpinUnlockRestore(&w->lock, intSave);
+        return;
+    }
+    netif->napi_state = NAPI_STATE_SCHED;
+    netif->napi_next = NULL;
+    *w->pollTail = netif;
+    w->pollTail = &netif->napi_next;
+    wake = w->idle;
+    w->idle = 0;
+    LOS_SpinUnlockRestore(&w->lock, intSave);
+
+    if (wake) {
+        sys_sem_signal(&w->sem);
+    }
+}
+
+int sys_tcpip_core_locked(void)
+{
+    return lock_tcpip_core.owner == (VOID *)OsCurrTaskGet();
+}
+
+
 /**
  * MessageBox
  */
@@ -36,6 +36,7 @@
 #include "linux/wait.h"
 #include "fs/fs.h"
 #include "fs_poll_pri.h"
+#include "fs_epoll.h"
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -68,6 +69,7 @@ typedef struct {
     BOOL eventPend;
     EVENT_CB_S eventTelnet;
     wait_queue_head_t wait;
+    struct EpollWatch watch; /* tells epoll about new commands, as wait does for poll */
     TELNTE_FIFO_S *cmdFifo;  /* use a FIFO to store user's commands */
 } TELNET_DEV_S;
 
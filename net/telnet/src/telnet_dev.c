@@ -132,6 +132,7 @@ INT32 TelnetTx(const CHAR *buf, UINT32 bufLen)
     }
     /* notify the command resolver task */
     notify_poll(&telnetDev->wait);
+    EpollWatchNotify(&telnetDev->watch, POLLIN | POLLRDNORM);
     TelnetUnlock();
 
     return (INT32)bufLen;
@@ -185,6 +186,7 @@ STATIC INT32 TelnetClose(struct file *file)
     if (telnetDev != NULL) {
         wait = &telnetDev->wait;
         LOS_ListDelete(&wait->poll_queue);
+        EpollWatchDetach(&telnetDev->watch);
         free(telnetDev->cmdFifo);
         telnetDev->cmdFifo = NULL;
         (VOID)LOS_EventDestroy(&telnetDev->eventTelnet);
@@ -351,9 +353,38 @@ STATIC const struct file_operations_vfs g_telnetOps = {
     NULL,
 };
 
+STATIC UINT32 TelnetEpollEvents(struct EpollWatch *watch)
+{
+    TELNET_DEV_S *telnetDev = LOS_DL_LIST_ENTRY(watch, TELNET_DEV_S, watch);
+    UINT32 events = 0;
+
+    TelnetLock();
+    if ((telnetDev->cmdFifo != NULL) && (telnetDev->cmdFifo->fifoNum != FIFO_MAX)) {
+        events = POLLIN | POLLRDNORM;
+    }
+    TelnetUnlock();
+    return events;
+}
+
+STATIC const struct EpollWatchOps g_telnetWatchOps = {
+    TelnetEpollEvents,
+    NULL,
+    NULL,
+};
+
+/* Called by epoll under its registry lock, must not sleep */
+STATIC struct EpollWatch *TelnetEpollWatch(struct file *file)
+{
+    TELNET_DEV_S *telnetDev = GetTelnetDevByFile(file, FALSE);
+
+    return (telnetDev != NULL) ? &telnetDev->watch : NULL;
+}
+
 /* Once the telnet server stopped, remove the telnet device file. */
 INT32 TelnetedUnregister(VOID)
 {
+    EpollWatchDetach(&g_telnetDev.watch);
+    EpollDriverUnregister(&g_telnetOps);
     free(g_telnetDev.cmdFifo);
     g_telnetDev.cmdFifo = NULL;
     (VOID)unregister_driver(TELNET);
@@ -370,9 +401,14 @@ INT32 TelnetedRegister(VOID)
     g_telnetDev.cmdFifo = NULL;
     g_telnetDev.eventPend = TRUE;
 
+    EpollWatchInit(&g_telnetDev.watch, &g_telnetWatchOps);
     ret = register_driver(TELNET, &g_telnetOps, TELNET_DEV_DRV_MODE, &g_telnetDev);
     if (ret != 0) {
         PRINT_ERR("Telnet register driver error.\n");
+        return ret;
+    }
+    if (EpollDriverRegister(&g_telnetOps, TelnetEpollWatch) != 0) {
+        PRINT_ERR("Telnet epoll hook error.\n"); /* epoll falls back to poll() */
     }
     return ret;
 }
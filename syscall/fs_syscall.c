@@ -54,6 +54,11 @@
 #include "los_strncpy_from_user.h"
 #include "fs_other.h"
 #include "fs_file.h"
+#include "fs_epoll.h"
+#include "fs_eventfd.h"
+#include "fs_uring.h"
+#include "fs_splice.h"
+#include "fs_getdents.h"
 #include "capability_type.h"
 #include "capability_api.h"
 
@@ -242,6 +247,20 @@ ssize_t SysRead(int fd, void *buf, size_t nbytes)
     return ret;
 }
 
+/* pace a writer by the dirty page cache of its disk as well as by the block cache it wrote to */
+static void WriteBalanceDirty(int sysfd)
+{
+#ifdef LOSCFG_KERNEL_VM
+    struct file *filep = NULL;
+
+    if (fs_getfilep(sysfd, &filep) >= 0) {
+        balance_file_mappings(filep);
+    }
+#else
+    (void)sysfd;
+#endif
+}
+
 ssize_t SysWrite(int fd, const void *buf, size_t nbytes)
 {
     int ret;
@@ -261,6 +280,7 @@ ssize_t SysWrite(int fd, const void *buf, size_t nbytes)
     if (ret < 0) {
         return -get_errno();
     }
+    WriteBalanceDirty(fd);
     return ret;
 }
 
@@ -532,6 +552,7 @@ int SysMount(const char *source, const char *target, const char *filesystemtype,
     int ret;
     char *sourceRet = NULL;
     char *targetRet = NULL;
+    char *dataRet = NULL;
     char fstypeRet[FILESYSTEM_TYPE_MAX + 1] = {0};
 
     if (!IsCapPermit(CAP_FS_MOUNT)) {
@@ -554,12 +575,20 @@ int SysMount(const char *source, const char *target, const char *filesystemtype,
             goto OUT;
         }
 
-        if (strcmp(fstypeRet, "ramfs") && (source != NULL)) {
+        if (strcmp(fstypeRet, "ramfs") && strcmp(fstypeRet, "tmpfs") && (source != NULL)) {
             ret = UserPathCopy(source, &sourceRet);
             if (ret != 0) {
                 goto OUT;
             }
         }
+        /* tmpfs parses its option string, which must not be read from user memory */
+        if ((strcmp(fstypeRet, "tmpfs") == 0) && (data != NULL)) {
+            ret = UserPathCopy((const char *)data, &dataRet);
+            if (ret != 0) {
+                goto OUT;
+            }
+            data = dataRet;
+        }
 #ifdef LOSCFG_FS_NFS
         if (strcmp(fstypeRet, "nfs") == 0) {
             ret = NfsMount(sourceRet, targetRet, 0, 0);
@@ -580,6 +609,9 @@ OUT:
     if (targetRet != NULL) {
         (void)LOS_MemFree(OS_SYS_MEM_ADDR, targetRet);
     }
+    if (dataRet != NULL) {
+        (void)LOS_MemFree(OS_SYS_MEM_ADDR, dataRet);
+    }
     return ret;
 }
 
@@ -862,6 +894,293 @@ int SysPipe(int pipefd[2]) /* 2 : pipe fds for read and write */
 }
 #endif
 
+int SysEpollCreate1(int flags)
+{
+    int sysFd;
+    int procFd = AllocProcessFd();
+    if (procFd < 0) {
+        return -EMFILE;
+    }
+
+    sysFd = EpollCreate(flags);
+    if (sysFd < 0) {
+        FreeProcessFd(procFd);
+        return sysFd;
+    }
+
+    AssociateSystemFd(procFd, sysFd);
+    return procFd;
+}
+
+int SysEpollCreate(int size)
+{
+    if (size <= 0) {
+        return -EINVAL;
+    }
+
+    return SysEpollCreate1(0);
+}
+
+int SysEpollCtl(int epfd, int op, int fd, struct epoll_event *event)
+{
+    struct epoll_event eventRet = { 0 };
+    int epSysFd = GetAssociatedSystemFd(epfd);
+    int sysFd = GetAssociatedSystemFd(fd);
+
+    if ((epSysFd < 0) || (sysFd < 0)) {
+        return -EBADF;
+    }
+
+    if (op != EPOLL_CTL_DEL) {
+        if (event == NULL) {
+            return -EFAULT;
+        }
+        if (LOS_ArchCopyFromUser(&eventRet, event, sizeof(struct epoll_event)) != 0) {
+            return -EFAULT;
+        }
+    }
+
+    return EpollCtl(epSysFd, op, sysFd, &eventRet);
+}
+
+int SysEpollWait(int epfd, struct epoll_event *events, int maxevents, int timeout)
+{
+    int ret;
+    struct epoll_event *eventsRet = NULL;
+    int epSysFd = GetAssociatedSystemFd(epfd);
+
+    if (epSysFd < 0) {
+        return -EBADF;
+    }
+    if ((maxevents <= 0) || (maxevents > EPOLL_MAX_EVENTS)) {
+        return -EINVAL;
+    }
+    if ((events == NULL) || !LOS_IsUserAddressRange((vaddr_t)(UINTPTR)events,
+                                                    sizeof(struct epoll_event) * maxevents)) {
+        return -EFAULT;
+    }
+
+    eventsRet = (struct epoll_event *)malloc(sizeof(struct epoll_event) * maxevents);
+    if (eventsRet == NULL) {
+        return -ENOMEM;
+    }
+
+    ret = EpollWait(epSysFd, eventsRet, maxevents, timeout);
+    if ((ret > 0) && (LOS_ArchCopyToUser(events, eventsRet, sizeof(struct epoll_event) * ret) != 0)) {
+        ret = -EFAULT;
+    }
+
+    free(eventsRet);
+    return ret;
+}
+
+int SysEpollPwait(int epfd, struct epoll_event *events, int maxevents, int timeout, const sigset_t_l *mask)
+{
+    int ret;
+    unsigned int intSave;
+    sigset_t setRet;
+    sigset_t oldSet = 0;
+    LosTaskCB *runTask = NULL;
+
+    if (mask != NULL) {
+        if (LOS_ArchCopyFromUser(&setRet, &(mask->sig[0]), sizeof(sigset_t)) != 0) {
+            return -EFAULT;
+        }
+        SCHEDULER_LOCK(intSave);
+        runTask = OsCurrTaskGet();
+        oldSet = runTask->sig.sigprocmask;
+        runTask->sig.sigprocmask = setRet;
+        SCHEDULER_UNLOCK(intSave);
+    }
+
+    ret = SysEpollWait(epfd, events, maxevents, timeout);
+
+    if (mask != NULL) {
+        SCHEDULER_LOCK(intSave);
+        runTask->sig.sigprocmask = oldSet;
+        SCHEDULER_UNLOCK(intSave);
+    }
+    return ret;
+}
+
+static int InstallAnonFd(int procFd, int sysFd)
+{
+    if (sysFd < 0) {
+        FreeProcessFd(procFd);
+        return sysFd;
+    }
+
+    AssociateSystemFd(procFd, sysFd);
+    return procFd;
+}
+
+int SysEventfd2(unsigned int initval, int flags)
+{
+    int procFd = AllocProcessFd();
+    if (procFd < 0) {
+        return -EMFILE;
+    }
+
+    return InstallAnonFd(procFd, EventfdCreate(initval, flags));
+}
+
+int SysEventfd(unsigned int initval)
+{
+    return SysEventfd2(initval, 0);
+}
+
+int SysTimerfdCreate(int clockid, int flags)
+{
+    int procFd = AllocProcessFd();
+    if (procFd < 0) {
+        return -EMFILE;
+    }
+
+    return InstallAnonFd(procFd, TimerfdCreate(clockid, flags));
+}
+
+int SysTimerfdSettime(int fd, int flags, const struct itimerspec *newValue, struct itimerspec *oldValue)
+{
+    int ret;
+    struct itimerspec newRet;
+    struct itimerspec oldRet = { 0 };
+    int sysFd = GetAssociatedSystemFd(fd);
+
+    if (sysFd < 0) {
+        return -EBADF;
+    }
+    if ((newValue == NULL) || (LOS_ArchCopyFromUser(&newRet, newValue, sizeof(struct itimerspec)) != 0)) {
+        return -EFAULT;
+    }
+
+    ret = TimerfdSettime(sysFd, flags, &newRet, (oldValue != NULL) ? &oldRet : NULL);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if ((oldValue != NULL) && (LOS_ArchCopyToUser(oldValue, &oldRet, sizeof(struct itimerspec)) != 0)) {
+        return -EFAULT;
+    }
+    return ret;
+}
+
+int SysTimerfdGettime(int fd, struct itimerspec *value)
+{
+    int ret;
+    struct itimerspec valueRet = { 0 };
+    int sysFd = GetAssociatedSystemFd(fd);
+
+    if (sysFd < 0) {
+        return -EBADF;
+    }
+
+    ret = TimerfdGettime(sysFd, &valueRet);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if ((value == NULL) || (LOS_ArchCopyToUser(value, &valueRet, sizeof(struct itimerspec)) != 0)) {
+        return -EFAULT;
+    }
+    return ret;
+}
+
+int SysSignalfd4(int fd, const sigset_t_l *mask, size_t sigsetsize, int flags)
+{
+    int ret;
+    int sysFd;
+    sigset_t maskRet;
+
+    if ((mask == NULL) || (sigsetsize < sizeof(sigset_t))) {
+        return -EINVAL;
+    }
+    if (LOS_ArchCopyFromUser(&maskRet, &(mask->sig[0]), sizeof(sigset_t)) != 0) {
+        return -EFAULT;
+    }
+
+    if (fd == -1) {
+        int procFd = AllocProcessFd();
+        if (procFd < 0) {
+            return -EMFILE;
+        }
+        return InstallAnonFd(procFd, SignalfdCreate(maskRet, flags));
+    }
+
+    sysFd = GetAssociatedSystemFd(fd);
+    if (sysFd < 0) {
+        return -EBADF;
+    }
+    ret = SignalfdUpdate(sysFd, maskRet);
+    return (ret < 0) ? ret : fd;
+}
+
+int SysSignalfd(int fd, const sigset_t_l *mask, size_t sigsetsize)
+{
+    return SysSignalfd4(fd, mask, sigsetsize, 0);
+}
+
+int SysIoUringSetup(unsigned int entries, struct io_uring_params *params)
+{
+    struct io_uring_params paramsRet;
+    int sysFd;
+    int procFd;
+
+    if ((params == NULL) || (LOS_ArchCopyFromUser(&paramsRet, params, sizeof(struct io_uring_params)) != 0)) {
+        return -EFAULT;
+    }
+
+    procFd = AllocProcessFd();
+    if (procFd < 0) {
+        return -EMFILE;
+    }
+
+    sysFd = UringSetup(entries, &paramsRet);
+    if ((sysFd >= 0) && (LOS_ArchCopyToUser(params, &paramsRet, sizeof(struct io_uring_params)) != 0)) {
+        (void)close(sysFd);
+        sysFd = -EFAULT;
+    }
+
+    return InstallAnonFd(procFd, sysFd);
+}
+
+int SysIoUringEnter(int fd, unsigned int toSubmit, unsigned int minComplete, unsigned int flags,
+                    const sigset_t_l *mask, size_t sigsetsize)
+{
+    int ret;
+    unsigned int intSave;
+    sigset_t setRet;
+    sigset_t oldSet = 0;
+    LosTaskCB *runTask = NULL;
+    int sysFd = GetAssociatedSystemFd(fd);
+
+    if (sysFd < 0) {
+        return -EBADF;
+    }
+
+    if (mask != NULL) {
+        if (sigsetsize < sizeof(sigset_t)) {
+            return -EINVAL;
+        }
+        if (LOS_ArchCopyFromUser(&setRet, &(mask->sig[0]), sizeof(sigset_t)) != 0) {
+            return -EFAULT;
+        }
+        SCHEDULER_LOCK(intSave);
+        runTask = OsCurrTaskGet();
+        oldSet = runTask->sig.sigprocmask;
+        runTask->sig.sigprocmask = setRet;
+        SCHEDULER_UNLOCK(intSave);
+    }
+
+    ret = UringEnter(sysFd, toSubmit, minComplete, flags);
+
+    if (mask != NULL) {
+        SCHEDULER_LOCK(intSave);
+        runTask->sig.sigprocmask = oldSet;
+        SCHEDULER_UNLOCK(intSave);
+    }
+    return ret;
+}
+
 int SysDup2(int fd1, int fd2)
 {
     int ret;
@@ -1324,6 +1643,8 @@ ssize_t SysWritev(int fd, const struct iovec *iov, int iovcnt)
     ret = writev(fd, iovRet, valid_iovcnt);
     if (ret < 0) {
         ret = -get_errno();
+    } else {
+        WriteBalanceDirty(fd);
     }
 
 OUT_FREE:
@@ -1482,6 +1803,7 @@ ssize_t SysPwrite64(int fd, const void *buf, size_t nbytes, off64_t offset)
     }
 
     (void)LOS_MemFree(OS_SYS_MEM_ADDR, bufRet);
+    WriteBalanceDirty(fd);
     return ret;
 }
 
@@ -1516,25 +1838,70 @@ char *SysGetcwd(char *buf, size_t n)
 
 ssize_t SysSendFile(int outfd, int infd, off_t *offset, size_t count)
 {
-    int ret, retVal;
-    off_t offsetRet;
+    ssize_t ret;
+    int retVal;
+    off_t offsetRet = 0;
 
-    retVal = LOS_ArchCopyFromUser(&offsetRet, offset, sizeof(off_t));
-    if (retVal != 0) {
-        return -EFAULT;
+    if (offset != NULL) {
+        retVal = LOS_ArchCopyFromUser(&offsetRet, offset, sizeof(off_t));
+        if (retVal != 0) {
+            return -EFAULT;
+        }
     }
 
     /* Process fd convert to system global fd */
     outfd = GetAssociatedSystemFd(outfd);
     infd = GetAssociatedSystemFd(infd);
 
-    ret = sendfile(outfd, infd, (offset ? (&offsetRet) : NULL), count);
+    ret = SpliceSendFile(outfd, infd, (offset ? (&offsetRet) : NULL), count);
+    if (ret == -EOPNOTSUPP) {
+        ret = sendfile(outfd, infd, (offset ? (&offsetRet) : NULL), count);
+        if (ret < 0) {
+            return -get_errno();
+        }
+    } else if (ret < 0) {
+        return ret;
+    }
+
+    if (offset != NULL) {
+        retVal = LOS_ArchCopyToUser(offset, &offsetRet, sizeof(off_t));
+        if (retVal != 0) {
+            return -EFAULT;
+        }
+    }
+
+    return ret;
+}
+
+ssize_t SysSplice(int fdIn, off_t *offIn, int fdOut, off_t *offOut, size_t len, unsigned int flags)
+{
+    ssize_t ret;
+    off_t offInRet = 0;
+    off_t offOutRet = 0;
+
+    if ((offIn != NULL) && (LOS_ArchCopyFromUser(&offInRet, offIn, sizeof(off_t)) != 0)) {
+        return -EFAULT;
+    }
+    if ((offOut != NULL) && (LOS_ArchCopyFromUser(&offOutRet, offOut, sizeof(off_t)) != 0)) {
+        return -EFAULT;
+    }
+
+    /* Process fd convert to system global fd */
+    fdIn = GetAssociatedSystemFd(fdIn);
+    fdOut = GetAssociatedSystemFd(fdOut);
+    if ((fdIn < 0) || (fdOut < 0)) {
+        return -EBADF;
+    }
+
+    ret = SpliceFd(fdIn, (offIn ? (&offInRet) : NULL), fdOut, (offOut ? (&offOutRet) : NULL), len, flags);
     if (ret < 0) {
-        return -get_errno();
+        return ret;
     }
 
-    retVal = LOS_ArchCopyToUser(offset, &offsetRet, sizeof(off_t));
-    if (retVal != 0) {
+    if ((offIn != NULL) && (LOS_ArchCopyToUser(offIn, &offInRet, sizeof(off_t)) != 0)) {
+        return -EFAULT;
+    }
+    if ((offOut != NULL) && (LOS_ArchCopyToUser(offOut, &offOutRet, sizeof(off_t)) != 0)) {
         return -EFAULT;
     }
 
@@ -1788,6 +2155,8 @@ ssize_t SysPwritev(int fd, const struct iovec *iov, int iovcnt, long loffset, lo
     ret = pwritev(fd, iovRet, valid_iovcnt, offsetflag);
     if (ret < 0) {
         ret = -get_errno();
+    } else {
+        WriteBalanceDirty(fd);
     }
 
 OUT_FREE:
@@ -1868,23 +2237,22 @@ int SysGetdents64(int fd, struct dirent *de_user, unsigned int count)
         return -EFAULT;
     }
 
-    struct dirent *de_knl = NULL;
-
     /* Process fd convert to system global fd */
     fd = GetAssociatedSystemFd(fd);
 
-    int ret = do_readdir(fd, &de_knl, count);
-    if (ret < 0) {
-        return ret;
-    }
-    if (de_knl != NULL) {
-        int cpy_ret = LOS_ArchCopyToUser(de_user, de_knl, ret);
-        if (cpy_ret != 0)
-        {
-            return -EFAULT;
-        }
+    return (int)GetdentsFill(fd, de_user, count, FALSE);
+}
+
+int SysGetdentsPlus(int fd, struct dirent_plus *dp_user, unsigned int count)
+{
+    if (!LOS_IsUserAddressRange((VADDR_T)(UINTPTR)dp_user, count)) {
+        return -EFAULT;
     }
-    return ret;
+
+    /* Process fd convert to system global fd */
+    fd = GetAssociatedSystemFd(fd);
+
+    return (int)GetdentsFill(fd, dp_user, count, TRUE);
 }
 
 char *SysRealpath(const char *path, char *resolved_path)
@@ -135,7 +135,6 @@ int SysMqTimedSend(mqd_t personal, const char *msg, size_t msgLen, unsigned int
 {
     int ret;
     struct timespec timeout;
-    char *msgIntr = NULL;
 
     if (absTimeout != NULL) {
         ret = LOS_ArchCopyFromUser(&timeout, absTimeout, sizeof(struct timespec));
@@ -146,18 +145,12 @@ int SysMqTimedSend(mqd_t personal, const char *msg, size_t msgLen, unsigned int
     if (msgLen == 0) {
         return -EINVAL;
     }
-    msgIntr = (char *)malloc(msgLen);
-    if (msgIntr == NULL) {
-        return -ENOMEM;
-    }
-    ret = LOS_ArchCopyFromUser(msgIntr, msg, msgLen);
-    if (ret != 0) {
-        free(msgIntr);
+    /* the message is copied once, straight from the user buffer into its queue slot */
+    if (!LOS_IsUserAddressRange((VADDR_T)(UINTPTR)msg, msgLen)) {
         return -EFAULT;
     }
     MQUEUE_FD_U2K(personal);
-    ret = mq_timedsend(personal, msgIntr, msgLen, msgPrio, absTimeout ? &timeout : NULL);
-    free(msgIntr);
+    ret = mq_timedsend(personal, msg, msgLen, msgPrio, absTimeout ? &timeout : NULL);
     if (ret < 0) {
         return -get_errno();
     }
@@ -169,7 +162,6 @@ ssize_t SysMqTimedReceive(mqd_t personal, char *msg, size_t msgLen, unsigned int
 {
     int ret, receiveLen;
     struct timespec timeout;
-    char *msgIntr = NULL;
     unsigned int kMsgPrio;
 
     if (absTimeout != NULL) {
@@ -181,30 +173,21 @@ ssize_t SysMqTimedReceive(mqd_t personal, char *msg, size_t msgLen, unsigned int
     if (msgLen == 0) {
         return -EINVAL;
     }
-    msgIntr = (char *)malloc(msgLen);
-    if (msgIntr == NULL) {
-        return -ENOMEM;
+    if (!LOS_IsUserAddressRange((VADDR_T)(UINTPTR)msg, msgLen)) {
+        return -EFAULT;
     }
     MQUEUE_FD_U2K(personal);
-    receiveLen = mq_timedreceive(personal, msgIntr, msgLen, &kMsgPrio, absTimeout ? &timeout : NULL);
+    receiveLen = mq_timedreceive(personal, msg, msgLen, &kMsgPrio, absTimeout ? &timeout : NULL);
     if (receiveLen < 0) {
-        free(msgIntr);
         return -get_errno();
     }
 
     if (msgPrio != NULL) {
         ret = LOS_ArchCopyToUser(msgPrio, &kMsgPrio, sizeof(unsigned int));
         if (ret != 0) {
-            free(msgIntr);
             return -EFAULT;
         }
     }
-
-    ret = LOS_ArchCopyToUser(msg, msgIntr, receiveLen);
-    free(msgIntr);
-    if (ret != 0) {
-        return -EFAULT;
-    }
     return receiveLen;
 }
 
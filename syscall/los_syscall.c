@@ -68,7 +68,7 @@
 #include "sys/shm.h"
 
 
-#define SYS_CALL_NUM    (__NR_syscallend + 1)
+#define SYS_CALL_NUM    (__NR_kernel_syscallend + 1)
 #define NARG_BITS       4
 #define NARG_MASK       0x0F
 #define NARG_PER_BYTE   2
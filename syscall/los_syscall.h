@@ -47,6 +47,7 @@
 #include "sys/utsname.h"
 #include "sys/shm.h"
 #include "poll.h"
+#include "sys/epoll.h"
 #include "utime.h"
 #include "mqueue.h"
 #include "time.h"
@@ -60,6 +61,12 @@
 #include <sys/wait.h>
 #include "sys/resource.h"
 
+/* LiteOS customized syscalls the libc does not number are numbered past its last syscall */
+#ifndef __NR_getdents_plus
+#define __NR_getdents_plus      (__NR_syscallend + 1)
+#endif
+#define __NR_kernel_syscallend  ((__NR_getdents_plus > __NR_syscallend) ? __NR_getdents_plus : __NR_syscallend)
+
 /* process */
 extern unsigned int SysGetGroupId(void);
 extern unsigned int SysGetTid(void);
@@ -130,6 +137,7 @@ extern int SysMkFifo(const char *pathName, mode_t mode);
 /* net */
 #ifdef LOSCFG_NET_LWIP_SACK
 extern int SysSocket(int domain, int type, int protocol);
+extern int SysSocketPair(int domain, int type, int protocol, int *sv);
 extern int SysBind(int s, const struct sockaddr *name, socklen_t namelen);
 extern int SysConnect(int s, const struct sockaddr *name, socklen_t namelen);
 extern int SysListen(int sockfd, int backlog);
@@ -149,6 +157,10 @@ extern int SysGetSockOpt(int sockfd, int level, int optName,
                          void *optValue, socklen_t *optLen);
 extern ssize_t SysSendMsg(int s, const struct msghdr *message, int flags);
 extern ssize_t SysRecvMsg(int s, struct msghdr *message, int flags);
+struct mmsghdr;
+extern int SysSendMMsg(int s, struct mmsghdr *msgvec, unsigned int vlen, unsigned int flags);
+extern int SysRecvMMsg(int s, struct mmsghdr *msgvec, unsigned int vlen, unsigned int flags,
+                       struct timespec *timeout);
 #endif
 
 /* vmm */
@@ -249,11 +261,28 @@ extern int SysFstat64(int fd, struct stat64 *buf);
 extern int SysFstatat64(int fd, const char *restrict path, struct stat *restrict buf, int flag);
 extern int SysFcntl64(int fd, int cmd, void *arg);
 extern int SysPoll(struct pollfd *fds, nfds_t nfds, int timeout);
+extern int SysEpollCreate(int size);
+extern int SysEpollCreate1(int flags);
+extern int SysEpollCtl(int epfd, int op, int fd, struct epoll_event *event);
+extern int SysEpollWait(int epfd, struct epoll_event *events, int maxevents, int timeout);
+extern int SysEpollPwait(int epfd, struct epoll_event *events, int maxevents, int timeout, const sigset_t_l *mask);
+extern int SysEventfd(unsigned int initval);
+extern int SysEventfd2(unsigned int initval, int flags);
+extern int SysTimerfdCreate(int clockid, int flags);
+extern int SysTimerfdSettime(int fd, int flags, const struct itimerspec *newValue, struct itimerspec *oldValue);
+extern int SysTimerfdGettime(int fd, struct itimerspec *value);
+extern int SysSignalfd(int fd, const sigset_t_l *mask, size_t sigsetsize);
+extern int SysSignalfd4(int fd, const sigset_t_l *mask, size_t sigsetsize, int flags);
+struct io_uring_params;
+extern int SysIoUringSetup(unsigned int entries, struct io_uring_params *params);
+extern int SysIoUringEnter(int fd, unsigned int toSubmit, unsigned int minComplete, unsigned int flags,
+                           const sigset_t_l *mask, size_t sigsetsize);
 extern int SysPrctl(int option, ...);
 extern ssize_t SysPread64(int fd, void *buf, size_t nbytes, off64_t offset);
 extern ssize_t SysPwrite64(int fd, const void *buf, size_t nbytes, off64_t offset);
 extern char *SysGetcwd(char *buf, size_t n);
 extern ssize_t SysSendFile(int outfd, int infd, off_t *offset, size_t count);
+extern ssize_t SysSplice(int fdIn, off_t *offIn, int fdOut, off_t *offOut, size_t len, unsigned int flags);
 extern int SysTruncate(const char *path, off_t length);
 extern int SysTruncate64(const char *path, off64_t length);
 extern int SysFtruncate64(int fd, off64_t length);
@@ -267,6 +296,8 @@ extern ssize_t SysPreadv(int fd, const struct iovec *iov, int iovcnt, long loffs
 extern ssize_t SysPwritev(int fd, const struct iovec *iov, int iovcnt, long loffset, long hoffset);
 extern void SysSync(void);
 extern int SysGetdents64(int fd, struct dirent *de_user, unsigned int count);
+struct dirent_plus;
+extern int SysGetdentsPlus(int fd, struct dirent_plus *dp_user, unsigned int count);
 extern int do_opendir(const char *path, int oflags);
 extern char *SysRealpath(const char *path, char *resolvedPath);
 extern int SysUmask(int mask);
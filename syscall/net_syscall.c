@@ -29,9 +29,12 @@
  * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#define _GNU_SOURCE
 #include "syscall_pub.h"
 #include "stdlib.h"
 #include "fs_file.h"
+#include "fs_unix.h"
+#include "fs_pktring.h"
 #include "fs/fs.h"
 #include "los_process_pri.h"
 #include "los_signal.h"
@@ -41,6 +44,7 @@
 
 #ifdef LOSCFG_NET_LWIP_SACK
 #include "lwip/sockets.h"
+#include "lwip/sys.h"
 
 #define SOCKET_U2K(s) \
     do { \
@@ -55,7 +59,7 @@
     do { \
         int fd = AllocAndAssocProcessFd(s, MIN_START_FD); \
         if (fd == -1) { \
-            closesocket(s); \
+            close(s); \
             set_errno(EMFILE); \
             s = -EMFILE; \
         } else { \
@@ -63,24 +67,365 @@
         } \
     } while (0)
 
+/*
+ * AF_UNIX sockets live in the VFS as anonymous files rather than in lwip. The helpers below
+ * marshal the user arguments for them: addresses, options and control data are copied into
+ * kernel buffers, payload buffers are only range-checked and copied once by the socket itself.
+ */
+STATIC int UnixSysAddrIn(const struct sockaddr *name, socklen_t namelen, struct sockaddr_un *addr)
+{
+    if (namelen > sizeof(struct sockaddr_un)) {
+        return -EINVAL;
+    }
+    if ((name == NULL) || (LOS_ArchCopyFromUser(addr, name, namelen) != 0)) {
+        return -EFAULT;
+    }
+    return 0;
+}
+
+STATIC int UnixSysAddrOut(const struct sockaddr_un *addr, socklen_t len, struct sockaddr *name, socklen_t *namelen)
+{
+    socklen_t size;
+
+    if ((namelen == NULL) || (LOS_ArchCopyFromUser(&size, namelen, sizeof(socklen_t)) != 0)) {
+        return -EFAULT;
+    }
+    if ((name != NULL) && (LOS_ArchCopyToUser(name, addr, MIN(size, len)) != 0)) {
+        return -EFAULT;
+    }
+    if (LOS_ArchCopyToUser(namelen, &len, sizeof(socklen_t)) != 0) {
+        return -EFAULT;
+    }
+    return 0;
+}
+
+STATIC int UnixSysBuf(const void *buf, size_t len)
+{
+    if ((len != 0) && ((buf == NULL) || !LOS_IsUserAddressRange((VADDR_T)(UINTPTR)buf, len))) {
+        return -EFAULT;
+    }
+    return 0;
+}
+
+STATIC int UnixSysAccept(int s, struct sockaddr *address, socklen_t *addressLen, int flags)
+{
+    struct sockaddr_un addr;
+    socklen_t len = sizeof(addr);
+    int ret;
+    int err;
+
+    ret = UnixAccept(s, (struct sockaddr *)&addr, &len, flags);
+    if (ret < 0) {
+        return ret;
+    }
+    if (address != NULL) {
+        err = UnixSysAddrOut(&addr, len, address, addressLen);
+        if (err != 0) {
+            close(ret);
+            return err;
+        }
+    }
+
+    SOCKET_K2U(ret);
+    return ret;
+}
+
+STATIC int UnixSysGetName(int s, struct sockaddr *name, socklen_t *namelen, BOOL peer)
+{
+    struct sockaddr_un addr;
+    socklen_t len = sizeof(addr);
+    int ret;
+
+    ret = UnixGetName(s, (struct sockaddr *)&addr, &len, peer);
+    if (ret != 0) {
+        return ret;
+    }
+    return UnixSysAddrOut(&addr, len, name, namelen);
+}
+
+STATIC int UnixSysSetSockOpt(int s, int level, int optName, const void *optValue, socklen_t optLen)
+{
+    int val;
+
+    if (optLen < sizeof(int)) {
+        return -EINVAL;
+    }
+    if ((optValue == NULL) || (LOS_ArchCopyFromUser(&val, optValue, sizeof(int)) != 0)) {
+        return -EFAULT;
+    }
+    return UnixSetSockOpt(s, level, optName, &val, sizeof(int));
+}
+
+STATIC int UnixSysGetSockOpt(int s, int level, int optName, void *optValue, socklen_t *optLen)
+{
+    struct ucred val; /* the largest option AF_UNIX reports */
+    socklen_t size;
+    socklen_t len;
+    int ret;
+
+    if ((optLen == NULL) || (LOS_ArchCopyFromUser(&size, optLen, sizeof(socklen_t)) != 0)) {
+        return -EFAULT;
+    }
+    len = MIN(size, sizeof(val));
+    ret = UnixGetSockOpt(s, level, optName, &val, &len);
+    if (ret != 0) {
+        return ret;
+    }
+    if ((optValue == NULL) || (LOS_ArchCopyToUser(optValue, &val, len) != 0) ||
+        (LOS_ArchCopyToUser(optLen, &len, sizeof(socklen_t)) != 0)) {
+        return -EFAULT;
+    }
+    return 0;
+}
+
+STATIC ssize_t UnixSysSendTo(int s, const void *dataptr, size_t size, int flags,
+                             const struct sockaddr *to, socklen_t tolen)
+{
+    struct iovec iov = { (void *)dataptr, size };
+    struct sockaddr_un addr;
+    struct msghdr msg;
+    int ret;
+
+    ret = UnixSysBuf(dataptr, size);
+    if (ret != 0) {
+        return ret;
+    }
+    (void)memset_s(&msg, sizeof(msg), 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if ((to != NULL) && (tolen != 0)) {
+        ret = UnixSysAddrIn(to, tolen, &addr);
+        if (ret != 0) {
+            return ret;
+        }
+        msg.msg_name = &addr;
+        msg.msg_namelen = tolen;
+    }
+    return UnixSendMsg(s, &msg, flags);
+}
+
+STATIC ssize_t UnixSysRecvFrom(int s, void *buffer, size_t length, int flags,
+                               struct sockaddr *address, socklen_t *addressLen)
+{
+    struct iovec iov = { buffer, length };
+    struct sockaddr_un addr;
+    struct msghdr msg;
+    ssize_t ret;
+    int err;
+
+    err = UnixSysBuf(buffer, length);
+    if (err != 0) {
+        return err;
+    }
+    (void)memset_s(&msg, sizeof(msg), 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (address != NULL) {
+        msg.msg_name = &addr;
+        msg.msg_namelen = sizeof(addr);
+    }
+    ret = UnixRecvMsg(s, &msg, flags);
+    if ((ret >= 0) && (address != NULL)) {
+        err = UnixSysAddrOut(&addr, msg.msg_namelen, address, addressLen);
+        if (err != 0) {
+            return err;
+        }
+    }
+    return ret;
+}
+
+/*
+ * Copy a user msghdr into orig and build its kernel twin in msg: the iovec array, name and control
+ * data are copied in, the iov_base buffers stay in user space.
+ */
+STATIC int UnixSysMsgIn(const struct msghdr *umsg, struct msghdr *orig, struct msghdr *msg,
+                        struct sockaddr_un *addr, BOOL send)
+{
+    size_t i;
+
+    if ((umsg == NULL) || (LOS_ArchCopyFromUser(orig, umsg, sizeof(struct msghdr)) != 0)) {
+        return -EFAULT;
+    }
+    *msg = *orig;
+    if (msg->msg_iovlen > IOV_MAX) {
+        return -EMSGSIZE;
+    }
+    if ((msg->msg_control == NULL) || (msg->msg_controllen == 0)) {
+        msg->msg_control = NULL;
+        msg->msg_controllen = 0;
+    } else if (msg->msg_controllen > UNIX_CMSG_MAX) {
+        return -ENOBUFS;
+    }
+    if ((msg->msg_name == NULL) || (msg->msg_namelen == 0)) {
+        msg->msg_name = NULL;
+        msg->msg_namelen = 0;
+    } else if (send) {
+        if (UnixSysAddrIn(msg->msg_name, msg->msg_namelen, addr) != 0) {
+            return (msg->msg_namelen > sizeof(struct sockaddr_un)) ? -EINVAL : -EFAULT;
+        }
+        msg->msg_name = addr;
+    } else {
+        msg->msg_name = addr;
+        msg->msg_namelen = MIN(msg->msg_namelen, sizeof(struct sockaddr_un));
+    }
+
+    if (msg->msg_iovlen != 0) {
+        const struct iovec *uiov = msg->msg_iov;
+        struct iovec *iov = (struct iovec *)malloc(msg->msg_iovlen * sizeof(struct iovec));
+        if (iov == NULL) {
+            return -ENOMEM;
+        }
+        msg->msg_iov = iov;
+        if ((uiov == NULL) || (LOS_ArchCopyFromUser(iov, uiov, msg->msg_iovlen * sizeof(struct iovec)) != 0)) {
+            return -EFAULT;
+        }
+        for (i = 0; i < msg->msg_iovlen; i++) {
+            if (UnixSysBuf(iov[i].iov_base, iov[i].iov_len) != 0) {
+                return -EFAULT;
+            }
+        }
+    }
+
+    if (msg->msg_control != NULL) {
+        void *uctl = msg->msg_control;
+        msg->msg_control = malloc(msg->msg_controllen);
+        if (msg->msg_control == NULL) {
+            return -ENOMEM;
+        }
+        if (send && (LOS_ArchCopyFromUser(msg->msg_control, uctl, msg->msg_controllen) != 0)) {
+            return -EFAULT;
+        }
+    }
+    return 0;
+}
+
+STATIC void UnixSysMsgFree(const struct msghdr *umsg, struct msghdr *msg)
+{
+    if ((msg->msg_iovlen != 0) && (msg->msg_iov != umsg->msg_iov)) {
+        free(msg->msg_iov);
+    }
+    if ((msg->msg_control != NULL) && (msg->msg_control != umsg->msg_control)) {
+        free(msg->msg_control);
+    }
+}
+
+STATIC ssize_t UnixSysSendMsg(int s, const struct msghdr *message, int flags)
+{
+    struct sockaddr_un addr;
+    struct msghdr umsg;
+    struct msghdr msg;
+    ssize_t ret;
+
+    (void)memset_s(&umsg, sizeof(umsg), 0, sizeof(umsg));
+    (void)memset_s(&msg, sizeof(msg), 0, sizeof(msg));
+    ret = UnixSysMsgIn(message, &umsg, &msg, &addr, TRUE);
+    if (ret == 0) {
+        ret = UnixSendMsg(s, &msg, flags);
+    }
+    UnixSysMsgFree(&umsg, &msg);
+    return ret;
+}
+
+STATIC ssize_t UnixSysRecvMsg(int s, struct msghdr *message, int flags)
+{
+    struct sockaddr_un addr;
+    struct msghdr umsg;
+    struct msghdr msg;
+    ssize_t ret;
+
+    (void)memset_s(&umsg, sizeof(umsg), 0, sizeof(umsg));
+    (void)memset_s(&msg, sizeof(msg), 0, sizeof(msg));
+    ret = UnixSysMsgIn(message, &umsg, &msg, &addr, FALSE);
+    if (ret == 0) {
+        ret = UnixRecvMsg(s, &msg, flags);
+    }
+    if (ret >= 0) {
+        if (((msg.msg_name != NULL) && (LOS_ArchCopyToUser(umsg.msg_name, &addr,
+                                                            MIN(umsg.msg_namelen, msg.msg_namelen)) != 0)) ||
+            ((msg.msg_controllen != 0) &&
+             (LOS_ArchCopyToUser(umsg.msg_control, msg.msg_control, msg.msg_controllen) != 0))) {
+            ret = -EFAULT;
+        } else {
+            /* only the lengths and flags of the header are results */
+            umsg.msg_namelen = (msg.msg_name != NULL) ? msg.msg_namelen : 0;
+            umsg.msg_controllen = msg.msg_controllen;
+            umsg.msg_flags = msg.msg_flags;
+            if (LOS_ArchCopyToUser(message, &umsg, sizeof(umsg)) != 0) {
+                ret = -EFAULT;
+            }
+        }
+        /* the message is consumed either way, but descriptors the caller never learns of must go */
+        if (ret == -EFAULT) {
+            UnixCtlRevoke(&msg);
+        }
+    }
+    UnixSysMsgFree(&umsg, &msg);
+    return ret;
+}
+
 int SysSocket(int domain, int type, int protocol)
 {
     int ret;
 
-    ret = socket(domain, type, protocol);
-    if (ret == -1) {
-        return -get_errno();
+    if (domain == AF_UNIX) {
+        ret = UnixSocketCreate(type, protocol);
+        if (ret < 0) {
+            return ret;
+        }
+    } else {
+        ret = socket(domain, type, protocol);
+        if (ret == -1) {
+            return -get_errno();
+        }
     }
 
     SOCKET_K2U(ret);
     return ret;
 }
 
+int SysSocketPair(int domain, int type, int protocol, int *sv)
+{
+    int ksv[2];
+    int ret;
+
+    if (domain != AF_UNIX) {
+        return -EOPNOTSUPP;
+    }
+    CHECK_ASPACE(sv, sizeof(ksv));
+
+    ret = UnixSocketPair(type, protocol, ksv);
+    if (ret != 0) {
+        return ret;
+    }
+    SOCKET_K2U(ksv[0]);
+    if (ksv[0] < 0) {
+        close(ksv[1]);
+        return ksv[0];
+    }
+    SOCKET_K2U(ksv[1]);
+    if (ksv[1] < 0) {
+        (void)SysClose(ksv[0]);
+        return ksv[1];
+    }
+
+    if (LOS_ArchCopyToUser(sv, ksv, sizeof(ksv)) != 0) {
+        (void)SysClose(ksv[0]);
+        (void)SysClose(ksv[1]);
+        return -EFAULT;
+    }
+    return 0;
+}
+
 int SysBind(int s, const struct sockaddr *name, socklen_t namelen)
 {
     int ret;
 
     SOCKET_U2K(s);
+    if (UnixSocketIs(s)) {
+        struct sockaddr_un addr;
+        ret = UnixSysAddrIn(name, namelen, &addr);
+        return (ret != 0) ? ret : UnixBind(s, (struct sockaddr *)&addr, namelen);
+    }
     CHECK_ASPACE(name, namelen);
 
     DUP_FROM_USER(name, namelen);
@@ -104,6 +449,11 @@ int SysConnect(int s, const struct sockaddr *name, socklen_t namelen)
     int ret;
 
     SOCKET_U2K(s);
+    if (UnixSocketIs(s)) {
+        struct sockaddr_un addr;
+        ret = UnixSysAddrIn(name, namelen, &addr);
+        return (ret != 0) ? ret : UnixConnect(s, (struct sockaddr *)&addr, namelen);
+    }
     CHECK_ASPACE(name, namelen);
 
     DUP_FROM_USER(name, namelen);
@@ -127,6 +477,9 @@ int SysListen(int sockfd, int backlog)
     int ret;
 
     SOCKET_U2K(sockfd);
+    if (UnixSocketIs(sockfd)) {
+        return UnixListen(sockfd, backlog);
+    }
     ret = listen(sockfd, backlog);
     if (ret == -1) {
         return -get_errno();
@@ -141,6 +494,9 @@ int SysAccept(int socket, struct sockaddr *address,
     int ret;
 
     SOCKET_U2K(socket);
+    if (UnixSocketIs(socket)) {
+        return UnixSysAccept(socket, address, addressLen, 0);
+    }
 
     CHECK_ASPACE(addressLen, sizeof(socklen_t));
     CPY_FROM_USER(addressLen);
@@ -167,6 +523,9 @@ int SysGetSockName(int s, struct sockaddr *name, socklen_t *namelen)
     int ret;
 
     SOCKET_U2K(s);
+    if (UnixSocketIs(s)) {
+        return UnixSysGetName(s, name, namelen, FALSE);
+    }
 
     CHECK_ASPACE(namelen, sizeof(socklen_t));
     CPY_FROM_USER(namelen);
@@ -196,6 +555,9 @@ int SysGetPeerName(int s, struct sockaddr *name, socklen_t *namelen)
     int ret;
 
     SOCKET_U2K(s);
+    if (UnixSocketIs(s)) {
+        return UnixSysGetName(s, name, namelen, TRUE);
+    }
 
     CHECK_ASPACE(namelen, sizeof(socklen_t));
     CPY_FROM_USER(namelen);
@@ -225,6 +587,12 @@ ssize_t SysSend(int s, const void *dataptr, size_t size, int flags)
     int ret;
 
     SOCKET_U2K(s);
+    if (UnixSocketIs(s)) {
+        return UnixSysSendTo(s, dataptr, size, flags, NULL, 0);
+    }
+    if ((dataptr == NULL) && socks_ring_tx_active(s)) {
+        return socks_ring_send(s);
+    }
     CHECK_ASPACE(dataptr, size);
 
     DUP_FROM_USER(dataptr, size);
@@ -249,6 +617,12 @@ ssize_t SysSendTo(int s, const void *dataptr, size_t size, int flags,
     int ret;
 
     SOCKET_U2K(s);
+    if (UnixSocketIs(s)) {
+        return UnixSysSendTo(s, dataptr, size, flags, to, tolen);
+    }
+    if ((dataptr == NULL) && socks_ring_tx_active(s)) {
+        return socks_ring_send(s);
+    }
     CHECK_ASPACE(dataptr, size);
     CHECK_ASPACE(to, tolen);
 
@@ -275,6 +649,9 @@ ssize_t SysRecv(int socket, void *buffer, size_t length, int flags)
     int ret;
 
     SOCKET_U2K(socket);
+    if (UnixSocketIs(socket)) {
+        return UnixSysRecvFrom(socket, buffer, length, flags, NULL, NULL);
+    }
     CHECK_ASPACE(buffer, length);
 
     DUP_FROM_USER_NOCOPY(buffer, length);
@@ -302,6 +679,9 @@ ssize_t SysRecvFrom(int socket, void *buffer, size_t length,
     int ret;
 
     SOCKET_U2K(socket);
+    if (UnixSocketIs(socket)) {
+        return UnixSysRecvFrom(socket, buffer, length, flags, address, addressLen);
+    }
     CHECK_ASPACE(buffer, length);
 
     CHECK_ASPACE(addressLen, sizeof(socklen_t));
@@ -337,6 +717,9 @@ int SysShutdown(int socket, int how)
     int ret;
 
     SOCKET_U2K(socket);
+    if (UnixSocketIs(socket)) {
+        return UnixShutdown(socket, how);
+    }
     ret = shutdown(socket, how);
     if (ret == -1) {
         return -get_errno();
@@ -349,8 +732,21 @@ int SysSetSockOpt(int socket, int level, int optName,
                   const void *optValue, socklen_t optLen)
 {
     int ret;
+    struct tpacket_req req;
 
     SOCKET_U2K(socket);
+    if (UnixSocketIs(socket)) {
+        return UnixSysSetSockOpt(socket, level, optName, optValue, optLen);
+    }
+    if (level == SOL_PACKET) {
+        if ((optValue == NULL) || (optLen < sizeof(req))) {
+            return -EINVAL;
+        }
+        if (LOS_ArchCopyFromUser(&req, optValue, sizeof(req)) != 0) {
+            return -EFAULT;
+        }
+        return socks_ring_setsockopt(socket, optName, &req);
+    }
     CHECK_ASPACE(optValue, optLen);
 
     DUP_FROM_USER(optValue, optLen);
@@ -369,6 +765,9 @@ int SysGetSockOpt(int sockfd, int level, int optName,
     int ret;
 
     SOCKET_U2K(sockfd);
+    if (UnixSocketIs(sockfd)) {
+        return UnixSysGetSockOpt(sockfd, level, optName, optValue, optLen);
+    }
 
     CHECK_ASPACE(optLen, sizeof(socklen_t));
     CPY_FROM_USER(optLen);
@@ -398,6 +797,9 @@ ssize_t SysSendMsg(int s, const struct msghdr *message, int flags)
     int ret;
 
     SOCKET_U2K(s);
+    if (UnixSocketIs(s)) {
+        return UnixSysSendMsg(s, message, flags);
+    }
 
     CHECK_ASPACE(message, sizeof(struct msghdr));
     CPY_FROM_CONST_USER(struct msghdr, message);
@@ -446,6 +848,9 @@ ssize_t SysRecvMsg(int s, struct msghdr *message, int flags)
     int ret;
 
     SOCKET_U2K(s);
+    if (UnixSocketIs(s)) {
+        return UnixSysRecvMsg(s, message, flags);
+    }
 
     CHECK_ASPACE(message, sizeof(struct msghdr));
     CPY_FROM_NONCONST_USER(message);
@@ -495,4 +900,295 @@ OUT:
     return (ret == -1) ? -get_errno() : ret;
 }
 
+/*
+ * recvmmsg/sendmmsg on lwip sockets: the vector is marshalled NET_MMSG_CHUNK messages at a time
+ * and every chunk goes to the socket layer as one batch. The payload of a message passes through
+ * a single kernel bounce buffer sized to its iovec, and a chunk ends early once its buffers would
+ * go past NET_MMSG_BUF_MAX, so large user buffers cost fewer messages per batch, not more memory.
+ */
+#define NET_MMSG_CHUNK      16
+#define NET_MMSG_DATA_MAX   0xFFFF
+#define NET_MMSG_CMSG_MAX   256
+#define NET_MMSG_BUF_MAX    0x10000 /* above NET_MMSG_DATA_MAX: the first message always fits */
+#define NET_MMSG_FULL       1
+
+typedef struct {
+    struct msghdr umsg;                 /* user copy of the header */
+    struct iovec *uiov;                 /* kernel copy of the user iovec array */
+    struct iovec iov;                   /* the one kernel iovec, over buf */
+    struct sockaddr_storage addr;
+    UINT8 ctl[NET_MMSG_CMSG_MAX];
+    void *buf;
+} NetSysMmsg;
+
+STATIC void NetSysMmsgFree(NetSysMmsg *m)
+{
+    free(m->uiov);
+    free(m->buf);
+    m->uiov = NULL;
+    m->buf = NULL;
+}
+
+STATIC int NetSysMmsgIn(const struct mmsghdr *uhdr, NetSysMmsg *m, struct msghdr *msg, BOOL send, size_t *left)
+{
+    size_t total = 0;
+    size_t off = 0;
+    size_t i;
+
+    if (LOS_ArchCopyFromUser(&m->umsg, &uhdr->msg_hdr, sizeof(struct msghdr)) != 0) {
+        return -EFAULT;
+    }
+    if (m->umsg.msg_iovlen > IOV_MAX) {
+        return -EMSGSIZE;
+    }
+    (void)memset_s(msg, sizeof(struct msghdr), 0, sizeof(struct msghdr));
+
+    if (m->umsg.msg_iovlen != 0) {
+        m->uiov = (struct iovec *)malloc(m->umsg.msg_iovlen * sizeof(struct iovec));
+        if (m->uiov == NULL) {
+            return -ENOMEM;
+        }
+        if ((m->umsg.msg_iov == NULL) ||
+            (LOS_ArchCopyFromUser(m->uiov, m->umsg.msg_iov, m->umsg.msg_iovlen * sizeof(struct iovec)) != 0)) {
+            return -EFAULT;
+        }
+    }
+    for (i = 0; i < m->umsg.msg_iovlen; i++) {
+        if (UnixSysBuf(m->uiov[i].iov_base, m->uiov[i].iov_len) != 0) {
+            return -EFAULT;
+        }
+        total += m->uiov[i].iov_len;
+    }
+    if (total > NET_MMSG_DATA_MAX) {
+        /* more than a datagram can carry: a send fails, a receive just reads less */
+        if (send) {
+            return -EMSGSIZE;
+        }
+        total = NET_MMSG_DATA_MAX;
+    }
+    if (total > *left) {
+        return NET_MMSG_FULL;
+    }
+    *left -= total;
+    m->buf = malloc(MAX(total, 1));
+    if (m->buf == NULL) {
+        return -ENOMEM;
+    }
+    for (i = 0; send && (off < total); i++) {
+        if (LOS_ArchCopyFromUser((UINT8 *)m->buf + off, m->uiov[i].iov_base, m->uiov[i].iov_len) != 0) {
+            return -EFAULT;
+        }
+        off += m->uiov[i].iov_len;
+    }
+    m->iov.iov_base = m->buf;
+    m->iov.iov_len = total;
+    msg->msg_iov = &m->iov;
+    msg->msg_iovlen = 1;
+
+    if ((m->umsg.msg_name != NULL) && (m->umsg.msg_namelen != 0)) {
+        msg->msg_name = &m->addr;
+        if (!send) {
+            msg->msg_namelen = MIN(m->umsg.msg_namelen, sizeof(m->addr));
+        } else if (m->umsg.msg_namelen > sizeof(m->addr)) {
+            return -EINVAL;
+        } else if (LOS_ArchCopyFromUser(&m->addr, m->umsg.msg_name, m->umsg.msg_namelen) != 0) {
+            return -EFAULT;
+        } else {
+            msg->msg_namelen = m->umsg.msg_namelen;
+        }
+    }
+
+    if ((m->umsg.msg_control != NULL) && (m->umsg.msg_controllen != 0)) {
+        msg->msg_control = m->ctl;
+        if (!send) {
+            msg->msg_controllen = MIN(m->umsg.msg_controllen, sizeof(m->ctl));
+        } else if (m->umsg.msg_controllen > sizeof(m->ctl)) {
+            return -ENOBUFS;
+        } else if (LOS_ArchCopyFromUser(m->ctl, m->umsg.msg_control, m->umsg.msg_controllen) != 0) {
+            return -EFAULT;
+        } else {
+            msg->msg_controllen = m->umsg.msg_controllen;
+        }
+    }
+    return 0;
+}
+
+STATIC int NetSysMmsgOut(struct mmsghdr *uhdr, NetSysMmsg *m, const struct mmsghdr *khdr, BOOL send)
+{
+    const struct msghdr *msg = &khdr->msg_hdr;
+    struct mmsghdr out;
+    size_t left = khdr->msg_len;
+    size_t off = 0;
+    size_t len;
+    size_t i;
+
+    if (send) {
+        return (LOS_ArchCopyToUser(&uhdr->msg_len, &khdr->msg_len, sizeof(unsigned int)) != 0) ? -EFAULT : 0;
+    }
+
+    for (i = 0; (i < m->umsg.msg_iovlen) && (left != 0); i++) {
+        len = MIN(left, m->uiov[i].iov_len);
+        if (LOS_ArchCopyToUser(m->uiov[i].iov_base, (UINT8 *)m->buf + off, len) != 0) {
+            return -EFAULT;
+        }
+        off += len;
+        left -= len;
+    }
+    if (((msg->msg_name != NULL) &&
+         (LOS_ArchCopyToUser(m->umsg.msg_name, msg->msg_name, MIN(m->umsg.msg_namelen, msg->msg_namelen)) != 0)) ||
+        ((msg->msg_controllen != 0) &&
+         (LOS_ArchCopyToUser(m->umsg.msg_control, msg->msg_control, msg->msg_controllen) != 0))) {
+        return -EFAULT;
+    }
+
+    /* only the lengths and flags of the header are results */
+    out.msg_hdr = m->umsg;
+    out.msg_hdr.msg_namelen = (msg->msg_name != NULL) ? msg->msg_namelen : 0;
+    out.msg_hdr.msg_controllen = msg->msg_controllen;
+    out.msg_hdr.msg_flags = msg->msg_flags;
+    out.msg_len = khdr->msg_len;
+    return (LOS_ArchCopyToUser(uhdr, &out, sizeof(out)) != 0) ? -EFAULT : 0;
+}
+
+STATIC int NetSysMmsgBatch(int s, struct mmsghdr *msgvec, unsigned int vlen, int flags,
+                           const u32_t *deadline, BOOL send)
+{
+    struct mmsghdr kvec[NET_MMSG_CHUNK];
+    NetSysMmsg *m = NULL;
+    unsigned int done = 0;
+    unsigned int chunk;
+    unsigned int n;
+    unsigned int i;
+    size_t left;
+    int err = 0;
+    int ret;
+
+    vlen = MIN(vlen, IOV_MAX);
+    if (vlen == 0) {
+        return 0;
+    }
+    if (!LOS_IsUserAddressRange((VADDR_T)(UINTPTR)msgvec, vlen * sizeof(struct mmsghdr))) {
+        return -EFAULT;
+    }
+    m = (NetSysMmsg *)malloc(MIN(vlen, NET_MMSG_CHUNK) * sizeof(NetSysMmsg));
+    if (m == NULL) {
+        return -ENOMEM;
+    }
+
+    while ((done < vlen) && (err == 0)) {
+        chunk = MIN(vlen - done, NET_MMSG_CHUNK);
+        (void)memset_s(m, chunk * sizeof(NetSysMmsg), 0, chunk * sizeof(NetSysMmsg));
+        left = NET_MMSG_BUF_MAX;
+        for (n = 0; n < chunk; n++) {
+            err = NetSysMmsgIn(&msgvec[done + n], &m[n], &kvec[n].msg_hdr, send, &left);
+            if (err != 0) {
+                NetSysMmsgFree(&m[n]);
+                err = (err == NET_MMSG_FULL) ? 0 : err; /* that message opens the next chunk */
+                break;
+            }
+        }
+
+        ret = 0;
+        if (n != 0) {
+            ret = send ? socks_sendmmsg(s, kvec, n, flags) : socks_recvmmsg(s, kvec, n, flags, deadline);
+        }
+        if (ret < 0) {
+            err = ret;
+        } else if ((unsigned int)ret < n) {
+            err = -EAGAIN; /* the batch ended early, no error to report past the count */
+        }
+        for (i = 0; i < n; i++) {
+            if ((ret > 0) && (i < (unsigned int)ret) &&
+                (NetSysMmsgOut(&msgvec[done + i], &m[i], &kvec[i], send) != 0)) {
+                err = -EFAULT;
+                ret = (int)i;
+            }
+            NetSysMmsgFree(&m[i]);
+        }
+        done += (ret > 0) ? (unsigned int)ret : 0;
+
+        if (!send && (flags & MSG_WAITFORONE) && (done != 0)) {
+            flags |= MSG_DONTWAIT;
+        }
+        if ((deadline != NULL) && ((s32_t)(sys_now() - *deadline) >= 0)) {
+            break;
+        }
+    }
+
+    free(m);
+    return (done != 0) ? (int)done : err;
+}
+
+int SysSendMMsg(int s, struct mmsghdr *msgvec, unsigned int vlen, unsigned int flags)
+{
+    unsigned int len;
+    unsigned int i;
+    ssize_t ret;
+
+    SOCKET_U2K(s);
+    if (UnixSocketIs(s)) {
+        for (i = 0; i < MIN(vlen, IOV_MAX); i++) {
+            ret = UnixSysSendMsg(s, &msgvec[i].msg_hdr, (int)flags);
+            len = (unsigned int)ret;
+            if ((ret >= 0) && (LOS_ArchCopyToUser(&msgvec[i].msg_len, &len, sizeof(len)) != 0)) {
+                ret = -EFAULT;
+            }
+            if (ret < 0) {
+                return (i == 0) ? (int)ret : (int)i;
+            }
+        }
+        return (int)i;
+    }
+
+    return NetSysMmsgBatch(s, msgvec, vlen, (int)flags, NULL, TRUE);
+}
+
+/*
+ * The timeout is checked after each message, as on Linux: it bounds a batch that keeps finding
+ * data, not the wait for the first message.
+ */
+int SysRecvMMsg(int s, struct mmsghdr *msgvec, unsigned int vlen, unsigned int flags, struct timespec *timeout)
+{
+    struct timespec ts;
+    u32_t deadline = 0;
+    UINT64 ms;
+    unsigned int len;
+    unsigned int i;
+    ssize_t ret;
+
+    SOCKET_U2K(s);
+    if (timeout != NULL) {
+        if (LOS_ArchCopyFromUser(&ts, timeout, sizeof(ts)) != 0) {
+            return -EFAULT;
+        }
+        if ((ts.tv_sec < 0) || (ts.tv_nsec < 0) || (ts.tv_nsec >= OS_SYS_NS_PER_SECOND)) {
+            return -EINVAL;
+        }
+        ms = (UINT64)ts.tv_sec * OS_SYS_MS_PER_SECOND + (UINT64)ts.tv_nsec / OS_SYS_NS_PER_MS;
+        deadline = sys_now() + (u32_t)MIN(ms, (UINT64)INT32_MAX);
+    }
+
+    if (UnixSocketIs(s)) {
+        for (i = 0; i < MIN(vlen, IOV_MAX); i++) {
+            ret = UnixSysRecvMsg(s, &msgvec[i].msg_hdr, (int)(flags & ~MSG_WAITFORONE));
+            len = (unsigned int)ret;
+            if ((ret >= 0) && (LOS_ArchCopyToUser(&msgvec[i].msg_len, &len, sizeof(len)) != 0)) {
+                ret = -EFAULT;
+            }
+            if (ret < 0) {
+                return (i == 0) ? (int)ret : (int)i;
+            }
+            if (flags & MSG_WAITFORONE) {
+                flags |= MSG_DONTWAIT;
+            }
+            if ((timeout != NULL) && ((s32_t)(sys_now() - deadline) >= 0)) {
+                return (int)(i + 1);
+            }
+        }
+        return (int)i;
+    }
+
+    return NetSysMmsgBatch(s, msgvec, vlen, (int)flags, (timeout != NULL) ? &deadline : NULL, FALSE);
+}
+
 #endif
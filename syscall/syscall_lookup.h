@@ -75,11 +75,26 @@ SYSCALL_HAND_DEF(__NR__newselect, SysSelect, int, ARG_NUM_5)
 SYSCALL_HAND_DEF(__NR_readv, SysReadv, ssize_t, ARG_NUM_3)
 SYSCALL_HAND_DEF(__NR_writev, SysWritev, ssize_t, ARG_NUM_3)
 SYSCALL_HAND_DEF(__NR_poll, SysPoll, int, ARG_NUM_3)
+SYSCALL_HAND_DEF(__NR_epoll_create, SysEpollCreate, int, ARG_NUM_1)
+SYSCALL_HAND_DEF(__NR_epoll_create1, SysEpollCreate1, int, ARG_NUM_1)
+SYSCALL_HAND_DEF(__NR_epoll_ctl, SysEpollCtl, int, ARG_NUM_4)
+SYSCALL_HAND_DEF(__NR_epoll_wait, SysEpollWait, int, ARG_NUM_4)
+SYSCALL_HAND_DEF(__NR_epoll_pwait, SysEpollPwait, int, ARG_NUM_5)
+SYSCALL_HAND_DEF(__NR_eventfd, SysEventfd, int, ARG_NUM_1)
+SYSCALL_HAND_DEF(__NR_eventfd2, SysEventfd2, int, ARG_NUM_2)
+SYSCALL_HAND_DEF(__NR_timerfd_create, SysTimerfdCreate, int, ARG_NUM_2)
+SYSCALL_HAND_DEF(__NR_timerfd_settime, SysTimerfdSettime, int, ARG_NUM_4)
+SYSCALL_HAND_DEF(__NR_timerfd_gettime, SysTimerfdGettime, int, ARG_NUM_2)
+SYSCALL_HAND_DEF(__NR_signalfd, SysSignalfd, int, ARG_NUM_3)
+SYSCALL_HAND_DEF(__NR_signalfd4, SysSignalfd4, int, ARG_NUM_4)
+SYSCALL_HAND_DEF(__NR_io_uring_setup, SysIoUringSetup, int, ARG_NUM_2)
+SYSCALL_HAND_DEF(__NR_io_uring_enter, SysIoUringEnter, int, ARG_NUM_6)
 SYSCALL_HAND_DEF(__NR_prctl, SysPrctl, int, ARG_NUM_7)
 SYSCALL_HAND_DEF(__NR_pread64, SysPread64, ssize_t, ARG_NUM_7)
 SYSCALL_HAND_DEF(__NR_pwrite64, SysPwrite64, ssize_t, ARG_NUM_7)
 SYSCALL_HAND_DEF(__NR_getcwd, SysGetcwd, char *, ARG_NUM_2)
 SYSCALL_HAND_DEF(__NR_sendfile, SysSendFile, ssize_t, ARG_NUM_4)
+SYSCALL_HAND_DEF(__NR_splice, SysSplice, ssize_t, ARG_NUM_6)
 SYSCALL_HAND_DEF(__NR_truncate64, SysTruncate64, int, ARG_NUM_7)
 SYSCALL_HAND_DEF(__NR_ftruncate64, SysFtruncate64, int, ARG_NUM_7)
 SYSCALL_HAND_DEF(__NR_stat64, SysStat, int, ARG_NUM_2)
@@ -91,6 +106,7 @@ SYSCALL_HAND_DEF(__NR_preadv, SysPreadv, ssize_t, ARG_NUM_7)
 SYSCALL_HAND_DEF(__NR_pwritev, SysPwritev, ssize_t, ARG_NUM_7)
 SYSCALL_HAND_DEF(__NR_fallocate, SysFallocate64, int, ARG_NUM_7)
 SYSCALL_HAND_DEF(__NR_getdents64, SysGetdents64, int, ARG_NUM_3)
+SYSCALL_HAND_DEF(__NR_getdents_plus, SysGetdentsPlus, int, ARG_NUM_3)
 
 #ifdef LOSCFG_FS_FAT
 SYSCALL_HAND_DEF(__NR_format, SysFormat, int, ARG_NUM_3)
@@ -208,6 +224,7 @@ SYSCALL_HAND_DEF(__NR_mq_getsetattr, SysMqGetSetAttr, int, ARG_NUM_3)
 
 #ifdef LOSCFG_NET_LWIP_SACK
 SYSCALL_HAND_DEF(__NR_socket, SysSocket, int, ARG_NUM_3)
+SYSCALL_HAND_DEF(__NR_socketpair, SysSocketPair, int, ARG_NUM_4)
 SYSCALL_HAND_DEF(__NR_bind, SysBind, int, ARG_NUM_3)
 SYSCALL_HAND_DEF(__NR_connect, SysConnect, int, ARG_NUM_3)
 SYSCALL_HAND_DEF(__NR_listen, SysListen, int, ARG_NUM_2)
@@ -223,6 +240,8 @@ SYSCALL_HAND_DEF(__NR_setsockopt, SysSetSockOpt, int, ARG_NUM_5)
 SYSCALL_HAND_DEF(__NR_getsockopt, SysGetSockOpt, int, ARG_NUM_5)
 SYSCALL_HAND_DEF(__NR_sendmsg, SysSendMsg, ssize_t, ARG_NUM_3)
 SYSCALL_HAND_DEF(__NR_recvmsg, SysRecvMsg, ssize_t, ARG_NUM_3)
+SYSCALL_HAND_DEF(__NR_sendmmsg, SysSendMMsg, int, ARG_NUM_4)
+SYSCALL_HAND_DEF(__NR_recvmmsg, SysRecvMMsg, int, ARG_NUM_5)
 #endif
 
 #ifdef LOSCFG_KERNEL_SHM
@@ -35,6 +35,9 @@
 #include "unistd.h"
 #include "los_vm_syscall.h"
 #include "fs_file.h"
+#ifdef LOSCFG_NET_LWIP_SACK
+#include "lwip/sockets.h"
+#endif
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -46,6 +49,15 @@ void *SysMmap(void *addr, size_t size, int prot, int flags, int fd, size_t offse
 {
     /* Process fd convert to system global fd */
     fd = GetAssociatedSystemFd(fd);
+#ifdef LOSCFG_NET_LWIP_SACK
+    /* a socket maps its packet rings, which live in an anonymous file of their own */
+    if (LOS_IsNamedMapping((unsigned long)flags) && (fd >= CONFIG_NFILE_DESCRIPTORS)) {
+        fd = socks_ring_fd(fd);
+        if (fd < 0) {
+            return (void *)(intptr_t)fd;
+        }
+    }
+#endif
 
     return (void *)LOS_MMap((uintptr_t)addr, size, prot, flags, fd, offset);
 }
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host-side check and benchmark of the NEON checksum kernels in
+ * arch/arm/arm/src/armv7a/in_cksum_neon.S. Build it with the Makefile beside it for an armv7-a
+ * Linux userspace and run it on a board or under qemu-arm: it compares both kernels against a
+ * plain C model over every length up to CKSUM_CHECK_LEN at every source and destination
+ * alignment, then reports the throughput of the model, the NEON sum, memcpy followed by the
+ * model, and the fused NEON copy+sum. It exits non-zero on the first mismatch.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+unsigned int csum_partial_neon(const void *buf, int len, unsigned int wsum);
+unsigned int csum_partial_copy_neon(const void *src, void *dst, int len, unsigned int wsum);
+
+#define CKSUM_CHECK_LEN     2048
+#define CKSUM_ALIGN_MAX     8
+#define CKSUM_GUARD         16
+#define CKSUM_BENCH_BYTES   (256UL << 20)   /* per case, so short lengths run enough iterations */
+
+static const int g_benchLen[] = { 64, 576, 1500, 9000, 65535 };
+
+/* The contract of csum_partial: 16-bit words in memory order, little-endian, plus wsum */
+static uint32_t RefSum(const uint8_t *buf, int len, uint32_t wsum)
+{
+    uint64_t sum = wsum;
+    int i;
+
+    for (i = 0; (i + 1) < len; i += 2) {
+        sum += (uint32_t)buf[i] | ((uint32_t)buf[i + 1] << 8);
+    }
+    if (len & 1) {
+        sum += buf[len - 1];
+    }
+    while (sum >> 32) {
+        sum = (sum & 0xffffffffULL) + (sum >> 32);
+    }
+    return (uint32_t)sum;
+}
+
+/* Partial sums are only defined modulo 0xffff, compare them folded */
+static uint16_t Fold(uint32_t sum)
+{
+    sum = (sum & 0xffff) + (sum >> 16);
+    sum = (sum & 0xffff) + (sum >> 16);
+    return (uint16_t)((sum == 0xffff) ? 0 : sum);
+}
+
+static int CheckOne(const uint8_t *src, uint8_t *dstArea, int dstAlign, int len, uint32_t wsum)
+{
+    uint8_t *dst = dstArea + CKSUM_GUARD + dstAlign;
+    uint16_t want = Fold(RefSum(src, len, wsum));
+    uint16_t got;
+    int i;
+
+    got = Fold(csum_partial_neon(src, len, wsum));
+    if (got != want) {
+        printf("csum_partial_neon: len %d src %p wsum 0x%08x: 0x%04x, want 0x%04x\n",
+               len, (const void *)src, wsum, got, want);
+        return -1;
+    }
+
+    memset(dstArea, 0xa5, CKSUM_CHECK_LEN + CKSUM_ALIGN_MAX + (2 * CKSUM_GUARD));
+    got = Fold(csum_partial_copy_neon(src, dst, len, wsum));
+    if (got != want) {
+        printf("csum_partial_copy_neon: len %d src %p dst %p wsum 0x%08x: 0x%04x, want 0x%04x\n",
+               len, (const void *)src, (void *)dst, wsum, got, want);
+        return -1;
+    }
+    if (memcmp(dst, src, len) != 0) {
+        printf("csum_partial_copy_neon: len %d: copy differs from the source\n", len);
+        return -1;
+    }
+    for (i = 0; i < (CKSUM_GUARD + dstAlign); i++) {
+        if (dstArea[i] != 0xa5) {
+            printf("csum_partial_copy_neon: len %d: wrote before dst\n", len);
+            return -1;
+        }
+    }
+    for (i = 0; i < CKSUM_GUARD; i++) {
+        if (dst[len + i] != 0xa5) {
+            printf("csum_partial_copy_neon: len %d: wrote past dst + len\n", len);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int Check(void)
+{
+    static const uint32_t wsums[] = { 0, 1, 0xffff, 0xfffffffe, 0xffffffff };
+    uint8_t *src = malloc(CKSUM_CHECK_LEN + CKSUM_ALIGN_MAX);
+    uint8_t *dstArea = malloc(CKSUM_CHECK_LEN + CKSUM_ALIGN_MAX + (2 * CKSUM_GUARD));
+    int ret = -1;
+    int len;
+    int sa;
+    int da;
+    size_t w;
+    size_t i;
+
+    if ((src == NULL) || (dstArea == NULL)) {
+        goto OUT;
+    }
+    for (i = 0; i < (CKSUM_CHECK_LEN + CKSUM_ALIGN_MAX); i++) {
+        src[i] = (uint8_t)rand();
+    }
+
+    for (len = 0; len <= CKSUM_CHECK_LEN; len++) {
+        for (sa = 0; sa < CKSUM_ALIGN_MAX; sa++) {
+            for (da = 0; da < CKSUM_ALIGN_MAX; da++) {
+                w = (size_t)(len + sa + da) % (sizeof(wsums) / sizeof(wsums[0]));
+                if (CheckOne(src + sa, dstArea, da, len, wsums[w]) != 0) {
+                    goto OUT;
+                }
+            }
+        }
+    }
+
+    /* all ones is the worst case for the accumulators */
+    memset(src, 0xff, CKSUM_CHECK_LEN);
+    if (CheckOne(src, dstArea, 0, CKSUM_CHECK_LEN, 0xffffffff) != 0) {
+        goto OUT;
+    }
+    printf("check: lengths 0-%d, %d x %d alignments: ok\n", CKSUM_CHECK_LEN, CKSUM_ALIGN_MAX, CKSUM_ALIGN_MAX);
+    ret = 0;
+
+OUT:
+    free(src);
+    free(dstArea);
+    return ret;
+}
+
+static double Now(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+enum { BENCH_REF, BENCH_NEON, BENCH_MEMCPY_REF, BENCH_COPY_NEON, BENCH_NUM };
+
+static const char *g_benchName[BENCH_NUM] = { "C model", "neon", "memcpy+C model", "neon copy" };
+
+static double BenchOne(int kind, const uint8_t *src, uint8_t *dst, int len)
+{
+    unsigned long iters = CKSUM_BENCH_BYTES / (unsigned long)len;
+    volatile uint32_t sink = 0;
+    unsigned long i;
+    double start;
+
+    start = Now();
+    for (i = 0; i < iters; i++) {
+        switch (kind) {
+            case BENCH_REF:
+                sink += RefSum(src, len, 0);
+                break;
+            case BENCH_NEON:
+                sink += csum_partial_neon(src, len, 0);
+                break;
+            case BENCH_MEMCPY_REF:
+                memcpy(dst, src, len);
+                sink += RefSum(dst, len, 0);
+                break;
+            default:
+                sink += csum_partial_copy_neon(src, dst, len, 0);
+                break;
+        }
+    }
+    (void)sink;
+    return ((double)iters * (double)len) / (Now() - start) / 1e6;
+}
+
+static void Bench(void)
+{
+    uint8_t *src = malloc(65536);
+    uint8_t *dst = malloc(65536);
+    size_t i;
+    int kind;
+
+    if ((src == NULL) || (dst == NULL)) {
+        free(src);
+        free(dst);
+        return;
+    }
+    for (i = 0; i < 65536; i++) {
+        src[i] = (uint8_t)rand();
+    }
+
+    printf("%8s", "len");
+    for (kind = 0; kind < BENCH_NUM; kind++) {
+        printf("%16s", g_benchName[kind]);
+    }
+    printf("   (MB/s)\n");
+    for (i = 0; i < (sizeof(g_benchLen) / sizeof(g_benchLen[0])); i++) {
+        printf("%8d", g_benchLen[i]);
+        for (kind = 0; kind < BENCH_NUM; kind++) {
+            printf("%16.1f", BenchOne(kind, src, dst, g_benchLen[i]));
+        }
+        printf("\n");
+    }
+    free(src);
+    free(dst);
+}
+
+int main(int argc, char **argv)
+{
+    srand(1);
+    if (Check() != 0) {
+        return 1;
+    }
+    if ((argc < 2) || (strcmp(argv[1], "-n") != 0)) {
+        Bench();
+    }
+    return 0;
+}
@@ -33,8 +33,11 @@ set -e
 system=$(uname -s)
 ROOTFS_DIR=$1
 FSTYPE=$2
+JFFS2_SUMMARY=${JFFS2_SUMMARY:-n}
+JFFS2_ERASE_SIZE=${JFFS2_ERASE_SIZE:-0x10000}
 ROOTFS_IMG=${ROOTFS_DIR}"_"${FSTYPE}".img"
 JFFS2_TOOL=mkfs.jffs2
+JFFS2_SUM_TOOL=sumtool
 WIN_JFFS2_TOOL=mkfs.jffs2.exe
 YAFFS2_TOOL=mkyaffs2image100
 VFAT_TOOL=mkfs.vfat
@@ -60,10 +63,15 @@ fi
 if [ "${FSTYPE}" = "jffs2" ]; then
     if [ "${system}" != "Linux" ] ; then
         tool_check ${WIN_JFFS2_TOOL}
-        ${WIN_JFFS2_TOOL} -q -o ${ROOTFS_IMG} -d ${ROOTFS_DIR} --pagesize=4096
+        ${WIN_JFFS2_TOOL} -q -o ${ROOTFS_IMG} -d ${ROOTFS_DIR} --pagesize=4096 -e ${JFFS2_ERASE_SIZE}
     else
         tool_check ${JFFS2_TOOL}
-        ${JFFS2_TOOL} -q -o ${ROOTFS_IMG} -d ${ROOTFS_DIR} --pagesize=4096
+        ${JFFS2_TOOL} -q -o ${ROOTFS_IMG} -d ${ROOTFS_DIR} --pagesize=4096 -e ${JFFS2_ERASE_SIZE}
+        if [ "${JFFS2_SUMMARY}" = "y" ]; then
+            tool_check ${JFFS2_SUM_TOOL}
+            ${JFFS2_SUM_TOOL} -e ${JFFS2_ERASE_SIZE} -p -i ${ROOTFS_IMG} -o ${ROOTFS_IMG}.sum
+            mv ${ROOTFS_IMG}.sum ${ROOTFS_IMG}
+        fi
     fi
 elif [ "${FSTYPE}" = "yaffs2" ]; then
         tool_check ${YAFFS2_TOOL}